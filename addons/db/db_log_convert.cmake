@@ -0,0 +1,24 @@
+# Build statsdb_log_convert utility; we do this in a file included from the
+# top-level CMakeLists.txt file instead of in addons/db/CMakeLists.txt
+# so that we can get the final values of ALL_INCLUDES, etc., and also
+# make sure we build after simlib is ready.
+
+add_executable(statsdb_log_convert ${CMAKE_CURRENT_LIST_DIR}/src/db-log-convert.cpp)
+target_link_libraries(statsdb_log_convert ${ALL_LINK_LIBS})
+if (USE_MPI AND MPI_CXX_LIBRARIES)
+    target_link_libraries(statsdb_log_convert ${MPI_CXX_LIBRARIES})
+endif ()
+set_target_properties(statsdb_log_convert
+  PROPERTIES COMPILE_FLAGS "${EXTRA_COMPILE_FLAGS}"
+             RUNTIME_OUTPUT_DIRECTORY ${CMAKE_BINARY_DIR}/bin
+             RUNTIME_OUTPUT_DIRECTORY_RELEASE ${CMAKE_BINARY_DIR}/bin
+             RUNTIME_OUTPUT_DIRECTORY_RELWITHDEBINFO ${CMAKE_BINARY_DIR}/bin
+             RUNTIME_OUTPUT_DIRECTORY_MINSIZEREL ${CMAKE_BINARY_DIR}/bin
+             RUNTIME_OUTPUT_DIRECTORY_DEBUG ${CMAKE_BINARY_DIR}/bin
+             FOLDER "Utilities")
+if (USE_MPI AND MPI_CXX_LINK_FLAGS)
+    set_target_properties(statsdb_log_convert
+        PROPERTIES LINK_FLAGS "${MPI_CXX_LINK_FLAGS}")
+endif ()
+
+install(TARGETS statsdb_log_convert RUNTIME DESTINATION bin)
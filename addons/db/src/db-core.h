@@ -19,6 +19,7 @@
 #define _DBCORE_H_
 
 #include <string>
+#include <vector>
 
 #include "node.h"
 
@@ -38,15 +39,26 @@ enum dbEngineType
 {
     dbSqlite,
     dbMariaDB,
+    dbLog,          // columnar log, converted to SQLite afterwards
     dbMaxEngineType
 };
 
+// One row to insert into a table.  The values are in the textual form
+// they would have in an INSERT statement, without the quotes.  Columns
+// other than the first with an empty name are skipped.
+struct DatabaseRow
+{
+    std::string table;
+    std::vector<std::string> columns;
+    std::vector<std::string> values;
+};
+
 struct DatabaseDriver
 {
     virtual void open(bool dropDatabase) = 0;
     virtual void close() = 0;
 
-    DatabaseDriver() : inTransaction(false) { }
+    DatabaseDriver() : maxBatchRows(0), inTransaction(false) { }
 
     void startTransaction()
     {
@@ -77,6 +89,10 @@ struct DatabaseDriver
     virtual void exec(const std::string& query) = 0;
     virtual void exec(std::string in, std::string& out) = 0;
 
+    // Drivers that can bind the values of a row override this, the
+    // default executes the equivalent INSERT statement.
+    virtual void insert(const DatabaseRow& row) { exec(insertSQL(row)); }
+
     // the properties and methods below should probably be private,
     // in that they are clearly implimentation details.  However
     // it all works like this and there is little real gain from
@@ -84,8 +100,39 @@ struct DatabaseDriver
     dbEngineType engineType;
     unsigned sleepCounter;
     size_t maxEngineBuffer;
+    size_t maxBatchRows;  // rows per transaction, 0 if unlimited
     bool inTransaction;
 
+    static std::string insertSQL(const DatabaseRow& row)
+    {
+        std::string query;
+
+        if (row.columns.empty()) return query;
+
+        query = "INSERT INTO ";
+        query += row.table;
+        query += "(";
+        query += row.columns[0];
+        std::string values = ") VALUES('";
+        values += row.values[0];
+        values += "'";
+
+        for (size_t i = 1; i < row.values.size(); i++)
+        {
+            if (row.columns[i].length() > 0)
+            {
+                query += ",";
+                query += row.columns[i];
+                values += ",'";
+                values += row.values[i];
+                values += "'";
+            }
+        }
+        query += values;
+        query += ")";
+        return query;
+    }
+
     static std::string marshall(char** table, int nrow, int ncol) {
         std::string result;
         //char buf[BUFSIZ];
@@ -0,0 +1,499 @@
+// Copyright (c) 2001-2015, SCALABLE Network Technologies, Inc.  All Rights Reserved.
+//                          600 Corporate Pointe
+//                          Suite 1200
+//                          Culver City, CA 90230
+//                          info@scalable-networks.com
+//
+// This source code is licensed, not sold, and is subject to a written
+// license agreement.  Among other things, no portion of this source
+// code may be copied, transmitted, disclosed, displayed, distributed,
+// translated, used as the basis for a derivative work, or used, in
+// whole or in part, for any program or purpose other than its intended
+// use in compliance with the license agreement as part of the QualNet
+// software.  This source code and certain of the algorithms contained
+// within it are confidential trade secrets of Scalable Network
+// Technologies, Inc. and may not be used as the basis for any other
+// software, hardware, product or service.
+
+/*
+ * Converts a StatsDB columnar log (STATS-DB-ENGINE LOG) into the SQLite
+ * database the simulation would have written with STATS-DB-ENGINE SQLITE.
+ *
+ *   statsdb_log_convert <log directory> <database file>
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <sqlite3.h>
+
+#include "api.h"
+#include "db-log.h"
+
+using namespace UTIL::Database;
+
+// The segments of the table file holding one stream of a column
+struct ConvertStream
+{
+    std::vector<UInt64> starts;     // stream offset of each segment
+    std::vector<long> offsets;      // file offset of its bytes
+    std::vector<UInt32> lengths;
+    UInt64 size;
+};
+
+// The streams of one column, the cells read in row order
+struct ConvertColumn
+{
+    LogColumnDesc desc;
+    ConvertStream streams[logNumStreams];
+    UInt64 nextCell;
+    std::vector<UInt64> cells;      // read ahead from nextCell on
+    size_t cellIndex;
+    std::map<UInt64, UInt64> overflow;  // strings offset by row
+    std::map<UInt64, std::string> cache;
+};
+
+struct ConvertTable
+{
+    LogTableDesc desc;
+    FILE* fp;
+    UInt64 insertedRows;
+    std::vector<ConvertColumn> columns;
+
+    // Insert of the first columns, by their number.  The columns are in
+    // the order of their start rows, so the columns a row may set are
+    // always the first ones.
+    std::vector<sqlite3_stmt*> inserts;
+};
+
+static sqlite3* convertDb;
+static UInt64 convertErrors;
+
+static
+void ConvertExec(const std::string& statement)
+{
+    char* errMsg = NULL;
+
+    if (sqlite3_exec(convertDb, statement.c_str(), NULL, NULL, &errMsg)
+        != SQLITE_OK)
+    {
+        fprintf(stderr, "Error: %s\n  in %s\n",
+                errMsg ? errMsg : sqlite3_errmsg(convertDb),
+                statement.c_str());
+        sqlite3_free(errMsg);
+        convertErrors++;
+    }
+}
+
+// Reads bytes of a stream from the segments holding them, returns false
+// if the stream ends first
+static
+bool ConvertReadStream(FILE* fp,
+                       const ConvertStream* stream,
+                       UInt64 offset,
+                       void* data,
+                       size_t length)
+{
+    char* bytes = (char*) data;
+    size_t i;
+
+    if (offset + length > stream->size)
+    {
+        return false;
+    }
+
+    i = std::upper_bound(stream->starts.begin(), stream->starts.end(),
+                         offset) - stream->starts.begin() - 1;
+    while (length > 0)
+    {
+        UInt64 skip = offset - stream->starts[i];
+        size_t count = (size_t) MIN(length, stream->lengths[i] - skip);
+
+        if (fseek(fp, stream->offsets[i] + (long) skip, SEEK_SET) != 0 ||
+            fread(bytes, 1, count, fp) != count)
+        {
+            return false;
+        }
+        bytes += count;
+        offset += count;
+        length -= count;
+        i++;
+    }
+    return true;
+}
+
+// Reads the next cell of the column, returns false past its last cell
+static
+bool ConvertReadCell(FILE* fp, ConvertColumn* column, UInt64* cell)
+{
+    if (column->cellIndex == column->cells.size())
+    {
+        const ConvertStream* stream = &column->streams[logCells];
+        UInt64 numCells = stream->size / sizeof(UInt64) - column->nextCell;
+
+        column->cells.resize((size_t) MIN(numCells, 1024));
+        column->cellIndex = 0;
+        if (column->cells.empty() ||
+            !ConvertReadStream(fp, stream, column->nextCell * sizeof(UInt64),
+                               &column->cells[0],
+                               column->cells.size() * sizeof(UInt64)))
+        {
+            column->cells.clear();
+            return false;
+        }
+        column->nextCell += column->cells.size();
+    }
+    *cell = column->cells[column->cellIndex++];
+    return true;
+}
+
+// Returns the string at the offset of the strings of the column
+static
+const std::string& ConvertReadString(FILE* fp,
+                                     ConvertColumn* column,
+                                     UInt64 offset)
+{
+    std::map<UInt64, std::string>::iterator it = column->cache.find(offset);
+    const ConvertStream* stream = &column->streams[logStrings];
+    UInt32 length = 0;
+    std::string value;
+
+    if (it != column->cache.end())
+    {
+        return it->second;
+    }
+
+    if (ConvertReadStream(fp, stream, offset, &length, sizeof(length)))
+    {
+        value.resize(length);
+        if (length > 0 &&
+            !ConvertReadStream(fp, stream, offset + sizeof(length),
+                               &value[0], length))
+        {
+            value.clear();
+        }
+    }
+
+    // Values beyond the dictionary of the log are seldom repeated
+    if (column->cache.size() >= STATSDB_LOG_MAX_DICTIONARY)
+    {
+        column->cache.erase(column->cache.begin());
+    }
+    return column->cache[offset] = value;
+}
+
+// Opens the file of the table and finds the segments of its streams.  A
+// segment cut short at the end of the file is left out.
+static
+bool ConvertOpenTable(const std::string& logName,
+                      int number,
+                      ConvertTable* table)
+{
+    std::string fileName = LogFileName(logName, number, "data");
+    UInt32 header[3];
+    long fileSize;
+
+    table->insertedRows = 0;
+    table->columns.resize(table->desc.columns.size());
+    table->inserts.resize(table->columns.size() + 1, NULL);
+
+    table->fp = fopen(fileName.c_str(), "rb");
+    if (table->fp == NULL)
+    {
+        fprintf(stderr, "Can't open %s\n", fileName.c_str());
+        return false;
+    }
+    fseek(table->fp, 0, SEEK_END);
+    fileSize = ftell(table->fp);
+    rewind(table->fp);
+
+    for (size_t i = 0; i < table->columns.size(); i++)
+    {
+        ConvertColumn& column = table->columns[i];
+
+        column.desc = table->desc.columns[i];
+        column.nextCell = 0;
+        column.cellIndex = 0;
+        for (int j = 0; j < logNumStreams; j++)
+        {
+            column.streams[j].size = 0;
+        }
+    }
+
+    while (fread(header, sizeof(header), 1, table->fp) == 1)
+    {
+        long offset = ftell(table->fp);
+
+        if (offset + (long) header[2] > fileSize ||
+            fseek(table->fp, offset + (long) header[2], SEEK_SET) != 0)
+        {
+            break;
+        }
+        if (header[0] < table->columns.size() && header[1] < logNumStreams)
+        {
+            ConvertStream& stream = table->columns[header[0]].streams[header[1]];
+            stream.starts.push_back(stream.size);
+            stream.offsets.push_back(offset);
+            stream.lengths.push_back(header[2]);
+            stream.size += header[2];
+        }
+    }
+
+    for (size_t i = 0; i < table->columns.size(); i++)
+    {
+        ConvertColumn& column = table->columns[i];
+        const ConvertStream* stream = &column.streams[logOverflow];
+        UInt64 entry[2];
+
+        for (UInt64 offset = 0;
+             ConvertReadStream(table->fp, stream, offset, entry, sizeof(entry));
+             offset += sizeof(entry))
+        {
+            column.overflow[entry[0]] = entry[1];
+        }
+    }
+    return true;
+}
+
+// Returns the insert of the first columns of the table, prepared at the
+// first row that needs it so that the statements before have created
+// the columns
+static
+sqlite3_stmt* ConvertPrepare(ConvertTable* table, size_t numColumns)
+{
+    std::string sql = "INSERT INTO " + table->desc.name + "(";
+    std::string values;
+
+    if (table->inserts[numColumns] != NULL)
+    {
+        return table->inserts[numColumns];
+    }
+
+    for (size_t i = 0; i < numColumns; i++)
+    {
+        if (i > 0)
+        {
+            sql += ",";
+            values += ",";
+        }
+        sql += table->columns[i].desc.name;
+        values += "?";
+    }
+    sql += ") VALUES(" + values + ")";
+
+    if (sqlite3_prepare_v2(convertDb, sql.c_str(), -1,
+                           &table->inserts[numColumns], NULL)
+        != SQLITE_OK)
+    {
+        fprintf(stderr, "Error: %s\n  in %s\n",
+                sqlite3_errmsg(convertDb), sql.c_str());
+        table->inserts[numColumns] = NULL;
+        convertErrors++;
+    }
+    return table->inserts[numColumns];
+}
+
+// Inserts the rows of the table up to the count.  The columns a row did
+// not set are NULL.
+static
+void ConvertInsertRows(ConvertTable* table, UInt64 numRows)
+{
+    size_t numColumns = 0;
+
+    if (numRows > table->desc.numRows)
+    {
+        numRows = table->desc.numRows;
+    }
+
+    for (UInt64 row = table->insertedRows; row < numRows; row++)
+    {
+        sqlite3_stmt* insert;
+
+        while (numColumns < table->columns.size() &&
+               table->columns[numColumns].desc.startRow <= row)
+        {
+            numColumns++;
+        }
+        insert = ConvertPrepare(table, numColumns);
+
+        for (size_t i = 0; i < numColumns; i++)
+        {
+            ConvertColumn* column = &table->columns[i];
+            int index = (int) i + 1;
+            UInt64 cell;
+
+            if (!ConvertReadCell(table->fp, column, &cell))
+            {
+                sqlite3_bind_null(insert, index);
+            }
+            else if (cell == STATSDB_LOG_NULL)
+            {
+                std::map<UInt64, UInt64>::iterator it =
+                    column->overflow.find(row);
+                if (it == column->overflow.end())
+                {
+                    sqlite3_bind_null(insert, index);
+                }
+                else
+                {
+                    const std::string& value =
+                        ConvertReadString(table->fp, column, it->second);
+                    sqlite3_bind_text(insert, index, value.data(),
+                                      (int) value.length(),
+                                      SQLITE_TRANSIENT);
+                }
+            }
+            else if (column->desc.kind == logInteger)
+            {
+                Int64 value;
+                memcpy(&value, &cell, sizeof(value));
+                sqlite3_bind_int64(insert, index, value);
+            }
+            else if (column->desc.kind == logReal)
+            {
+                double value;
+                memcpy(&value, &cell, sizeof(value));
+                sqlite3_bind_double(insert, index, value);
+            }
+            else
+            {
+                const std::string& value =
+                    ConvertReadString(table->fp, column, cell - 1);
+                sqlite3_bind_text(insert, index, value.data(),
+                                  (int) value.length(), SQLITE_TRANSIENT);
+            }
+        }
+
+        if (insert == NULL)
+        {
+            continue;
+        }
+        if (sqlite3_step(insert) != SQLITE_DONE)
+        {
+            fprintf(stderr, "Error: %s\n  inserting into %s\n",
+                    sqlite3_errmsg(convertDb), table->desc.name.c_str());
+            convertErrors++;
+        }
+        sqlite3_reset(insert);
+    }
+    table->insertedRows = numRows;
+}
+
+int main(int argc, char** argv)
+{
+    std::vector<LogTableDesc> descs;
+    std::vector<ConvertTable> tables;
+    std::string logName;
+    std::string statement;
+    UInt64 numStatements = 0;
+    UInt64 numRows = 0;
+    FILE* fp;
+
+    if (argc != 3)
+    {
+        fprintf(stderr, "Usage: %s <log directory> <database file>\n",
+                argv[0]);
+        return 1;
+    }
+
+    logName = argv[1];
+    if (!LogReadManifest(logName, descs))
+    {
+        fprintf(stderr, "Can't read the manifest of %s\n", argv[1]);
+        return 1;
+    }
+
+    tables.resize(descs.size());
+    for (size_t i = 0; i < descs.size(); i++)
+    {
+        tables[i].desc = descs[i];
+        if (!ConvertOpenTable(logName, (int) i, &tables[i]))
+        {
+            return 1;
+        }
+    }
+
+    fp = fopen(LogFileName(logName, "statements").c_str(), "rb");
+    if (fp == NULL)
+    {
+        fprintf(stderr, "Can't open the statements of %s\n", argv[1]);
+        return 1;
+    }
+
+    remove(argv[2]);
+    if (sqlite3_open(argv[2], &convertDb) != SQLITE_OK)
+    {
+        fprintf(stderr, "Can't open %s: %s\n",
+                argv[2], sqlite3_errmsg(convertDb));
+        return 1;
+    }
+    ConvertExec("PRAGMA synchronous = OFF");
+    ConvertExec("PRAGMA journal_mode = OFF");
+    ConvertExec("BEGIN TRANSACTION");
+
+    // The statements come in the order they were executed.  Statements
+    // written after the last commit of the log may be cut short.
+    while (true)
+    {
+        UInt32 numCounts;
+        UInt32 length;
+        bool complete = true;
+
+        if (fread(&numCounts, sizeof(numCounts), 1, fp) != 1)
+        {
+            break;
+        }
+        for (UInt32 i = 0; i < numCounts && complete; i++)
+        {
+            UInt32 table;
+            UInt64 count;
+
+            complete = fread(&table, sizeof(table), 1, fp) == 1 &&
+                       fread(&count, sizeof(count), 1, fp) == 1;
+            if (complete && table < tables.size())
+            {
+                ConvertInsertRows(&tables[table], count);
+            }
+        }
+        if (!complete || fread(&length, sizeof(length), 1, fp) != 1)
+        {
+            break;
+        }
+
+        statement.resize(length);
+        if (length > 0 && fread(&statement[0], 1, length, fp) != length)
+        {
+            break;
+        }
+
+        ConvertExec(statement);
+        numStatements++;
+    }
+    fclose(fp);
+
+    for (size_t i = 0; i < tables.size(); i++)
+    {
+        ConvertInsertRows(&tables[i], tables[i].desc.numRows);
+        numRows += tables[i].insertedRows;
+
+        for (size_t j = 0; j < tables[i].inserts.size(); j++)
+        {
+            sqlite3_finalize(tables[i].inserts[j]);
+        }
+        fclose(tables[i].fp);
+    }
+
+    ConvertExec("COMMIT");
+    sqlite3_close(convertDb);
+
+    printf("%s: %" TYPES_64BITFMT "u statements, %" TYPES_64BITFMT "u rows "
+           "in %d tables, %" TYPES_64BITFMT "u errors\n",
+           argv[2], numStatements, numRows, (int) tables.size(),
+           convertErrors);
+    return convertErrors > 0 ? 1 : 0;
+}
@@ -0,0 +1,677 @@
+// Copyright (c) 2001-2015, SCALABLE Network Technologies, Inc.  All Rights Reserved.
+//                          600 Corporate Pointe
+//                          Suite 1200
+//                          Culver City, CA 90230
+//                          info@scalable-networks.com
+//
+// This source code is licensed, not sold, and is subject to a written
+// license agreement.  Among other things, no portion of this source
+// code may be copied, transmitted, disclosed, displayed, distributed,
+// translated, used as the basis for a derivative work, or used, in
+// whole or in part, for any program or purpose other than its intended
+// use in compliance with the license agreement as part of the QualNet
+// software.  This source code and certain of the algorithms contained
+// within it are confidential trade secrets of Scalable Network
+// Technologies, Inc. and may not be used as the basis for any other
+// software, hardware, product or service.
+
+#include <string>
+#include <vector>
+#include <map>
+#include <ctype.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#include <sys/types.h>
+#endif
+
+#include "fileio.h"
+#include "node.h"
+
+#include "db-core.h"
+#include "db-log.h"
+
+UTIL::Database::LogColumnKind UTIL::Database::LogColumnKindOf(
+    const std::string& declaredType)
+{
+    std::string type = declaredType;
+
+    for (size_t i = 0; i < type.length(); i++)
+    {
+        type[i] = (char) toupper(type[i]);
+    }
+
+    if (type.find("INT") != std::string::npos)
+    {
+        return logInteger;
+    }
+    if (type.empty() ||
+        type.find("CHAR") != std::string::npos ||
+        type.find("CLOB") != std::string::npos ||
+        type.find("TEXT") != std::string::npos ||
+        type.find("BLOB") != std::string::npos)
+    {
+        return logText;
+    }
+    return logReal;
+}
+
+std::string UTIL::Database::LogFileName(
+    const std::string& logName,
+    const char* file)
+{
+    return logName + "/" + file;
+}
+
+std::string UTIL::Database::LogFileName(
+    const std::string& logName,
+    int table,
+    const char* extension)
+{
+    char file[MAX_STRING_LENGTH];
+
+    sprintf(file, "t%d.%s", table, extension);
+    return LogFileName(logName, file);
+}
+
+bool UTIL::Database::LogReadManifest(
+    const std::string& logName,
+    std::vector<LogTableDesc>& tables)
+{
+    std::string fileName = LogFileName(logName, "manifest");
+    FILE* fp = fopen(fileName.c_str(), "r");
+    char line[MAX_STRING_LENGTH];
+    char name[MAX_STRING_LENGTH];
+    int version = 0;
+
+    tables.clear();
+    if (fp == NULL)
+    {
+        return false;
+    }
+
+    if (fgets(line, sizeof(line), fp) == NULL ||
+        sscanf(line, "STATSDB-LOG %d", &version) != 1 ||
+        version != STATSDB_LOG_VERSION)
+    {
+        fclose(fp);
+        return false;
+    }
+
+    while (fgets(line, sizeof(line), fp) != NULL)
+    {
+        unsigned long long count;
+        char kind;
+
+        if (sscanf(line, "TABLE %s %llu", name, &count) == 2)
+        {
+            LogTableDesc table;
+            table.name = name;
+            table.numRows = count;
+            tables.push_back(table);
+        }
+        else if (sscanf(line, "COLUMN %s %c %llu", name, &kind, &count) == 3 &&
+                 !tables.empty())
+        {
+            LogColumnDesc column;
+            column.name = name;
+            column.kind = kind;
+            column.startRow = count;
+            tables.back().columns.push_back(column);
+        }
+    }
+
+    fclose(fp);
+    return true;
+}
+
+bool UTIL::Database::ColumnarLogDriver::LogFile::open(const std::string& name)
+{
+    fp = fopen(name.c_str(), "wb");
+    size = 0;
+    used = 0;
+    return fp != NULL;
+}
+
+void UTIL::Database::ColumnarLogDriver::LogFile::write(
+    const void* data,
+    size_t length)
+{
+    if (used + length > sizeof(buffer))
+    {
+        flush();
+        if (length > sizeof(buffer))
+        {
+            fwrite(data, 1, length, fp);
+            size += length;
+            return;
+        }
+    }
+    memcpy(buffer + used, data, length);
+    used += length;
+    size += length;
+}
+
+void UTIL::Database::ColumnarLogDriver::LogFile::flush()
+{
+    if (fp == NULL) return;
+    if (used > 0)
+    {
+        fwrite(buffer, 1, used, fp);
+        used = 0;
+    }
+    fflush(fp);
+}
+
+void UTIL::Database::ColumnarLogDriver::LogFile::close()
+{
+    if (fp == NULL) return;
+    flush();
+    fclose(fp);
+    fp = NULL;
+}
+
+UTIL::Database::ColumnarLogDriver::ColumnarLogDriver(std::string p_logName)
+    : logName(p_logName), isOpen(false)
+{
+    engineType = dbLog;
+    maxEngineBuffer = 0;
+}
+
+UTIL::Database::ColumnarLogDriver::ColumnarLogDriver(ColumnarLogDriver& db)
+    : logName(db.logName), isOpen(false)
+{
+    engineType = dbLog;
+    maxEngineBuffer = 0;
+    maxBatchRows = db.maxBatchRows;
+}
+
+UTIL::Database::ColumnarLogDriver::~ColumnarLogDriver()
+{
+    if (isOpen) close();
+}
+
+void UTIL::Database::ColumnarLogDriver::open(bool dropDatabase)
+{
+    // The directory may exist, so ignore errors
+#ifdef _WIN32
+    _mkdir(logName.c_str());
+#else
+    mkdir(logName.c_str(), 0777);
+#endif
+
+    if (dropDatabase)
+    {
+        removeFiles();
+    }
+    else
+    {
+        ERROR_ReportWarningArgs("The log %s is always written from the start",
+                                logName.c_str());
+    }
+
+    if (!statements.open(LogFileName(logName, "statements")))
+    {
+        ERROR_ReportErrorArgs("Can't open the log %s", logName.c_str());
+    }
+    isOpen = true;
+    writeManifest();
+}
+
+void UTIL::Database::ColumnarLogDriver::close()
+{
+    if (!isOpen) return;
+    if (STATS_DEBUG) printf("LOG:closing\n");
+    flush();
+
+    for (size_t i = 0; i < tables.size(); i++)
+    {
+        LogTable* table = tables[i];
+        for (size_t j = 0; j < table->columns.size(); j++)
+        {
+            delete table->columns[j];
+        }
+        if (table->fp != NULL)
+        {
+            fclose(table->fp);
+        }
+        delete table;
+    }
+    tables.clear();
+    tableNames.clear();
+    statements.close();
+    isOpen = false;
+    if (STATS_DEBUG) printf("LOG:closed\n");
+}
+
+// Removes the files of a previous log with the same name
+void UTIL::Database::ColumnarLogDriver::removeFiles()
+{
+    std::vector<LogTableDesc> oldTables;
+
+    LogReadManifest(logName, oldTables);
+    for (size_t i = 0; i < oldTables.size(); i++)
+    {
+        remove(LogFileName(logName, (int) i, "data").c_str());
+    }
+    remove(LogFileName(logName, "statements").c_str());
+    remove(LogFileName(logName, "manifest").c_str());
+}
+
+void UTIL::Database::ColumnarLogDriver::exec(const std::string& query)
+{
+    std::vector<std::pair<UInt32, UInt64> > counts;
+    UInt32 length;
+
+    parseStatement(query);
+
+    // The rows logged before the statement are inserted before it
+    for (size_t i = 0; i < tables.size(); i++)
+    {
+        if (tables[i]->numRows != tables[i]->loggedRows)
+        {
+            counts.push_back(std::make_pair((UInt32) i, tables[i]->numRows));
+            tables[i]->loggedRows = tables[i]->numRows;
+        }
+    }
+
+    length = (UInt32) counts.size();
+    statements.write(&length, sizeof(length));
+    for (size_t i = 0; i < counts.size(); i++)
+    {
+        statements.write(&counts[i].first, sizeof(UInt32));
+        statements.write(&counts[i].second, sizeof(UInt64));
+    }
+
+    length = (UInt32) query.length();
+    statements.write(&length, sizeof(length));
+    statements.write(query.data(), length);
+}
+
+void UTIL::Database::ColumnarLogDriver::exec(std::string in, std::string& out)
+{
+    out = "";
+}
+
+// Reads the column types of CREATE TABLE and ALTER TABLE ADD COLUMN
+void UTIL::Database::ColumnarLogDriver::parseStatement(const std::string& query)
+{
+    std::string upper = query.substr(0, 64);
+    LogTable* table;
+    size_t start;
+    size_t end;
+
+    for (size_t i = 0; i < upper.length(); i++)
+    {
+        upper[i] = (char) toupper(upper[i]);
+    }
+
+    if (upper.compare(0, 12, "CREATE TABLE") == 0)
+    {
+        size_t open = query.find('(');
+        int depth = 0;
+
+        if (open == std::string::npos) return;
+
+        start = 12;
+        if (upper.compare(13, 13, "IF NOT EXISTS") == 0)
+        {
+            start = 26;
+        }
+        start = query.find_first_not_of(" ", start);
+        end = query.find_last_not_of(" ", open - 1);
+        table = findTable(query.substr(start, end + 1 - start));
+
+        // The column definitions are separated by the commas outside
+        // parentheses, such as those of varchar(64)
+        start = open + 1;
+        for (end = start; end < query.length(); end++)
+        {
+            char c = query[end];
+            if (c == '(') depth++;
+            if ((c == ',' && depth == 0) || (c == ')' && depth-- == 0))
+            {
+                std::string definition = query.substr(start, end - start);
+                size_t nameStart = definition.find_first_not_of(" ");
+                size_t nameEnd = definition.find(' ', nameStart);
+                if (nameStart != std::string::npos)
+                {
+                    std::string type;
+                    if (nameEnd != std::string::npos)
+                    {
+                        type = definition.substr(nameEnd + 1);
+                    }
+                    table->declaredKinds[definition.substr(
+                        nameStart, nameEnd - nameStart)] =
+                        LogColumnKindOf(type);
+                }
+                if (c == ')') break;
+                start = end + 1;
+            }
+        }
+    }
+    else if (upper.compare(0, 11, "ALTER TABLE") == 0)
+    {
+        size_t add = upper.find(" ADD COLUMN ");
+        size_t nameEnd;
+
+        if (add == std::string::npos) return;
+
+        start = query.find_first_not_of(" ", 11);
+        end = query.find(' ', start);
+        table = findTable(query.substr(start, end - start));
+
+        start = query.find_first_not_of(" ", add + 12);
+        nameEnd = query.find(' ', start);
+        if (start == std::string::npos) return;
+        table->declaredKinds[query.substr(start, nameEnd - start)] =
+            LogColumnKindOf(nameEnd == std::string::npos ?
+                                "" : query.substr(nameEnd + 1));
+    }
+}
+
+UTIL::Database::ColumnarLogDriver::LogTable*
+UTIL::Database::ColumnarLogDriver::findTable(const std::string& name)
+{
+    std::map<std::string, LogTable*>::iterator it = tableNames.find(name);
+
+    if (it != tableNames.end())
+    {
+        return it->second;
+    }
+
+    LogTable* table = new LogTable;
+    table->name = name;
+    table->number = (int) tables.size();
+    table->pending = 0;
+    table->fp = fopen(LogFileName(logName, table->number, "data").c_str(),
+                      "wb");
+    if (table->fp == NULL)
+    {
+        ERROR_ReportErrorArgs("Can't open the data of %s in %s",
+                              name.c_str(), logName.c_str());
+    }
+    table->numRows = 0;
+    table->loggedRows = 0;
+    tables.push_back(table);
+    tableNames[name] = table;
+    return table;
+}
+
+UTIL::Database::ColumnarLogDriver::LogColumn*
+UTIL::Database::ColumnarLogDriver::addColumn(
+    LogTable* table,
+    const std::string& name)
+{
+    std::map<std::string, LogColumnKind>::iterator it =
+        table->declaredKinds.find(name);
+    LogColumn* column = new LogColumn;
+    int number = (int) table->columns.size();
+
+    column->name = name;
+    column->number = number;
+    column->kind = (it == table->declaredKinds.end()) ? logText : it->second;
+    column->startRow = table->numRows;
+
+    table->columns.push_back(column);
+    table->columnNumbers[name] = number;
+    return column;
+}
+
+const std::vector<int>& UTIL::Database::ColumnarLogDriver::layout(
+    LogTable* table,
+    const DatabaseRow& row)
+{
+    layoutKey = row.columns[0];
+    for (size_t i = 1; i < row.values.size(); i++)
+    {
+        if (row.columns[i].length() > 0)
+        {
+            layoutKey += ",";
+            layoutKey += row.columns[i];
+        }
+    }
+
+    std::map<std::string, std::vector<int> >::iterator it =
+        table->layouts.find(layoutKey);
+    if (it != table->layouts.end())
+    {
+        return it->second;
+    }
+
+    std::vector<int>& numbers = table->layouts[layoutKey];
+    for (size_t i = 0; i < row.values.size(); i++)
+    {
+        if (i > 0 && row.columns[i].length() == 0)
+        {
+            numbers.push_back(-1);
+            continue;
+        }
+
+        std::map<std::string, int>::iterator number =
+            table->columnNumbers.find(row.columns[i]);
+        if (number == table->columnNumbers.end())
+        {
+            addColumn(table, row.columns[i]);
+            number = table->columnNumbers.find(row.columns[i]);
+        }
+        numbers.push_back(number->second);
+    }
+    return numbers;
+}
+
+void UTIL::Database::ColumnarLogDriver::insert(const DatabaseRow& row)
+{
+    LogTable* table;
+
+    if (row.columns.empty()) return;
+
+    table = findTable(row.table);
+    const std::vector<int>& numbers = layout(table, row);
+
+    for (size_t i = 0; i < numbers.size(); i++)
+    {
+        if (numbers[i] >= 0)
+        {
+            writeCell(table, table->columns[numbers[i]], row.values[i]);
+        }
+    }
+    table->numRows++;
+}
+
+// Writes NULL cells up to the row of the table
+void UTIL::Database::ColumnarLogDriver::padColumn(
+    LogTable* table,
+    LogColumn* column)
+{
+    UInt64 cells = column->startRow +
+                   column->streams[logCells].size / sizeof(UInt64);
+
+    for (; cells < table->numRows; cells++)
+    {
+        append(table, column, logCells, &STATSDB_LOG_NULL, sizeof(UInt64));
+    }
+}
+
+// Adds bytes to a stream of a column, writing out the streams of the
+// table once they fill the buffer
+void UTIL::Database::ColumnarLogDriver::append(
+    LogTable* table,
+    LogColumn* column,
+    LogStreamKind stream,
+    const void* data,
+    size_t length)
+{
+    LogStream& s = column->streams[stream];
+    const char* bytes = (const char*) data;
+
+    s.pending.insert(s.pending.end(), bytes, bytes + length);
+    s.size += length;
+    table->pending += length;
+    if (table->pending >= STATSDB_LOG_BUFFER_SIZE)
+    {
+        writeSegments(table);
+    }
+}
+
+// Writes a segment for each stream of the table with pending bytes
+void UTIL::Database::ColumnarLogDriver::writeSegments(LogTable* table)
+{
+    for (size_t i = 0; i < table->columns.size(); i++)
+    {
+        LogColumn* column = table->columns[i];
+        for (int j = 0; j < logNumStreams; j++)
+        {
+            std::vector<char>& pending = column->streams[j].pending;
+            UInt32 header[3];
+
+            if (pending.empty()) continue;
+
+            header[0] = (UInt32) column->number;
+            header[1] = (UInt32) j;
+            header[2] = (UInt32) pending.size();
+            if (fwrite(header, sizeof(header), 1, table->fp) != 1 ||
+                fwrite(&pending[0], 1, pending.size(), table->fp)
+                    != pending.size())
+            {
+                ERROR_ReportErrorArgs("Can't write the data of %s in %s",
+                                      table->name.c_str(), logName.c_str());
+            }
+            pending.clear();
+        }
+    }
+    table->pending = 0;
+}
+
+UInt64 UTIL::Database::ColumnarLogDriver::writeString(
+    LogTable* table,
+    LogColumn* column,
+    const std::string& value)
+{
+    UNORDERED_MAP<std::string, UInt64>::iterator it =
+        column->dictionary.find(value);
+    UInt64 offset;
+    UInt32 length = (UInt32) value.length();
+
+    if (it != column->dictionary.end())
+    {
+        return it->second;
+    }
+
+    offset = column->streams[logStrings].size;
+    append(table, column, logStrings, &length, sizeof(length));
+    append(table, column, logStrings, value.data(), length);
+
+    if (column->dictionary.size() < STATSDB_LOG_MAX_DICTIONARY)
+    {
+        column->dictionary[value] = offset;
+    }
+    return offset;
+}
+
+void UTIL::Database::ColumnarLogDriver::writeCell(
+    LogTable* table,
+    LogColumn* column,
+    const std::string& value)
+{
+    const char* text = value.c_str();
+    char* end;
+    UInt64 cell;
+
+    padColumn(table, column);
+
+    if (column->kind == logText)
+    {
+        cell = writeString(table, column, value) + 1;
+        append(table, column, logCells, &cell, sizeof(cell));
+        return;
+    }
+
+    // Only plain decimal numbers, as in Sqlite3Driver::bind
+    if (!value.empty() &&
+        value.find_first_not_of("0123456789+-.eE") == std::string::npos)
+    {
+        errno = 0;
+        if (column->kind == logInteger)
+        {
+            Int64 integer = strtoll(text, &end, 10);
+            memcpy(&cell, &integer, sizeof(cell));
+        }
+        else
+        {
+            double real = strtod(text, &end);
+            memcpy(&cell, &real, sizeof(cell));
+        }
+        if (*end == '\0' && errno == 0 && cell != STATSDB_LOG_NULL)
+        {
+            append(table, column, logCells, &cell, sizeof(cell));
+            return;
+        }
+    }
+
+    // Kept as text, for the database to convert it as it would have
+    UInt64 overflow[2];
+    overflow[0] = table->numRows;
+    overflow[1] = writeString(table, column, value);
+    append(table, column, logOverflow, overflow, sizeof(overflow));
+    append(table, column, logCells, &STATSDB_LOG_NULL, sizeof(UInt64));
+}
+
+void UTIL::Database::ColumnarLogDriver::flush()
+{
+    if (!isOpen) return;
+
+    for (size_t i = 0; i < tables.size(); i++)
+    {
+        LogTable* table = tables[i];
+        for (size_t j = 0; j < table->columns.size(); j++)
+        {
+            padColumn(table, table->columns[j]);
+        }
+        writeSegments(table);
+        if (table->fp != NULL) fflush(table->fp);
+    }
+    statements.flush();
+    writeManifest();
+}
+
+// Writes the manifest beside and moves it over the old one, so that a
+// log is readable up to its last commit
+void UTIL::Database::ColumnarLogDriver::writeManifest()
+{
+    std::string fileName = LogFileName(logName, "manifest");
+    std::string tempName = fileName + ".tmp";
+    FILE* fp = fopen(tempName.c_str(), "w");
+
+    if (fp == NULL)
+    {
+        ERROR_ReportWarningArgs("Can't write the manifest of %s",
+                                logName.c_str());
+        return;
+    }
+
+    fprintf(fp, "STATSDB-LOG %d\n", STATSDB_LOG_VERSION);
+    for (size_t i = 0; i < tables.size(); i++)
+    {
+        LogTable* table = tables[i];
+        fprintf(fp, "TABLE %s %llu\n",
+                table->name.c_str(),
+                (unsigned long long) table->numRows);
+        for (size_t j = 0; j < table->columns.size(); j++)
+        {
+            fprintf(fp, "COLUMN %s %c %llu\n",
+                    table->columns[j]->name.c_str(),
+                    (char) table->columns[j]->kind,
+                    (unsigned long long) table->columns[j]->startRow);
+        }
+    }
+    fclose(fp);
+
+    remove(fileName.c_str());
+    rename(tempName.c_str(), fileName.c_str());
+}
@@ -0,0 +1,227 @@
+// Copyright (c) 2001-2015, SCALABLE Network Technologies, Inc.  All Rights Reserved.
+//                          600 Corporate Pointe
+//                          Suite 1200
+//                          Culver City, CA 90230
+//                          info@scalable-networks.com
+//
+// This source code is licensed, not sold, and is subject to a written
+// license agreement.  Among other things, no portion of this source
+// code may be copied, transmitted, disclosed, displayed, distributed,
+// translated, used as the basis for a derivative work, or used, in
+// whole or in part, for any program or purpose other than its intended
+// use in compliance with the license agreement as part of the QualNet
+// software.  This source code and certain of the algorithms contained
+// within it are confidential trade secrets of Scalable Network
+// Technologies, Inc. and may not be used as the basis for any other
+// software, hardware, product or service.
+
+#ifndef _DBLOG_H_
+#define _DBLOG_H_
+
+#include <map>
+#include <string>
+#include <vector>
+#include <stdio.h>
+#include <string.h>
+
+#include "db-core.h"
+#include "unordered_map_config.h"
+
+// The columnar log is a directory holding one file per table,
+// t<table>.data, in which each column has three streams:
+//
+//   cells     8-byte cells, one per row from the column's start row on
+//   strings   text values, a UInt32 length then the characters, each
+//             distinct value of a column stored once until the column
+//             has STATSDB_LOG_MAX_DICTIONARY
+//   overflow  (row, strings offset) of the values of a numeric column
+//             that are not numbers
+//
+// The streams of a table are buffered together and written out in
+// segments, each a UInt32 column, a UInt32 stream and a UInt32 length
+// followed by the bytes, so that a table keeps a single file open
+// whatever its number of columns.  The segments of a stream are in
+// order in the file.
+//
+// An integer cell is an Int64, a real cell a double, a text cell the
+// offset of the value in the strings file plus one.  STATSDB_LOG_NULL
+// (the bits of the cell) is NULL for the three kinds.
+//
+// The statements file holds every statement other than the rows, in
+// order, each preceded by the row counts of the tables that have grown
+// since the statement before:
+//
+//   UInt32 number of counts, then (UInt32 table, UInt64 rows) for each
+//   UInt32 length, then the statement
+//
+// The manifest, a text file rewritten at each commit, lists the tables
+// and columns in the order of their numbers.  The files are written in
+// the byte order of the simulation host.
+
+#define STATSDB_LOG_VERSION         2
+#define STATSDB_LOG_MAX_DICTIONARY  4096
+#define STATSDB_LOG_BUFFER_SIZE     65536
+
+namespace UTIL {
+namespace Database {
+
+// Kinds of column, from the affinity of its declared type
+enum LogColumnKind
+{
+    logInteger = 'I',
+    logReal    = 'R',
+    logText    = 'T'
+};
+
+// Streams of a column in the file of its table
+enum LogStreamKind
+{
+    logCells,
+    logStrings,
+    logOverflow,
+    logNumStreams
+};
+
+static const UInt64 STATSDB_LOG_NULL = 0x8000000000000000ULL;
+
+// Returns the kind of a column declared with the type, with the affinity
+// rules of SQLite
+LogColumnKind LogColumnKindOf(const std::string& declaredType);
+
+// Returns the name of a file of the log
+std::string LogFileName(const std::string& logName, const char* file);
+std::string LogFileName(const std::string& logName,
+                        int table,
+                        const char* extension);
+
+// One column, or one table, of the manifest
+struct LogColumnDesc
+{
+    std::string name;
+    char kind;
+    UInt64 startRow;
+};
+
+struct LogTableDesc
+{
+    std::string name;
+    UInt64 numRows;
+    std::vector<LogColumnDesc> columns;
+};
+
+// Reads the manifest of a log, returns false if it cannot be read
+bool LogReadManifest(const std::string& logName,
+                     std::vector<LogTableDesc>& tables);
+
+class ColumnarLogDriver : public DatabaseDriver
+{
+public:
+    ColumnarLogDriver(std::string p_logName);
+    ColumnarLogDriver(ColumnarLogDriver& db);
+    ~ColumnarLogDriver();
+
+    void open(bool dropDatabase);
+    void close();
+
+    void DriverCommit() {flush();}
+    void DriverFlush()  {flush();}
+
+    const char* error() {return "";}
+
+    // Logs the statement.  The columns of CREATE TABLE and ALTER TABLE
+    // statements give the kinds of the columns.
+    void exec(const std::string& query);
+
+    // The log cannot be read back, the result is always empty
+    void exec(std::string in, std::string& out);
+
+    void insert(const DatabaseRow& row);
+
+    // Writes out the buffers and the manifest
+    void flush();
+
+    const char* fileName() {return logName.c_str();}
+
+private:
+    // Buffered append-only file, for the statements
+    struct LogFile
+    {
+        FILE* fp;
+        UInt64 size;
+        size_t used;
+        char buffer[STATSDB_LOG_BUFFER_SIZE];
+
+        LogFile() : fp(NULL), size(0), used(0) {}
+        bool open(const std::string& name);
+        void write(const void* data, size_t length);
+        void flush();
+        void close();
+    };
+
+    // Bytes of a stream not yet written to the file of the table
+    struct LogStream
+    {
+        UInt64 size;        // bytes appended to the stream
+        std::vector<char> pending;
+
+        LogStream() : size(0) {}
+    };
+
+    struct LogColumn
+    {
+        std::string name;
+        int number;
+        LogColumnKind kind;
+        UInt64 startRow;
+        LogStream streams[logNumStreams];  // NULL cells are written when
+                                           // a later row sets the column,
+                                           // or at the flush
+        UNORDERED_MAP<std::string, UInt64> dictionary;
+    };
+
+    struct LogTable
+    {
+        std::string name;
+        int number;
+        FILE* fp;
+        size_t pending;     // bytes pending in the streams of the columns
+        UInt64 numRows;
+        UInt64 loggedRows;  // rows at the last statement
+        std::map<std::string, LogColumnKind> declaredKinds;
+        std::vector<LogColumn*> columns;
+        std::map<std::string, int> columnNumbers;
+
+        // Columns of the rows inserted, by the list of their names
+        std::map<std::string, std::vector<int> > layouts;
+    };
+
+    LogTable* findTable(const std::string& name);
+    LogColumn* addColumn(LogTable* table, const std::string& name);
+    const std::vector<int>& layout(LogTable* table, const DatabaseRow& row);
+    void padColumn(LogTable* table, LogColumn* column);
+    void writeCell(LogTable* table, LogColumn* column, const std::string& value);
+    UInt64 writeString(LogTable* table,
+                       LogColumn* column,
+                       const std::string& value);
+    void append(LogTable* table,
+                LogColumn* column,
+                LogStreamKind stream,
+                const void* data,
+                size_t length);
+    void writeSegments(LogTable* table);
+    void parseStatement(const std::string& query);
+    void writeManifest();
+    void removeFiles();
+
+    std::string logName;
+    std::vector<LogTable*> tables;
+    std::map<std::string, LogTable*> tableNames;
+    LogFile statements;
+    std::string layoutKey;
+    bool isOpen;
+
+}; // class ColumnarLogDriver
+}  // namespace Database
+}  // namespace UTIL
+
+#endif
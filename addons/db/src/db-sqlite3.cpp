@@ -19,6 +19,11 @@
 #include <vector>
 #include <iostream>
 #include <list>
+#include <map>
+#include <ctype.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include "fileio.h"
 #include "node.h"
@@ -28,19 +33,22 @@
 #include "sqlite3.h"
 
 UTIL::Database::Sqlite3Driver::Sqlite3Driver(std::string p_dbFileName)
-    : dbFileName(p_dbFileName)
+    : dbFile(NULL), dbFileName(p_dbFileName), batchRows(0)
 {
   engineType = dbSqlite;
   maxEngineBuffer = defaultMaxEngineBuffer;
+  maxBatchRows = defaultMaxBatchRows;
   queryBuffer.reserve(maxEngineBuffer);
 }
 
 UTIL::Database::Sqlite3Driver::Sqlite3Driver(Sqlite3Driver& db)
+    : dbFile(NULL), batchRows(0)
 {
     engineType = dbSqlite;
     dbFileName = db.dbFileName;
     maxEngineBuffer = db.maxEngineBuffer;
     if (maxEngineBuffer == 0) maxEngineBuffer = defaultMaxEngineBuffer;
+    maxBatchRows = db.maxBatchRows;
     queryBuffer.reserve(maxEngineBuffer);
 }
 
@@ -53,6 +61,7 @@ void UTIL::Database::Sqlite3Driver::close()
 {
     if (STATS_DEBUG) printf("SQLITE3:closing\n");
     flush();
+    finalizeStatements();
     sqlite3_close(dbFile);
     if (STATS_DEBUG) printf("SQLITE3:closed\n");
 }
@@ -68,11 +77,15 @@ void UTIL::Database::Sqlite3Driver::open(bool dropDatabase)
         ERROR_ReportErrorArgs("Problem setting Shared Cache mode, error %d\n", err);
     }
 
-    // Remove a db file before opening it
-    // The file may not exist, so ignore errors
+    // Remove a db file before opening it, with the journals of a
+    // previous run that would otherwise be applied to the new file.
+    // The files may not exist, so ignore errors
     if (dropDatabase)
     {
         remove(dbFileName.c_str());
+        remove((dbFileName + "-wal").c_str());
+        remove((dbFileName + "-shm").c_str());
+        remove((dbFileName + "-journal").c_str());
     }
 
     err = sqlite3_open(dbFileName.c_str(), &dbFile);
@@ -83,6 +96,9 @@ void UTIL::Database::Sqlite3Driver::open(bool dropDatabase)
         close();
     }
 
+    // The writer thread appends while the simulation reads, a write
+    // ahead log lets the readers go on during the writer's transactions
+    exec("PRAGMA journal_mode=WAL");
     exec("PRAGMA synchronous=OFF");
     flush();
 }
@@ -225,4 +241,217 @@ void UTIL::Database::Sqlite3Driver::exec(std::string in, std::string& out)
 #endif
 }
 
+void UTIL::Database::Sqlite3Driver::insert(const DatabaseRow& row)
+{
+    InsertStatement* insert;
+    int index = 1;
+    int err;
+
+    if (row.columns.empty()) return;
+
+    // The statements queued before the row must run first
+    if (!queryBuffer.empty()) flush();
+
+    insert = prepareInsert(row);
+    if (insert == NULL) return;
+
+    bind(insert, index++, row.values[0]);
+    for (size_t i = 1; i < row.values.size(); i++)
+    {
+        if (row.columns[i].length() > 0)
+        {
+            bind(insert, index++, row.values[i]);
+        }
+    }
+
+    sleepCounter = 0;
+    err = sqlite3_step(insert->stmt);
+
+    while (err == SQLITE_LOCKED || err == SQLITE_BUSY)
+    {
+        sleepCounter++;
+        sqlite3_reset(insert->stmt);
+
+        if (sleepCounter > MAX_DB_SLEEP_COUNTER)
+        {
+            ERROR_ReportErrorArgs("Sleep Timeout: Cannot execute SQLite statement: %s.", error());
+            close();
+        }
+        else if (STATS_DEBUG_LOCK)
+        {
+            ERROR_ReportWarningArgs("Error in SQL Write: %s, count %d\n", error(), sleepCounter);
+        }
+
+        EXTERNAL_Sleep(1 * SECOND);
+        err = sqlite3_step(insert->stmt);
+    }
+
+    if (err != SQLITE_DONE)
+    {
+        ERROR_ReportWarningArgs("Error:%s\nDML:%s\n", error(), sqlite3_sql(insert->stmt));
+    }
+    sqlite3_reset(insert->stmt);
+
+    batchRows++;
+    if (inTransaction && maxBatchRows > 0 && batchRows >= maxBatchRows)
+    {
+        DriverCommit();
+        DriverStartTransaction();
+    }
+}
+
+UTIL::Database::Sqlite3Driver::InsertStatement*
+UTIL::Database::Sqlite3Driver::prepareInsert(const DatabaseRow& row)
+{
+    // The statement depends on the table and on the columns set
+    insertKey = row.table;
+    insertKey += "(";
+    insertKey += row.columns[0];
+    for (size_t i = 1; i < row.columns.size(); i++)
+    {
+        if (row.columns[i].length() > 0)
+        {
+            insertKey += ",";
+            insertKey += row.columns[i];
+        }
+    }
+    insertKey += ")";
+
+    InsertStatementMap::iterator it = insertStatements.find(insertKey);
+    if (it != insertStatements.end())
+    {
+        return &it->second;
+    }
+
+    std::map<std::string, BindType> columnTypes;
+    std::map<std::string, BindType>::iterator typeIt;
+    std::string query = "INSERT INTO ";
+    std::string values = " VALUES(?";
+    InsertStatement insert;
+
+    readColumnTypes(row.table, columnTypes);
 
+    query += insertKey;
+    for (size_t i = 0; i < row.columns.size(); i++)
+    {
+        if (i > 0 && row.columns[i].length() == 0) continue;
+        if (i > 0) values += ",?";
+
+        typeIt = columnTypes.find(row.columns[i]);
+        if (typeIt == columnTypes.end())
+        {
+            insert.types.push_back(bindText);
+        }
+        else
+        {
+            insert.types.push_back(typeIt->second);
+        }
+    }
+    query += values;
+    query += ")";
+
+    if (sqlite3_prepare_v2(dbFile, query.c_str(), -1, &insert.stmt, NULL)
+        != SQLITE_OK)
+    {
+        ERROR_ReportWarningArgs("Error:%s\nDML:%s\n", error(), query.c_str());
+        return NULL;
+    }
+
+    return &(insertStatements[insertKey] = insert);
+}
+
+// Reads the declared types of the columns of a table and maps them to
+// bind types with the affinity rules of SQLite.
+void UTIL::Database::Sqlite3Driver::readColumnTypes(
+    const std::string& table,
+    std::map<std::string, BindType>& types)
+{
+    sqlite3_stmt* stmt;
+    std::string query = "PRAGMA table_info(" + table + ")";
+
+    if (sqlite3_prepare_v2(dbFile, query.c_str(), -1, &stmt, NULL)
+        != SQLITE_OK)
+    {
+        return;
+    }
+
+    while (sqlite3_step(stmt) == SQLITE_ROW)
+    {
+        const char* name = (const char*) sqlite3_column_text(stmt, 1);
+        const char* decl = (const char*) sqlite3_column_text(stmt, 2);
+        std::string type;
+        BindType bindType;
+
+        if (name == NULL) continue;
+        if (decl != NULL) type = decl;
+        for (size_t i = 0; i < type.length(); i++)
+        {
+            type[i] = (char) toupper(type[i]);
+        }
+
+        // Columns of INTEGER, REAL and NUMERIC affinity convert text
+        // to numbers, those of TEXT and BLOB affinity do not
+        if (type.find("INT") == std::string::npos &&
+            (type.empty() ||
+             type.find("CHAR") != std::string::npos ||
+             type.find("CLOB") != std::string::npos ||
+             type.find("TEXT") != std::string::npos ||
+             type.find("BLOB") != std::string::npos))
+        {
+            bindType = bindText;
+        }
+        else
+        {
+            bindType = bindNumber;
+        }
+        types[name] = bindType;
+    }
+
+    sqlite3_finalize(stmt);
+}
+
+void UTIL::Database::Sqlite3Driver::bind(
+    InsertStatement* insert,
+    int index,
+    const std::string& value)
+{
+    sqlite3_stmt* stmt = insert->stmt;
+    const char* text = value.c_str();
+    char* end;
+
+    // Only plain decimal numbers: SQLite keeps hexadecimal, infinities
+    // and values with spaces as text where strtod would convert them
+    if (insert->types[index - 1] == bindNumber &&
+        !value.empty() &&
+        value.find_first_not_of("0123456789+-.eE") == std::string::npos)
+    {
+        errno = 0;
+        long long integer = strtoll(text, &end, 10);
+        if (*end == '\0' && errno == 0)
+        {
+            sqlite3_bind_int64(stmt, index, integer);
+            return;
+        }
+
+        errno = 0;
+        double real = strtod(text, &end);
+        if (*end == '\0' && errno == 0)
+        {
+            sqlite3_bind_double(stmt, index, real);
+            return;
+        }
+    }
+
+    sqlite3_bind_text(stmt, index, text, (int) value.length(), SQLITE_STATIC);
+}
+
+void UTIL::Database::Sqlite3Driver::finalizeStatements()
+{
+    InsertStatementMap::iterator it;
+
+    for (it = insertStatements.begin(); it != insertStatements.end(); ++it)
+    {
+        sqlite3_finalize(it->second.stmt);
+    }
+    insertStatements.clear();
+}
@@ -18,11 +18,14 @@
 #ifndef _DBSQLITE3_H_
 #define _DBSQLITE3_H_
 
+#include <map>
 #include <string>
+#include <vector>
 
 #include "db-core.h"
 
 struct sqlite3;
+struct sqlite3_stmt;
 
 namespace UTIL {
 namespace Database {
@@ -37,24 +40,56 @@ public:
     void close();
     void create() {}
 
-    void DriverStartTransaction() {exec("BEGIN");}
-    void DriverCommit()           {exec("COMMIT"); flush();}
+    void DriverStartTransaction() {exec("BEGIN"); batchRows = 0;}
+    void DriverCommit()           {exec("COMMIT"); flush(); batchRows = 0;}
+    void DriverFlush()            {flush();}
 
     void exec(const std::string& query);
     void exec(const char* query);
     void exec(std::string in, std::string& out);
 
+    // Inserts the row with a prepared statement kept for its table and
+    // columns.  Commits and starts a new transaction after maxBatchRows
+    // rows.
+    void insert(const DatabaseRow& row);
+
     void flush();
     void flush(const char* cmds);
 
     const char* fileName() {return dbFileName.c_str();}
 private:
+    // How a value is bound: the values of columns with numeric affinity
+    // are bound as numbers when they convert exactly, the others as
+    // text, so that the stored values are those of the quoted SQL.
+    enum BindType
+    {
+        bindText,
+        bindNumber
+    };
+
+    struct InsertStatement
+    {
+        sqlite3_stmt* stmt;
+        std::vector<BindType> types;
+    };
+    typedef std::map<std::string, InsertStatement> InsertStatementMap;
+
     const char* error();
 
+    InsertStatement* prepareInsert(const DatabaseRow& row);
+    void readColumnTypes(const std::string& table,
+                         std::map<std::string, BindType>& types);
+    void bind(InsertStatement* insert, int index, const std::string& value);
+    void finalizeStatements();
+
     sqlite3* dbFile;
     std::string dbFileName;
     std::string queryBuffer;
+    InsertStatementMap insertStatements;
+    std::string insertKey;
+    size_t batchRows;
     static const size_t defaultMaxEngineBuffer = 8000;
+    static const size_t defaultMaxBatchRows = 10000;
 
 }; // class Sqlite3Driver
 }  // namespace Database
@@ -40,6 +40,7 @@
 #include "dbapi.h"
 #include "db-core.h"
 #include "db-sqlite3.h"
+#include "db-log.h"
 #include "application.h"
 #include "network_ip.h"
 #include "network_dualip.h"
@@ -138,6 +139,10 @@ void STATSDB_Initialize(PartitionData* partition,
             {
                 db->engineType = UTIL::Database::dbMariaDB;
             }
+            else if (strcmp(buf, "LOG") == 0)
+            {
+                db->engineType = UTIL::Database::dbLog;
+            }
             else
             {
                 ERROR_ReportErrorArgs(
@@ -384,6 +389,14 @@ void STATSDB_Initialize(PartitionData* partition,
 
             db->driver = new UTIL::Database::Sqlite3Driver(database);
         }
+        else if (db->engineType == UTIL::Database::dbLog)
+        {
+            // A directory, converted with statsdb_log_convert
+            std::string database = db->statsDatabase
+                + std::string(".statslog");
+
+            db->driver = new UTIL::Database::ColumnarLogDriver(database);
+        }
 
         //db->driver->open(partition->partitionId == 0);
 
@@ -398,6 +411,38 @@ void STATSDB_Initialize(PartitionData* partition,
         {
             db->maxQueryBuffer = intBuf;
         }
+
+        // Rows the database thread inserts per transaction
+        IO_ReadInt(
+            ANY_NODEID,
+            ANY_ADDRESS,
+            nodeInput,
+            "STATS-DB-MAX-BATCH-ROWS",
+            &wasFound,
+            &intBuf);
+        if (wasFound && db->driver != NULL)
+        {
+            if (intBuf < 0)
+            {
+                ERROR_ReportErrorArgs("STATS-DB-MAX-BATCH-ROWS must not be "
+                                      "negative, not %d", intBuf);
+            }
+            db->driver->maxBatchRows = intBuf;
+        }
+
+        // Rows are dropped rather than waited for when the database
+        // thread falls behind
+        IO_ReadBool(
+            ANY_NODEID,
+            ANY_ADDRESS,
+            nodeInput,
+            "STATS-DB-DROP-ROWS-WHEN-QUEUE-FULL",
+            &wasFound,
+            &value);
+        if (wasFound)
+        {
+            db->dropRowsWhenQueueFull = (value == TRUE);
+        }
     }
 
     IO_ReadString(ANY_NODEID, ANY_ADDRESS, nodeInput, "STATS-DB-DETAIL", &wasFound, buf);
@@ -11118,7 +11163,8 @@ void CreateTable(
         {
             query += "RowId bigint auto_increment primary key,";
         }
-        else if (db->engineType == UTIL::Database::dbSqlite)
+        else if (db->engineType == UTIL::Database::dbSqlite ||
+                 db->engineType == UTIL::Database::dbLog)
         {
             query += "RowId INTEGER PRIMARY KEY AUTOINCREMENT,";
         }
@@ -11197,31 +11243,25 @@ void InsertValues(
 {
     if (columns.size() > 0)
     {
-        std::string query = "INSERT INTO ";
-        query += table;
-        query += "(";
-        std::string values = "VALUES(";
+        UTIL::Database::DatabaseRow row =
+            GetInsertValuesRow(table, columns, newValues);
 
-        query += columns[0];
-        values += newValues[0];
+        AddInsertRowToBufferStatsDb(db, row);
+    }
+}
 
-        for (size_t i = 1; i<newValues.size(); i++)
-        {
-            if (columns[i].length() > 0)
-            {
-                query += ",";
-                query += columns[i];
-                values += ",'";
-                values += newValues[i];
-                values += "'";
-            }
-        }
-        query += ") ";
-        query += values;
-        query += ")";
+UTIL::Database::DatabaseRow GetInsertValuesRow(
+    const std::string& table,
+    const std::vector<std::string>& columns,
+    const std::vector<std::string>& newValues)
+{
+    UTIL::Database::DatabaseRow row;
+    size_t numValues = MIN(columns.size(), newValues.size());
 
-        AddQueryToBufferStatsDb(db, query);
-    }
+    row.table = table;
+    row.columns.assign(columns.begin(), columns.begin() + numValues);
+    row.values.assign(newValues.begin(), newValues.begin() + numValues);
+    return row;
 }
 
 std::string GetInsertValuesSQL(
@@ -11501,6 +11541,16 @@ void ExecuteMultipleNoReturnQueries(
     }
 }
 
+void ExecuteMultipleNoReturnQueries(
+    StatsDb* db,
+    std::vector<UTIL::Database::DatabaseRow>& insertList)
+{
+    for (size_t i = 0; i < insertList.size(); i++)
+    {
+        AddInsertRowToBufferStatsDb(db, insertList[i]);
+    }
+}
+
 std::string Select(
     StatsDb* db,
     const std::string &query)
@@ -26,6 +26,7 @@
 #include "network.h"
 #include "main.h"
 #include "stats.h"
+#include "db-core.h"
 
 #define MAX_DATABASE_TABLES 7
 #define MAX_INSERT_SIZE 1000
@@ -1949,6 +1950,18 @@ void ExecuteMultipleNoReturnQueries(
     StatsDb* db,
     std::vector<std::string>& insertList);
 
+//--------------------------------------------------------------------------
+// FUNCTION:  ExecuteMultipleNoReturnQueries
+// PURPOSE : queues rows for insertion
+// PARAMETERS
+// + db : StatsDb* : Pointer to the database
+// + insertList : std::vector<DatabaseRow> : rows to insert
+// RETURN void.
+//--------------------------------------------------------------------------
+void ExecuteMultipleNoReturnQueries(
+    StatsDb* db,
+    std::vector<UTIL::Database::DatabaseRow>& insertList);
+
 
 //--------------------------------------------------------------------------
 // FUNCTION:  CreateTable
@@ -2012,6 +2025,24 @@ std::string GetInsertValuesSQL(
     const std::vector<std::string>& columns,
     const std::vector<std::string>& newValues);
 
+//--------------------------------------------------------------------------
+// FUNCTION:  GetInsertValuesRow
+// PURPOSE : collects the values of a row to insert, for the driver to
+//      bind instead of formatting an INSERT statement
+// PARAMETERS
+// + table : std::string : name of desired table to insert into
+// + columns : std::vector<std::string> : column names of data that
+//      you want insert
+// + values : std::vector<std::string> : column values data that
+//      you want insert
+// RETURN
+// + DatabaseRow : the row
+//--------------------------------------------------------------------------
+UTIL::Database::DatabaseRow GetInsertValuesRow(
+    const std::string& table,
+    const std::vector<std::string>& columns,
+    const std::vector<std::string>& newValues);
+
 //--------------------------------------------------------------------------
 // FUNCTION:  InsertValues
 // PARAMETERS
@@ -149,10 +149,10 @@ Int32 STAT_GlobalAppStatisticsBridge::numFields(PartitionData* partition)
     return numFixedFields + numOptionalFields;
 }
 
-// Function to compose SQL insertion string
+// Function to compose the row to insert
 
-std::string
-STAT_GlobalAppStatisticsBridge::composeGlobalAppStatisticsInsertSQLString(
+UTIL::Database::DatabaseRow
+STAT_GlobalAppStatisticsBridge::composeGlobalAppStatisticsInsertRow(
                                                 Node* node,
                                                 PartitionData* partition)
 {
@@ -199,7 +199,7 @@ STAT_GlobalAppStatisticsBridge::composeGlobalAppStatisticsInsertSQLString(
         }
     }
 
-    return GetInsertValuesSQL("APPLICATION_Aggregate", columns, newValues);
+    return GetInsertValuesRow("APPLICATION_Aggregate", columns, newValues);
 }
 
 // Function to compose SQL updation string
@@ -884,7 +884,7 @@ void
 STAT_AppSummaryBridge::composeAppSummaryInsertSQLString(
                                         Node* node,
                                         PartitionData* partition,
-                                        std::vector<std::string>* insertList,
+                                        std::vector<UTIL::Database::DatabaseRow>* insertList,
                                         STAT_DestAddressType type)
 {
     map<STAT_AppSummaryTag11, STAT_AppSummaryStatistics>::iterator it1;
@@ -976,7 +976,7 @@ STAT_AppSummaryBridge::composeAppSummaryInsertSQLString(
             }
         }
 
-        insertList->push_back(GetInsertValuesSQL(
+        insertList->push_back(GetInsertValuesRow(
             "APPLICATION_Summary", columns, newValues));
     }
 }
@@ -1378,10 +1378,10 @@ Int32 STAT_GlobalNetStatisticsBridge::numFields(PartitionData* partition)
     return numFixedFields + numOptionalFields;
 }
 
-// Function to compose SQL insertion string
+// Function to compose the row to insert
 
-std::string
-STAT_GlobalNetStatisticsBridge::composeGlobalNetStatisticsInsertSQLString(
+UTIL::Database::DatabaseRow
+STAT_GlobalNetStatisticsBridge::composeGlobalNetStatisticsInsertRow(
                                                 Node* node,
                                                 PartitionData* partition)
 {
@@ -1427,7 +1427,7 @@ STAT_GlobalNetStatisticsBridge::composeGlobalNetStatisticsInsertSQLString(
             }
         }
     }
-    return GetInsertValuesSQL("NETWORK_Aggregate", columns, newValues);
+    return GetInsertValuesRow("NETWORK_Aggregate", columns, newValues);
 }
 
 // Function to call Stat APIs to get various values to be inserted in
@@ -1987,7 +1987,7 @@ void
 STAT_NetSummaryBridge::composeNetSummaryInsertSQLString(
                                         Node* node,
                                         PartitionData* partition,
-                                        std::vector<std::string>* insertList)
+                                        std::vector<UTIL::Database::DatabaseRow>* insertList)
 {
     size_t countOfNetSummary;
     size_t netSummarySize = netSummary.size();
@@ -2049,7 +2049,7 @@ STAT_NetSummaryBridge::composeNetSummaryInsertSQLString(
             }
         }
 
-        insertList->push_back(GetInsertValuesSQL(
+        insertList->push_back(GetInsertValuesRow(
                                 "NETWORK_Summary", columns, newValues));
     }
 }
@@ -2488,14 +2488,13 @@ void STAT_GlobalTransportStatisticsBridge::initializeNameTypeConfigurations()
                           "STATS-DB-TRANSPORT-AGGREGATE-JITTER");
 }
 
-std::string
+UTIL::Database::DatabaseRow
 STAT_GlobalTransportStatisticsBridge::
-           composeGlobalTransportStatisticsInsertSQLString(
+           composeGlobalTransportStatisticsInsertRow(
     Node* node,
     PartitionData* partition)
 {
     Int32 i;
-    string combinedQueryForAllAddressTypes = "";
     std::vector<std::string> newValues;
     newValues.reserve(numFixedFields + numOptionalFields);
     std::vector<std::string> columns;
@@ -2541,10 +2540,7 @@ STAT_GlobalTransportStatisticsBridge::
             }
         }
     }
-    combinedQueryForAllAddressTypes +=
-        GetInsertValuesSQL("TRANSPORT_Aggregate", columns, newValues);
-
-    return combinedQueryForAllAddressTypes;
+    return GetInsertValuesRow("TRANSPORT_Aggregate", columns, newValues);
 }
 
 // Function to call Stat APIs to get various values to be inserted in
@@ -2971,7 +2967,7 @@ double STAT_TransportSummaryBridge::valueForIndex(
 void STAT_TransportSummaryBridge::composeTransportSummaryInsertSQLString(
     Node* node,
     PartitionData* partition,
-    std::vector<std::string>* insertList)
+    std::vector<UTIL::Database::DatabaseRow>* insertList)
 {
 
     size_t countOfTransportSummary;
@@ -3041,7 +3037,7 @@ void STAT_TransportSummaryBridge::composeTransportSummaryInsertSQLString(
                 }
             }
         }
-        insertList->push_back(GetInsertValuesSQL(
+        insertList->push_back(GetInsertValuesRow(
             "TRANSPORT_Summary", columns, newValues));
     }
 }
@@ -3293,13 +3289,12 @@ void STAT_GlobalPhysicalStatisticsBridge::initializeNameTypeConfigurations()
               "STATS-DB-PHY-AGGREGATE-SIGNAL-POWER");
 }
 
-std::string
-STAT_GlobalPhysicalStatisticsBridge::composeGlobalPhysicalStatisticsInsertSQLString(
+UTIL::Database::DatabaseRow
+STAT_GlobalPhysicalStatisticsBridge::composeGlobalPhysicalStatisticsInsertRow(
     Node* node,
     PartitionData * partition)
 {
     Int32 i;
-    string combinedQueryForAllAddressTypes = "";
 
     std::vector<std::string> newValues;
     newValues.reserve(25);
@@ -3328,10 +3323,7 @@ STAT_GlobalPhysicalStatisticsBridge::composeGlobalPhysicalStatisticsInsertSQLStr
             }
         }
     }
-    combinedQueryForAllAddressTypes +=
-        GetInsertValuesSQL("PHY_Aggregate", columns, newValues);
-
-    return combinedQueryForAllAddressTypes;
+    return GetInsertValuesRow("PHY_Aggregate", columns, newValues);
 }
 /* Function to enable/disable Physical Aggregate table column indexes
    in array
@@ -3543,7 +3535,7 @@ void STAT_PhySummaryBridge::initializeNameTypeConfigurations()
 void STAT_PhySummaryBridge::composePhysicalSummaryInsertSQLString(
     Node* node,
     PartitionData* partition,
-    std::vector<std::string>* insertList)
+    std::vector<UTIL::Database::DatabaseRow>* insertList)
 {
     size_t countOfPhysicalSummary;
     size_t phySummarySize = phySummary->size();
@@ -3619,7 +3611,7 @@ void STAT_PhySummaryBridge::composePhysicalSummaryInsertSQLString(
                 }
             }
         }
-        insertList->push_back(GetInsertValuesSQL("PHY_Summary", columns, newValues));
+        insertList->push_back(GetInsertValuesRow("PHY_Summary", columns, newValues));
     }
 }
 double STAT_PhySummaryBridge::valueForIndex(Node* node, Int32 index)
@@ -3765,9 +3757,9 @@ Int32 STAT_GlobalMacStatisticsBridge::numFields(PartitionData* partition)
     }
     return numFixedFields + numOptionalFields;
 }
-// Function to compose SQL insertion string
-std::string STAT_GlobalMacStatisticsBridge::
-        composeGlobalMacStatisticsInsertSQLString(
+// Function to compose the row to insert
+UTIL::Database::DatabaseRow STAT_GlobalMacStatisticsBridge::
+        composeGlobalMacStatisticsInsertRow(
                                                 Node* node,
                                                 PartitionData* partition)
 {
@@ -3818,7 +3810,7 @@ std::string STAT_GlobalMacStatisticsBridge::
         }
     }
 
-    return GetInsertValuesSQL("MAC_Aggregate", columns, newValues);
+    return GetInsertValuesRow("MAC_Aggregate", columns, newValues);
 }
 
 // Function to call Stat APIs to get various values to be inserted in
@@ -4281,7 +4273,7 @@ Int32 STAT_MacSummaryBridge::numFields(PartitionData* partition)
 void STAT_MacSummaryBridge::composeMacSummaryInsertSQLString(
     Node* node,
     PartitionData* partition,
-    std::vector<std::string>* insertList)
+    std::vector<UTIL::Database::DatabaseRow>* insertList)
 {
     size_t countOfMacSummary;
     size_t macSummarySize = macSummary->size();
@@ -4348,7 +4340,7 @@ void STAT_MacSummaryBridge::composeMacSummaryInsertSQLString(
                 }
             }
         }
-        insertList->push_back(GetInsertValuesSQL(
+        insertList->push_back(GetInsertValuesRow(
                                     "MAC_Summary", columns, newValues));
     }
 }
@@ -4842,8 +4834,8 @@ double STAT_GlobalQueueStatisticsBridge::valueForIndex(Node* node,
     return 0;
 }
 
-std::string
-STAT_GlobalQueueStatisticsBridge::composeGlobalQueueStatisticsInsertSQLString(
+UTIL::Database::DatabaseRow
+STAT_GlobalQueueStatisticsBridge::composeGlobalQueueStatisticsInsertRow(
     Node* node,
     PartitionData * partition)
 {
@@ -4870,7 +4862,7 @@ STAT_GlobalQueueStatisticsBridge::composeGlobalQueueStatisticsInsertSQLString(
             }
         }
     }
-    return GetInsertValuesSQL("QUEUE_Aggregate", columns, newValues);
+    return GetInsertValuesRow("QUEUE_Aggregate", columns, newValues);
 }
 
 // Function to initialize Name and Types of columns of
@@ -5075,7 +5067,7 @@ UInt64 STAT_QueueSummaryBridge::valueForIndexInUInt64(
 void STAT_QueueSummaryBridge::composeQueueSummaryInsertSQLString(
     Node* node,
     PartitionData * partition,
-    std::vector<std::string>* insertList)
+    std::vector<UTIL::Database::DatabaseRow>* insertList)
 {
     size_t countOfQueueSummary;
     size_t queueSummarySize = queueSummary->size();
@@ -5137,7 +5129,7 @@ void STAT_QueueSummaryBridge::composeQueueSummaryInsertSQLString(
                 }
             }
         }
-        insertList->push_back(GetInsertValuesSQL("QUEUE_Summary", columns, newValues));
+        insertList->push_back(GetInsertValuesRow("QUEUE_Summary", columns, newValues));
     }
 }
 
@@ -5370,7 +5362,7 @@ Int32 STAT_QueueStatusBridge::numFields(PartitionData* partition)
 void STAT_QueueStatusBridge::composeQueueStatusInsertSQLString(
     Node* node,
     PartitionData* partition,
-    std::vector<std::string>* insertList)
+    std::vector<UTIL::Database::DatabaseRow>* insertList)
 {
     size_t countOfQueueSummary;
     size_t queueSummarySize = queueSummary->size();
@@ -5432,7 +5424,7 @@ void STAT_QueueStatusBridge::composeQueueStatusInsertSQLString(
                 }
             }
         }
-        insertList->push_back(GetInsertValuesSQL("QUEUE_Status", columns, newValues));
+        insertList->push_back(GetInsertValuesRow("QUEUE_Status", columns, newValues));
     }
 }
 
@@ -5737,7 +5729,7 @@ void
 STAT_MulticastAppSummaryBridge::composeMutlicastAppSummaryInsertSQLString(
                                         Node* node,
                                         PartitionData* partition,
-                                        std::vector<std::string>* insertList)
+                                        std::vector<UTIL::Database::DatabaseRow>* insertList)
 {
     size_t countOfMutlicastSessionSummary;
     size_t mutlicastSessionSummarySize = sessionSummary->size();
@@ -5795,7 +5787,7 @@ STAT_MulticastAppSummaryBridge::composeMutlicastAppSummaryInsertSQLString(
                 }
             }
         }
-        insertList->push_back(GetInsertValuesSQL("MULTICAST_APPLICATION_Summary", columns, newValues));
+        insertList->push_back(GetInsertValuesRow("MULTICAST_APPLICATION_Summary", columns, newValues));
     }
 }
 
@@ -21,6 +21,7 @@
 #include <string>
 
 #include "partition.h"
+#include "db-core.h"
 #include "stats_app.h"
 #include "stats_net.h"
 #include "stats_transport.h"
@@ -545,8 +546,8 @@ class STAT_GlobalAppStatisticsBridge : public DB_API_Bridge{
         // New Destructor to resolve memory leak issue
         ~STAT_GlobalAppStatisticsBridge();
         Int32 numFields(PartitionData* partition);
-        std::string composeGlobalAppStatisticsInsertSQLString(Node* node,
-           PartitionData* partition);  // compose the sql string;
+        UTIL::Database::DatabaseRow composeGlobalAppStatisticsInsertRow(Node* node,
+           PartitionData* partition);  // compose the row to insert
         std::string composeGlobalAppStatisticsUpdateSQLString(
             Node* node,
             PartitionData* partition,
@@ -598,7 +599,7 @@ class STAT_AppSummaryBridge : public DB_API_Bridge
             void composeAppSummaryInsertSQLString(
                 Node* node,
                 PartitionData* partition,
-                std::vector<std::string>* insertList,
+                std::vector<UTIL::Database::DatabaseRow>* insertList,
                 STAT_DestAddressType type = STAT_Unicast);
 
             // retrieving values for field index
@@ -665,7 +666,7 @@ class STAT_MulticastAppSummaryBridge : public DB_API_Bridge
             void composeMutlicastAppSummaryInsertSQLString(
                                 Node* node,
                                 PartitionData* partition,
-                                std::vector<std::string>* insertList);
+                                std::vector<UTIL::Database::DatabaseRow>* insertList);
 
             // retrieving values for field index
             double valueForIndex(Node* node,
@@ -721,8 +722,8 @@ class STAT_GlobalNetStatisticsBridge : public DB_API_Bridge{
                                                 PartitionData* partition);
         Int32 numFields(PartitionData* partition);
 
-        // compose the sql string;
-        std::string composeGlobalNetStatisticsInsertSQLString(Node* node,
+        // compose the row to insert
+        UTIL::Database::DatabaseRow composeGlobalNetStatisticsInsertRow(Node* node,
                                                PartitionData* partition);
 
         double valueForIndex(Node* node, Int32 index);
@@ -766,7 +767,7 @@ class STAT_NetSummaryBridge : public DB_API_Bridge
             void composeNetSummaryInsertSQLString(
                 Node* node,
                 PartitionData* partition,
-                std::vector<std::string>* insertList);
+                std::vector<UTIL::Database::DatabaseRow>* insertList);
 
             // retrieving values for field index
             double valueForIndex(Node* node,
@@ -816,8 +817,8 @@ class STAT_GlobalTransportStatisticsBridge : public DB_API_Bridge{
                                                 PartitionData* partition);
         Int32 numFields(PartitionData* partition);
 
-        // compose the sql string;
-        std::string composeGlobalTransportStatisticsInsertSQLString(Node* node,
+        // compose the row to insert
+        UTIL::Database::DatabaseRow composeGlobalTransportStatisticsInsertRow(Node* node,
                                                PartitionData* partition);
         double valueForIndex(Node* node, Int32 index);
         UInt64 valueForIndexInUInt64(Node* node, Int32 index);
@@ -860,7 +861,7 @@ class STAT_TransportSummaryBridge : public DB_API_Bridge
             void composeTransportSummaryInsertSQLString(
                 Node* node,
                 PartitionData* partition,
-                std::vector<std::string>* insertList);
+                std::vector<UTIL::Database::DatabaseRow>* insertList);
 
             // retrieving values for field index
             double valueForIndex(Node* node,
@@ -918,7 +919,7 @@ class STAT_PhySummaryBridge : public DB_API_Bridge
             void composePhysicalSummaryInsertSQLString(
                 Node* node,
                 PartitionData * partition,
-                std::vector<std::string>* insertList);
+                std::vector<UTIL::Database::DatabaseRow>* insertList);
 
             // retrieving values for field index
             double valueForIndex(Node* node,
@@ -965,8 +966,8 @@ class STAT_GlobalPhysicalStatisticsBridge : public DB_API_Bridge{
                                                 PartitionData * partition);
         Int32 numFields(PartitionData* partition);
 
-        // compose the sql string;
-        std::string composeGlobalPhysicalStatisticsInsertSQLString(Node* node,
+        // compose the row to insert
+        UTIL::Database::DatabaseRow composeGlobalPhysicalStatisticsInsertRow(Node* node,
                                                PartitionData * partition);
         double valueForIndex(Node* node, Int32 index);
         UInt64 valueForIndexInUInt64(Node* node, Int32 index);
@@ -1001,8 +1002,8 @@ class STAT_GlobalMacStatisticsBridge : public DB_API_Bridge{
                                                 PartitionData* partition);
         Int32 numFields(PartitionData* partition);
 
-        // compose the sql string;
-        std::string composeGlobalMacStatisticsInsertSQLString(Node* node,
+        // compose the row to insert
+        UTIL::Database::DatabaseRow composeGlobalMacStatisticsInsertRow(Node* node,
                                                PartitionData* partition);
 
         double valueForIndex(Node* node, Int32 index);
@@ -1043,7 +1044,7 @@ class STAT_MacSummaryBridge : public DB_API_Bridge{
         void composeMacSummaryInsertSQLString(
                 Node* node,
                 PartitionData* partition,
-                std::vector<std::string>* insertList);
+                std::vector<UTIL::Database::DatabaseRow>* insertList);
 
         double valueForIndex(Node* node, Int32 index);
         double valueForIndex(Node* node,
@@ -1087,8 +1088,8 @@ class STAT_GlobalQueueStatisticsBridge : public DB_API_Bridge{
                                                 PartitionData* partition);
         // New Destructor to resolve memory leak issue
         ~STAT_GlobalQueueStatisticsBridge();
-        std::string composeGlobalQueueStatisticsInsertSQLString(Node* node,
-           PartitionData* partition);  // compose the sql string;
+        UTIL::Database::DatabaseRow composeGlobalQueueStatisticsInsertRow(Node* node,
+           PartitionData* partition);  // compose the row to insert
         double valueForIndex(Node* node, Int32 index);
         UInt64 valueForIndexInUInt64(Node* node, Int32 index);
         Int32 numFields(PartitionData* partition);
@@ -1128,7 +1129,7 @@ class STAT_QueueSummaryBridge : public DB_API_Bridge
             void composeQueueSummaryInsertSQLString(
                 Node* node,
                 PartitionData * partition,
-                std::vector<std::string>* insertList);
+                std::vector<UTIL::Database::DatabaseRow>* insertList);
 
             // retrieving values for field index
             double valueForIndex(Node* node,
@@ -1190,7 +1191,7 @@ class STAT_QueueStatusBridge : public DB_API_Bridge
             void composeQueueStatusInsertSQLString(
                 Node* node,
                 PartitionData * partition,
-                std::vector<std::string>* insertList);
+                std::vector<UTIL::Database::DatabaseRow>* insertList);
 
             // retrieving values for field index
             double valueForIndex(Node* node,
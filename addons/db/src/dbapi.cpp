@@ -36,6 +36,7 @@
 #include "db-core.h"
 #include "db-mariadb.h"
 #include "db-sqlite3.h"
+#include "db-log.h"
 
 #include "mysqld_error.h"
 #include "fileio.h"
@@ -46,7 +47,6 @@
 #include "socket-interface.h"
 #endif
 
-#include <boost/lockfree/queue.hpp>
 #include <boost/thread.hpp>
 #include <boost/atomic.hpp>
 #include <boost/date_time/posix_time/posix_time.hpp>
@@ -113,51 +113,202 @@ struct aThread
 };
 
 
+// An entry of the database thread queue: a statement, or a row to insert
+// when the row has a table.
+struct DatabaseQuery
+{
+    std::string sql;
+    UTIL::Database::DatabaseRow row;
+};
+
+// Bounded ring of the queries of one partition.  The partition thread is
+// the only producer and the database thread the only consumer.  The
+// slots are reused, so their strings keep their capacity from one row to
+// the next.
+class DatabaseRing
+{
+    std::vector<DatabaseQuery> m_slots;
+    boost::atomic<size_t> m_head;   // next slot to read
+    boost::atomic<size_t> m_tail;   // next slot to write
+
+public:
+    // Updated by the producer only
+    int m_nSleep;
+    int m_maxSleep;
+    int m_maxQueueCount;
+    int m_nDropped;
+    // Updated by the consumer only
+    int m_nRows;
+
+    DatabaseRing(size_t size) :
+        m_slots(size),
+        m_head(0),
+        m_tail(0),
+        m_nSleep(0),
+        m_maxSleep(0),
+        m_maxQueueCount(0),
+        m_nDropped(0),
+        m_nRows(0)
+    { }
+
+    size_t size() { return m_slots.size(); }
+
+    // Returns the slot to fill next, or NULL if the ring is full
+    DatabaseQuery* reserve()
+    {
+        size_t tail = m_tail.load(boost::memory_order_relaxed);
+        if (tail - m_head.load(boost::memory_order_acquire) == m_slots.size())
+        {
+            return NULL;
+        }
+        return &m_slots[tail % m_slots.size()];
+    }
+
+    // Hands the reserved slot to the consumer, returns the number queued
+    size_t publish()
+    {
+        size_t tail = m_tail.load(boost::memory_order_relaxed) + 1;
+        m_tail.store(tail, boost::memory_order_release);
+        return tail - m_head.load(boost::memory_order_relaxed);
+    }
+
+    // Returns the oldest query, or NULL if the ring is empty
+    DatabaseQuery* front()
+    {
+        size_t head = m_head.load(boost::memory_order_relaxed);
+        if (head == m_tail.load(boost::memory_order_acquire))
+        {
+            return NULL;
+        }
+        return &m_slots[head % m_slots.size()];
+    }
+
+    void pop()
+    {
+        m_head.store(m_head.load(boost::memory_order_relaxed) + 1,
+                     boost::memory_order_release);
+    }
+};
+
+
 class DatabaseThread : public aThread
 {
     UTIL::Database::DatabaseDriver* m_driver;
-    boost::lockfree::queue <std::string* >* m_queue;
-    boost::atomic<int> m_queueCount;
-    //int m_queueCount;
-#ifdef USE_MUTEX
-    boost::condition_variable m_cond;
-    boost::mutex m_mut;
-#endif
+    std::vector<DatabaseRing*> m_rings;
+    boost::atomic<bool> m_opened;
+    boost::mutex m_openMutex;
+    bool m_dropRows;
 
+    // Statements longer than this do not keep their slot's memory
+    static const size_t maxKeptSql = 4096;
+
+    void execute(DatabaseRing* ring, DatabaseQuery* query)
+    {
+        if (query->row.table.empty())
+        {
+            m_driver->exec(query->sql);
+            if (query->sql.capacity() > maxKeptSql)
+            {
+                std::string().swap(query->sql);
+            }
+        }
+        else
+        {
+            m_driver->insert(query->row);
+        }
+        ring->pop();
+        ring->m_nRows++;
+    }
+
+    // Runs the queries of a ring, those of partition 0 first: partition
+    // 0 creates the tables that the other partitions insert into.
+    void drain(size_t partition)
+    {
+        DatabaseRing* ring = m_rings[partition];
+        DatabaseQuery* query;
+
+        while ((query = ring->front()) != NULL)
+        {
+            if (partition > 0)
+            {
+                drain(0);
+            }
+            execute(ring, query);
+        }
+    }
+
+    DatabaseRing* ring(StatsDb* db)
+    {
+        if (!m_opened.load(boost::memory_order_acquire))
+        {
+            open(db);
+        }
+        return m_rings[db->partition->partitionId];
+    }
+
+    // Waits for a free slot, or returns NULL if the query is a row to
+    // drop.
+    DatabaseQuery* reserve(DatabaseRing* ring, bool isRow)
+    {
+        DatabaseQuery* query = ring->reserve();
+        int countSleep = 0;
+
+        while (query == NULL)
+        {
+            if (isRow && m_dropRows)
+            {
+                ring->m_nDropped++;
+                return NULL;
+            }
+            wake();
+            boost::this_thread::sleep(boost::posix_time::milliseconds(1));
+            if (!countSleep) {
+              ring->m_nSleep++;
+            }
+            countSleep++;
+            query = ring->reserve();
+        }
+        if (countSleep > ring->m_maxSleep) ring->m_maxSleep = countSleep;
+        return query;
+    }
+
+    void publish(DatabaseRing* ring)
+    {
+        int count = (int)ring->publish();
+        if (count > ring->m_maxQueueCount) ring->m_maxQueueCount = count;
+
+        // Waking the thread costs more than a row, it also wakes up on
+        // its own every second
+        if ((size_t)count * 4 >= ring->size())
+        {
+            wake();
+        }
+    }
 
-  int m_nRows;
-  int m_nSleep;
-  int m_maxSleep;
-  int m_maxQueueCount;
 public:
 
   DatabaseThread() :
     m_driver(NULL),
-    m_queue(NULL),
-    m_queueCount(0),
-    m_maxQueueCount(0),
-    m_nRows(0),
-    m_nSleep(0),
-    m_maxSleep(0)
+    m_opened(false),
+    m_dropRows(false)
   { }
 
     void run()
     {
-        int ops = 0;
-        const std::string* sql;
-        if (!m_queue || !m_queue->pop(sql)) return;
+        if (!m_opened.load(boost::memory_order_acquire)) return;
+
+        size_t i;
+        for (i = 0; i < m_rings.size(); i++)
+        {
+            if (m_rings[i]->front() != NULL) break;
+        }
+        if (i == m_rings.size()) return;
+
         m_driver->startTransaction();
-        do
+        for (i = 0; i < m_rings.size(); i++)
         {
-#ifdef USE_MUTEX
-            m_cond.notify_one();
-#endif
-            //m_queueCount.fetch_sub(1, boost::memory_order_relaxed);
-            m_queueCount--;
-            m_driver->exec(*sql);
-            delete(sql);
-            m_nRows++;
-        }   while (m_queue->pop(sql));
+            drain(i);
+        }
         m_driver->commit();
     }
 
@@ -168,16 +319,28 @@ public:
             m_driver->close();
             m_driver = NULL;
         }
-        if (m_nRows > 0) {
-            std::cout << "Database thread stats. Rows:" << m_nRows
-                << " Waits:" << m_nSleep << " Max Wait Time (mS):" << m_maxSleep
-                << " Max Queue:" << m_maxQueueCount
-                << std::endl;
+        for (size_t i = 0; i < m_rings.size(); i++)
+        {
+            DatabaseRing* ring = m_rings[i];
+            if (ring->m_nRows > 0 || ring->m_nDropped > 0) {
+                std::cout << "Database thread stats. Partition:" << i
+                    << " Rows:" << ring->m_nRows
+                    << " Waits:" << ring->m_nSleep
+                    << " Max Wait Time (mS):" << ring->m_maxSleep
+                    << " Max Queue:" << ring->m_maxQueueCount
+                    << " Dropped Rows:" << ring->m_nDropped
+                    << std::endl;
+            }
+            delete ring;
         }
+        m_rings.clear();
     }
 
     void open(StatsDb* db)
     {
+        boost::unique_lock<boost::mutex> lock(m_openMutex);
+        if (m_opened.load(boost::memory_order_relaxed)) return;
+
         if (db->engineType == UTIL::Database::dbMariaDB)
         {
             m_driver = new UTIL::Database::MariaDBNativeDriver(
@@ -188,57 +351,64 @@ public:
             m_driver = new UTIL::Database::Sqlite3Driver(
                 *(UTIL::Database::Sqlite3Driver*)db->driver);
         }
+        else if (db->engineType == UTIL::Database::dbLog)
+        {
+            m_driver = new UTIL::Database::ColumnarLogDriver(
+                *(UTIL::Database::ColumnarLogDriver*)db->driver);
+        }
         else
         {
             ERROR_AssertArgs(false, "unsupported engine type:%d", db->engineType);
         }
         m_driver->open(true);
-        m_queue = new boost::lockfree::queue<std::string* >(db->maxQueryBuffer);
+        for (int i = 0; i < db->partition->getNumPartitions(); i++)
+        {
+            m_rings.push_back(new DatabaseRing(db->maxQueryBuffer));
+        }
+        m_dropRows = db->dropRowsWhenQueueFull;
+        m_opened.store(true, boost::memory_order_release);
     }
 
     void push_back(StatsDb* db, const char* sql)
     {
-        push_back(db, new std::string(sql));
+        DatabaseRing* queue = ring(db);
+        DatabaseQuery* query = reserve(queue, false);
+        query->sql.assign(sql);
+        query->row.table.clear();
+        publish(queue);
     }
 
     void push_back(StatsDb* db, const std::string &sql)
     {
-        push_back(db, new std::string(sql));
+        DatabaseRing* queue = ring(db);
+        DatabaseQuery* query = reserve(queue, false);
+        query->sql.assign(sql);
+        query->row.table.clear();
+        publish(queue);
     }
 
-    void push_back(StatsDb* db, std::string* sql)
+    // Queues a copy of a row for the driver to bind
+    void insert(StatsDb* db, const UTIL::Database::DatabaseRow& row)
     {
-        if (m_driver == NULL)
+        DatabaseRing* queue = ring(db);
+        DatabaseQuery* query = reserve(queue, true);
+        size_t numValues = row.values.size();
+
+        if (query == NULL)
         {
-          open(db);
+            return;
         }
-        int countSleep = 0;
-        wake();
 
-#ifdef USE_MUTEX
-        boost::unique_lock<boost::mutex> lock(m_mut);
-        while (!m_queue->bounded_push(sql)) {
-            if (!countSleep) {
-              m_nSleep++;
-            }
-            countSleep++;
-            m_cond.wait(lock);
-        }
-#else
-        while (!m_queue->bounded_push(sql))
+        // Assigning keeps the memory of the slot's strings
+        query->row.table.assign(row.table);
+        query->row.columns.resize(numValues);
+        query->row.values.resize(numValues);
+        for (size_t i = 0; i < numValues; i++)
         {
-            boost::this_thread::sleep(boost::posix_time::milliseconds(1));
-            if (!countSleep) {
-              m_nSleep++;
-            }
-            countSleep++;
+            query->row.columns[i].assign(row.columns[i]);
+            query->row.values[i].assign(row.values[i]);
         }
-#endif
-        if (countSleep > m_maxSleep) m_maxSleep = countSleep;
-        //int count = m_queueCount.fetch_add(1, boost::memory_order_relaxed);
-        int count = m_queueCount++;
-        count++;
-        if (count > m_maxQueueCount) m_maxQueueCount = count;
+        publish(queue);
     }
 
     void finalize() {
@@ -284,7 +454,8 @@ const char* STATSDB_Table::FixColType(const char* type) {
     if (TypeIs(type, "double")) return "real";
     if (TypeIs(type, "rowid")) {
         if (db_->engineType == UTIL::Database::dbMariaDB) return "bigint auto_increment primary key";
-        if (db_->engineType == UTIL::Database::dbSqlite) return "INTEGER PRIMARY KEY AUTOINCREMENT";
+        if (db_->engineType == UTIL::Database::dbSqlite ||
+            db_->engineType == UTIL::Database::dbLog) return "INTEGER PRIMARY KEY AUTOINCREMENT";
     }
     return type;
 }
@@ -386,6 +557,16 @@ void AddQueryToBufferStatsDb(StatsDb* db, const std::string &queryStr)
     dataBase.push_back(db, queryStr);
 }
 
+void AddInsertRowToBufferStatsDb(StatsDb* db,
+                                 const UTIL::Database::DatabaseRow& row)
+{
+    if (STATS_DEBUG)
+    {
+        printf("Inserting row into %s\n", row.table.c_str());
+    }
+    dataBase.insert(db, row);
+}
+
 void STATSDB_Close()
 {
     if (STATS_DEBUG) {
@@ -2666,9 +2847,9 @@ void STATSDB_HandleTransAggregateTableInsert(Node* node)
                     &node->partitionData->stats->global.transportAggregate,
                     node->partitionData);
         }
-        // Compose and Insert SQL
-        AddInsertQueryToBuffer(db, node->partitionData->stats->global.transportBridge->
-            composeGlobalTransportStatisticsInsertSQLString(node, node->partitionData));
+        // Compose and insert the row
+        AddInsertRowToBufferStatsDb(db, node->partitionData->stats->global.transportBridge->
+            composeGlobalTransportStatisticsInsertRow(node, node->partitionData));
     }
 }
 
@@ -2705,9 +2886,9 @@ void STATSDB_HandleAppAggregateTableInsert(Node* node)
             appBridge->copyFromGlobalApp(
                         node->partitionData->stats->global.appAggregate);
         }
-        // Compose SQL string
-        AddInsertQueryToBuffer(db,
-            appBridge->composeGlobalAppStatisticsInsertSQLString(node,
+        // Compose and insert the row
+        AddInsertRowToBufferStatsDb(db,
+            appBridge->composeGlobalAppStatisticsInsertRow(node,
                                                      node->partitionData));
     }
 }
@@ -2792,9 +2973,9 @@ void STATSDB_HandleNetworkAggregateTableInsert(Node* node)
             netBridge->copyFromGlobalNet(
                         node->partitionData->stats->global.netAggregate);
         }
-        // Compose SQL string
-        AddInsertQueryToBuffer(db,
-            netBridge->composeGlobalNetStatisticsInsertSQLString(node,
+        // Compose and insert the row
+        AddInsertRowToBufferStatsDb(db,
+            netBridge->composeGlobalNetStatisticsInsertRow(node,
                                                      node->partitionData));
     }
 }
@@ -2827,9 +3008,9 @@ void STATSDB_HandleMacAggregateTableInsert(Node* node)
                     &node->partitionData->stats->global.macAggregate,
                     node->partitionData);
         }
-        // Compose and Insert SQL
-        AddInsertQueryToBuffer(db, node->partitionData->stats->global.macBridge->
-            composeGlobalMacStatisticsInsertSQLString(node, node->partitionData));
+        // Compose and insert the row
+        AddInsertRowToBufferStatsDb(db, node->partitionData->stats->global.macBridge->
+            composeGlobalMacStatisticsInsertRow(node, node->partitionData));
     }
 }
 
@@ -2863,8 +3044,8 @@ void STATSDB_HandlePhyAggregateTableInsert(
                                 node->partitionData);
         }
 
-        // Compose and exectue insert SQL string
-        AddInsertQueryToBuffer(db, node->partitionData->stats->global.phyBridge->composeGlobalPhysicalStatisticsInsertSQLString(
+        // Compose and insert the row
+        AddInsertRowToBufferStatsDb(db, node->partitionData->stats->global.phyBridge->composeGlobalPhysicalStatisticsInsertRow(
             node, node->partitionData));
     }
 }
@@ -2872,7 +3053,7 @@ void STATSDB_HandlePhyAggregateTableInsert(
 // Summary Table update
 void STATSDB_HandleAppSummaryTableInsert(Node* node)
 {
-    std::vector<std::string> insertList;
+    std::vector<UTIL::Database::DatabaseRow> insertList;
     StatsDb* db = node->partitionData->statsDb;
     if (db == NULL)
     {
@@ -2937,7 +3118,7 @@ void STATSDB_HandleMulticastAppSummaryTableInsert(Node* node)
 
     if (node->partitionData->partitionId == 0)
     {
-        std::vector<std::string> insertList;
+        std::vector<UTIL::Database::DatabaseRow> insertList;
 
         // Would enter here only once(during first time of insertion)
         if (node->partitionData->stats->global.multicastAppSummaryBridge == NULL)
@@ -3026,7 +3207,7 @@ void STATSDB_HandleTransSummaryTableInsert(Node *node)
 
     if (node->partitionData->partitionId == 0)
     {
-        std::vector<std::string> insertList;
+        std::vector<UTIL::Database::DatabaseRow> insertList;
 
         // Would enter here only once(during first time of insertion)
         //TCP first
@@ -3049,7 +3230,7 @@ void STATSDB_HandleTransSummaryTableInsert(Node *node)
 // Network Summary Table Insert
 void STATSDB_HandleNetworkSummaryTableInsert(Node* node)
 {
-    std::vector<std::string> insertList;
+    std::vector<UTIL::Database::DatabaseRow> insertList;
     StatsDb* db = node->partitionData->statsDb;
     if (db == NULL)
     {
@@ -3099,7 +3280,7 @@ void STATSDB_HandleMacSummaryTableInsert(Node* node)
 
     if (node->partitionData->partitionId == 0)
     {
-        std::vector<std::string> insertList;
+        std::vector<UTIL::Database::DatabaseRow> insertList;
 
         // Would enter here only once(during first time of insertion)
         if (node->partitionData->stats->global.macSummaryBridge == NULL)
@@ -3146,8 +3327,8 @@ void STATSDB_HandleQueueAggregateTableInsert(Node* node)
                                 node->partitionData);
         }
 
-        // Compose and exectue insert SQL string
-        AddInsertQueryToBuffer(db, node->partitionData->stats->global.queueBridge->composeGlobalQueueStatisticsInsertSQLString(
+        // Compose and insert the row
+        AddInsertRowToBufferStatsDb(db, node->partitionData->stats->global.queueBridge->composeGlobalQueueStatisticsInsertRow(
             node, node->partitionData));
     }
 }
@@ -3171,7 +3352,7 @@ void STATSDB_HandleQueueSummaryTableInsert(Node* node)
 
     //if (node->partitionData->partitionId == 0)
     {
-        std::vector<std::string> insertList;
+        std::vector<UTIL::Database::DatabaseRow> insertList;
 
         // Would enter here only once(during first time of insertion)
         if (node->partitionData->stats->global.queueSummaryBridge == NULL)
@@ -3210,7 +3391,7 @@ void STATSDB_HandleQueueStatusTableInsertion(Node* node)
 
     //if (node->partitionData->partitionId == 0)
     {
-        std::vector<std::string> insertList;
+        std::vector<UTIL::Database::DatabaseRow> insertList;
 
         // Would enter here only once(during first time of insertion)
         if (node->partitionData->stats->global.queueStatusBridge == NULL)
@@ -3249,7 +3430,7 @@ void STATSDB_HandlePhySummaryTableInsert(Node* node)
 
     if (node->partitionData->partitionId == 0)
     {
-        std::vector<std::string> insertList;
+        std::vector<UTIL::Database::DatabaseRow> insertList;
 
         // Would enter here only once(during first time of insertion)
         if (node->partitionData->stats->global.phySummaryBridge == NULL)
@@ -3657,86 +3838,89 @@ void STATSDB_HandleNetworkEventsTableUpdate(Node* node,
     IO_ConvertIpAddressToString(networkParam.m_ReceiverAddr, receiverAddr);
 
     // In this table we insert the network layer content on to the database.
-    char buf[DB_LONG_BUFFER_LENGTH];
-    size_t offset = sprintf(buf,
-            "%s(" STATSDB_TIME_FORMAT ",%d,'%s','%s','%s',%d,'%s'",
-            db->statsNetEvents->networkEventsTbColsName,
-            timeVal,
-            node->nodeId,
-            mapParamInfo->msgId,
-            senderAddr,
-            receiverAddr,
-            networkParam.m_MsgSize,
-            eventType);
+    // The optional columns left out of the row are stored as null.
+    std::vector<std::string> newValues;
+    newValues.reserve(16);
+    std::vector<std::string> columns;
+    columns.reserve(16);
+
+    columns.push_back("Timestamp");
+    newValues.push_back(STATSDB_DoubleToString(timeVal));
+    columns.push_back("NodeId");
+    newValues.push_back(STATSDB_IntToString(node->nodeId));
+    columns.push_back("MessageId");
+    newValues.push_back(mapParamInfo->msgId);
+    columns.push_back("SenderAddress");
+    newValues.push_back(senderAddr);
+    columns.push_back("ReceiverAddress");
+    newValues.push_back(receiverAddr);
+    columns.push_back("PacketSize");
+    newValues.push_back(STATSDB_IntToString(networkParam.m_MsgSize));
+    columns.push_back("EventType");
+    newValues.push_back(eventType);
 
     // Now to add the optional stuff
     if (!networkParam.m_InterfaceIndex.isNULL() && ipEvent->isInterfaceIndex)
     {
         int idx = networkParam.m_InterfaceIndex.get();
+        columns.push_back("InterfaceIndex");
         if (idx >= 0)
-            offset += sprintf(buf + offset, ",%d", idx);
-         else if (idx == CPU_INTERFACE)
-            offset += sprintf(buf + offset, ",'CPU'");
+            newValues.push_back(STATSDB_IntToString(idx));
+        else if (idx == CPU_INTERFACE)
+            newValues.push_back("CPU");
         else
-            offset += sprintf(buf + offset, ",'BACKPLANE'");
-    }
-    else
-    {
-      offset += sprintf(buf + offset, ",null");
+            newValues.push_back("BACKPLANE");
     }
 
     if (!networkParam.m_MsgSeqNum.isNULL() && ipEvent->isMsgSeqNum)
-        offset += sprintf(buf + offset, ",%d", networkParam.m_MsgSeqNum.get());
-    else
-        offset += sprintf(buf + offset, ",null");
+    {
+        columns.push_back("MessageSeqNum");
+        newValues.push_back(STATSDB_IntToString(networkParam.m_MsgSeqNum.get()));
+    }
 
     if (!networkParam.m_HeaderSize.isNULL() && ipEvent->isControlSize)
-        offset += sprintf(buf + offset, ", %d", networkParam.m_HeaderSize.get());
-    else
-        offset += sprintf(buf + offset, ",null");
+    {
+        columns.push_back("OverheadSize");
+        newValues.push_back(STATSDB_IntToString(networkParam.m_HeaderSize.get()));
+    }
 
     if (!networkParam.m_PktType.isNULL() && ipEvent->isPktType)
     {
+        columns.push_back("PacketType");
         if (networkParam.m_PktType.get() == StatsDBNetworkEventParam::DATA)
-            offset += sprintf(buf + offset, ",'%s'", "Data");
+            newValues.push_back("Data");
         else
-            offset += sprintf(buf + offset, ",'%s'", "Control");
-    }
-    else
-    {
-        offset += sprintf(buf + offset, ",null");
+            newValues.push_back("Control");
     }
 
     if (!networkParam.m_ProtocolType.isNULL() && ipEvent->isProtocolType)
     {
         std::string protocolType;
         NetworkIpConvertIpProtocolNumToString(networkParam.m_ProtocolType.get(), &protocolType);
-        offset += sprintf(buf + offset, ",'%s'", protocolType.c_str());
-    }
-    else
-    {
-        offset += sprintf(buf + offset, ",null");
+        columns.push_back("ProtocolType");
+        newValues.push_back(protocolType);
     }
 
     if (!networkParam.m_Priority.isNULL() && ipEvent->isPriority)
-        offset += sprintf(buf + offset, ",%d", networkParam.m_Priority.get());
-    else
-        offset += sprintf(buf + offset, ",null");
-
+    {
+        columns.push_back("Priority");
+        newValues.push_back(STATSDB_IntToString(networkParam.m_Priority.get()));
+    }
 
     if (failureSpecified && ipEvent->isPktFailureType)
-        offset += sprintf(buf + offset, ",'%s'", failure);
-    else
-        offset += sprintf(buf + offset, ",null");
+    {
+        columns.push_back("PacketFailureType");
+        newValues.push_back(failure);
+    }
 
     if (!networkParam.m_HopCount.isNULL() && ipEvent->isHopCount)
-        offset += sprintf(buf + offset, "," STATSDB_DOUBLE_FORMAT, networkParam.m_HopCount.get());
-    else
-        offset += sprintf(buf + offset, ",null");
-
-    sprintf(buf + offset, ")");
-    dataBase.push_back(db, buf);
+    {
+        columns.push_back("HopCount");
+        newValues.push_back(
+            STATSDB_DoubleToString(networkParam.m_HopCount.get()));
+    }
 
+    InsertValues(db, "NETWORK_Events", columns, newValues);
 }
 
 //--------------------------------------------------------------------//
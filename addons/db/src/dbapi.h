@@ -266,10 +266,11 @@ struct StatsDb
         return statsExternalEvents->Use();
     }
     int maxQueryBuffer;
+    bool dropRowsWhenQueueFull;
 
     /*---------------------------------*/
     StatsDb(): engineType(UTIL::Database::dbSqlite), queueDbPtr(0), networkEventsBytesUsed(0), appEventsBytesUsed(0),
-        statsExternalEvents(0)
+        statsExternalEvents(0), dropRowsWhenQueueFull(false)
     {
         networkEventsString = NULL;
         memset(storageEngine, 0, sizeof(storageEngine));
@@ -1780,6 +1781,8 @@ private:
 };
 
 void AddQueryToBufferStatsDb(StatsDb* db, const std::string &queryStr);
+void AddInsertRowToBufferStatsDb(StatsDb* db,
+                                 const UTIL::Database::DatabaseRow& row);
 void FlushQueryBufferStatsDb(StatsDb* db);
 
 void InitializePartitionStatsDb(StatsDb* statsDb);
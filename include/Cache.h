@@ -151,6 +151,24 @@ public:
         m_max = max;
     }
 
+    /// \brief Calls visitor(key, value) for every pair, from the LRU to
+    /// the MRU, without changing the use order.
+    ///
+    /// Inserting the pairs in the order visited into an empty cache
+    /// rebuilds the same use order.
+    ///
+    /// \param visitor function object taking (const KeyType&,
+    ///        const ValueType&)
+    template<class _Visitor>
+    void forEach(_Visitor& visitor)
+    {
+        typename UseList::iterator it;
+        for (it = m_useList.begin(); it != m_useList.end(); ++it)
+        {
+            visitor(*it, m_valueMap.find(*it)->second.first);
+        }
+    }
+
 #ifdef CACHE_DEBUG
     /// Provides access to the use-list for debugging
     typename UseList::iterator useListBegin() 
@@ -1,6 +1,8 @@
 #ifndef INTERFERENCE_H
 #define INTERFERENCE_H
 
+#include <deque>
+#include <map>
 #include <set>
 #include <vector>
 #include <boost/numeric/interval.hpp>
@@ -68,6 +70,8 @@ public:
     ~PropOverlappingSignal();
     std::ostream& fmt(std::ostream& os) const;
 
+    const period& times() const {return m_times;}
+
 private:
 
     friend class PropInterference;
@@ -205,15 +209,31 @@ private:
 
     Node* m_node;  // the node that this object is attached to.
 
-    typedef std::set<PropOverlappingSignal*> SignalSet;
-    typedef std::set<PropOverlappingSignal*>::iterator SignalSetIterator;
+    // Signals sorted by start time.  A signal overlapping time t starts
+    // after t minus the longest duration held, so a query only looks at
+    // the signals between two binary searches.
+    typedef std::deque<PropOverlappingSignal> SignalList;
+    typedef SignalList::iterator SignalListIterator;
+    typedef SignalList::const_iterator SignalListConstIterator;
+
+    struct SignalStore
+    {
+        SignalList signals;
+        clocktype maxDuration;        // longest signal in signals
+        // number of signals of each duration, so that maxDuration is
+        // kept up to date as signals are pruned
+        std::map<clocktype, int> durations;
+    };
+
+    double overlapFraction(const spectralBand* band,
+                           const spectralBand* signalBand);
 
     // Want to use an object of this class inside node.  Unfortunately node is not
     // constructed. An area of memory is allocated as a void* and cast to Node*
     // This means can not use objects that need construction.  Get round it by
     // using pointers to the object and construting a new object on first reference
 
-    SignalSet* m_signals;
+    SignalStore* m_signals;
 };
 
 inline std::ostream& operator<<(std::ostream& os, const PropInterference& p) 
@@ -25,6 +25,8 @@
 #ifndef MEMORY_H
 #define MEMORY_H
 
+#include <stddef.h>
+
 #include "types.h"
 
 /// Defines the parameters collected by the memory system.
@@ -42,6 +44,56 @@ extern UInt32 totalAllocatedMemory;
 extern UInt32 totalFreedMemory;
 extern UInt32 totalPeakUsage;
 
+/// Number of size classes kept by a MemoryPool.  Class i holds
+/// cells of (MEM_POOL_MIN_CELL_SIZE << i) bytes.
+#define MEM_POOL_NUM_SIZE_CLASSES       9
+
+/// Size of the smallest MemoryPool cell.
+#define MEM_POOL_MIN_CELL_SIZE          64
+
+/// Largest request served by a MemoryPool.  Larger requests are
+/// passed straight to MEM_malloc/MEM_free.
+#define MEM_POOL_MAX_CELL_SIZE \
+    (MEM_POOL_MIN_CELL_SIZE << (MEM_POOL_NUM_SIZE_CLASSES - 1))
+
+/// Bytes a partition pool keeps cached for each size class.
+#define MEM_POOL_PARTITION_CACHE_BYTES  (4 * 1024 * 1024)
+
+/// Bytes a thread-local pool keeps cached for each size class.
+#define MEM_POOL_THREAD_CACHE_BYTES     (1024 * 1024)
+
+/// A free cell in a MemoryPool size class.
+union MemoryPoolCell
+{
+    union MemoryPoolCell* next;
+    double                align;
+};
+
+/// Usage counters for one size class of a MemoryPool.
+struct MemoryPoolClassStats
+{
+    UInt64 hits;      // allocations served from the free list
+    UInt64 misses;    // allocations that called MEM_malloc
+    UInt64 recycled;  // frees returned to the free list
+    UInt64 released;  // frees passed to MEM_free, free list was full
+};
+
+/// Size-classed slab cache.  A pool is not locked, so it may only be
+/// used by one thread at a time: partition pools by the partition
+/// thread, thread pools (see MEM_PoolGetThreadCache) by their owner.
+struct MemoryPool
+{
+    char                 name[32];
+    int                  partitionId;
+    MemoryPoolCell*      freeList[MEM_POOL_NUM_SIZE_CLASSES];
+    UInt32               numFree[MEM_POOL_NUM_SIZE_CLASSES];
+    UInt32               maxFree[MEM_POOL_NUM_SIZE_CLASSES];
+    MemoryPoolClassStats stats[MEM_POOL_NUM_SIZE_CLASSES];
+    UInt64               numOversize;  // requests above the largest class
+    MemoryPool*          nextPool;     // For kernel use only.
+};
+
+
 /// Creates partition-specific space for collecting memory usage
 /// statistics.  This is used in threaded versions of QualNet,
 /// but not in distributed versions, currently.
@@ -53,7 +105,9 @@ void MEM_CreateThreadData();
 /// \param data  the data
 void MEM_InitializeThreadData(MemoryUsageData* data);
 
-/// Prints the partition-specific memory data.
+/// Prints the partition-specific memory data, including the
+/// counters of the memory pools belonging to the partition and the
+/// calling thread if MEM_PoolEnableStats turned them on.
 ///
 void MEM_PrintThreadData();
 
@@ -80,4 +134,58 @@ void MEM_ReportTotalUsage(UInt32 totalAllocatedMemory,
                           UInt32 totalFreedMemory,
                           UInt32 totalPeakUsage);
 
+/// Creates a size-classed memory pool.
+///
+/// \param name  label used when reporting the pool's counters
+/// \param partitionId  partition owning the pool, -1 for none
+/// \param cacheBytesPerClass  bytes of free cells kept per size class
+///
+/// \return the new pool
+MemoryPool* MEM_PoolCreate(const char* name,
+                           int partitionId,
+                           UInt32 cacheBytesPerClass);
+
+/// Releases every cached cell and the pool itself.  The statistics of
+/// the pool are printed first if MEM_PoolEnableStats turned them on.
+///
+/// \param pool  the pool
+void MEM_PoolDestroy(MemoryPool* pool);
+
+/// Allocates a block of at least size bytes.  The block is not
+/// cleared.
+///
+/// \param pool  the pool
+/// \param size  requested size
+///
+/// \return pointer to the block
+void* MEM_PoolAlloc(MemoryPool* pool, size_t size);
+
+/// Returns a block to the pool.  Blocks are plain MEM_malloc
+/// allocations, so a block may be returned to a different pool than
+/// the one it came from, and blocks from MEM_malloc may be given to
+/// the pool too.  The block is filed under the size class its real
+/// size can serve, or freed if there is none.
+///
+/// \param pool  the pool
+/// \param ptr  the block
+void MEM_PoolFree(MemoryPool* pool, void* ptr);
+
+/// Returns the pool private to the calling thread, creating it on
+/// first use.  Used for allocations made from worker threads, which
+/// cannot touch the unlocked partition pools.
+///
+/// \return the calling thread's pool
+MemoryPool* MEM_PoolGetThreadCache();
+
+/// Prints the hit/miss counters of a pool.
+///
+/// \param pool  the pool
+void MEM_PoolPrintStats(const MemoryPool* pool);
+
+/// Turns the reporting of pool counters by MEM_PrintThreadData on or
+/// off.  It is off by default.
+///
+/// \param enable  true to print the counters
+void MEM_PoolEnableStats(bool enable);
+
 #endif // MEMORY_H
@@ -32,6 +32,7 @@
 
 #include "main.h"
 #include "clock.h"
+#include "memory.h"
 #include "trace.h"
 #include "qualnet_error.h"
 #include "spectrum.h"
@@ -246,6 +247,15 @@ enum MessageInfoType
 	INFO_TYPE_MYAPI_BEACON
 };
 
+/// Reference count for a payload buffer shared between a Message and
+/// its duplicates.  The buffer itself stays in each holder's
+/// Message::payload field.  Sharing is disabled in parallel runs, so
+/// the count is only ever touched by the partition thread.
+struct MessageSharedPayload
+{
+    int refCount;
+};
+
 /// \brief Main data structure that represents a discrete event in qualnet.
 ///
 /// A Message can represent either a timer or a simulated packet actually
@@ -269,6 +279,14 @@ enum MessageInfoType
 ///   also the usual way to pass data to the handler of a Message representing
 ///   a timer event.
 ///
+/// MESSAGE_DuplicateShared shares the payload buffer with the original
+/// rather than copying it.  A private copy is made the first time either
+/// message's packet is returned by MESSAGE_ReturnPacket or
+/// MESSAGE_ReturnHeader, or its headers are added, removed, expanded or
+/// shrunk.  Since writes through the packet field directly are not
+/// caught, it may only be used where neither message is written that
+/// way; MESSAGE_Duplicate always copies.
+///
 /// \sa MESSAGE_* functions in message.h
 class Message
 {
@@ -451,8 +469,16 @@ public:
         ERROR_Assert(virtualPayloadSize >= 0, "invalid virtual payload size");
     }
 
-    /// returns a pointer to the beginning of the data packet.
-    char* returnPacket() const { return packet; }
+    /// returns a pointer to the beginning of the data packet.  The caller
+    /// may modify the packet, so a shared payload is copied first.
+    char* returnPacket() const
+    {
+        if (m_sharedPayload != NULL)
+        {
+            const_cast<Message*>(this)->unsharePayload();
+        }
+        return packet;
+    }
 
     /// returns the packet size, including virtual data.
     int returnPacketSize() const { return packetSize + virtualPayloadSize; }
@@ -497,6 +523,22 @@ public:
 
     spectralBand* m_band;
     MIMO_Data* m_mimoData;
+
+    /// Non-NULL while the payload is shared with duplicates of this
+    /// message.  For kernel use only.
+    MessageSharedPayload* m_sharedPayload;
+
+    /// Gives this message a private copy of a payload shared by
+    /// MESSAGE_DuplicateShared.  Called before the payload is modified.
+    void unsharePayload();
+
+    /// Copies msg into this message, as operator= does.  If
+    /// sharePayload is true the payload buffer is shared with msg where
+    /// possible instead of copied.  For kernel use only.
+    ///
+    /// \param msg  message to copy
+    /// \param sharePayload  share the payload instead of copying it
+    void copyFrom(const Message& msg, bool sharePayload);
 };
 
 /// Shorter version of the message data structure used to reduce the amount of data send to
@@ -1415,6 +1457,32 @@ Message* MESSAGE_DuplicateMT(PartitionData *partition, const Message *msg)
     return MESSAGE_Duplicate(partition, msg, true);
 }
 
+/// Create a new message which is a duplicate of the message supplied
+/// as the parameter to the function, sharing its payload buffer until
+/// either message modifies it through the MESSAGE_* functions.  Only
+/// use this where neither message is written through its packet field
+/// directly.  Sharing is not done in parallel runs, where this is the
+/// same as MESSAGE_Duplicate.
+///
+/// \param node  node is calling message copy
+/// \param msg  message for which duplicate has to be made
+///
+/// \return Pointer to the new message
+Message* MESSAGE_DuplicateShared(Node *node, const Message *msg);
+
+/// Create a new message which is a duplicate of the message supplied
+/// as the parameter to the function, sharing its payload buffer until
+/// either message modifies it through the MESSAGE_* functions.  Only
+/// use this where neither message is written through its packet field
+/// directly.
+///
+/// \param partition  partition is calling message copy
+/// \param msg  message for which duplicate has to be made
+///
+/// \return Pointer to the new message
+Message* MESSAGE_DuplicateShared(PartitionData *partition,
+                                 const Message *msg);
+
 /// Allocate a character payload out of the free list,
 /// if possible otherwise via malloc.
 ///
@@ -30,6 +30,7 @@
 #include "coordinates.h"
 #include "main.h"
 #include "mapping.h"
+#include "memory.h"
 #include "message.h"
 #include "terrain.h"
 #include "mobility.h"
@@ -127,6 +128,12 @@ extern clocktype PrintSimTimeInterval;
 struct StatsDb;
 
 class MessageSendRemoteInfo;
+struct SchedulerTrace;
+class LadderQueue;
+class PairingHeap;
+struct PropBatch;
+struct PathlossCache;
+struct PropSpatialIndex;
 
 #include <memory> // std::allocator
 
@@ -272,6 +279,8 @@ public:
 
     int                     msgFreeListNum;
     Message                *msgFreeList;
+    // Unused since msgPayloadPool and msgInfoPool replaced them.  Kept
+    // so that the offsets of the members after them do not change.
     int                     msgPayloadFreeListNum;
     MessagePayloadListCell *msgPayloadFreeList;
     int                     msgInfoFreeListNum;
@@ -482,6 +491,34 @@ public:
     std::map<std::string, HITLApplication> hitlApplicationMap;
 #endif // CYBER_LIB
     spectrum theSpectrum;
+
+    // Size-classed pools for message payloads and info fields.  They
+    // replace the msgPayloadFreeList and msgInfoFreeList lists above.
+    // Destroyed by PARTITION_Finalize.
+    MemoryPool             *msgPayloadPool;
+    MemoryPool             *msgInfoPool;
+
+    SchedulerTrace  *schedulerTrace;    // Scheduler call recording, if any
+
+    // Queues of the LADDER and PAIRING-HEAP scheduler types.  They are
+    // kept here because the kernel allocates SchedulerInfo at its own
+    // size.
+    LadderQueue     *ladderQueue;
+    PairingHeap     *pairingHeap;
+
+    PropBatch*   propBatch;     // numChannels entries, NULL if disabled
+
+    // Pathloss values of terrain and urban models, if
+    // PROPAGATION-PATHLOSS-CACHE is enabled.  Kept in the partition for
+    // thread safety.
+    PathlossCache* pathlossCache;
+
+    PropSpatialIndex* propSpatialIndex; // numChannels entries, NULL if
+                                        // PROPAGATION-SPATIAL-INDEX is NO
+
+    // Signals skipped by PROPAGATION-CULLING, indexed by channel and
+    // then by nodeIndex.  A channel's entry is NULL without culling.
+    UInt64** propSignalsCulled;
     // Users should not modify anything above this line.
 };
 
@@ -152,6 +152,62 @@ enum PhyStatusType {
   PHY_TRX_OFF
 };
 
+/// Most points of the uniform grid an error rate table is resampled onto
+#define PHY_ERROR_RATE_GRID_MAX_POINTS  8192
+
+/// Number of packet length buckets of a BER or SER grid
+#define PHY_ERROR_RATE_GRID_NUM_BUCKETS  16
+
+/// Length of the shortest bucket, in bits or symbols.  Each bucket is
+/// twice as long as the one before.
+#define PHY_ERROR_RATE_GRID_MIN_BUCKET  64
+
+/// Error rate curve of a table resampled onto a uniform SNR grid, so
+/// that a rate is looked up by direct indexing.  The SNR is in the units
+/// of the table.  The grids are kept beside the tables, which are fixed
+/// in size, for the PHYs with PHY-ERROR-RATE-GRID YES, and are shared by
+/// the tables of the same entries.
+struct PhyErrorRateGrid {
+    int     numPoints;
+    double  snrStart;
+    double  snrEnd;
+    double  invInterval;    // points per unit of SNR
+    double* rates;          // error rate at each point
+    double* logSuccess;     // log(1 - rate) at each point, the packet
+                            // error rate of n units is
+                            // 1 - exp(n * logSuccess)
+    double* bucketPers;     // packet error rate of each length bucket at
+                            // each point, numPoints per bucket, NULL for
+                            // a PER table
+};
+
+/// Get the error rate of the grid at the SNR, interpolated between the
+/// nearest points.  As PHY_BER, the rate below the grid is the rate at
+/// the start and the rate above it is 0.
+///
+/// \param grid  Error rate grid
+/// \param snr  SNR in the units of the table
+///
+/// \return Error rate, 0 if the grid is empty
+double PHY_ErrorRateGridLookup(const PhyErrorRateGrid& grid, double snr);
+
+/// Get the packet error rate at the SNR of a packet of independent
+/// units (bits or symbols).  The rates at the nearest points,
+/// 1 - exp(numUnits * logSuccess), are interpolated linearly, as the
+/// error rates are.  For a packet of the length of a bucket they are
+/// read from the bucket table, so every length is interpolated the same
+/// way.
+///
+/// \param grid  Error rate grid of a BER or SER table
+/// \param snr  SNR in the units of the table
+/// \param numUnits  Number of bits or symbols of the packet
+///
+/// \return Packet error rate
+double PHY_ErrorRateGridPacketErrorRate(
+    const PhyErrorRateGrid& grid,
+    double snr,
+    double numUnits);
+
 /// SNR/BER curve entry
 struct PhyBerEntry {
     double snr;
@@ -291,6 +347,7 @@ struct PhyPcomItem {
 
 
 struct AbstractPhyStru;
+struct PhyErrorRateGrids;
 
 /// Structure for phy layer
 struct PhyData {
@@ -357,6 +414,10 @@ struct PhyData {
     BOOL isSigintInterface;
 #endif
 
+    // The grids of the error rate tables, NULL unless
+    // PHY-ERROR-RATE-GRID is YES
+    PhyErrorRateGrids* errorRateGrids;
+
     PhyData() 
     : phyIndex(0), macInterfaceIndex(0), networkAddress(NULL), phyStats(FALSE), channelIndexForTransmission(0), 
       phyModel(PHY_NONE), phyRxModel(RX_MODEL_NONE), phyRxSnrThreshold(0.0), noise_mW_hz(0.0), 
@@ -378,6 +439,8 @@ struct PhyData {
      jammerStatistics(FALSE), jamInstances(0), jamDuration(0),
      isSigintInterface(FALSE)
 #endif
+     ,
+     errorRateGrids(NULL)
 
     { ; }
       
@@ -849,6 +912,127 @@ double PHY_SER(
     int perTableIndex,
     double sinr);
 
+/// Read PHY-ERROR-RATE-GRID for the PHY.  When it is YES the error
+/// rates of PHY_GridBER, PHY_GridPER, PHY_GridSER and
+/// PHY_GridPacketErrorRate are looked up in the uniform grids of the
+/// tables of the PHY, otherwise they are those of PHY_BER, PHY_PER and
+/// PHY_SER.
+///
+/// \param node  Node of the PHY
+/// \param interfaceIndex  Interface of the PHY
+/// \param nodeInput  Structure containing contents of input file
+/// \param thisPhy  PHY layer data
+void PHY_ErrorRateGridInit(
+    Node* node,
+    int interfaceIndex,
+    const NodeInput* nodeInput,
+    PhyData* thisPhy);
+
+/// Release the grids of the PHY
+///
+/// \param thisPhy  PHY layer data
+void PHY_ErrorRateGridFinalize(PhyData* thisPhy);
+
+/// Get BER, from the uniform grid of the table if the PHY uses them
+///
+/// \param phyData  PHY layer data
+/// \param berTableIndex  index for BER tables
+/// \param sinr  Signal to Interference and Noise Ratio
+/// \param rxModel  Model of the BER tables, that of the PHY if none
+///
+/// \return Bit Error Rate
+double PHY_GridBER(
+    PhyData *phyData,
+    int berTableIndex,
+    double sinr,
+    PhyRxModel rxModel = RX_MODEL_NONE);
+
+/// Get PER, from the uniform grid of the table if the PHY uses them
+///
+/// \param phyData  PHY layer data
+/// \param perTableIndex  index for PER tables
+/// \param sinr  Signal to Interference and Noise Ratio
+///
+/// \return Packet Error Rate
+double PHY_GridPER(
+    PhyData *phyData,
+    int perTableIndex,
+    double sinr);
+
+/// Get SER, from the uniform grid of the table if the PHY uses them
+///
+/// \param phyData  PHY layer data
+/// \param serTableIndex  index for SER tables
+/// \param sinr  Signal to Interference and Noise Ratio
+///
+/// \return Symbol Error Rate
+double PHY_GridSER(
+    PhyData *phyData,
+    int serTableIndex,
+    double sinr);
+
+/// Get the error rate of a packet of independent bits from a BER
+/// table, 1 - (1 - BER)^numBits.  With the uniform grids a packet of
+/// the length of a bucket is looked up in the bucket table.
+///
+/// \param phyData  PHY layer data
+/// \param berTableIndex  index for BER tables
+/// \param sinr  Signal to Interference and Noise Ratio
+/// \param numBits  Number of bits of the packet
+/// \param rxModel  Model of the BER tables, that of the PHY if none
+///
+/// \return Packet Error Rate
+double PHY_GridPacketErrorRate(
+    PhyData *phyData,
+    int berTableIndex,
+    double sinr,
+    double numBits,
+    PhyRxModel rxModel = RX_MODEL_NONE);
+
+/// Get the BER of each BER table of the model at the SINR, as for the
+/// modulation and coding candidates of rate adaptation
+///
+/// \param phyData  PHY layer data
+/// \param sinr  Signal to Interference and Noise Ratio
+/// \param bers  BER of each table
+/// \param rxModel  Model of the BER tables, that of the PHY if none
+///
+/// \return Number of tables
+int PHY_GridBERs(
+    PhyData *phyData,
+    double sinr,
+    double* bers,
+    PhyRxModel rxModel = RX_MODEL_NONE);
+
+/// Get the packet error rate of each BER table of the model at the SINR
+/// for a packet of the number of bits
+///
+/// \param phyData  PHY layer data
+/// \param sinr  Signal to Interference and Noise Ratio
+/// \param numBits  Number of bits of the packet
+/// \param pers  Packet error rate of each table
+/// \param rxModel  Model of the BER tables, that of the PHY if none
+///
+/// \return Number of tables
+int PHY_GridPacketErrorRates(
+    PhyData *phyData,
+    double sinr,
+    double numBits,
+    double* pers,
+    PhyRxModel rxModel = RX_MODEL_NONE);
+
+/// Get the PER of each PER table of the PHY at the SINR
+///
+/// \param phyData  PHY layer data
+/// \param sinr  Signal to Interference and Noise Ratio
+/// \param pers  PER of each table
+///
+/// \return Number of tables
+int PHY_GridPERs(
+    PhyData *phyData,
+    double sinr,
+    double* pers);
+
 
 /// Check if it can listen to the channel
 ///
@@ -53,6 +53,13 @@ using namespace::std;
 
 /// Default mean value for shadowing in dB
 #define PROP_DEFAULT_SHADOWING_MEAN_dB 4.0
+
+/// Default margin below the noise floor for PROPAGATION-CULLING, in dB
+#define PROP_DEFAULT_CULLING_MARGIN_dB 20.0
+
+/// Largest gain of the two-ray model over free space in dB, from the
+/// two rays adding in phase
+#define PROP_TWO_RAY_MAX_GAIN_dB 6.0206
 //PL_OPAR_PROP
 #define PROP_DEFAULT_INTER_CITY_OBSTRUCTION_DENSITY_FACTOR 0.04
 #define PROP_DEFAULT_INTRA_CITY_OBSTRUCTION_DENSITY_FACTOR 0.02
@@ -325,6 +332,20 @@ struct PropProfile {
 
     // TIREM library
     void * tiremLibHandle;
+
+    // Ricean fading in dB for each gaussian component, built for
+    // riceanTableKFactor.  NULL without Ricean fading.
+    float*  riceanFading_dB;
+    double  riceanTableKFactor;
+
+    // Receivers whose best case power is this far below their noise
+    // floor are skipped.  See PROPAGATION-CULLING.
+    BOOL    cullingEnabled;
+    double  cullingMargin_dB;
+
+    // LOGNORMAL shadowing drawn by the Ziggurat method.  See
+    // PROPAGATION-SHADOWING-SAMPLER.
+    BOOL    shadowingZiggurat;
 };
 
 /// Main structure of propagation data.
@@ -461,6 +482,12 @@ void PROP_GlobalInit(PartitionData *partitionData, NodeInput *nodeInput);
 /// \param nodeInput  structure containing contents of input file
 void PROP_PartitionInit(PartitionData *partitionData, NodeInput *nodeInput);
 
+/// Finalizes partition level propagation structures.
+/// This function is called from each partition, not from each node
+///
+/// \param partitionData  partition being finalized
+void PROP_PartitionFinalize(PartitionData *partitionData);
+
 /// Initialization function for propagation functions.
 /// This function is called from each node.
 ///
@@ -562,6 +589,27 @@ void PROP_CalculateFading(
     double* channelReal,
     double* channelImag);
 
+/// To calculate fading from one transmitter to several receivers.
+/// Gives the same values as calling PROP_CalculateFading for each
+/// receiver in turn.
+///
+/// \param signalMsg  signal being received
+/// \param propTxInfo  Information about the transmitter
+/// \param rxNodes  receivers, all in the same partition
+/// \param numNodes  number of receivers
+/// \param channelIndex  channel number
+/// \param currentTime  current simulation time
+/// \param fading_dB  numNodes entries, receive the fading of each
+///    receiver
+void PROP_CalculateFadingBatch(
+    Message* signalMsg,
+    PropTxInfo* propTxInfo,
+    Node** rxNodes,
+    int numNodes,
+    int channelIndex,
+    clocktype currentTime,
+    float* fading_dB);
+
 /// Determines when shadowing applies to pathloss.
 /// It applies when the model is FREE_SPACE or TWO_RAY, or 
 /// with PL_OPAR or PL_OPAR_PROP models if the primary pathloss
@@ -593,6 +641,62 @@ bool PROP_CalculateShadowing(
     int channelIndex,
     double* shadowing_dB);
 
+/// Channels with fewer nodes than this are always computed one
+/// pair at a time.
+#define PROP_BATCH_MIN_RECEIVERS 16
+
+/// Batched free-space / two-ray pathloss and Ricean fading for all
+/// receivers on one channel, kept in structure-of-arrays form.
+///
+/// The receivers are gathered from the channel's node list once per
+/// simulation time.  The first PROP_CalculatePathloss (or
+/// PROP_CalculateFading) call for a new transmitter only records it;
+/// the second computes the values for every receiver in one pass.
+/// An entry is used only if the receiver's position, antenna height
+/// and distance equal those of the call exactly, so results are
+/// identical to the per-pair computation.
+struct PropBatch {
+    // Receivers, gathered at rxTime
+    clocktype   rxTime;
+    int         numReceivers;
+    int         capacity;
+    Node**      rxNode;
+    double*     rxX;
+    double*     rxY;
+    double*     rxZ;
+    float*      rxAntennaHeight;
+
+    // Open addressing map from node id to receiver index, -1 if empty
+    int         hashSize;
+    NodeId*     hashKey;
+    int*        hashIndex;
+
+    // Pathloss of every receiver from the transmitter position below
+    BOOL        pathlossValid;
+    double      txX;
+    double      txY;
+    double      txZ;
+    float       txAntennaHeight;
+    double      wavelength;
+    double*     distance;
+    double*     pathloss_dB;
+
+    // Fading of every receiver from txNodeId at fadingTime
+    BOOL        fadingValid;
+    NodeId      txNodeId;
+    clocktype   fadingTime;
+    double*     fadingStretchingFactor;
+    float*      fading_dB;
+};
+
+/// Allocates the partition's per-channel batches unless
+/// PROPAGATION-BATCH is NO.  Called from PROP_GlobalInit, and again
+/// from PROP_PartitionInit so that partitions do not share them.
+///
+/// \param partitionData  partition to allocate for
+/// \param nodeInput  structure containing contents of input file
+void PROP_BatchInit(PartitionData* partitionData, NodeInput* nodeInput);
+
 /// This function will be called by QualNet wireless
 /// propagation code to calculate rxPower and prop delay
 /// for a specific signal from a specific tx node to
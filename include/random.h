@@ -34,11 +34,33 @@ struct ValueProbabilityPair {
     Float32 probability;
 };
 
+/// How a user defined distribution is sampled, from the keyword after
+/// its name in the distribution file.
+enum ArbitrarySampling {
+    ARBITRARY_SCAN,         // cumulative scan of the points, the default
+    ARBITRARY_ALIAS,        // ALIAS: constant time through an alias table
+    ARBITRARY_CONTINUOUS    // CONTINUOUS: linear between the points
+};
+
 /// Stores a user defined distribution.
+///
+/// By default a draw scans the points until their cumulative probability
+/// exceeds the uniform number.  A distribution declared ALIAS is sampled
+/// in constant time through its alias table instead: point i is drawn
+/// with probability aliasProbability[i] / numDistPoints directly, and
+/// otherwise through the alias of another point.  The values drawn for a
+/// seed then differ from those of the scan, but the distribution does
+/// not.  A distribution declared CONTINUOUS is sampled through its
+/// cumulative probabilities, interpolating linearly between the values.
 struct ArbitraryDistribution {
     char* distributionName;
     Int32 numDistPoints;
     ValueProbabilityPair* values;
+    ArbitrarySampling sampling;
+    double* aliasProbability;   // chance of keeping each point, ALIAS only
+    Int32* alias;               // point drawn otherwise
+    double* cumulative;         // probability up to each point included,
+                                // CONTINUOUS only
 };
 
 /// Random function types
@@ -54,7 +76,10 @@ typedef enum {
     TPD4,        //Truncated Pareto (4 parameters)
     UPD,        //Untruncated Pareto (2 parameters)
     GPD,        //General Untruncated Pareto 
-    INT_GAU     //Gaussian- discrete valued, only integers
+    INT_GAU,    //Gaussian- discrete valued, only integers
+    ZIG_EXP,    //EXP drawn by the Ziggurat method
+    ZIG_GAU,    //GAU drawn by the Ziggurat method
+    ZIG_INT_GAU //INT_GAU drawn by the Ziggurat method
 } RandomDistributionType;
 
 /// Used for parsing input strings.
@@ -105,6 +130,53 @@ extern Int32  RANDOM_jrand(RandomSeed);
 /// \return a random number
 extern Int32  RANDOM_nrand(RandomSeed);
 
+/// Fills an array with the numbers count calls to RANDOM_erand would
+/// return, and advances the seed past them.  The generator is stepped
+/// several values at a time with precomputed jump-ahead constants, so
+/// the steps of a block are independent and vectorize.
+///
+/// \param seed  the seed for this random stream.
+/// \param values  filled with count uniform numbers in [0.0 .. 1.0]
+/// \param count  number of values
+void RANDOM_erandArray(RandomSeed seed, double* values, int count);
+
+/// Fills an array with the numbers count calls to RANDOM_nrand would
+/// return, and advances the seed past them.
+///
+/// \param seed  the seed for this random stream.
+/// \param values  filled with count integers between 0 and 2^31
+/// \param count  number of values
+void RANDOM_nrandArray(RandomSeed seed, Int32* values, int count);
+
+/// Fills an array with exponentially distributed numbers, the values
+/// an EXP RandomDistribution<double> of the mean would return.
+///
+/// \param seed  the seed for this random stream.
+/// \param mean  the mean value of the distribution
+/// \param values  filled with count values
+/// \param count  number of values
+void RANDOM_ExponentialArray(RandomSeed seed,
+                             double mean,
+                             double* values,
+                             int count);
+
+/// Fills an array with normally distributed numbers of mean 0, the
+/// values a Gaussian RandomDistribution<double> of the sigma would
+/// return.  The seed is left after the last uniform number used.
+///
+/// \param seed  the seed for this random stream.
+/// \param sigma  the standard deviation
+/// \param values  filled with count values
+/// \param count  number of values
+void RANDOM_GaussianArray(RandomSeed seed,
+                          double sigma,
+                          double* values,
+                          int count);
+
+/// Number of uniform numbers a buffered RandomDistribution draws at a
+/// time.
+#define RANDOM_BUFFER_SIZE 16
+
 
 /// Loads all user defined distributions.
 ///
@@ -121,6 +193,25 @@ class RandomDistribution
 public:
     char* userDefinedDistributionName;
 
+    // API        :: RandomDistribution.RandomDistribution
+    // PURPOSE    :: The distribution is not buffered.  Its other members
+    //               are set by init.
+    RandomDistribution() : bufferSlot(0) {}
+
+    // API        :: RandomDistribution.RandomDistribution
+    // PURPOSE    :: Copies the distribution.  A copy of a buffered
+    //               distribution is buffered in a buffer of its own.
+    RandomDistribution(const RandomDistribution& other);
+
+    // API        :: RandomDistribution.operator=
+    // PURPOSE    :: Copies the distribution, keeping this one's buffer and
+    //               buffering it as other is.
+    RandomDistribution& operator=(const RandomDistribution& other);
+
+    // API        :: RandomDistribution.~RandomDistribution
+    // PURPOSE    :: Releases the buffer of a buffered distribution.
+    ~RandomDistribution();
+
     // API        :: RandomDistribution.init
     // PURPOSE    :: Initializes the random distribution
     // PARAMETERS ::
@@ -134,6 +225,7 @@ public:
         randomSeed[1] = 0;
         randomSeed[2] = 0;
         type = DNULL;
+        bufferSlot = 0;
     }
 
     // API        :: RandomDistribution.setDistributionUniform
@@ -276,16 +368,56 @@ public:
     // RETURN :: void :
     void setSeed(RandomSeed seed);
 
+    // API        :: RandomDistribution.setBuffered
+    // PURPOSE    :: In buffered mode the uniform numbers of the member seed
+    //               are drawn RANDOM_BUFFER_SIZE at a time with
+    //               RANDOM_erandArray.  The values returned are the same
+    //               as in the default mode.  The numbers drawn ahead are
+    //               kept in a buffer allocated aside, which is released
+    //               by disabling the mode or destroying the distribution.
+    //               A distribution in memory that is freed without being
+    //               destroyed must disable the mode first.
+    // PARAMETERS ::
+    // + enable : bool : whether to buffer
+    // RETURN :: void :
+    void setBuffered(bool enable);
+
+    // API        :: RandomDistribution.setZiggurat
+    // PURPOSE    :: Draws the Gaussian and exponential distributions by the
+    //               Ziggurat method, which in most draws takes one number
+    //               from the seed and no math library call.  The values
+    //               differ from those of the default polar and inversion
+    //               methods, which are kept for existing scenarios.  The
+    //               method is part of the distribution type, ZIG_EXP,
+    //               ZIG_GAU or ZIG_INT_GAU, so this is called after the
+    //               setDistribution functions, which restore the default.
+    // PARAMETERS ::
+    // + enable : bool : whether to use the Ziggurat method
+    // RETURN :: void :
+    void setZiggurat(bool enable);
+
     RandomDistributionType getDistributionType() { return type; }
 
+    // Whether the distribution has a buffer, which it may not get when
+    // too many distributions are buffered
+    bool isBuffered() const { return bufferSlot != 0; }
+
 private:
     T                      value1;
     T                      value2;
     T                      value3;
     double                 alpha;
     RandomSeed             randomSeed;
+    UInt16                 bufferSlot;  // buffered mode: buffer of the
+                                        // seed states, 0 if not buffered
     RandomDistributionType type;
 
+    UInt64 nextBufferedState();
+    double erand(RandomSeed seed);
+    UInt32 bits(RandomSeed seed);
+    double zigguratNormal(RandomSeed seed);
+    double zigguratExponential(RandomSeed seed);
+
     T uniform(RandomSeed seed);
     T exponential(RandomSeed seed);
 
@@ -0,0 +1,263 @@
+// Copyright (c) 2001-2015, SCALABLE Network Technologies, Inc.  All Rights Reserved.
+//                          600 Corporate Pointe
+//                          Suite 1200
+//                          Culver City, CA 90230
+//                          info@scalable-networks.com
+//
+// This source code is licensed, not sold, and is subject to a written
+// license agreement.  Among other things, no portion of this source
+// code may be copied, transmitted, disclosed, displayed, distributed,
+// translated, used as the basis for a derivative work, or used, in
+// whole or in part, for any program or purpose other than its intended
+// use in compliance with the license agreement as part of the QualNet
+// software.  This source code and certain of the algorithms contained
+// within it are confidential trade secrets of Scalable Network
+// Technologies, Inc. and may not be used as the basis for any other
+// software, hardware, product or service.
+
+/*
+ * PURPOSE: Event (message) queue using a ladder queue
+ */
+
+#ifndef SCHED_LADDER_H
+#define SCHED_LADDER_H
+
+#include <vector>
+
+#include "scheduler_types.h"
+#include "sched_std_library.h"
+
+
+//------------ Declaration of Scheduler Queue Structure -------------
+
+/// Events in a ladder bottom or bucket with more than this many
+/// entries are spread over a new rung rather than sorted.
+#define LADDER_THRESHOLD        50
+
+/// Maximum number of rungs in the ladder.
+#define LADDER_MAX_RUNGS        8
+
+/// Maximum number of buckets in a rung.
+#define LADDER_MAX_BUCKETS      65536
+
+/// Ladder queue (Tang, Goh and Thng, ACM TOMACS 2005).  Events far in
+/// the future collect unsorted in the top list; they are spread over
+/// rungs of time buckets as the simulation gets close to them, and only
+/// the few events in the earliest bucket are sorted into the bottom
+/// list.  Insert and extract are O(1) amortized, independent of the
+/// number of pending events.
+///
+/// Events are ordered exactly as in the STDLIB heap, see
+/// SchedulerStlEvent::operator<.
+class LadderQueue
+{
+public:
+    LadderQueue();
+
+    /// Adds an event
+    void insert(const SchedulerStlEvent& event);
+
+    /// Returns the earliest event.  The queue must not be empty.
+    const SchedulerStlEvent& top();
+
+    /// Removes the earliest event.  The queue must not be empty.
+    void pop();
+
+    bool empty() const { return m_size == 0; }
+    size_t size() const { return m_size; }
+
+    /// Removes the events of node, or only the event of msg if msg is
+    /// not NULL.  The messages of the removed events are appended to
+    /// removed.  O(n) in the number of pending events.
+    void remove(
+        const Node* node,
+        const Message* msg,
+        std::vector<Message*>& removed);
+
+private:
+    typedef std::vector<SchedulerStlEvent> EventList;
+
+    struct Rung
+    {
+        clocktype start;        // time of the first bucket
+        clocktype last;         // last time covered by the rung
+        clocktype width;        // time covered by each bucket
+        size_t    numBuckets;
+        size_t    current;      // first bucket that may hold events
+        size_t    numEvents;
+        std::vector<EventList> buckets;
+
+        bool isActive() const { return current < numBuckets; }
+
+        clocktype currentStart() const
+        {
+            return start + (clocktype)current * width;
+        }
+    };
+
+    EventList m_top;
+    clocktype m_lowerMax;   // events after this time go to m_top
+    clocktype m_topMin;
+    clocktype m_topMax;
+
+    // m_rungs[0] is the coarsest rung.  Rungs beyond m_numRungs are
+    // kept to reuse their bucket storage.
+    std::vector<Rung> m_rungs;
+    size_t m_numRungs;
+
+    // Sorted with the earliest event at the back
+    EventList m_bottom;
+
+    size_t m_size;
+
+    void route(const SchedulerStlEvent& event);
+    void insertBottom(const SchedulerStlEvent& event);
+    void spawnRung(EventList& events, clocktype start, clocktype last);
+    void fillBottom();
+
+    static size_t removeFrom(
+        EventList& events,
+        const Node* node,
+        const Message* msg,
+        std::vector<Message*>& removed);
+};
+
+
+//------------------------------------------------------------------
+
+/// Insert a message into the node's message queue
+///
+/// \param node  Pointer to the node to insert into
+/// \param msg  Pointer to the message to insert
+/// \param time  time to delay
+void SCHED_LADDER_InsertMessage(
+    Node *node,
+    Message *msg,
+    clocktype delay);
+
+
+/// Remove the first message from the node's message queue
+///
+/// \param partitionData  Pointer to the partition data
+/// \param node  Pointer to the node
+///    to be extracted
+///
+/// \return First message from queue
+Message* SCHED_LADDER_ExtractFirstMessage(
+    PartitionData *partitionData,
+    Node *node);
+
+
+/// Peek at the first message from the node's message queue
+/// NOT REMOVED FROM QUEUE
+///
+/// \param node  Pointer to the node
+///
+/// \return Pointer to message
+Message* SCHED_LADDER_PeekFirstMessage(
+    Node *node);
+
+
+/// Delete a message from the nodes's message queue.  The message is
+/// not freed.
+///
+/// \param node  Pointer to the node
+///    to delete message from
+/// \param msg  Pointer to the message
+void SCHED_LADDER_DeleteMessage(
+    Node *node,
+    Message *msg);
+
+
+/// Insert a node into the partition's scheduler queue
+///
+/// \param partitionData  Pointer to the partition
+///    to be inserted
+/// \param node  Pointer to the node
+void SCHED_LADDER_InsertNode(
+    PartitionData *partitionData,
+    Node *node);
+
+
+/// Peek at next node to process in the partition's scheduler queue
+///
+/// \param partitionData  Pointer to the node
+///    to be inserted
+///
+/// \return next node to process
+Node* SCHED_LADDER_PeekNextNode(
+    PartitionData *partitionData);
+
+
+/// Delete a node from the partition's scheduler queue.  All events
+/// are kept in the one partition queue, so this removes and frees the
+/// node's pending messages.
+///
+/// \param partitionData  Pointer to the node
+///    to be inserted
+/// \param node  Pointer to the node
+void SCHED_LADDER_DeleteNode(
+    PartitionData *partitionData,
+    Node *node);
+
+
+/// Current node from the partition's scheduler queue
+///
+/// \param partitionData  Pointer to the node
+///    to be inserted
+Node* SCHED_LADDER_CurrentNode(
+    const PartitionData *partitionData);
+
+
+/// Check for nodes in the scheduler's node queue.
+///
+/// \param partitionData  Pointer to the partition data
+///
+/// \return scheduler has nodes in it's queue
+BOOL SCHED_LADDER_HasNodes(
+    const PartitionData *partitionData);
+
+
+/// Get the next event for this partition
+///
+/// \param partitionData  Pointer to the partition data
+/// \param node  Pointer to the node
+///
+/// \return next event
+Message* SCHED_LADDER_NextEvent(
+    PartitionData *partitionData,
+    Node* node);
+
+
+/// Get the next event time for this partition
+///
+/// \param partitionData  Pointer to the partition data
+///
+/// \return time of next event
+clocktype SCHED_LADDER_NextEventTime(
+    const PartitionData *partitionData);
+
+
+/// Initalize Scheduler
+///
+/// \param partitionData  Pointer to the partition data
+void SCHED_LADDER_Initialize(
+    PartitionData *partitionData);
+
+
+/// Finalize Scheduler
+///
+/// \param partitionData  Pointer to the partition data
+void SCHED_LADDER_Finalize(
+    PartitionData *partitionData);
+
+
+/// Replaces the queue that SCHED_Initialize set up in the partition's
+/// SchedulerInfo with a ladder queue.  Called after SCHED_Initialize
+/// when SCHEDULER-QUEUE-TYPE is LADDER, before any event is scheduled.
+///
+/// \param partitionData  Pointer to the partition data
+void SCHED_LADDER_Setup(
+    PartitionData *partitionData);
+
+#endif /* SCHED_LADDER_H */
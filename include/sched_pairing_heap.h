@@ -0,0 +1,234 @@
+// Copyright (c) 2001-2015, SCALABLE Network Technologies, Inc.  All Rights Reserved.
+//                          600 Corporate Pointe
+//                          Suite 1200
+//                          Culver City, CA 90230
+//                          info@scalable-networks.com
+//
+// This source code is licensed, not sold, and is subject to a written
+// license agreement.  Among other things, no portion of this source
+// code may be copied, transmitted, disclosed, displayed, distributed,
+// translated, used as the basis for a derivative work, or used, in
+// whole or in part, for any program or purpose other than its intended
+// use in compliance with the license agreement as part of the QualNet
+// software.  This source code and certain of the algorithms contained
+// within it are confidential trade secrets of Scalable Network
+// Technologies, Inc. and may not be used as the basis for any other
+// software, hardware, product or service.
+
+/*
+ * PURPOSE: Event (message) queue using a pairing heap
+ */
+
+#ifndef SCHED_PAIRING_HEAP_H
+#define SCHED_PAIRING_HEAP_H
+
+#include <vector>
+
+#include "scheduler_types.h"
+#include "sched_std_library.h"
+
+
+//------------ Declaration of Scheduler Queue Structure -------------
+
+/// Number of heap nodes allocated at a time.
+#define PAIRING_HEAP_BLOCK_SIZE     4096
+
+/// Pairing heap (Fredman, Sedgewick, Sleator and Tarjan, 1986).  Insert
+/// is O(1) and extract is O(log n) amortized with the two-pass merge.
+/// Heap nodes are recycled through a free list, so steady-state
+/// scheduling does not allocate.
+///
+/// Events are ordered exactly as in the STDLIB heap, see
+/// SchedulerStlEvent::operator<.
+class PairingHeap
+{
+public:
+    PairingHeap();
+    ~PairingHeap();
+
+    /// Adds an event
+    void insert(const SchedulerStlEvent& event);
+
+    /// Returns the earliest event.  The heap must not be empty.
+    const SchedulerStlEvent& top() const { return m_root->event; }
+
+    /// Removes the earliest event.  The heap must not be empty.
+    void pop();
+
+    bool empty() const { return m_root == NULL; }
+    size_t size() const { return m_size; }
+
+    /// Removes the events of node, or only the event of msg if msg is
+    /// not NULL.  The messages of the removed events are appended to
+    /// removed.  O(n) in the number of pending events.
+    void remove(
+        const Node* node,
+        const Message* msg,
+        std::vector<Message*>& removed);
+
+private:
+    struct HeapNode
+    {
+        SchedulerStlEvent event;
+        HeapNode* child;        // first child
+        HeapNode* sibling;      // next sibling, or next free node
+    };
+
+    HeapNode* m_root;
+    size_t    m_size;
+
+    HeapNode* m_freeList;
+    std::vector<HeapNode*> m_blocks;
+
+    // Scratch space for pop
+    std::vector<HeapNode*> m_pairs;
+
+    HeapNode* allocNode(const SchedulerStlEvent& event);
+    void freeNode(HeapNode* heapNode);
+    static HeapNode* meld(HeapNode* a, HeapNode* b);
+
+    // Not copyable
+    PairingHeap(const PairingHeap&);
+    PairingHeap& operator=(const PairingHeap&);
+};
+
+
+//------------------------------------------------------------------
+
+/// Insert a message into the node's message queue
+///
+/// \param node  Pointer to the node to insert into
+/// \param msg  Pointer to the message to insert
+/// \param time  time to delay
+void SCHED_PAIRINGHEAP_InsertMessage(
+    Node *node,
+    Message *msg,
+    clocktype delay);
+
+
+/// Remove the first message from the node's message queue
+///
+/// \param partitionData  Pointer to the partition data
+/// \param node  Pointer to the node
+///    to be extracted
+///
+/// \return First message from queue
+Message* SCHED_PAIRINGHEAP_ExtractFirstMessage(
+    PartitionData *partitionData,
+    Node *node);
+
+
+/// Peek at the first message from the node's message queue
+/// NOT REMOVED FROM QUEUE
+///
+/// \param node  Pointer to the node
+///
+/// \return Pointer to message
+Message* SCHED_PAIRINGHEAP_PeekFirstMessage(
+    Node *node);
+
+
+/// Delete a message from the nodes's message queue.  The message is
+/// not freed.
+///
+/// \param node  Pointer to the node
+///    to delete message from
+/// \param msg  Pointer to the message
+void SCHED_PAIRINGHEAP_DeleteMessage(
+    Node *node,
+    Message *msg);
+
+
+/// Insert a node into the partition's scheduler queue
+///
+/// \param partitionData  Pointer to the partition
+///    to be inserted
+/// \param node  Pointer to the node
+void SCHED_PAIRINGHEAP_InsertNode(
+    PartitionData *partitionData,
+    Node *node);
+
+
+/// Peek at next node to process in the partition's scheduler queue
+///
+/// \param partitionData  Pointer to the node
+///    to be inserted
+///
+/// \return next node to process
+Node* SCHED_PAIRINGHEAP_PeekNextNode(
+    PartitionData *partitionData);
+
+
+/// Delete a node from the partition's scheduler queue.  All events
+/// are kept in the one partition queue, so this removes and frees the
+/// node's pending messages.
+///
+/// \param partitionData  Pointer to the node
+///    to be inserted
+/// \param node  Pointer to the node
+void SCHED_PAIRINGHEAP_DeleteNode(
+    PartitionData *partitionData,
+    Node *node);
+
+
+/// Current node from the partition's scheduler queue
+///
+/// \param partitionData  Pointer to the node
+///    to be inserted
+Node* SCHED_PAIRINGHEAP_CurrentNode(
+    const PartitionData *partitionData);
+
+
+/// Check for nodes in the scheduler's node queue.
+///
+/// \param partitionData  Pointer to the partition data
+///
+/// \return scheduler has nodes in it's queue
+BOOL SCHED_PAIRINGHEAP_HasNodes(
+    const PartitionData *partitionData);
+
+
+/// Get the next event for this partition
+///
+/// \param partitionData  Pointer to the partition data
+/// \param node  Pointer to the node
+///
+/// \return next event
+Message* SCHED_PAIRINGHEAP_NextEvent(
+    PartitionData *partitionData,
+    Node* node);
+
+
+/// Get the next event time for this partition
+///
+/// \param partitionData  Pointer to the partition data
+///
+/// \return time of next event
+clocktype SCHED_PAIRINGHEAP_NextEventTime(
+    const PartitionData *partitionData);
+
+
+/// Initalize Scheduler
+///
+/// \param partitionData  Pointer to the partition data
+void SCHED_PAIRINGHEAP_Initialize(
+    PartitionData *partitionData);
+
+
+/// Finalize Scheduler
+///
+/// \param partitionData  Pointer to the partition data
+void SCHED_PAIRINGHEAP_Finalize(
+    PartitionData *partitionData);
+
+
+/// Replaces the queue that SCHED_Initialize set up in the partition's
+/// SchedulerInfo with a pairing heap.  Called after SCHED_Initialize
+/// when SCHEDULER-QUEUE-TYPE is PAIRING-HEAP, before any event is
+/// scheduled.
+///
+/// \param partitionData  Pointer to the partition data
+void SCHED_PAIRINGHEAP_Setup(
+    PartitionData *partitionData);
+
+#endif /* SCHED_PAIRING_HEAP_H */
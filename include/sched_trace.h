@@ -0,0 +1,89 @@
+// Copyright (c) 2001-2015, SCALABLE Network Technologies, Inc.  All Rights Reserved.
+//                          600 Corporate Pointe
+//                          Suite 1200
+//                          Culver City, CA 90230
+//                          info@scalable-networks.com
+//
+// This source code is licensed, not sold, and is subject to a written
+// license agreement.  Among other things, no portion of this source
+// code may be copied, transmitted, disclosed, displayed, distributed,
+// translated, used as the basis for a derivative work, or used, in
+// whole or in part, for any program or purpose other than its intended
+// use in compliance with the license agreement as part of the QualNet
+// software.  This source code and certain of the algorithms contained
+// within it are confidential trade secrets of Scalable Network
+// Technologies, Inc. and may not be used as the basis for any other
+// software, hardware, product or service.
+
+/*
+ * PURPOSE: Recording of the scheduler call stream, for replay by the
+ *          sched_bench utility
+ */
+
+#ifndef SCHED_TRACE_H
+#define SCHED_TRACE_H
+
+#include <vector>
+
+#include "scheduler_types.h"
+
+/// File signature, followed by a version byte
+#define SCHED_TRACE_MAGIC       "QSCHTRC"
+#define SCHED_TRACE_VERSION     2
+
+/// Scheduler calls recorded in a trace.  DeleteMessage, InsertNode,
+/// PeekNextNode and DeleteNode are passed through without being
+/// recorded.
+enum SchedTraceOp
+{
+    SCHED_TRACE_INSERT_MESSAGE = 1,
+    SCHED_TRACE_EXTRACT_FIRST_MESSAGE,
+    SCHED_TRACE_PEEK_FIRST_MESSAGE,
+    SCHED_TRACE_CURRENT_NODE,
+    SCHED_TRACE_HAS_NODES,
+    SCHED_TRACE_NEXT_EVENT,
+    SCHED_TRACE_NEXT_EVENT_TIME
+};
+
+/// One decoded trace record.  Fields that do not apply to the
+/// operation are 0.
+struct SchedTraceRecord
+{
+    UInt8     op;
+    UInt8     layerType;
+    UInt16    instanceId;
+    Int32     eventType;
+    Int32     nodeIndex;    // -1 if the call took no node
+    UInt32    originatingNodeId;
+    clocktype simTime;      // partition time when the call was made
+    clocktype delay;        // INSERT_MESSAGE only
+};
+
+/// Starts recording every scheduler call on the partition to
+/// fileName.  Must be called after the scheduler is initialized; the
+/// file is closed by SCHED_Finalize.
+///
+/// Records are a one byte operation followed by LEB128 varints: the
+/// change in simulation time since the previous record (zigzag
+/// encoded), the node index plus one (0 for none) where the call takes
+/// a node, and for inserts the delay, layer, event type, instance and
+/// originating node.
+///
+/// \param partitionData  Pointer to the partition data
+/// \param fileName  trace file to create
+void SCHED_TRACE_Start(
+    PartitionData *partitionData,
+    const char *fileName);
+
+/// Reads a whole trace file.
+///
+/// \param fileName  trace file written by SCHED_TRACE_Start
+/// \param records  receives the decoded records
+///
+/// \return TRUE on success, FALSE if the file cannot be read or is
+///         not a trace
+BOOL SCHED_TRACE_Load(
+    const char *fileName,
+    std::vector<SchedTraceRecord>& records);
+
+#endif /* SCHED_TRACE_H */
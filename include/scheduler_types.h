@@ -133,7 +133,8 @@ typedef enum {
     // CALENDAR_QUEUE,     // NO LONGER USED
     LADDER_QUEUE,
     STDLIB_HEAP,
-    CALENDAR_QUEUE2
+    CALENDAR_QUEUE2,
+    PAIRING_HEAP
 } SchedulerQueueType;
 
 class CalendarQ;
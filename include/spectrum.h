@@ -46,7 +46,7 @@ class spectralBand
     friend class spectrum;
 
 protected:
-    spectralBand(const std::string& name = "Unspecified") : m_name(name) { }
+    spectralBand(const std::string& name = "Unspecified") : m_name(name), m_bandId(-1) { }
     virtual ~spectralBand();
 public:
 
@@ -58,6 +58,10 @@ public:
     virtual double getBandwidth() const = 0;  ///< \pure  \brief bandwidth
     int getQualnetChannel() const {return m_radioOverlayID;}
 
+    /// \brief index of the band in its spectrum's overlap table, or -1
+    /// if the band was not made by a spectrum.
+    int getBandId() const {return m_bandId;}
+
     std::ostream& fmt(const char* tag, std::ostream& os) const;
     virtual std::ostream& fmt(std::ostream& os) const;
 
@@ -164,6 +168,7 @@ public:
     std::string m_name;
     int m_spectrumIndex;
     int m_radioOverlayID;
+    int m_bandId;
 
 public:
     DECLARE_SERIALIZE_SUPPORT;
@@ -305,6 +310,7 @@ public:
        elements[idx] = new spectralBand_Square(frequency, bw, name);
        elements[idx]->m_radioOverlayID = radioOverlayID;
        elements[idx]->m_spectrumIndex = idx;
+       addBand(elements[idx]);
       }
       return elements[idx];
     }
@@ -330,6 +336,7 @@ public:
       elements[idx] = new spectralBand_Square(frequency, bw, name);
       elements[idx]->m_radioOverlayID = 0;
       elements[idx]->m_spectrumIndex = idx;
+      addBand(elements[idx]);
     }
 #ifdef DEBUG
     cout << idx << endl;
@@ -366,13 +373,45 @@ public:
     return ix*spectralBand::CHBWDTH_MAX + ib; 
   }
 
+  /*
+    double overlapFraction(const spectralBand* band, const spectralBand* signalBand)
+      fraction of the power of a signal on signalBand that falls in band,
+      band->convolve(signalBand) / signalBand->getBandwidth().  Bands made
+      by this spectrum are looked up in a table filled as they are made;
+      other bands, such as pairs or bands of another partition, are
+      computed.
+   */
+  double overlapFraction(const spectralBand* band, const spectralBand* signalBand) const
+  {
+    int i = band->getBandId();
+    int j = signalBand->getBandId();
+
+    if (i >= 0 && j >= 0 && 
+        (size_t)i < m_bands.size() && (size_t)j < m_bands.size() &&
+        m_bands[i] == band && m_bands[j] == signalBand)
+    {
+      return m_overlap[i][j];
+    }
+    return band->convolve(signalBand) / signalBand->getBandwidth();
+  }
+
   std::ostream& fmt(std::ostream& os) const;
 private:
+  // gives a new band its id and its row and column of m_overlap
+  void addBand(spectralBand* b);
+
   // a vector of vectors to represent the radioOverlayID and the spectral band
   // it will be a rather sparse matrix with often only one element for radioOverlayID
   // As there is only one of these the memory use is inconsiquential but the rapid
   // access from using an array is important.
   std::vector<std::vector<spectralBand*> > m_elements;
+
+  // all the bands made, by band id
+  std::vector<spectralBand*> m_bands;
+
+  // m_overlap[i][j] is the overlapFraction of band i with signal band j.
+  // Only a few dozen bands are ever made, so the table stays small.
+  std::vector<std::vector<double> > m_overlap;
 };
 inline std::ostream& operator<<(std::ostream& os, const spectralBand* b) {return b->fmt(b->typeName(), os);}
 
@@ -40,6 +40,7 @@
 class PathSegment;
 class TerrainRegion;
 class TerrainData;
+struct TerrainProfileCache;
 struct PartitionData;
 
 using namespace std;
@@ -506,6 +507,22 @@ public:
     void print();
 };
 
+/// \brief Elevation grid of one tile (DEM or DTED file), as read by
+/// ElevationTerrainData::getElevationArray.
+///
+/// Line i runs from south to north along a longitude, the lines going
+/// from west to east; resolution is the spacing in arc seconds between
+/// the lines and between the samples of a line.  Line i has
+/// lineLengths[i] samples.
+struct ElevationProfileTile {
+    Coordinates         southWestCorner;
+    Coordinates         northEastCorner;
+    double              resolution[2];
+    int                 numLines;
+    const short* const* lines;
+    const int*          lineLengths;
+};
+
 /// ElevationTerrainData is a base class for elevation data formats such
 //  as DTED or DEM.
 class ElevationTerrainData {
@@ -546,6 +563,20 @@ public:
                                   double             elevationArray[],
                                   const int          maxSamples = MAX_NUM_ELEVATION_SAMPLES);
 
+    /// Get the grid of the tile holding a point, for formats whose
+    /// elevations are interpolated from a grid the way DEM and DTED are.
+    /// The samples of a profile in that tile are then interpolated
+    /// together instead of through getElevationAt.
+    ///
+    /// \param point  Point in the tile
+    /// \param tile  Receives the grid of the tile
+    ///
+    /// \return false if the format has no grid or no tile holds the point
+    virtual bool getProfileTile(const Coordinates*, ElevationProfileTile*)
+    {
+        return false;
+    }
+
     virtual void getElevationBoundaries(int, Coordinates* sw, Coordinates* ne)
     {
         sw->common.c1 = -1.0;
@@ -640,6 +671,7 @@ private:
 
 
     void initializeRegions(NodeInput* nodeInput);
+    void initializeProfileCache(NodeInput* nodeInput);
     void calculateNE();
     void calculateDimensions();
 
@@ -648,6 +680,13 @@ public:
     ElevationTerrainData* m_elevationData;
     UrbanTerrainData*     m_urbanData;
 
+private:
+    // Elevation profiles of recent paths, NULL unless
+    // TERRAIN-PROFILE-CACHE is YES.  Kept after the public members so
+    // that their offsets do not change.
+    TerrainProfileCache* m_profileCache;
+
+public:
     TerrainData() {
         m_useRegions    = false;
         m_gridRows      = 1;
@@ -655,6 +694,7 @@ public:
         m_elevationData = NULL;
         m_urbanData     = NULL;
         m_regions       = NULL;
+        m_profileCache  = NULL;
     }
     ~TerrainData() {} // cleanup performed in finalize.
 
@@ -690,11 +730,7 @@ public:
                           const Coordinates* c2,
                           double             distance,
                           double             samplingDistance,
-                          double             elevationArray[]) {
-        return m_elevationData->getElevationArray(c1, c2, distance,
-                                                  samplingDistance,
-                                                  elevationArray);
-    }
+                          double             elevationArray[]);
 
     bool isPositionIndoors(const Coordinates* c);
 
@@ -0,0 +1,100 @@
+// Copyright (c) 2001-2015, SCALABLE Network Technologies, Inc.  All Rights Reserved.
+//                          600 Corporate Pointe
+//                          Suite 1200
+//                          Culver City, CA 90230
+//                          info@scalable-networks.com
+//
+// This source code is licensed, not sold, and is subject to a written
+// license agreement.  Among other things, no portion of this source
+// code may be copied, transmitted, disclosed, displayed, distributed,
+// translated, used as the basis for a derivative work, or used, in
+// whole or in part, for any program or purpose other than its intended
+// use in compliance with the license agreement as part of the QualNet
+// software.  This source code and certain of the algorithms contained
+// within it are confidential trade secrets of Scalable Network
+// Technologies, Inc. and may not be used as the basis for any other
+// software, hardware, product or service.
+
+#ifndef TERRAIN_PROFILE_CACHE_H
+#define TERRAIN_PROFILE_CACHE_H
+
+/// \file This file defines the types needed to use the template Cache
+/// class to keep the elevation profiles of paths, indexed by their
+/// endpoints.
+
+#include <vector>
+#include <boost/functional/hash.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include "Cache.h"
+#include "qualnet_mutex.h"
+
+/// Number of profiles kept by default
+#define TERRAIN_PROFILE_CACHE_DEFAULT_SIZE  4096
+
+/// \brief Key value for the profile cache
+///
+/// The endpoints are in the order the profile is sampled, from the one
+/// with the larger latitude (or y), then longitude (or x), so that both
+/// directions of a link share a profile.  getElevationArray samples
+/// from its first endpoint when the latitudes are equal, so that
+/// direction gets the profile reversed.  The endpoints are quantized to
+/// the cache resolution; with a resolution of 0 they are kept exactly
+/// and a cached profile is the one getElevationArray would return.
+struct TerrainProfileKey
+{
+    double start[2];
+    double end[2];
+    double samplingDistance;
+    int    numSamples;
+};
+
+/// \brief Equality operator for TerrainProfileKey
+///
+/// This definition allows the use of std::equal_to for testing equality.
+inline bool operator==(const TerrainProfileKey& lhs,
+                       const TerrainProfileKey& rhs)
+{
+    return lhs.start[0] == rhs.start[0] &&
+           lhs.start[1] == rhs.start[1] &&
+           lhs.end[0] == rhs.end[0] &&
+           lhs.end[1] == rhs.end[1] &&
+           lhs.samplingDistance == rhs.samplingDistance &&
+           lhs.numSamples == rhs.numSamples;
+}
+
+/// \brief Hasher class for TerrainProfileKey
+struct HashTerrainProfileKey {
+    size_t operator()(const TerrainProfileKey& v) const
+    {
+        size_t seed = 0;
+        boost::hash_combine(seed, v.start[0]);
+        boost::hash_combine(seed, v.start[1]);
+        boost::hash_combine(seed, v.end[0]);
+        boost::hash_combine(seed, v.end[1]);
+        boost::hash_combine(seed, v.numSamples);
+        return seed;
+    }
+};
+
+/// Elevations of a profile, numSamples + 1 of them
+typedef boost::shared_ptr<const std::vector<double> > TerrainProfilePointer;
+
+typedef
+Cache<TerrainProfileKey, TerrainProfilePointer, HashTerrainProfileKey>
+TerrainProfileCacheMap;
+
+/// Profile cache of the terrain data, which the partitions share.  The
+/// counts and entries are used under the mutex.
+struct TerrainProfileCache
+{
+    double                 resolution;  // endpoint quantization, 0 if exact
+    UInt64                 numHits;
+    UInt64                 numMisses;
+    TerrainProfileCacheMap entries;
+    QNThreadMutex          mutex;
+
+    TerrainProfileCache(size_t maxEntries) : entries(maxEntries) {}
+};
+
+#endif /*TERRAIN_PROFILE_CACHE_H*/
@@ -5,6 +5,8 @@
 #include <stdexcept>
 #include <iostream>
 #include <complex>
+#include <algorithm>
+#include <cmath>
 
 /** @defgroup PackageMiniMatrix  MiniMatrix
  *  A Matrix template class family used for matrix caculations for small matrixes
@@ -229,9 +231,23 @@ class MiniMatrix
     MiniMatrix operator-(const MiniMatrix& rightMatrix) const;
     MiniMatrix operator/(const T& scalar) const;
     MiniMatrix Transpose() const;
+
+    /** Determinant(), Inverse()
+     *  Closed forms up to 4x4, LU decomposition with partial pivoting
+     *  above.  Inverse() throws std::overflow_error for a singular
+     *  matrix.
+     */
     T          Determinant() const;
     MiniMatrix Inverse() const;
 
+    /** CofactorDeterminant(), CofactorInverse()
+     *  The cofactor expansions Determinant() and Inverse() used before,
+     *  whose cost grows factorially with the size; kept as the reference
+     *  for mini_matrix_bench
+     */
+    T          CofactorDeterminant() const;
+    MiniMatrix CofactorInverse() const;
+
     std::size_t Rows() const { return m_Rows; }
     std::size_t Cols() const { return m_Cols; }
     bool isSquare() const { return m_Rows == m_Cols; }
@@ -266,6 +282,25 @@ class MiniMatrix
      */
     MiniMatrix Adjoint() const;
 
+    /** Inverse2(), Inverse3(), Inverse4()
+     *  Closed form inverses from the 2x2 sub-determinants
+     */
+    MiniMatrix Inverse2() const;
+    MiniMatrix Inverse3() const;
+    MiniMatrix Inverse4() const;
+
+    /** DecomposeLU()
+     *  Writes the LU decomposition of the rows permuted by pivot into lu,
+     *  L below the diagonal with unit diagonal and U above.  Returns
+     *  false if a pivot is zero.  sign is the sign of the permutation.
+     */
+    bool DecomposeLU(T* lu, std::size_t* pivot, int* sign) const;
+
+    /** InverseLU()
+     *  Inverse from the LU decomposition, one column at a time
+     */
+    MiniMatrix InverseLU() const;
+
 };
 
 typedef MiniVector<std::complex<double> >  CplxMiniVector;
@@ -449,22 +484,73 @@ T MiniMatrix<T>::Determinant() const
     }
     else
     {
-        determinant = static_cast<T>(0);
-        for (int j = 0; j < m_Cols; j++)
+        T lu[MAX_SIZE*MAX_SIZE];
+        std::size_t pivot[MAX_SIZE];
+        int sign;
+
+        if (!this->DecomposeLU(lu, pivot, &sign))
         {
-            T detM = this->Minor(0, j).Determinant();
-            if (j&1)        //i == 0; check whether i+j is odd
-            {
-                detM = -detM;
-            }
-            determinant += detM*m_Pdata[j];
+            return static_cast<T>(0);
+        }
+        determinant = static_cast<T>(sign);
+        for (std::size_t i = 0; i < m_Rows; i++)
+        {
+            determinant *= lu[i*m_Cols + i];
+        }
+    }
+    return determinant;
+}
+
+template<typename T>
+T MiniMatrix<T>::CofactorDeterminant() const
+{
+    if (!this->isSquare())
+    {
+        throw std::domain_error("Not applicable operation!");
+    }
+    if (m_Rows <= 3)
+    {
+        return this->Determinant();
+    }
+
+    T determinant = static_cast<T>(0);
+    for (std::size_t j = 0; j < m_Cols; j++)
+    {
+        T detM = this->Minor(0, j).CofactorDeterminant();
+        if (j&1)        //i == 0; check whether i+j is odd
+        {
+            detM = -detM;
         }
+        determinant += detM*m_Pdata[j];
     }
     return determinant;
 }
 
 template<typename T>
 MiniMatrix<T> MiniMatrix<T>::Inverse() const
+{
+    if (!this->isSquare())
+    {
+        throw std::domain_error("Not applicable operation!");
+    }
+
+    switch (m_Rows)
+    {
+        case 1:
+            throw std::domain_error("Not applicable operation!");
+        case 2:
+            return this->Inverse2();
+        case 3:
+            return this->Inverse3();
+        case 4:
+            return this->Inverse4();
+        default:
+            return this->InverseLU();
+    }
+}
+
+template<typename T>
+MiniMatrix<T> MiniMatrix<T>::CofactorInverse() const
 {
     if (!this->isSquare())
     {
@@ -474,7 +560,7 @@ MiniMatrix<T> MiniMatrix<T>::Inverse() const
     {
         throw std::domain_error("Not applicable operation!");
     }
-    T determinant = this->Determinant();
+    T determinant = this->CofactorDeterminant();
     //TODO: Test zero with relative comparison
     if (determinant == static_cast<T>(0))
     {
@@ -485,6 +571,218 @@ MiniMatrix<T> MiniMatrix<T>::Inverse() const
     return inverseMatrix;
 }
 
+template<typename T>
+MiniMatrix<T> MiniMatrix<T>::Inverse2() const
+{
+    const T* a = m_Pdata;
+    T determinant = a[0]*a[3] - a[1]*a[2];
+
+    if (determinant == static_cast<T>(0))
+    {
+        throw std::overflow_error("Matrix is not inversible!");
+    }
+
+    T scale = static_cast<T>(1) / determinant;
+    MiniMatrix<T> inverseMatrix(2, 2);
+    T* b = inverseMatrix.m_Pdata;
+
+    b[0] = a[3]*scale;
+    b[1] = -a[1]*scale;
+    b[2] = -a[2]*scale;
+    b[3] = a[0]*scale;
+    return inverseMatrix;
+}
+
+template<typename T>
+MiniMatrix<T> MiniMatrix<T>::Inverse3() const
+{
+    const T* a = m_Pdata;
+
+    // Cofactors of the first row
+    T c0 = a[4]*a[8] - a[5]*a[7];
+    T c1 = a[5]*a[6] - a[3]*a[8];
+    T c2 = a[3]*a[7] - a[4]*a[6];
+    T determinant = a[0]*c0 + a[1]*c1 + a[2]*c2;
+
+    if (determinant == static_cast<T>(0))
+    {
+        throw std::overflow_error("Matrix is not inversible!");
+    }
+
+    T scale = static_cast<T>(1) / determinant;
+    MiniMatrix<T> inverseMatrix(3, 3);
+    T* b = inverseMatrix.m_Pdata;
+
+    b[0] = c0*scale;
+    b[1] = (a[2]*a[7] - a[1]*a[8])*scale;
+    b[2] = (a[1]*a[5] - a[2]*a[4])*scale;
+    b[3] = c1*scale;
+    b[4] = (a[0]*a[8] - a[2]*a[6])*scale;
+    b[5] = (a[2]*a[3] - a[0]*a[5])*scale;
+    b[6] = c2*scale;
+    b[7] = (a[1]*a[6] - a[0]*a[7])*scale;
+    b[8] = (a[0]*a[4] - a[1]*a[3])*scale;
+    return inverseMatrix;
+}
+
+template<typename T>
+MiniMatrix<T> MiniMatrix<T>::Inverse4() const
+{
+    const T* a = m_Pdata;
+
+    // 2x2 sub-determinants of the first two rows (s) and the last two (c)
+    T s0 = a[0]*a[5] - a[4]*a[1];
+    T s1 = a[0]*a[6] - a[4]*a[2];
+    T s2 = a[0]*a[7] - a[4]*a[3];
+    T s3 = a[1]*a[6] - a[5]*a[2];
+    T s4 = a[1]*a[7] - a[5]*a[3];
+    T s5 = a[2]*a[7] - a[6]*a[3];
+
+    T c5 = a[10]*a[15] - a[14]*a[11];
+    T c4 = a[9]*a[15] - a[13]*a[11];
+    T c3 = a[9]*a[14] - a[13]*a[10];
+    T c2 = a[8]*a[15] - a[12]*a[11];
+    T c1 = a[8]*a[14] - a[12]*a[10];
+    T c0 = a[8]*a[13] - a[12]*a[9];
+
+    T determinant = s0*c5 - s1*c4 + s2*c3 + s3*c2 - s4*c1 + s5*c0;
+
+    if (determinant == static_cast<T>(0))
+    {
+        throw std::overflow_error("Matrix is not inversible!");
+    }
+
+    T scale = static_cast<T>(1) / determinant;
+    MiniMatrix<T> inverseMatrix(4, 4);
+    T* b = inverseMatrix.m_Pdata;
+
+    b[0]  = ( a[5]*c5 - a[6]*c4 + a[7]*c3)*scale;
+    b[1]  = (-a[1]*c5 + a[2]*c4 - a[3]*c3)*scale;
+    b[2]  = ( a[13]*s5 - a[14]*s4 + a[15]*s3)*scale;
+    b[3]  = (-a[9]*s5 + a[10]*s4 - a[11]*s3)*scale;
+
+    b[4]  = (-a[4]*c5 + a[6]*c2 - a[7]*c1)*scale;
+    b[5]  = ( a[0]*c5 - a[2]*c2 + a[3]*c1)*scale;
+    b[6]  = (-a[12]*s5 + a[14]*s2 - a[15]*s1)*scale;
+    b[7]  = ( a[8]*s5 - a[10]*s2 + a[11]*s1)*scale;
+
+    b[8]  = ( a[4]*c4 - a[5]*c2 + a[7]*c0)*scale;
+    b[9]  = (-a[0]*c4 + a[1]*c2 - a[3]*c0)*scale;
+    b[10] = ( a[12]*s4 - a[13]*s2 + a[15]*s0)*scale;
+    b[11] = (-a[8]*s4 + a[9]*s2 - a[11]*s0)*scale;
+
+    b[12] = (-a[4]*c3 + a[5]*c1 - a[6]*c0)*scale;
+    b[13] = ( a[0]*c3 - a[1]*c1 + a[2]*c0)*scale;
+    b[14] = (-a[12]*s3 + a[13]*s1 - a[14]*s0)*scale;
+    b[15] = ( a[8]*s3 - a[9]*s1 + a[10]*s0)*scale;
+    return inverseMatrix;
+}
+
+template<typename T>
+bool MiniMatrix<T>::DecomposeLU(T* lu, std::size_t* pivot, int* sign) const
+{
+    std::size_t n = m_Rows;
+
+    for (std::size_t i = 0; i < n*n; i++)
+    {
+        lu[i] = m_Pdata[i];
+    }
+    for (std::size_t i = 0; i < n; i++)
+    {
+        pivot[i] = i;
+    }
+    *sign = 1;
+
+    for (std::size_t k = 0; k < n; k++)
+    {
+        // Largest magnitude in the column at or below the diagonal
+        std::size_t p = k;
+        double largest = std::abs(lu[k*n + k]);
+        for (std::size_t i = k + 1; i < n; i++)
+        {
+            double magnitude = std::abs(lu[i*n + k]);
+            if (magnitude > largest)
+            {
+                largest = magnitude;
+                p = i;
+            }
+        }
+        if (largest == 0.0)
+        {
+            return false;
+        }
+
+        if (p != k)
+        {
+            for (std::size_t j = 0; j < n; j++)
+            {
+                std::swap(lu[k*n + j], lu[p*n + j]);
+            }
+            std::swap(pivot[k], pivot[p]);
+            *sign = -*sign;
+        }
+
+        // The rows are contiguous, so the updates run over whole rows
+        T scale = static_cast<T>(1) / lu[k*n + k];
+        for (std::size_t i = k + 1; i < n; i++)
+        {
+            T factor = lu[i*n + k] * scale;
+            lu[i*n + k] = factor;
+            for (std::size_t j = k + 1; j < n; j++)
+            {
+                lu[i*n + j] -= factor * lu[k*n + j];
+            }
+        }
+    }
+    return true;
+}
+
+template<typename T>
+MiniMatrix<T> MiniMatrix<T>::InverseLU() const
+{
+    T lu[MAX_SIZE*MAX_SIZE];
+    std::size_t pivot[MAX_SIZE];
+    int sign;
+    std::size_t n = m_Rows;
+
+    if (!this->DecomposeLU(lu, pivot, &sign))
+    {
+        throw std::overflow_error("Matrix is not inversible!");
+    }
+
+    MiniMatrix<T> inverseMatrix(n, n);
+    T* b = inverseMatrix.m_Pdata;
+    T column[MAX_SIZE];
+
+    for (std::size_t j = 0; j < n; j++)
+    {
+        // L y = P e_j, then U x = y
+        for (std::size_t i = 0; i < n; i++)
+        {
+            T sum = (pivot[i] == j) ? static_cast<T>(1) : static_cast<T>(0);
+            for (std::size_t k = 0; k < i; k++)
+            {
+                sum -= lu[i*n + k] * column[k];
+            }
+            column[i] = sum;
+        }
+        for (std::size_t i = n; i-- > 0; )
+        {
+            T sum = column[i];
+            for (std::size_t k = i + 1; k < n; k++)
+            {
+                sum -= lu[i*n + k] * column[k];
+            }
+            column[i] = sum / lu[i*n + i];
+        }
+        for (std::size_t i = 0; i < n; i++)
+        {
+            b[i*n + j] = column[i];
+        }
+    }
+    return inverseMatrix;
+}
+
 template<typename T>
 void MiniMatrix<T>::Clone(const MiniMatrix<T>& matrix)
 {
@@ -538,7 +836,7 @@ MiniMatrix<T> MiniMatrix<T>::Adjoint() const
     {
         for (int j = 0; j < m_Rows; j++)
         {
-            adjoint(j, i) = this->Minor(i, j).Determinant();
+            adjoint(j, i) = this->Minor(i, j).CofactorDeterminant();
             //if (i+j) is odd, then negative
             if ((i+j)&1)
             {
@@ -723,7 +723,7 @@ void PhyDot16CheckBurstError(Node* node,
         sinr =  signalPower / (interferencePower + noisePower_mW);
         ofdmaBurst->cinr = sinr;
 
-        BER = PHY_BER(phyDot16->thisPhy, ofdmaBurst->modCodeType, sinr);
+        BER = PHY_GridBER(phyDot16->thisPhy, ofdmaBurst->modCodeType, sinr);
 
         if (DEBUG_SNR )
         {
@@ -77,7 +77,7 @@ BOOL PhyGsmCheckRxPacketError(
     sinr = (phyGsm->rxMsgPower_mW /
                (phyGsm->interferencePower_mW + noise));
 
-    BER = PHY_BER(phyGsm->thisPhy, 0,/* ber table index */
+    BER = PHY_GridBER(phyGsm->thisPhy, 0,/* ber table index */
             sinr);
 
     if (BER != 0.0) {
@@ -258,6 +258,13 @@ void NetworkIpLoopbackForwardingTableInit(Node *node)
     ip->loopbackFwdTable.size = 0;
     ip->loopbackFwdTable.allocatedSize = 0;
     ip->loopbackFwdTable.row = NULL;
+    ip->loopbackFwdTable.prefixLengths = 0;
+    ip->loopbackFwdTable.version = 0;
+    ip->loopbackFwdTable.cache = NULL;
+    ip->loopbackFwdTable.updateInProgress = FALSE;
+    ip->loopbackFwdTable.numPending = 0;
+    ip->loopbackFwdTable.allocatedPending = 0;
+    ip->loopbackFwdTable.pending = NULL;
 }
 
 
@@ -28,6 +28,8 @@
 #include <string.h>
 #include <math.h>
 
+#include <algorithm>
+
 #include "api.h"
 #include "partition.h"
 #include "adaptation_aal5.h"
@@ -9521,6 +9523,242 @@ ReturnPriorityForPHB(
 // Routing table (forwarding table)
 //-----------------------------------------------------------------------------
 
+// Rows a lookup accepts besides having a next hop on an enabled interface
+typedef
+struct
+{
+    BOOL matchInterface;    // accept only rows on interfaceIndex
+    int interfaceIndex;
+    BOOL matchType;         // accept only rows selected by testType
+    BOOL testType;          // TRUE for rows of type, FALSE for the others
+    NetworkRoutingProtocolType type;
+}
+NetworkForwardingFilter;
+
+//-----------------------------------------------------------------------------
+// FUNCTION     NetworkForwardingTablePrefixLength()
+// PURPOSE      Get the prefix length of a subnet mask.
+// PARAMETERS   NodeAddress mask
+//                  Subnet mask.
+// RETURN       Number of leading one bits of the mask, or
+//              FORWARDING_TABLE_IRREGULAR_MASK if the mask has ones
+//              after its first zero.
+//-----------------------------------------------------------------------------
+
+static int
+NetworkForwardingTablePrefixLength(NodeAddress mask)
+{
+    int length = 0;
+
+    while (length < 32 && (mask & (0x80000000U >> length)) != 0)
+    {
+        length++;
+    }
+
+    if (mask != ConvertNumHostBitsToSubnetMask(32 - length))
+    {
+        return FORWARDING_TABLE_IRREGULAR_MASK;
+    }
+
+    return length;
+}
+
+//-----------------------------------------------------------------------------
+// FUNCTION     NetworkForwardingTableRowAccepted()
+// PURPOSE      Check whether a lookup may use a row matching its
+//              destination.
+// PARAMETERS   const NetworkForwardingTableRow *row
+//                  Row to check.
+//              const NetworkForwardingFilter *filter
+//                  Rows accepted by the lookup.
+// RETURN       TRUE if the lookup may use the row.
+//-----------------------------------------------------------------------------
+
+static BOOL
+NetworkForwardingTableRowAccepted(
+    const NetworkForwardingTableRow *row,
+    const NetworkForwardingFilter *filter)
+{
+    if (row->nextHopAddress == (unsigned) NETWORK_UNREACHABLE
+        || row->interfaceIsEnabled == FALSE)
+    {
+        return FALSE;
+    }
+
+    if (filter->matchInterface
+        && row->interfaceIndex != filter->interfaceIndex)
+    {
+        return FALSE;
+    }
+
+    if (filter->matchType)
+    {
+        if (filter->testType == TRUE)
+        {
+            return row->protocolType == filter->type;
+        }
+        if (filter->testType == FALSE)
+        {
+            return row->protocolType != filter->type;
+        }
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+//-----------------------------------------------------------------------------
+// FUNCTION     NetworkForwardingTableFind()
+// PURPOSE      Find the first row, in table order, that matches a
+//              destination and is accepted by a filter.
+// PARAMETERS   const NetworkForwardingTable *forwardTable
+//                  Table to search.
+//              NodeAddress destinationAddress
+//                  Destination IP address.
+//              const NetworkForwardingFilter *filter
+//                  Rows accepted.
+// RETURN       Index of the row, or -1 if there is none.
+//
+// NOTES        The rows are sorted by destination and mask descending, so
+//              the matching rows come in prefix length order, longest
+//              first, and the rows of a prefix are contiguous.  Each
+//              prefix length in use is binary searched, which finds the
+//              same row as a scan of the table.  Tables with a mask that
+//              is not a prefix are scanned.
+//
+//              A lookup costs at most one binary search per prefix
+//              length in use, 33 * log2(size) row compares, plus the
+//              rows of a matching prefix that the filter rejects.  The
+//              sorted rows stay the only copy of the table, rather than
+//              a trie, because routing protocols and mac.cpp change
+//              rows in place.
+//-----------------------------------------------------------------------------
+
+static int
+NetworkForwardingTableFind(
+    const NetworkForwardingTable *forwardTable,
+    NodeAddress destinationAddress,
+    const NetworkForwardingFilter *filter)
+{
+    const NetworkForwardingTableRow *row = forwardTable->row;
+    int length;
+    int i;
+
+    if (forwardTable->prefixLengths
+        & ((UInt64) 1 << FORWARDING_TABLE_IRREGULAR_MASK))
+    {
+        for (i = 0; i < forwardTable->size; i++)
+        {
+            NodeAddress maskedDestinationAddress =
+                MaskIpAddress(destinationAddress, row[i].destAddressMask);
+
+            if (row[i].destAddress == maskedDestinationAddress
+                && NetworkForwardingTableRowAccepted(&row[i], filter))
+            {
+                return i;
+            }
+        }
+        return -1;
+    }
+
+    for (length = 32; length >= 0; length--)
+    {
+        if ((forwardTable->prefixLengths & ((UInt64) 1 << length)) == 0)
+        {
+            continue;
+        }
+
+        NodeAddress mask = ConvertNumHostBitsToSubnetMask(32 - length);
+        NodeAddress prefix = MaskIpAddress(destinationAddress, mask);
+        int low = 0;
+        int high = forwardTable->size;
+
+        // first row not sorted before the prefix
+        while (low < high)
+        {
+            int middle = low + (high - low) / 2;
+
+            if (row[middle].destAddress > prefix
+                || (row[middle].destAddress == prefix
+                    && row[middle].destAddressMask > mask))
+            {
+                low = middle + 1;
+            }
+            else
+            {
+                high = middle;
+            }
+        }
+
+        for (i = low; i < forwardTable->size
+                      && row[i].destAddress == prefix
+                      && row[i].destAddressMask == mask; i++)
+        {
+            if (NetworkForwardingTableRowAccepted(&row[i], filter))
+            {
+                return i;
+            }
+        }
+    }
+
+    return -1;
+}
+
+//-----------------------------------------------------------------------------
+// FUNCTION     NetworkForwardingTableFindUsable()
+// PURPOSE      Find the first row, in table order, that matches a
+//              destination and has a next hop on an enabled interface,
+//              through the next hop cache of the table.
+// PARAMETERS   NetworkForwardingTable *forwardTable
+//                  Table to search.
+//              NodeAddress destinationAddress
+//                  Destination IP address.
+// RETURN       Index of the row, or -1 if there is none.
+//-----------------------------------------------------------------------------
+
+static int
+NetworkForwardingTableFindUsable(
+    NetworkForwardingTable *forwardTable,
+    NodeAddress destinationAddress)
+{
+    NetworkForwardingCacheEntry *entry;
+    NetworkForwardingFilter filter;
+    int i;
+
+    if (forwardTable->cache == NULL)
+    {
+        forwardTable->cache = (NetworkForwardingCacheEntry*)
+            MEM_malloc(FORWARDING_TABLE_CACHE_SIZE
+                       * sizeof(NetworkForwardingCacheEntry));
+
+        for (i = 0; i < FORWARDING_TABLE_CACHE_SIZE; i++)
+        {
+            forwardTable->cache[i].destAddress = 0;
+            forwardTable->cache[i].version = forwardTable->version - 1;
+            forwardTable->cache[i].rowIndex = -1;
+        }
+    }
+
+    entry = &forwardTable->cache[
+                ((destinationAddress * 2654435761U) >> 16)
+                & (FORWARDING_TABLE_CACHE_SIZE - 1)];
+
+    if (entry->version == forwardTable->version
+        && entry->destAddress == destinationAddress)
+    {
+        return entry->rowIndex;
+    }
+
+    memset(&filter, 0, sizeof(filter));
+
+    entry->destAddress = destinationAddress;
+    entry->version = forwardTable->version;
+    entry->rowIndex =
+        NetworkForwardingTableFind(forwardTable, destinationAddress, &filter);
+
+    return entry->rowIndex;
+}
+
 //-----------------------------------------------------------------------------
 // FUNCTION     NetworkGetInterfaceAndNextHopFromForwardingTable()
 // PURPOSE      Do a lookup on the routing table with a destination IP
@@ -9554,20 +9792,12 @@ void NetworkGetInterfaceAndNextHopFromForwardingTable(
 
     //NetworkPrintForwardingTable(node);
 
-    for (i=0; i < forwardTable->size; i++) {
-        NodeAddress maskedDestinationAddress =
-            MaskIpAddress(
-                destinationAddress, forwardTable->row[i].destAddressMask);
+    i = NetworkForwardingTableFindUsable(forwardTable, destinationAddress);
 
-        if (forwardTable->row[i].destAddress == maskedDestinationAddress
-            && forwardTable->row[i].nextHopAddress !=
-            (unsigned) NETWORK_UNREACHABLE
-            && forwardTable->row[i].interfaceIsEnabled != FALSE)
-        {
-            *interfaceIndex = forwardTable->row[i].interfaceIndex;
-            *nextHopAddress = forwardTable->row[i].nextHopAddress;
-            break;
-        }
+    if (i >= 0)
+    {
+        *interfaceIndex = forwardTable->row[i].interfaceIndex;
+        *nextHopAddress = forwardTable->row[i].nextHopAddress;
     }
 }
 
@@ -9601,6 +9831,7 @@ void NetworkGetInterfaceAndNextHopFromForwardingTable(
 {
     NetworkDataIp *ip = (NetworkDataIp *) node->networkData.networkVar;
     NetworkForwardingTable *forwardTable = &(ip->forwardTable);
+    NetworkForwardingFilter filter;
     int i;
 
     *interfaceIndex = NETWORK_UNREACHABLE;
@@ -9608,21 +9839,16 @@ void NetworkGetInterfaceAndNextHopFromForwardingTable(
 
     //NetworkPrintForwardingTable(node);
 
-    for (i=0; i < forwardTable->size; i++) {
-        NodeAddress maskedDestinationAddress =
-            MaskIpAddress(
-                destinationAddress, forwardTable->row[i].destAddressMask);
+    memset(&filter, 0, sizeof(filter));
+    filter.matchInterface = TRUE;
+    filter.interfaceIndex = currentInterface;
 
-        if (forwardTable->row[i].destAddress == maskedDestinationAddress
-            && forwardTable->row[i].nextHopAddress !=
-            (unsigned) NETWORK_UNREACHABLE
-            && forwardTable->row[i].interfaceIsEnabled != FALSE
-            && forwardTable->row[i].interfaceIndex == currentInterface)
-        {
-            *interfaceIndex = forwardTable->row[i].interfaceIndex;
-            *nextHopAddress = forwardTable->row[i].nextHopAddress;
-            break;
-        }
+    i = NetworkForwardingTableFind(forwardTable, destinationAddress, &filter);
+
+    if (i >= 0)
+    {
+        *interfaceIndex = forwardTable->row[i].interfaceIndex;
+        *nextHopAddress = forwardTable->row[i].nextHopAddress;
     }
 }
 //-----------------------------------------------------------------------------
@@ -9661,27 +9887,20 @@ void NetworkGetInterfaceAndNextHopFromForwardingTable(
 
     //NetworkPrintForwardingTable(node);
 
-    for (i=0; i < forwardTable->size; i++) {
-        NodeAddress maskedDestinationAddress =
-            MaskIpAddress(
-                destinationAddress, forwardTable->row[i].destAddressMask);
+    i = NetworkForwardingTableFindUsable(forwardTable, destinationAddress);
 
-        if (forwardTable->row[i].destAddress == maskedDestinationAddress
-            && forwardTable->row[i].nextHopAddress != (unsigned) NETWORK_UNREACHABLE
-            && forwardTable->row[i].interfaceIsEnabled != FALSE)
+    if (i >= 0)
+    {
+        if (forwardTable->row[i].destAddress == destinationAddress)
         {
-            if (maskedDestinationAddress == destinationAddress)
-            {
-                *routeType = TRUE;
-            }
-            else
-            {
-                *routeType = FALSE;
-            }
-            *interfaceIndex = forwardTable->row[i].interfaceIndex;
-            *nextHopAddress = forwardTable->row[i].nextHopAddress;
-            break;
+            *routeType = TRUE;
         }
+        else
+        {
+            *routeType = FALSE;
+        }
+        *interfaceIndex = forwardTable->row[i].interfaceIndex;
+        *nextHopAddress = forwardTable->row[i].nextHopAddress;
     }
 }
 
@@ -9718,6 +9937,7 @@ void NetworkGetInterfaceAndNextHopFromForwardingTable
 {
     NetworkDataIp *ip = (NetworkDataIp *) node->networkData.networkVar;
     NetworkForwardingTable *forwardTable = &(ip->forwardTable);
+    NetworkForwardingFilter filter;
     int i;
 
     *interfaceIndex = NETWORK_UNREACHABLE;
@@ -9725,32 +9945,17 @@ void NetworkGetInterfaceAndNextHopFromForwardingTable
 
     // NetworkPrintForwardingTable(node);
 
-    for (i=0; i < forwardTable->size; i++) {
-        NodeAddress maskedDestinationAddress =
-            MaskIpAddress(
-                destinationAddress,
-                forwardTable->row[i].destAddressMask);
+    memset(&filter, 0, sizeof(filter));
+    filter.matchType = TRUE;
+    filter.testType = testType;
+    filter.type = type;
 
-        if (forwardTable->row[i].destAddress == maskedDestinationAddress
-            && forwardTable->row[i].nextHopAddress !=
-            (unsigned) NETWORK_UNREACHABLE
-            && forwardTable->row[i].interfaceIsEnabled != FALSE)
-        {
-            if (testType == TRUE &&
-                forwardTable->row[i].protocolType == type)
-            {
-                *interfaceIndex = forwardTable->row[i].interfaceIndex;
-                *nextHopAddress = forwardTable->row[i].nextHopAddress;
-                break;
-            }
-            else if (testType == FALSE && forwardTable->row[i].protocolType
-                != type)
-            {
-                *interfaceIndex = forwardTable->row[i].interfaceIndex;
-                *nextHopAddress = forwardTable->row[i].nextHopAddress;
-                break;
-            }
-        }
+    i = NetworkForwardingTableFind(forwardTable, destinationAddress, &filter);
+
+    if (i >= 0)
+    {
+        *interfaceIndex = forwardTable->row[i].interfaceIndex;
+        *nextHopAddress = forwardTable->row[i].nextHopAddress;
     }
 }
 
@@ -9793,6 +9998,7 @@ void NetworkGetInterfaceAndNextHopFromForwardingTable
 {
     NetworkDataIp *ip = (NetworkDataIp *) node->networkData.networkVar;
     NetworkForwardingTable *forwardTable = &(ip->forwardTable);
+    NetworkForwardingFilter filter;
     int i;
 
     *interfaceIndex = NETWORK_UNREACHABLE;
@@ -9800,33 +10006,19 @@ void NetworkGetInterfaceAndNextHopFromForwardingTable
 
     // NetworkPrintForwardingTable(node);
 
-    for (i=0; i < forwardTable->size; i++) {
-        NodeAddress maskedDestinationAddress =
-            MaskIpAddress(
-                destinationAddress,
-                forwardTable->row[i].destAddressMask);
+    memset(&filter, 0, sizeof(filter));
+    filter.matchInterface = TRUE;
+    filter.interfaceIndex = operatingInterface;
+    filter.matchType = TRUE;
+    filter.testType = testType;
+    filter.type = type;
 
-        if (forwardTable->row[i].destAddress == maskedDestinationAddress
-            && forwardTable->row[i].nextHopAddress !=
-            (unsigned) NETWORK_UNREACHABLE
-            && forwardTable->row[i].interfaceIsEnabled != FALSE
-            && forwardTable->row[i].interfaceIndex == operatingInterface)
-        {
-            if (testType == TRUE &&
-                forwardTable->row[i].protocolType == type)
-            {
-                *interfaceIndex = forwardTable->row[i].interfaceIndex;
-                *nextHopAddress = forwardTable->row[i].nextHopAddress;
-                break;
-            }
-            else if (testType == FALSE && forwardTable->row[i].protocolType
-                != type)
-            {
-                *interfaceIndex = forwardTable->row[i].interfaceIndex;
-                *nextHopAddress = forwardTable->row[i].nextHopAddress;
-                break;
-            }
-        }
+    i = NetworkForwardingTableFind(forwardTable, destinationAddress, &filter);
+
+    if (i >= 0)
+    {
+        *interfaceIndex = forwardTable->row[i].interfaceIndex;
+        *nextHopAddress = forwardTable->row[i].nextHopAddress;
     }
 }
 
@@ -9871,6 +10063,7 @@ void NetworkGetInterfaceAndNextHopFromForwardingTable
 {
     NetworkDataIp *ip = (NetworkDataIp *) node->networkData.networkVar;
     NetworkForwardingTable *forwardTable = &(ip->forwardTable);
+    NetworkForwardingFilter filter;
     int i;
 
     *interfaceIndex = NETWORK_UNREACHABLE;
@@ -9878,50 +10071,26 @@ void NetworkGetInterfaceAndNextHopFromForwardingTable
 
     // NetworkPrintForwardingTable(node);
 
-    for (i=0; i < forwardTable->size; i++) {
-        NodeAddress maskedDestinationAddress =
-            MaskIpAddress(
-                destinationAddress,
-                forwardTable->row[i].destAddressMask);
-
-        if (forwardTable->row[i].destAddress == maskedDestinationAddress
-            && forwardTable->row[i].nextHopAddress != (unsigned) NETWORK_UNREACHABLE
-            && forwardTable->row[i].interfaceIsEnabled != FALSE)
-        {
-            if (testType == TRUE &&
-                forwardTable->row[i].protocolType == type)
-            {
-
-                if (maskedDestinationAddress == destinationAddress)
-                {
-                    *routeType = TRUE;
-                }
-                else
-                {
-                    *routeType = FALSE;
-                }
-
-                *interfaceIndex = forwardTable->row[i].interfaceIndex;
-                *nextHopAddress = forwardTable->row[i].nextHopAddress;
-                break;
-            }
-            else if (testType == FALSE && forwardTable->row[i].protocolType != type)
-            {
+    memset(&filter, 0, sizeof(filter));
+    filter.matchType = TRUE;
+    filter.testType = testType;
+    filter.type = type;
 
-                if (maskedDestinationAddress == destinationAddress)
-                {
-                    *routeType = TRUE;
-                }
-                else
-                {
-                    *routeType = FALSE;
-                }
+    i = NetworkForwardingTableFind(forwardTable, destinationAddress, &filter);
 
-                *interfaceIndex = forwardTable->row[i].interfaceIndex;
-                *nextHopAddress = forwardTable->row[i].nextHopAddress;
-                break;
-            }
+    if (i >= 0)
+    {
+        if (forwardTable->row[i].destAddress == destinationAddress)
+        {
+            *routeType = TRUE;
+        }
+        else
+        {
+            *routeType = FALSE;
         }
+
+        *interfaceIndex = forwardTable->row[i].interfaceIndex;
+        *nextHopAddress = forwardTable->row[i].nextHopAddress;
     }
 }
 
@@ -10095,22 +10264,14 @@ NetworkGetMetricForDestAddress(
         *dist = ROUTING_ADMIN_DISTANCE_DEFAULT;
     }
 
-    for (i = 0; i < forwardTable->size; i++) {
-        NodeAddress maskedDestinationAddress =
-            MaskIpAddress(
-                destAddress, forwardTable->row[i].destAddressMask);
+    i = NetworkForwardingTableFindUsable(forwardTable, destAddress);
 
-        if (forwardTable->row[i].destAddress == maskedDestinationAddress
-            && forwardTable->row[i].nextHopAddress !=
-            (unsigned) NETWORK_UNREACHABLE
-            && forwardTable->row[i].interfaceIsEnabled != FALSE)
+    if (i >= 0)
+    {
+        metric = forwardTable->row[i].cost;
+        if (dist != NULL)
         {
-            metric = forwardTable->row[i].cost;
-            if (dist != NULL)
-            {
-                *dist = forwardTable->row[i].adminDistance;
-            }
-            break;
+            *dist = forwardTable->row[i].adminDistance;
         }
     }
     return metric;
@@ -10298,9 +10459,64 @@ NetworkInitForwardingTable(Node *node)
     ip->forwardTable.size = 0;
     ip->forwardTable.allocatedSize = 0;
     ip->forwardTable.row = NULL;
+    ip->forwardTable.prefixLengths = 0;
+    ip->forwardTable.version = 0;
+    ip->forwardTable.cache = NULL;
+    ip->forwardTable.updateInProgress = FALSE;
+    ip->forwardTable.numPending = 0;
+    ip->forwardTable.allocatedPending = 0;
+    ip->forwardTable.pending = NULL;
 }
 
 
+//-----------------------------------------------------------------------------
+// FUNCTION     NetworkForwardingTableRouteInterface()
+// PURPOSE      Get the outgoing interface of a route being added to the
+//              IP routing table.
+// PARAMETERS   Node *node
+//                  Pointer to node.
+//              NodeAddress nextHopAddress
+//                  Next hop IP address.
+//              int interfaceIndex
+//                  Outgoing interface given for the route, or
+//                  ANY_INTERFACE to find it from nextHopAddress.
+// RETURN       Outgoing interface.
+//-----------------------------------------------------------------------------
+
+static int
+NetworkForwardingTableRouteInterface(
+    Node *node,
+    NodeAddress nextHopAddress,
+    int interfaceIndex)
+{
+    if (interfaceIndex == ANY_INTERFACE)
+    {
+        if (nextHopAddress == (unsigned) NETWORK_UNREACHABLE)
+        {
+            interfaceIndex = DEFAULT_INTERFACE;
+        }
+        else
+        {
+            interfaceIndex = NetworkIpGetInterfaceIndexForNextHop(
+                node,
+                nextHopAddress);
+        }
+    }
+
+    if (interfaceIndex < 0)
+    {
+        char err[MAX_STRING_LENGTH];
+        char addr[MAX_STRING_LENGTH];
+
+        IO_ConvertIpAddressToString(nextHopAddress, addr);
+        sprintf(err, "Node %u: Next hop %s is not connected to this node\n",
+            node->nodeId, addr);
+        ERROR_ReportError(err);
+    }
+
+    return interfaceIndex;
+}
+
 //-----------------------------------------------------------------------------
 // FUNCTION     NetworkUpdateForwardingTable()
 // PURPOSE      Update or add entry to IP routing table.  Search the
@@ -10382,30 +10598,10 @@ NetworkUpdateForwardingTable(
 
     NetworkRouteUpdateEventType routeUpdateFunction = NULL;
 
-    if (interfaceIndex == ANY_INTERFACE)
-    {
-        if (nextHopAddress == (unsigned) NETWORK_UNREACHABLE)
-        {
-            interfaceIndex = DEFAULT_INTERFACE;
-        }
-        else
-        {
-            interfaceIndex = NetworkIpGetInterfaceIndexForNextHop(
-                node,
-                nextHopAddress);
-        }
-    }
-
-    if (interfaceIndex < 0)
-    {
-        char err[MAX_STRING_LENGTH];
-        char addr[MAX_STRING_LENGTH];
-
-        IO_ConvertIpAddressToString(nextHopAddress, addr);
-        sprintf(err, "Node %u: Next hop %s is not connected to this node\n",
-            node->nodeId, addr);
-        ERROR_ReportError(err);
-    }
+    interfaceIndex = NetworkForwardingTableRouteInterface(
+                         node,
+                         nextHopAddress,
+                         interfaceIndex);
 
 #ifdef ENTERPRISE_LIB
     // Will proceed if Redistribution is enabled
@@ -10497,6 +10693,10 @@ NetworkUpdateForwardingTable(
         forwardTable->row[i].interfaceIsEnabled = FALSE;
     }
 
+    forwardTable->prefixLengths |=
+        (UInt64) 1 << NetworkForwardingTablePrefixLength(destAddressMask);
+    forwardTable->version++;
+
     routeUpdateFunction = NetworkIpGetRouteUpdateEventFunction(node);
 
     if (routeUpdateFunction)
@@ -10506,6 +10706,384 @@ NetworkUpdateForwardingTable(
     }
 }
 
+//-----------------------------------------------------------------------------
+// FUNCTION     NetworkBeginForwardingTableUpdate()
+// PURPOSE      Start a batch update of the IP routing table.
+// PARAMETERS   Node *node
+//                  Pointer to node.
+// RETURN       None.
+//-----------------------------------------------------------------------------
+
+void
+NetworkBeginForwardingTableUpdate(Node *node)
+{
+    NetworkDataIp *ip = (NetworkDataIp *) node->networkData.networkVar;
+    NetworkForwardingTable *forwardTable = &(ip->forwardTable);
+
+    ERROR_Assert(!forwardTable->updateInProgress,
+                 "Forwarding table batch update already started");
+
+    forwardTable->updateInProgress = TRUE;
+    forwardTable->numPending = 0;
+}
+
+//-----------------------------------------------------------------------------
+// FUNCTION     NetworkAddForwardingTableUpdate()
+// PURPOSE      Add a route to a batch update of the IP routing table.
+// PARAMETERS   Node *node
+//                  Pointer to node.
+//              NodeAddress destAddress
+//                  IP address of destination network or host.
+//              NodeAddress destAddressMask
+//                  Netmask.
+//              NodeAddress nextHopAddress
+//                  Next hop IP address.
+//              int interfaceIndex
+//                  Outgoing interface, or ANY_INTERFACE.
+//              int cost,
+//                  Cost metric associated with the route.
+//              NetworkRoutingProtocolType type
+//                  Type value of routing protocol.
+// RETURN       None.
+//-----------------------------------------------------------------------------
+
+void
+NetworkAddForwardingTableUpdate(
+    Node *node,
+    NodeAddress destAddress,
+    NodeAddress destAddressMask,
+    NodeAddress nextHopAddress,
+    int interfaceIndex,
+    int cost,
+    NetworkRoutingProtocolType type)
+{
+    NetworkDataIp *ip = (NetworkDataIp *) node->networkData.networkVar;
+    NetworkForwardingTable *forwardTable = &(ip->forwardTable);
+    NetworkForwardingTableRow *route;
+
+    ERROR_Assert(forwardTable->updateInProgress,
+                 "Forwarding table batch update not started");
+    ERROR_Assert(type != ROUTING_PROTOCOL_ICMP_REDIRECT,
+                 "ICMP redirects can not be added to a batch update");
+
+    interfaceIndex = NetworkForwardingTableRouteInterface(
+                         node,
+                         nextHopAddress,
+                         interfaceIndex);
+
+#ifdef ENTERPRISE_LIB
+    // Will proceed if Redistribution is enabled
+    if (ip->rtRedistributeIsEnabled == TRUE)
+    {
+        RouteRedistributeAddHook(
+            node,
+            destAddress,
+            destAddressMask,
+            nextHopAddress,
+            interfaceIndex,
+            cost,
+            type);
+    }
+#endif // ENTERPRISE_LIB
+
+    if (forwardTable->numPending == forwardTable->allocatedPending)
+    {
+        int newSize = (forwardTable->allocatedPending == 0)
+                      ? FORWARDING_TABLE_ROW_START_SIZE
+                      : forwardTable->allocatedPending * 2;
+
+        NetworkForwardingTableRow* newPending =
+            (NetworkForwardingTableRow*)MEM_malloc(
+                newSize * sizeof(NetworkForwardingTableRow));
+
+        if (forwardTable->pending != NULL)
+        {
+            memcpy(newPending, forwardTable->pending,
+                   (forwardTable->numPending *
+                    sizeof(NetworkForwardingTableRow)));
+            MEM_free(forwardTable->pending);
+        }
+
+        forwardTable->pending = newPending;
+        forwardTable->allocatedPending = newSize;
+    }
+
+    route = &forwardTable->pending[forwardTable->numPending];
+    forwardTable->numPending++;
+
+    route->destAddress = destAddress;
+    route->destAddressMask = destAddressMask;
+    route->interfaceIndex = interfaceIndex;
+    route->nextHopAddress = nextHopAddress;
+    route->cost = cost;
+    route->protocolType = type;
+    route->adminDistance = NetworkRoutingGetAdminDistance(node, type);
+
+    if (NetworkIpInterfaceIsEnabled(node, interfaceIndex))
+    {
+        route->interfaceIsEnabled = TRUE;
+    }
+    else
+    {
+        route->interfaceIsEnabled = FALSE;
+    }
+}
+
+//-----------------------------------------------------------------------------
+// FUNCTION     NetworkForwardingTableRowBefore()
+// PURPOSE      Check whether a row goes before another in the IP routing
+//              table: greater destination, then greater mask, then
+//              smaller administrative distance.
+// PARAMETERS   const NetworkForwardingTableRow *row1
+//              const NetworkForwardingTableRow *row2
+//                  Rows to compare.
+// RETURN       TRUE if row1 goes strictly before row2.
+//-----------------------------------------------------------------------------
+
+static BOOL
+NetworkForwardingTableRowBefore(
+    const NetworkForwardingTableRow *row1,
+    const NetworkForwardingTableRow *row2)
+{
+    if (row1->destAddress != row2->destAddress)
+    {
+        return row1->destAddress > row2->destAddress;
+    }
+    if (row1->destAddressMask != row2->destAddressMask)
+    {
+        return row1->destAddressMask > row2->destAddressMask;
+    }
+    return row1->adminDistance < row2->adminDistance;
+}
+
+// Orders indices of batched routes as their rows go in the table
+struct NetworkForwardingTablePendingOrder
+{
+    const NetworkForwardingTableRow *pending;
+
+    bool operator()(int i, int j) const
+    {
+        return NetworkForwardingTableRowBefore(&pending[i], &pending[j])
+               == TRUE;
+    }
+};
+
+//-----------------------------------------------------------------------------
+// FUNCTION     NetworkCommitForwardingTableUpdate()
+// PURPOSE      Install the routes of a batch update of the IP routing
+//              table.
+// PARAMETERS   Node *node
+//                  Pointer to node.
+// RETURN       None.
+//
+// NOTES        The routes are sorted in table order, keeping the order
+//              they were added in among equal rows.  A route for the
+//              destination, mask and protocol of an earlier route of the
+//              batch replaces it in its place.  Rows already in the table
+//              are updated in place and the new ones are merged in after
+//              the rows they do not go before, which is where
+//              NetworkUpdateForwardingTable() would have put them.
+//-----------------------------------------------------------------------------
+
+void
+NetworkCommitForwardingTableUpdate(Node *node)
+{
+    NetworkDataIp *ip = (NetworkDataIp *) node->networkData.networkVar;
+    NetworkForwardingTable *forwardTable = &(ip->forwardTable);
+    NetworkForwardingTableRow *pending = forwardTable->pending;
+    int numPending = forwardTable->numPending;
+    NetworkForwardingTablePendingOrder pendingOrder;
+    NetworkRouteUpdateEventType routeUpdateFunction;
+    int *order;   // routes in table order
+    int *source;  // route giving the values of each place in order
+    int *target;  // row updated by each place, -1 if new, -2 if merged
+    int numNew = 0;
+    int i;
+    int j;
+    int k;
+
+    ERROR_Assert(forwardTable->updateInProgress,
+                 "Forwarding table batch update not started");
+
+    forwardTable->updateInProgress = FALSE;
+
+    if (numPending == 0)
+    {
+        return;
+    }
+
+    order = (int*) MEM_malloc(3 * numPending * sizeof(int));
+    source = order + numPending;
+    target = source + numPending;
+
+    for (k = 0; k < numPending; k++)
+    {
+        order[k] = k;
+    }
+
+    pendingOrder.pending = pending;
+    std::stable_sort(order, order + numPending, pendingOrder);
+
+    for (k = 0; k < numPending; k++)
+    {
+        const NetworkForwardingTableRow *route = &pending[order[k]];
+        int low = 0;
+        int high = forwardTable->size;
+
+        source[k] = order[k];
+        target[k] = -1;
+
+        // Routes of one protocol for a prefix have equal rows
+        for (j = k - 1;
+             j >= 0
+             && !NetworkForwardingTableRowBefore(&pending[order[j]], route);
+             j--)
+        {
+            if (target[j] != -2
+                && pending[order[j]].protocolType == route->protocolType)
+            {
+                source[j] = order[k];
+                target[k] = -2;
+                break;
+            }
+        }
+        if (target[k] == -2)
+        {
+            continue;
+        }
+
+        // first row not sorted before the route's prefix
+        while (low < high)
+        {
+            int middle = low + (high - low) / 2;
+
+            if (forwardTable->row[middle].destAddress > route->destAddress
+                || (forwardTable->row[middle].destAddress ==
+                        route->destAddress
+                    && forwardTable->row[middle].destAddressMask >
+                        route->destAddressMask))
+            {
+                low = middle + 1;
+            }
+            else
+            {
+                high = middle;
+            }
+        }
+
+        for (i = low; i < forwardTable->size
+                      && forwardTable->row[i].destAddress ==
+                          route->destAddress
+                      && forwardTable->row[i].destAddressMask ==
+                          route->destAddressMask; i++)
+        {
+            if (forwardTable->row[i].protocolType == route->protocolType)
+            {
+                target[k] = i;
+                break;
+            }
+        }
+
+        if (target[k] == -1)
+        {
+            numNew++;
+        }
+    }
+
+    for (k = 0; k < numPending; k++)
+    {
+        if (target[k] >= 0)
+        {
+            forwardTable->row[target[k]] = pending[source[k]];
+        }
+    }
+
+    if (forwardTable->size + numNew > forwardTable->allocatedSize)
+    {
+        int newSize = (forwardTable->allocatedSize == 0)
+                      ? FORWARDING_TABLE_ROW_START_SIZE
+                      : forwardTable->allocatedSize;
+
+        while (newSize < forwardTable->size + numNew)
+        {
+            newSize *= 2;
+        }
+
+        NetworkForwardingTableRow* newTableRow =
+            (NetworkForwardingTableRow*)MEM_malloc(
+                newSize * sizeof(NetworkForwardingTableRow));
+
+        if (forwardTable->row != NULL)
+        {
+            memcpy(newTableRow, forwardTable->row,
+                   (forwardTable->size *
+                    sizeof(NetworkForwardingTableRow)));
+            MEM_free(forwardTable->row);
+        }
+
+        forwardTable->row = newTableRow;
+        forwardTable->allocatedSize = newSize;
+    }
+
+    // Merge the new rows in from the end, after the equal rows
+    i = forwardTable->size - 1;
+    j = forwardTable->size + numNew - 1;
+    k = numPending - 1;
+
+    while (k >= 0)
+    {
+        if (target[k] != -1)
+        {
+            k--;
+            continue;
+        }
+
+        const NetworkForwardingTableRow *route = &pending[source[k]];
+
+        if (i >= 0
+            && NetworkForwardingTableRowBefore(route, &forwardTable->row[i]))
+        {
+            forwardTable->row[j] = forwardTable->row[i];
+            i--;
+        }
+        else
+        {
+            forwardTable->row[j] = *route;
+            forwardTable->prefixLengths |= (UInt64) 1
+                << NetworkForwardingTablePrefixLength(route->destAddressMask);
+
+            if (route->protocolType == ROUTING_PROTOCOL_STATIC)
+            {
+                forwardTable->numStaticRoutes++;
+            }
+            k--;
+        }
+        j--;
+    }
+
+    forwardTable->size += numNew;
+    forwardTable->version++;
+    forwardTable->numPending = 0;
+
+    MEM_free(order);
+
+    routeUpdateFunction = NetworkIpGetRouteUpdateEventFunction(node);
+
+    if (routeUpdateFunction)
+    {
+        for (k = 0; k < numPending; k++)
+        {
+            (routeUpdateFunction)(node,
+                                  pending[k].destAddress,
+                                  pending[k].destAddressMask,
+                                  pending[k].nextHopAddress,
+                                  pending[k].interfaceIndex,
+                                  pending[k].cost,
+                                  pending[k].adminDistance);
+        }
+    }
+}
+
 // /---------------------------------------------------------------------------
 // API        :: NetworkRemoveForwardingTableEntry
 // LAYER      :: Network
@@ -10551,6 +11129,7 @@ NetworkRemoveForwardingTableEntry(
 
             // Update forwarding table size.
             rt->size--;
+            rt->version++;
         }
         else
         {
@@ -10580,30 +11159,37 @@ NetworkEmptyForwardingTable(
     NetworkDataIp *ip = (NetworkDataIp *) node->networkData.networkVar;
     NetworkForwardingTable *rt = &ip->forwardTable;
 
-    // Go through the routing table...
-    for (int i = rt->size - 1; i >= 0; i--)
+    int numKept = 0;
+
+    // Go through the routing table, moving the entries of other routing
+    // protocols down over the deleted ones
+    for (int i = 0; i < rt->size; i++)
     {
-        // Delete entries that corresponds to the routing protocol used
-        if (rt->row[i].protocolType == type)
+        if (rt->row[i].protocolType != type)
         {
-            int j = i + 1;
-
-            // Move all other entries down
-            while (j < rt->size)
+            if (numKept != i)
             {
-                rt->row[j - 1] = rt->row[j];
-                j++;
+                rt->row[numKept] = rt->row[i];
             }
-
-            // Update forwarding table size.
-            rt->size--;
+            numKept++;
         }
     }
 
+    // Update forwarding table size.
+    rt->size = numKept;
+
     if (type == ROUTING_PROTOCOL_STATIC)
     {
         rt->numStaticRoutes = 0;
     }
+
+    rt->prefixLengths = 0;
+    for (int i = 0; i < rt->size; i++)
+    {
+        rt->prefixLengths |= (UInt64) 1
+            << NetworkForwardingTablePrefixLength(rt->row[i].destAddressMask);
+    }
+    rt->version++;
 }
 
 //-----------------------------------------------------------------------------
@@ -164,6 +164,20 @@ public:
 
 #define FORWARDING_TABLE_ROW_START_SIZE 8
 
+//
+// Entries of the per-node next hop cache of the forwarding table.  Must
+// be a power of two.
+//
+
+#define FORWARDING_TABLE_CACHE_SIZE 256
+
+//
+// Bit of NetworkForwardingTable::prefixLengths set when a row has a
+// mask that is not a prefix.
+//
+
+#define FORWARDING_TABLE_IRREGULAR_MASK 33
+
 //IP sourec route option padding
 
 #define IP_SOURCE_ROUTE_OPTION_PADDING  1
@@ -1606,7 +1620,24 @@ struct
 }
 NetworkForwardingTableRow;
 
+/// Entry of the next hop cache of a forwarding table.
+typedef
+struct
+{
+    NodeAddress destAddress;  // destination looked up
+    UInt32 version;           // table version when looked up
+    int rowIndex;             // first usable matching row, -1 if none
+}
+NetworkForwardingCacheEntry;
+
 /// Structure of forwarding table.
+///
+/// The rows are kept sorted by destination address and mask, both
+/// descending, so the rows matching a destination come longest prefix
+/// first and the rows of one prefix are contiguous.  Lookups binary
+/// search the rows of each prefix length in prefixLengths instead of
+/// scanning the table.  Code changing the rows outside network_ip.cpp,
+/// including interfaceIsEnabled, must increment version.
 typedef
 struct
 {
@@ -1614,6 +1645,15 @@ struct
     int allocatedSize;
     int numStaticRoutes; // number of static routes in routing table
     NetworkForwardingTableRow *row;  // allocation in Init function in Ip
+
+    UInt64 prefixLengths;  // bit n set if rows may have /n masks
+    UInt32 version;        // incremented on every change to the rows
+    NetworkForwardingCacheEntry* cache;  // allocated on first lookup
+
+    BOOL updateInProgress;  // between Begin and Commit of a batch update
+    int numPending;         // routes added to the batch, in order
+    int allocatedPending;
+    NetworkForwardingTableRow* pending;
 }
 NetworkForwardingTable;
 
@@ -3863,6 +3903,49 @@ NetworkUpdateForwardingTable(
     NetworkRoutingProtocolType type);
 
 
+/// Start a batch update of the IP routing table.  Routes given to
+/// NetworkAddForwardingTableUpdate() are installed together by
+/// NetworkCommitForwardingTableUpdate(), with the same result as calling
+/// NetworkUpdateForwardingTable() for each of them in order.
+///
+/// \param node  Pointer to node.
+void
+NetworkBeginForwardingTableUpdate(Node *node);
+
+/// Add a route to the batch update started by
+/// NetworkBeginForwardingTableUpdate().  The outgoing interface is
+/// resolved and route redistribution is notified at once, as by
+/// NetworkUpdateForwardingTable(); the forwarding table is not changed
+/// until the batch is committed.  ICMP redirects can not be batched.
+///
+/// \param node  Pointer to node.
+/// \param destAddress  IP address of destination
+///    network or host.
+/// \param destAddressMask  Netmask.
+/// \param nextHopAddress  Next hop IP address.
+/// \param outgoingInterfaceIndex  outgoing interface.
+/// \param cost  Cost metric associated with
+///    the route.
+/// \param type  type value of
+///    routing protocol.
+void
+NetworkAddForwardingTableUpdate(
+    Node *node,
+    NodeAddress destAddress,
+    NodeAddress destAddressMask,
+    NodeAddress nextHopAddress,
+    int outgoingInterfaceIndex,
+    int cost,
+    NetworkRoutingProtocolType type);
+
+/// Install the routes of a batch update in one merge with the table,
+/// then call the route update function for each of them in the order
+/// they were added.
+///
+/// \param node  Pointer to node.
+void
+NetworkCommitForwardingTableUpdate(Node *node);
+
 /// Remove single entries in the routing table
 ///
 /// \param node  Pointer to node.
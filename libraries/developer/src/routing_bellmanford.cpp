@@ -1302,6 +1302,9 @@ ProcessRouteAdvertisementPacket(
 
 #endif // DEBUG
 
+    // Install the advertised routes in one merge
+    NetworkBeginForwardingTableUpdate(node);
+
     for (i = 0; i < numAdvertisedRoutes; i++)
     {
         Route *rowPtr;
@@ -1469,7 +1472,7 @@ ProcessRouteAdvertisementPacket(
 
             // Update forwarding table.
 
-            NetworkUpdateForwardingTable(
+            NetworkAddForwardingTableUpdate(
                 node,
                 destAddress,
                 subnetMask,
@@ -1480,6 +1483,8 @@ ProcessRouteAdvertisementPacket(
         }//if//
     }//for//
 
+    NetworkCommitForwardingTableUpdate(node);
+
     // If a route has changed, call function which determines whether
     // to schedule a triggered update.
 
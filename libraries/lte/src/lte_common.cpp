@@ -183,6 +183,7 @@ LteDeleteRouteFromForwardingTable(
 
             // Update forwarding table size.
             rt->size--;
+            rt->version++;
         }
         else
         {
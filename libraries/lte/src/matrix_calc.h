@@ -22,15 +22,14 @@
 #define _MATRIX_CALC_H_
 
 #include <assert.h>
+#include <stddef.h>
 
 #include <complex>
-#include <valarray>
 
 ///////////////////////////////////////////////////////////////
 // typedef
 ///////////////////////////////////////////////////////////////
 typedef std::complex < double > Dcomp;
-typedef std::valarray < Dcomp > Cmat;
 
 ///////////////////////////////////////////////////////////////
 // typedef enum
@@ -52,23 +51,206 @@ typedef enum
 ///////////////////////////////////////////////////////////////
 const Dcomp LTE_DEFAULT_DCOMP(0.0, 0.0);
 
+///////////////////////////////////////////////////////////////
+// class
+///////////////////////////////////////////////////////////////
+
+/// Complex matrix of fixed dimensions, held in place so that it is
+/// never allocated from the heap.
+///
+/// The elements are stored row by row.  A channel matrix with fewer
+/// antennas than the dimensions uses only its first elements, indexed
+/// with MATRIX_INDEX() and the number of Tx antennas, and size() is then
+/// the number of elements in use.
+template <int ROWS, int COLS>
+class LteComplexMatrix
+{
+public:
+    /// Zero matrix
+    LteComplexMatrix()
+        : numElements(ROWS * COLS)
+    {
+        fill(LTE_DEFAULT_DCOMP);
+    }
+
+    /// Matrix of the first elements, all set to the value
+    ///
+    /// \param value  Value of the elements
+    /// \param size  Number of elements in use
+    LteComplexMatrix(const Dcomp& value, size_t size)
+        : numElements(size)
+    {
+        assert(size <= (size_t)(ROWS * COLS));
+        fill(value);
+    }
+
+    size_t size() const
+    {
+        return numElements;
+    }
+
+    Dcomp& operator[](size_t index)
+    {
+        assert(index < numElements);
+        return elements[index];
+    }
+
+    const Dcomp& operator[](size_t index) const
+    {
+        assert(index < numElements);
+        return elements[index];
+    }
+
+    Dcomp& operator()(int row, int col)
+    {
+        return elements[row * COLS + col];
+    }
+
+    const Dcomp& operator()(int row, int col) const
+    {
+        return elements[row * COLS + col];
+    }
+
+    LteComplexMatrix& operator+=(const LteComplexMatrix& other)
+    {
+        assert(numElements == other.numElements);
+        for (size_t i = 0; i < numElements; i++)
+        {
+            elements[i] += other.elements[i];
+        }
+        return *this;
+    }
+
+    LteComplexMatrix& operator*=(double factor)
+    {
+        for (size_t i = 0; i < numElements; i++)
+        {
+            elements[i] *= factor;
+        }
+        return *this;
+    }
+
+    void fill(const Dcomp& value)
+    {
+        for (int i = 0; i < ROWS * COLS; i++)
+        {
+            elements[i] = value;
+        }
+    }
+
+private:
+    Dcomp elements[ROWS * COLS];
+    size_t numElements;
+};
+
+/// 2x2 complex matrix, also large enough for the channel matrix of
+/// PHY_LTE_MAX_NUM_RX_ANTENNAS x PHY_LTE_MAX_NUM_TX_ANTENNAS
+typedef LteComplexMatrix < 2, 2 > Cmat;
+
 //--------------------------------------------------------------------------
-//  Utility functions for calculation of 2x2 complex matrix
+//  Utility functions for calculation of complex matrix
+//
+//  The functions taking the result as the last parameter write it in
+//  place, which must not be one of the operands.
 //--------------------------------------------------------------------------
 
+/// Get transposed matrix
+///
+/// \param org  Matrix to transpose
+/// \param ret  Transposed matrix
+template <int ROWS, int COLS>
+inline void GetTransposeMatrix(const LteComplexMatrix<ROWS, COLS>& org,
+                               LteComplexMatrix<COLS, ROWS>& ret)
+{
+    assert(org.size() == (size_t)(ROWS * COLS));
+    assert((const void*)&org != (const void*)&ret);
+
+    for (int i = 0; i < ROWS; i++)
+    {
+        for (int j = 0; j < COLS; j++)
+        {
+            ret(j, i) = org(i, j);
+        }
+    }
+}
+
 /// Get transposed matrix
 ///
 /// \param org  Matrix to transpose
 ///
 /// \return Transposed matrix
-Cmat GetTransposeMatrix(const Cmat& org);
+template <int ROWS, int COLS>
+inline LteComplexMatrix<COLS, ROWS> GetTransposeMatrix(
+    const LteComplexMatrix<ROWS, COLS>& org)
+{
+    LteComplexMatrix<COLS, ROWS> ret;
+    GetTransposeMatrix(org, ret);
+    return ret;
+}
+
+/// Get Conjugate transposed matrix
+///
+/// \param org  Matrix to transpose
+/// \param ret  Conjugate transposed matrix
+template <int ROWS, int COLS>
+inline void GetConjugateTransposeMatrix(
+    const LteComplexMatrix<ROWS, COLS>& org,
+    LteComplexMatrix<COLS, ROWS>& ret)
+{
+    assert(org.size() == (size_t)(ROWS * COLS));
+    assert((const void*)&org != (const void*)&ret);
+
+    for (int i = 0; i < ROWS; i++)
+    {
+        for (int j = 0; j < COLS; j++)
+        {
+            ret(j, i) = conj(org(i, j));
+        }
+    }
+}
 
 /// Get Conjugate transposed matrix
 ///
 /// \param org  Matrix to transpose
 ///
 /// \return Conjugate transposed matrix
-Cmat GetConjugateTransposeMatrix(const Cmat& org);
+template <int ROWS, int COLS>
+inline LteComplexMatrix<COLS, ROWS> GetConjugateTransposeMatrix(
+    const LteComplexMatrix<ROWS, COLS>& org)
+{
+    LteComplexMatrix<COLS, ROWS> ret;
+    GetConjugateTransposeMatrix(org, ret);
+    return ret;
+}
+
+/// Multiply 2 matrices
+///
+/// \param m1  Left term matrix
+/// \param m2  Right term matrix
+/// \param ret  Multiplied matrix
+template <int ROWS, int INNER, int COLS>
+inline void MulMatrix(const LteComplexMatrix<ROWS, INNER>& m1,
+                      const LteComplexMatrix<INNER, COLS>& m2,
+                      LteComplexMatrix<ROWS, COLS>& ret)
+{
+    assert(m1.size() == (size_t)(ROWS * INNER));
+    assert(m2.size() == (size_t)(INNER * COLS));
+    assert((const void*)&m1 != (const void*)&ret);
+    assert((const void*)&m2 != (const void*)&ret);
+
+    for (int i = 0; i < ROWS; i++)
+    {
+        for (int j = 0; j < COLS; j++)
+        {
+            Dcomp sum = m1(i, 0) * m2(0, j);
+            for (int k = 1; k < INNER; k++)
+            {
+                sum += m1(i, k) * m2(k, j);
+            }
+            ret(i, j) = sum;
+        }
+    }
+}
 
 /// Multiply 2 matrices
 ///
@@ -76,22 +258,63 @@ Cmat GetConjugateTransposeMatrix(const Cmat& org);
 /// \param m2  Right term matrix
 ///
 /// \return Multiplied matrix
-Cmat MulMatrix(const Cmat& m1, const Cmat& m2);
+template <int ROWS, int INNER, int COLS>
+inline LteComplexMatrix<ROWS, COLS> MulMatrix(
+    const LteComplexMatrix<ROWS, INNER>& m1,
+    const LteComplexMatrix<INNER, COLS>& m2)
+{
+    LteComplexMatrix<ROWS, COLS> ret;
+    MulMatrix(m1, m2, ret);
+    return ret;
+}
 
 /// Sum 2 matrices
 ///
 /// \param m1  Left term matrix
 /// \param m2  Right term matrix
 ///
-/// \return Multiplied matrix
-Cmat SumMatrix(const Cmat& m1, const Cmat& m2);
+/// \return Summed matrix
+template <int ROWS, int COLS>
+inline LteComplexMatrix<ROWS, COLS> SumMatrix(
+    const LteComplexMatrix<ROWS, COLS>& m1,
+    const LteComplexMatrix<ROWS, COLS>& m2)
+{
+    LteComplexMatrix<ROWS, COLS> ret(m1);
+    ret += m2;
+    return ret;
+}
+
+/// Get inverted matrix
+///
+/// \param org  Matrix to invert
+/// \param ret  Inverted matrix
+inline void GetInvertMatrix(const Cmat& org, Cmat& ret)
+{
+    assert(org.size() == numberOfElements2x2);
+    assert(&org != &ret);
+
+    Dcomp det_err(0.0, 0.0);
+    Dcomp det_org = org[m11] * org[m22] - org[m12] * org[m21];
+
+    assert(det_org != det_err);
+
+    ret[m11] = org[m22] / det_org;
+    ret[m12] = (-1.0) * org[m12] / det_org;
+    ret[m21] = (-1.0) * org[m21] / det_org;
+    ret[m22] = org[m11] / det_org;
+}
 
 /// Get inverted matrix
 ///
 /// \param org  Matrix to invert
 ///
 /// \return Inverted matrix
-Cmat GetInvertMatrix(const Cmat& org);
+inline Cmat GetInvertMatrix(const Cmat& org)
+{
+    Cmat ret;
+    GetInvertMatrix(org, ret);
+    return ret;
+}
 
 /// Get diagonal matrix
 ///
@@ -99,7 +322,13 @@ Cmat GetInvertMatrix(const Cmat& org);
 /// \param e2  (1,1) element
 ///
 /// \return Diagonal matrix
-Cmat GetDiagMatrix(const Dcomp& e1, const Dcomp& e2);
+inline Cmat GetDiagMatrix(const Dcomp& e1, const Dcomp& e2)
+{
+    Cmat ret;
+    ret[m11] = e1;
+    ret[m22] = e2;
+    return ret;
+}
 
 /// Get diagonal matrix
 ///
@@ -107,7 +336,13 @@ Cmat GetDiagMatrix(const Dcomp& e1, const Dcomp& e2);
 /// \param e2  (1,1) element
 ///
 /// \return Diagonal matrix
-Cmat GetDiagMatrix(double e1, double e2);
+inline Cmat GetDiagMatrix(double e1, double e2)
+{
+    Cmat ret;
+    ret[m11] = e1;
+    ret[m22] = e2;
+    return ret;
+}
 
 
 #endif /* _MATRIX_CALC_H_ */
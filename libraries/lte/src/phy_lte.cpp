@@ -1361,7 +1361,7 @@ double PhyLteCalculateBlockErrorRate(Node* node, int phyIndex,
 
     double refSinr_dB = effSnr_dB - deltaSnrDueToCodingGain - offset_dB;
 
-    double codeBlockErrorRate = PHY_PER(phyLte->thisPhy, berTableIndex, NON_DB(refSinr_dB));
+    double codeBlockErrorRate = PHY_GridPER(phyLte->thisPhy, berTableIndex, NON_DB(refSinr_dB));
 
     int numCodeBlocks = PhyLteGetNumCodeBlocks(isDL, mcsIndex, numRB);
 
@@ -4047,10 +4047,8 @@ Cmat PhyLteGetPrecodingMatrixList(Node* node, int phyIndex)
 {
     // Fixed precoding matrix is supported for first release.
     Dcomp p_elm(1/(sqrt(2.0)), 0);
-    Cmat matP(LTE_DEFAULT_DCOMP,4); // as 2x2 matrix
-    matP = GetDiagMatrix(p_elm, p_elm);
 
-    return matP;
+    return GetDiagMatrix(p_elm, p_elm);
 }
 
 // Get the RB groups size.
@@ -6147,15 +6145,8 @@ void PhyLteChannelMatrixMultiplyPathloss(Node* node,
                             double pathloss_dB,
                             Cmat& matHhat)
 {
-    for (UInt8 row = 0; row < phyLte->numRxAntennas; row++)
-    {
-        for (UInt8 col = 0; col < lteTxInfo->numTxAnntena; col++)
-        {
-            // H^ = GH
-            int mIndex = MATRIX_INDEX(row,col,lteTxInfo->numTxAnntena);
-            matHhat[mIndex] *= sqrt(1.0/NON_DB(pathloss_dB));
-        }
-    }
+    // H^ = GH
+    matHhat *= sqrt(1.0/NON_DB(pathloss_dB));
 }
 
 // Calculate channel matrix including pathloss.
@@ -6404,33 +6395,31 @@ std::vector < double > PhyLteCalculateSinr(Node* node,
         }
         else
         {
+            // The 2x2 matrices are held on the stack and computed in
+            // place, this runs for every RB of every TTI.
             // P
-            Cmat matP(LTE_DEFAULT_DCOMP,4); // as 2x2 matrix
-            matP = PhyLteGetPrecodingMatrixList(node, phyIndex);
+            Cmat matP = PhyLteGetPrecodingMatrixList(node, phyIndex);
             // H~ = H^P
-            Cmat matHtilde(LTE_DEFAULT_DCOMP,4); // as 2x2 matrix
-            matHtilde = MulMatrix(matHhat, matP);
+            Cmat matHtilde;
+            MulMatrix(matHhat, matP, matHtilde);
             // H~*
-            Cmat matHtildeConjT(LTE_DEFAULT_DCOMP,4); // as 2x2 matrix
-            matHtildeConjT = GetConjugateTransposeMatrix(matHtilde);
+            Cmat matHtildeConjT;
+            GetConjugateTransposeMatrix(matHtilde, matHtildeConjT);
             // R
             double r_real =
                 (phyLte->rbNoisePower_mW + ifPower_mW) / txPower_mW;
             Dcomp r_elm(r_real, 0);
-            Cmat matR(LTE_DEFAULT_DCOMP,4); // as 2x2 matrix
-            matR = GetDiagMatrix(r_elm, r_elm);
             // W (MMSE weight) = inv(H~*H~ + R) H~*
-            Cmat matW_HH(LTE_DEFAULT_DCOMP,4); // as 2x2 matrix
-            matW_HH = MulMatrix(matHtildeConjT, matHtilde);
-            Cmat matW_HHR(LTE_DEFAULT_DCOMP,4); // as 2x2 matrix
-            matW_HHR = SumMatrix(matW_HH, matR);
-            Cmat matW_HHRinv(LTE_DEFAULT_DCOMP,4); // as 2x2 matrix
-            matW_HHRinv = GetInvertMatrix(matW_HHR);
-            Cmat matW(LTE_DEFAULT_DCOMP,4); // as 2x2 matrix
-            matW = MulMatrix(matW_HHRinv, matHtildeConjT);
+            Cmat matW_HHR;
+            MulMatrix(matHtildeConjT, matHtilde, matW_HHR);
+            matW_HHR += GetDiagMatrix(r_elm, r_elm);
+            Cmat matW_HHRinv;
+            GetInvertMatrix(matW_HHR, matW_HHRinv);
+            Cmat matW;
+            MulMatrix(matW_HHRinv, matHtildeConjT, matW);
             // WH~
-            Cmat matWHtilde(LTE_DEFAULT_DCOMP,4); // as 2x2 matrix
-            matWHtilde = MulMatrix(matW, matHtilde);
+            Cmat matWHtilde;
+            MulMatrix(matW, matHtilde, matWHtilde);
 
             double Psignal = 0.0;
             double Pself = 0.0;
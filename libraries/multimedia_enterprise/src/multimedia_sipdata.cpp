@@ -1102,16 +1102,26 @@ void SipData :: SipInitRuleVectorAndSeedState(int noOfCell,
                                               unsigned *seedState,
                                               Node* node)
 {
-    while (noOfCell--)
+    std::vector<Int32> draws;
+    int cell;
+
+    if (noOfCell <= 0)
     {
-        ruleVector[noOfCell] = RULE_VECTOR_VAL1;
-        seedState[noOfCell] = RANDOM_nrand(seed) % 2;
+        return;
+    }
 
-        //for 32 bit maximum length CA
-        ruleVector[17] = RULE_VECTOR_VAL2;
-        ruleVector[31] = RULE_VECTOR_VAL2;
+    // One draw per cell, the last cell first
+    draws.resize(noOfCell);
+    RANDOM_nrandArray(seed, &draws[0], noOfCell);
+    for (cell = 0; cell < noOfCell; cell++)
+    {
+        ruleVector[noOfCell - 1 - cell] = RULE_VECTOR_VAL1;
+        seedState[noOfCell - 1 - cell] = draws[cell] % 2;
     }
 
+    //for 32 bit maximum length CA
+    ruleVector[17] = RULE_VECTOR_VAL2;
+    ruleVector[31] = RULE_VECTOR_VAL2;
 }
 
 
@@ -17736,7 +17736,8 @@ void Ospfv2UpdateIpForwardingTable(Node* node)
     NetworkEmptyForwardingTable(node, ROUTING_PROTOCOL_OSPFv2_TYPE1_EXTERNAL);
     NetworkEmptyForwardingTable(node, ROUTING_PROTOCOL_OSPFv2_TYPE2_EXTERNAL);
 
-
+    // Install the whole routing table in one merge
+    NetworkBeginForwardingTableUpdate(node);
 
     for (i = 0; i < ospf->routingTable.numRows; i++)
     {
@@ -17747,7 +17748,7 @@ void Ospfv2UpdateIpForwardingTable(Node* node)
         {
                 if (rowPtr[i].pathType == OSPFv2_TYPE1_EXTERNAL)
                 {
-                    NetworkUpdateForwardingTable(
+                    NetworkAddForwardingTableUpdate(
                         node,
                         rowPtr[i].destAddr,
                         rowPtr[i].addrMask,
@@ -17758,7 +17759,7 @@ void Ospfv2UpdateIpForwardingTable(Node* node)
                 }
                 else if (rowPtr[i].pathType == OSPFv2_TYPE2_EXTERNAL)
                 {
-                    NetworkUpdateForwardingTable(
+                    NetworkAddForwardingTableUpdate(
                         node,
                         rowPtr[i].destAddr,
                         rowPtr[i].addrMask,
@@ -17769,7 +17770,7 @@ void Ospfv2UpdateIpForwardingTable(Node* node)
                 }
                 else
                 {
-                     NetworkUpdateForwardingTable(
+                     NetworkAddForwardingTableUpdate(
                                 node,
                                 rowPtr[i].destAddr,
                                 rowPtr[i].addrMask,
@@ -17781,6 +17782,7 @@ void Ospfv2UpdateIpForwardingTable(Node* node)
         }
     }
 
+    NetworkCommitForwardingTableUpdate(node);
 }
 
 
@@ -347,7 +347,7 @@ if (KANDEB){
 
     if (thisPhy->phyRxModel == BER_BASED)
     {
-        BER = PHY_BER(phy802_15_4->thisPhy, 0, sinr);
+        BER = PHY_GridBER(phy802_15_4->thisPhy, 0, sinr);
     }
     else if (thisPhy->phyRxModel == RX_802_15_4)
     {
@@ -5092,5 +5092,5 @@ double UmtsMacPhyGetSignalBitErrorRate(
                         moduType,
                         & codeRate);
 
-    return PHY_BER(thisPhy, berTableIndex, sinr);
+    return PHY_GridBER(thisPhy, berTableIndex, sinr);
 }
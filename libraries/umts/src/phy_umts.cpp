@@ -420,7 +420,7 @@ void PhyUmtsCheckBurstError(Node* node,
                           cdmaBurst->moduType,
                           &codingRate);
 
-    BER = PHY_BER(thisPhy, modCodeType, sinr);
+    BER = PHY_GridBER(thisPhy, modCodeType, sinr);
 
     if (DEBUG_SNR)
     {
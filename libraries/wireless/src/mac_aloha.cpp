@@ -254,7 +254,9 @@ static void enterAlohaRetransmit(Node* node,
         }
     } else {
         assert(dataPtr->currentFrame);
-        retransmitPkt = MESSAGE_Duplicate(node, dataPtr->currentFrame);
+        // The frames kept for retransmission are only read, so they can
+        // share their payload with the copies handed to the PHY.
+        retransmitPkt = MESSAGE_DuplicateShared(node, dataPtr->currentFrame);
 
         dataPtr->retransmitTimer = NULL;
 
@@ -437,7 +439,7 @@ static void enterAlohaTransmit(Node* node,
 
     dataPtr->numTimeouts = 0;
 
-    dataPtr->currentFrame = MESSAGE_Duplicate(node, transmitFrame);
+    dataPtr->currentFrame = MESSAGE_DuplicateShared(node, transmitFrame);
 
     dataPtr->txMode = ALOHA_TX_DATA;
     assert(dataPtr->mode == ALOHA_IDLE);
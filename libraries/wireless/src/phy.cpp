@@ -22,9 +22,11 @@
 #include <limits.h>
 #include <sstream>
 #include <float.h>
+#include <map>
 
 #include "api.h"
 #include "partition.h"
+#include "qualnet_mutex.h"
 #include "propagation.h"
 #include "network_ip.h"
 #include "mac_phy_802_11n.h"
@@ -1029,6 +1031,8 @@ void PHY_CreateAPhyForMac(
         ERROR_ReportError("PHY-RX-MODEL is missing.");
     }
 
+    PHY_ErrorRateGridInit(node, interfaceIndex, nodeInput, thisPhy);
+
 
     //
     // Stats option
@@ -1330,6 +1334,7 @@ void PHY_Finalize(Node *node)
         }
 
         ENERGY_PrintStats(node,phyNum);
+        PHY_ErrorRateGridFinalize(node->phyData[phyNum]);
 
         node->exitInterface();
     }
@@ -3909,17 +3914,24 @@ double PHY_PropagationRange(Node* txnode,
                         case PHY802_11pSCH:
                         {
                             // As 802.11p is using 802.11a ber tables
-                            BER = PHY_BER(thisRadio, index, snr, RX_802_11a);
+                            PER = PHY_GridPacketErrorRate(
+                                      thisRadio,
+                                      index,
+                                      snr,
+                                      (double)PACKET_SIZE,
+                                      RX_802_11a);
                             break;
                         }
                         case PHY802_11a:
                         case PHY802_11b:
                         {
                             phy802_11 = (PhyData802_11*)thisRadio->phyVar;
-                            BER = PHY_BER(thisRadio,
-                                          index,
-                                          snr,
-                                          phy802_11->thisPhy->phyRxModel);
+                            PER = PHY_GridPacketErrorRate(
+                                      thisRadio,
+                                      index,
+                                      snr,
+                                      (double)PACKET_SIZE,
+                                      phy802_11->thisPhy->phyRxModel);
                             break;
                         }
                         case PHY802_11n:
@@ -3953,17 +3965,20 @@ double PHY_PropagationRange(Node* txnode,
                                              getDefaultChEstimationMatrix(
                                                             txnode,node),
                                   phy802_11->thisPhy->phyRxModel);
+                            PER = 1.0 - pow((1.0 - BER), (double)PACKET_SIZE);
                             break;
                         }
                         default:
                         {
-                            BER = PHY_BER(thisRadio, index, snr);
+                            PER = PHY_GridPacketErrorRate(
+                                      thisRadio,
+                                      index,
+                                      snr,
+                                      (double)PACKET_SIZE);
                             break;
                         }
                     }
 
-                    PER = 1.0 - pow((1.0 - BER), (double)PACKET_SIZE);
-
                     if (PER <= 0.1)
                     {
                         reachable = true;
@@ -4133,6 +4148,648 @@ double PHY_PropagationRange(Node* txnode,
 #endif // WIRELESS_LIB
 }
 
+// The uniform grids are kept beside the tables rather than in them, as
+// the size of the tables is fixed, and only for the PHYs that look their
+// rates up in them.  A curve resampled from the entries of a table is
+// shared by the tables of the same entries, as the shallow copies of a
+// table are.  It keeps a copy of the entries it was built from, so that
+// a table allocated where a freed one was gets a curve of its own.
+struct PhyErrorRateCurve
+{
+    PhyErrorRateGrid  grid;
+    const void*       entries;
+    std::vector<char> source;
+    bool              buckets;
+    int               refCount;
+};
+
+// The curves of a set of tables of a PHY, one table per modulation and
+// coding scheme.  The curve of table i is at index i, NULL until the
+// table is first looked up, with the entries of the table it is of.
+struct PhyErrorRateGridTables
+{
+    std::vector<const void*>        entries;
+    std::vector<PhyErrorRateCurve*> curves;
+};
+
+struct PhyErrorRateGrids
+{
+    std::map<PhyRxModel, PhyErrorRateGridTables> ber;
+    PhyErrorRateGridTables                       per;
+    PhyErrorRateGridTables                       ser;
+};
+
+// The shared curves, by the entries they were built from.  A PHY keeps
+// the curves it has looked up, so the store and its lock are used only
+// when a PHY first looks a table up and when it is finalized.
+static std::map<const void*, PhyErrorRateCurve*> phyErrorRateCurves;
+static QNThreadMutex phyErrorRateCurvesMutex;
+
+// Resample the curve of the table entries onto a uniform grid.  The
+// interval is the smallest between entries, so a table of a fixed
+// interval keeps its own points, unless that takes more than
+// PHY_ERROR_RATE_GRID_MAX_POINTS.  Between entries the rate is
+// interpolated linearly.
+template <typename Entry>
+static
+void PhyErrorRateGridBuild(PhyErrorRateGrid* grid,
+                           const Entry* entries,
+                           int numEntries,
+                           double Entry::*rate,
+                           bool buckets)
+{
+    double snrStart;
+    double snrEnd;
+    double interval = 0.0;
+    int numPoints = 1;
+    int entryIndex = 0;
+    int i;
+
+    memset(grid, 0, sizeof(PhyErrorRateGrid));
+    if (entries == NULL || numEntries < 1)
+    {
+        return;
+    }
+
+    snrStart = entries[0].snr;
+    snrEnd = entries[numEntries - 1].snr;
+    for (i = 1; i < numEntries; i++)
+    {
+        double spacing = entries[i].snr - entries[i - 1].snr;
+        if (spacing > 0.0 && (interval == 0.0 || spacing < interval))
+        {
+            interval = spacing;
+        }
+    }
+    if (interval > 0.0 && snrEnd > snrStart)
+    {
+        double span = (snrEnd - snrStart) / interval;
+        if (span >= PHY_ERROR_RATE_GRID_MAX_POINTS - 1)
+        {
+            numPoints = PHY_ERROR_RATE_GRID_MAX_POINTS;
+        }
+        else
+        {
+            // Same epsilon as the fixed interval check of the tables
+            numPoints = (int) ceil(span - 1.0e-9) + 1;
+        }
+        interval = (snrEnd - snrStart) / (numPoints - 1);
+    }
+
+    grid->numPoints = numPoints;
+    grid->snrStart = snrStart;
+    grid->snrEnd = snrEnd;
+    grid->invInterval = numPoints > 1 ? 1.0 / interval : 0.0;
+    grid->rates = (double*) MEM_malloc(numPoints * sizeof(double));
+    grid->logSuccess = (double*) MEM_malloc(numPoints * sizeof(double));
+
+    for (i = 0; i < numPoints; i++)
+    {
+        double snr = (i == numPoints - 1) ? snrEnd : snrStart + i * interval;
+        double value;
+
+        while (entryIndex < numEntries - 2 &&
+               entries[entryIndex + 1].snr <= snr)
+        {
+            entryIndex++;
+        }
+
+        if (numEntries == 1 || snr <= entries[entryIndex].snr)
+        {
+            value = entries[entryIndex].*rate;
+        }
+        else if (snr >= entries[entryIndex + 1].snr)
+        {
+            value = entries[entryIndex + 1].*rate;
+        }
+        else
+        {
+            const Entry& lower = entries[entryIndex];
+            const Entry& upper = entries[entryIndex + 1];
+            value = lower.*rate + (upper.*rate - lower.*rate)
+                    * (snr - lower.snr) / (upper.snr - lower.snr);
+        }
+
+        value = MIN(MAX(value, 0.0), 1.0);
+        grid->rates[i] = value;
+        grid->logSuccess[i] = value < 1.0 ? log1p(-value) : -DBL_MAX;
+    }
+
+    // Packet error rate of each length bucket, for the packet lengths
+    // that are looked up most.  They are the values of the log column
+    // at the points, so a bucket length gets the rate any length does.
+    if (buckets)
+    {
+        int bucket;
+
+        grid->bucketPers = (double*) MEM_malloc(
+            PHY_ERROR_RATE_GRID_NUM_BUCKETS * numPoints * sizeof(double));
+        for (bucket = 0; bucket < PHY_ERROR_RATE_GRID_NUM_BUCKETS; bucket++)
+        {
+            double length = (double) PHY_ERROR_RATE_GRID_MIN_BUCKET
+                            * (double) (1 << bucket);
+            double* pers = grid->bucketPers + bucket * numPoints;
+
+            for (i = 0; i < numPoints; i++)
+            {
+                pers[i] = -expm1(length * grid->logSuccess[i]);
+            }
+        }
+    }
+}
+
+// Get the shared curve of the table entries, building it when there is
+// none or the one built at the address was of other entries.  A curve
+// replaced that way is left to the PHYs that still hold it.
+template <typename Entry>
+static
+PhyErrorRateCurve* PhyErrorRateCurveAcquire(const Entry* entries,
+                                            int numEntries,
+                                            double Entry::*rate,
+                                            bool buckets)
+{
+    QNThreadLock lock(&phyErrorRateCurvesMutex);
+    const char* source = (const char*) entries;
+    size_t sourceSize = 0;
+    PhyErrorRateCurve*& stored = phyErrorRateCurves[entries];
+    PhyErrorRateCurve* curve = stored;
+
+    if (entries != NULL && numEntries > 0)
+    {
+        sourceSize = numEntries * sizeof(Entry);
+    }
+
+    if (curve != NULL &&
+        curve->buckets == buckets &&
+        curve->source.size() == sourceSize &&
+        (sourceSize == 0 ||
+         memcmp(&curve->source[0], source, sourceSize) == 0))
+    {
+        curve->refCount++;
+        return curve;
+    }
+
+    curve = new PhyErrorRateCurve;
+    curve->entries = entries;
+    curve->source.assign(source, source + sourceSize);
+    curve->buckets = buckets;
+    curve->refCount = 1;
+    PhyErrorRateGridBuild(&curve->grid, entries, numEntries, rate, buckets);
+    stored = curve;
+    return curve;
+}
+
+// Drop a PHY's hold on a curve, freeing it with the last
+static
+void PhyErrorRateCurveRelease(PhyErrorRateCurve* curve)
+{
+    QNThreadLock lock(&phyErrorRateCurvesMutex);
+    std::map<const void*, PhyErrorRateCurve*>::iterator it;
+
+    if (--curve->refCount > 0)
+    {
+        return;
+    }
+
+    it = phyErrorRateCurves.find(curve->entries);
+    if (it != phyErrorRateCurves.end() && it->second == curve)
+    {
+        phyErrorRateCurves.erase(it);
+    }
+    if (curve->grid.numPoints > 0)
+    {
+        MEM_free(curve->grid.rates);
+        MEM_free(curve->grid.logSuccess);
+        if (curve->grid.bucketPers != NULL)
+        {
+            MEM_free(curve->grid.bucketPers);
+        }
+    }
+    delete curve;
+}
+
+// Make room for the curves of tableCount tables, releasing those of the
+// tables beyond
+static
+void PhyErrorRateGridTablesResize(PhyErrorRateGridTables& gridTables,
+                                  int tableCount)
+{
+    for (size_t i = tableCount; i < gridTables.curves.size(); i++)
+    {
+        if (gridTables.curves[i] != NULL)
+        {
+            PhyErrorRateCurveRelease(gridTables.curves[i]);
+        }
+    }
+    gridTables.entries.resize(tableCount, NULL);
+    gridTables.curves.resize(tableCount, NULL);
+}
+
+// Get the grid of a table of a set of tables of the PHY, getting its
+// curve when the table is first looked up or has new entries
+template <typename Table, typename Entry>
+static
+const PhyErrorRateGrid& PhyErrorRateGridTablesFind(
+    PhyErrorRateGridTables& gridTables,
+    const Table* tables,
+    int tableCount,
+    int tableIndex,
+    double Entry::*rate,
+    bool buckets)
+{
+    const Table& table = tables[tableIndex];
+
+    if ((int) gridTables.curves.size() != tableCount)
+    {
+        PhyErrorRateGridTablesResize(gridTables, tableCount);
+    }
+
+    PhyErrorRateCurve*& curve = gridTables.curves[tableIndex];
+    if (curve == NULL || gridTables.entries[tableIndex] != table.entries)
+    {
+        if (curve != NULL)
+        {
+            PhyErrorRateCurveRelease(curve);
+        }
+        curve = PhyErrorRateCurveAcquire(table.entries,
+                                         table.numEntries,
+                                         rate,
+                                         buckets);
+        gridTables.entries[tableIndex] = table.entries;
+    }
+    return curve->grid;
+}
+
+// Find the point of the grid at or below the SNR, and how far the SNR is
+// from it toward the next point, as a fraction of the interval.  Below
+// the grid it is the first point, at the end the last.  Returns FALSE
+// above the grid, where the rates are 0 as those of PHY_BER are.
+static
+BOOL PhyErrorRateGridPosition(const PhyErrorRateGrid& grid,
+                              double snr,
+                              int* index,
+                              double* fraction)
+{
+    double position;
+
+    if (grid.numPoints == 0 || snr > grid.snrEnd)
+    {
+        return FALSE;
+    }
+
+    position = (snr - grid.snrStart) * grid.invInterval;
+    if (!(position > 0.0))
+    {
+        *index = 0;
+        *fraction = 0.0;
+    }
+    else if (position >= grid.numPoints - 1)
+    {
+        *index = grid.numPoints - 1;
+        *fraction = 0.0;
+    }
+    else
+    {
+        *index = (int) position;
+        *fraction = position - *index;
+    }
+    return TRUE;
+}
+
+// Interpolate linearly between two points
+static
+double PhyErrorRateGridInterpolate(double lower,
+                                   double upper,
+                                   double fraction)
+{
+    return lower + fraction * (upper - lower);
+}
+
+double PHY_ErrorRateGridLookup(const PhyErrorRateGrid& grid, double snr)
+{
+    int index;
+    double fraction;
+
+    if (!PhyErrorRateGridPosition(grid, snr, &index, &fraction))
+    {
+        return 0.0;
+    }
+    if (fraction == 0.0)
+    {
+        return grid.rates[index];
+    }
+    return PhyErrorRateGridInterpolate(grid.rates[index],
+                                       grid.rates[index + 1],
+                                       fraction);
+}
+
+double PHY_ErrorRateGridPacketErrorRate(
+    const PhyErrorRateGrid& grid,
+    double snr,
+    double numUnits)
+{
+    int index;
+    double fraction;
+    int exponent;
+    double mantissa;
+    double lower;
+    double upper;
+
+    if (!PhyErrorRateGridPosition(grid, snr, &index, &fraction))
+    {
+        return 0.0;
+    }
+
+    // A length of a bucket is MIN_BUCKET times a power of 2, and has its
+    // rates at the points precomputed
+    mantissa = frexp(numUnits / PHY_ERROR_RATE_GRID_MIN_BUCKET, &exponent);
+    if (grid.bucketPers != NULL && mantissa == 0.5 &&
+        exponent >= 1 && exponent <= PHY_ERROR_RATE_GRID_NUM_BUCKETS)
+    {
+        const double* pers =
+            grid.bucketPers + (exponent - 1) * grid.numPoints;
+
+        lower = pers[index];
+        upper = fraction == 0.0 ? lower : pers[index + 1];
+    }
+    else
+    {
+        lower = -expm1(numUnits * grid.logSuccess[index]);
+        upper = fraction == 0.0
+                ? lower
+                : -expm1(numUnits * grid.logSuccess[index + 1]);
+    }
+
+    return PhyErrorRateGridInterpolate(lower, upper, fraction);
+}
+
+void PHY_ErrorRateGridInit(
+    Node* node,
+    int interfaceIndex,
+    const NodeInput* nodeInput,
+    PhyData* thisPhy)
+{
+    BOOL wasFound;
+    BOOL enabled;
+
+    IO_ReadBool(
+        node,
+        node->nodeId,
+        interfaceIndex,
+        nodeInput,
+        "PHY-ERROR-RATE-GRID",
+        &wasFound,
+        &enabled);
+
+    if (wasFound && enabled && thisPhy->errorRateGrids == NULL)
+    {
+        thisPhy->errorRateGrids = new PhyErrorRateGrids;
+    }
+}
+
+void PHY_ErrorRateGridFinalize(PhyData* thisPhy)
+{
+    PhyErrorRateGrids* grids = thisPhy->errorRateGrids;
+    std::map<PhyRxModel, PhyErrorRateGridTables>::iterator it;
+
+    if (grids == NULL)
+    {
+        return;
+    }
+
+    for (it = grids->ber.begin(); it != grids->ber.end(); it++)
+    {
+        PhyErrorRateGridTablesResize(it->second, 0);
+    }
+    PhyErrorRateGridTablesResize(grids->per, 0);
+    PhyErrorRateGridTablesResize(grids->ser, 0);
+    delete grids;
+    thisPhy->errorRateGrids = NULL;
+}
+
+// Get the BER tables of the model, that of the PHY if none, NULL if
+// there are none
+static
+const std::vector<PhyBerTable>* PhyErrorRateGridBerTables(
+    PhyData* phyData,
+    PhyRxModel* rxModel)
+{
+    std::map<PhyRxModel, std::vector<PhyBerTable> >::const_iterator it;
+
+    if (*rxModel == RX_MODEL_NONE)
+    {
+        *rxModel = phyData->phyRxModel;
+    }
+    it = phyData->d_extSnrBerTables.find(*rxModel);
+    if (it == phyData->d_extSnrBerTables.end() || it->second.empty())
+    {
+        return NULL;
+    }
+    return &it->second;
+}
+
+// Get the grid of a BER table of the PHY, NULL if the PHY does not use
+// the grids or there is no such table
+static
+const PhyErrorRateGrid* PhyErrorRateGridBer(PhyData* phyData,
+                                            int berTableIndex,
+                                            PhyRxModel rxModel)
+{
+    const std::vector<PhyBerTable>* berTables;
+
+    if (phyData->errorRateGrids == NULL)
+    {
+        return NULL;
+    }
+
+    berTables = PhyErrorRateGridBerTables(phyData, &rxModel);
+    if (berTables == NULL ||
+        berTableIndex < 0 || berTableIndex >= (int) berTables->size())
+    {
+        return NULL;
+    }
+    return &PhyErrorRateGridTablesFind(
+                phyData->errorRateGrids->ber[rxModel],
+                &(*berTables)[0],
+                (int) berTables->size(),
+                berTableIndex,
+                &PhyBerEntry::ber,
+                true);
+}
+
+double PHY_GridBER(
+    PhyData* phyData,
+    int berTableIndex,
+    double sinr,
+    PhyRxModel rxModel)
+{
+    const PhyErrorRateGrid* grid =
+        PhyErrorRateGridBer(phyData, berTableIndex, rxModel);
+
+    if (grid == NULL)
+    {
+        return PHY_BER(phyData, berTableIndex, sinr, rxModel);
+    }
+    return PHY_ErrorRateGridLookup(*grid, sinr);
+}
+
+double PHY_GridPER(
+    PhyData* phyData,
+    int perTableIndex,
+    double sinr)
+{
+    if (phyData->errorRateGrids == NULL ||
+        perTableIndex < 0 || perTableIndex >= phyData->numPerTables)
+    {
+        return PHY_PER(phyData, perTableIndex, sinr);
+    }
+    return PHY_ErrorRateGridLookup(
+               PhyErrorRateGridTablesFind(phyData->errorRateGrids->per,
+                                          phyData->snrPerTables,
+                                          phyData->numPerTables,
+                                          perTableIndex,
+                                          &PhyPerEntry::per,
+                                          false),
+               sinr);
+}
+
+double PHY_GridSER(
+    PhyData* phyData,
+    int serTableIndex,
+    double sinr)
+{
+    if (phyData->errorRateGrids == NULL ||
+        serTableIndex < 0 || serTableIndex >= phyData->numSerTables)
+    {
+        return PHY_SER(phyData, serTableIndex, sinr);
+    }
+    return PHY_ErrorRateGridLookup(
+               PhyErrorRateGridTablesFind(phyData->errorRateGrids->ser,
+                                          phyData->snrSerTables,
+                                          phyData->numSerTables,
+                                          serTableIndex,
+                                          &PhySerEntry::ser,
+                                          true),
+               sinr);
+}
+
+double PHY_GridPacketErrorRate(
+    PhyData* phyData,
+    int berTableIndex,
+    double sinr,
+    double numBits,
+    PhyRxModel rxModel)
+{
+    const PhyErrorRateGrid* grid =
+        PhyErrorRateGridBer(phyData, berTableIndex, rxModel);
+
+    if (grid == NULL)
+    {
+        double BER = PHY_BER(phyData, berTableIndex, sinr, rxModel);
+        return 1.0 - pow((1.0 - BER), numBits);
+    }
+    return PHY_ErrorRateGridPacketErrorRate(*grid, sinr, numBits);
+}
+
+int PHY_GridBERs(
+    PhyData* phyData,
+    double sinr,
+    double* bers,
+    PhyRxModel rxModel)
+{
+    const std::vector<PhyBerTable>* berTables =
+        PhyErrorRateGridBerTables(phyData, &rxModel);
+    PhyErrorRateGridTables* gridTables = NULL;
+    int tableCount;
+    int i;
+
+    if (berTables == NULL)
+    {
+        return 0;
+    }
+
+    if (phyData->errorRateGrids != NULL)
+    {
+        gridTables = &phyData->errorRateGrids->ber[rxModel];
+    }
+    tableCount = (int) berTables->size();
+    for (i = 0; i < tableCount; i++)
+    {
+        if (gridTables == NULL)
+        {
+            bers[i] = PHY_BER(phyData, i, sinr, rxModel);
+            continue;
+        }
+        bers[i] = PHY_ErrorRateGridLookup(
+                      PhyErrorRateGridTablesFind(*gridTables,
+                                                 &(*berTables)[0],
+                                                 tableCount,
+                                                 i,
+                                                 &PhyBerEntry::ber,
+                                                 true),
+                      sinr);
+    }
+    return tableCount;
+}
+
+int PHY_GridPacketErrorRates(
+    PhyData* phyData,
+    double sinr,
+    double numBits,
+    double* pers,
+    PhyRxModel rxModel)
+{
+    const std::vector<PhyBerTable>* berTables =
+        PhyErrorRateGridBerTables(phyData, &rxModel);
+    PhyErrorRateGridTables* gridTables = NULL;
+    int tableCount;
+    int i;
+
+    if (berTables == NULL)
+    {
+        return 0;
+    }
+
+    if (phyData->errorRateGrids != NULL)
+    {
+        gridTables = &phyData->errorRateGrids->ber[rxModel];
+    }
+    tableCount = (int) berTables->size();
+    for (i = 0; i < tableCount; i++)
+    {
+        if (gridTables == NULL)
+        {
+            double BER = PHY_BER(phyData, i, sinr, rxModel);
+            pers[i] = 1.0 - pow((1.0 - BER), numBits);
+            continue;
+        }
+        pers[i] = PHY_ErrorRateGridPacketErrorRate(
+                      PhyErrorRateGridTablesFind(*gridTables,
+                                                 &(*berTables)[0],
+                                                 tableCount,
+                                                 i,
+                                                 &PhyBerEntry::ber,
+                                                 true),
+                      sinr,
+                      numBits);
+    }
+    return tableCount;
+}
+
+int PHY_GridPERs(
+    PhyData* phyData,
+    double sinr,
+    double* pers)
+{
+    int i;
+
+    for (i = 0; i < phyData->numPerTables; i++)
+    {
+        pers[i] = PHY_GridPER(phyData, i, sinr);
+    }
+    return phyData->numPerTables;
+}
+
 void
 PHY_BerTablesPrepare (std::vector<PhyBerTable>& berTables, const int tableCount)
 {
@@ -297,9 +297,9 @@ BOOL PhyAbstractCheckRxPacketError(Node* node,
     }
     else if (phy_abstract->thisPhy->phyRxModel == BER_BASED) {
 
-        BER = PHY_BER(phy_abstract->thisPhy,
-                      0,
-                      sinr);
+        BER = PHY_GridBER(phy_abstract->thisPhy,
+                          0,
+                          sinr);
 
         if (BER != 0.0) {
             double numBits;
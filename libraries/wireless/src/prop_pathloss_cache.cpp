@@ -0,0 +1,524 @@
+// Copyright (c) 2001-2015, SCALABLE Network Technologies, Inc.  All Rights Reserved.
+//                          600 Corporate Pointe
+//                          Suite 1200
+//                          Culver City, CA 90230
+//                          info@scalable-networks.com
+//
+// This source code is licensed, not sold, and is subject to a written
+// license agreement.  Among other things, no portion of this source
+// code may be copied, transmitted, disclosed, displayed, distributed,
+// translated, used as the basis for a derivative work, or used, in
+// whole or in part, for any program or purpose other than its intended
+// use in compliance with the license agreement as part of the QualNet
+// software.  This source code and certain of the algorithms contained
+// within it are confidential trade secrets of Scalable Network
+// Technologies, Inc. and may not be used as the basis for any other
+// software, hardware, product or service.
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#include "api.h"
+#include "partition.h"
+#include "prop_pathloss_cache.h"
+
+#define DEBUG 0
+
+// Reads one field of a cache file record
+#define PATHLOSS_CACHE_READ(fp, field) \
+    (fread(&(field), sizeof(field), 1, (fp)) == 1)
+
+// Writes one field of a cache file record
+#define PATHLOSS_CACHE_WRITE(fp, field) \
+    (fwrite(&(field), sizeof(field), 1, (fp)) == 1)
+
+// Configuration parameters, besides those of the channel profiles, that
+// change the pathloss of a pair: the terrain and urban data sources
+static const char* const pathlossCacheSignatureParameters[] =
+{
+    "COORDINATE-SYSTEM",
+    "TERRAIN-",
+    "DEM-",
+    "DTED-",
+    "URBAN-",
+    "PROPAGATION-OBSTRUCTION-",
+    NULL
+};
+
+// Quantizes a coordinate to the cache resolution
+static
+double PathlossCacheQuantize(double coordinate, double resolution)
+{
+    if (resolution > 0.0) {
+        return floor(coordinate / resolution);
+    }
+    return coordinate;
+}
+
+// Describes everything besides the key that the cached pathloss
+// depends on: the model and model parameters of each channel, and the
+// terrain configuration.  A cache file is only loaded by a scenario
+// with the same signature.
+static
+void PathlossCacheMakeSignature(
+    const PartitionData* partitionData,
+    const NodeInput* nodeInput,
+    std::string* signature)
+{
+    char buf[MAX_STRING_LENGTH];
+    int i;
+
+    signature->clear();
+
+    for (i = 0; i < partitionData->numChannels; i++) {
+        const PropProfile* propProfile =
+            partitionData->propChannel[i].profile;
+
+        if (propProfile == NULL) {
+            continue;
+        }
+
+        sprintf(buf,
+                "channel %d model %d %d frequency %.17g sampling %.9g "
+                "climate %d refractivity %.17g conductivity %.17g "
+                "permittivity %.17g humidity %.17g polarization %d\n",
+                i,
+                (int)propProfile->pathlossModel,
+                (int)propProfile->pathlossModelPrimary,
+                propProfile->frequency,
+                (double)propProfile->elevationSamplingDistance,
+                propProfile->climate,
+                propProfile->refractivity,
+                propProfile->conductivity,
+                propProfile->permittivity,
+                propProfile->humidity,
+                propProfile->polarization);
+        *signature += buf;
+
+        sprintf(buf,
+                "channel %d environment %d roof %.17g street %.17g "
+                "separation %.17g orientation %.17g roof %.17g %.17g "
+                "los %d buildings %d suburban %d\n",
+                i,
+                (int)propProfile->propagationEnvironment,
+                propProfile->roofHeight,
+                propProfile->streetWidth,
+                propProfile->buildingSeparation,
+                propProfile->RelativeNodeOrientation,
+                propProfile->MaxRoofHeight,
+                propProfile->MinRoofHeight,
+                (int)propProfile->losIndicator,
+                propProfile->Num_builings_in_path,
+                (int)propProfile->suburbanTerrainType);
+        *signature += buf;
+    }
+
+    for (i = 0; i < nodeInput->numLines; i++) {
+        const char* name = nodeInput->variableNames[i];
+        int j;
+
+        for (j = 0; pathlossCacheSignatureParameters[j] != NULL; j++) {
+            const char* prefix = pathlossCacheSignatureParameters[j];
+
+            if (strncmp(name, prefix, strlen(prefix)) == 0) {
+                *signature += nodeInput->qualifiers[i] != NULL ?
+                              nodeInput->qualifiers[i] : "";
+                *signature += " ";
+                *signature += name;
+                sprintf(buf, "[%d] ", nodeInput->instanceIds[i]);
+                *signature += buf;
+                *signature += nodeInput->values[i];
+                *signature += "\n";
+                break;
+            }
+        }
+    }
+}
+
+// Writes the cache entries to the cache file, least recently used
+// first, so that loading them restores the use order.
+//
+// The file holds the signature and version, the resolution, the length
+// and text of the scenario signature, the number of entries, and then
+// each key followed by its pathloss, in the byte order of the machine
+// that wrote it.
+struct PathlossCacheWriter
+{
+    FILE* fp;
+    bool  ok;
+
+    void operator()(const PathlossCacheKey& key, const double& pathloss_dB)
+    {
+        ok = ok &&
+             PATHLOSS_CACHE_WRITE(fp, key.txNodeId) &&
+             PATHLOSS_CACHE_WRITE(fp, key.rxNodeId) &&
+             PATHLOSS_CACHE_WRITE(fp, key.channelIndex) &&
+             PATHLOSS_CACHE_WRITE(fp, key.txAntennaHeight) &&
+             PATHLOSS_CACHE_WRITE(fp, key.rxAntennaHeight) &&
+             PATHLOSS_CACHE_WRITE(fp, key.wavelength) &&
+             PATHLOSS_CACHE_WRITE(fp, key.txPosition) &&
+             PATHLOSS_CACHE_WRITE(fp, key.rxPosition) &&
+             PATHLOSS_CACHE_WRITE(fp, pathloss_dB);
+    }
+};
+
+static
+void PathlossCacheSave(PathlossCache* cache)
+{
+    FILE* fp = fopen(cache->fileName.c_str(), "wb");
+    UInt8 version = PATHLOSS_CACHE_VERSION;
+    UInt32 signatureLength = (UInt32)cache->signature.size();
+    UInt32 numEntries = (UInt32)cache->entries.getSize();
+    PathlossCacheWriter writer;
+
+    if (fp == NULL) {
+        ERROR_ReportWarningArgs("Cannot write pathloss cache file %s",
+                                cache->fileName.c_str());
+        return;
+    }
+
+    writer.fp = fp;
+    writer.ok =
+        fwrite(PATHLOSS_CACHE_MAGIC, 1, strlen(PATHLOSS_CACHE_MAGIC), fp) ==
+            strlen(PATHLOSS_CACHE_MAGIC) &&
+        PATHLOSS_CACHE_WRITE(fp, version) &&
+        PATHLOSS_CACHE_WRITE(fp, cache->resolution) &&
+        PATHLOSS_CACHE_WRITE(fp, signatureLength) &&
+        fwrite(cache->signature.data(), 1, signatureLength, fp) ==
+            signatureLength &&
+        PATHLOSS_CACHE_WRITE(fp, numEntries);
+
+    if (writer.ok) {
+        cache->entries.forEach(writer);
+    }
+
+    if (fclose(fp) != 0 || !writer.ok) {
+        // Don't leave a truncated file for the next run
+        ERROR_ReportWarningArgs("Error writing pathloss cache file %s",
+                                cache->fileName.c_str());
+        remove(cache->fileName.c_str());
+    }
+}
+
+// Loads the entries of the cache file, if there is one made with the
+// same resolution by the same scenario
+static
+void PathlossCacheLoad(PathlossCache* cache)
+{
+    FILE* fp = fopen(cache->fileName.c_str(), "rb");
+    char magic[sizeof(PATHLOSS_CACHE_MAGIC)];
+    UInt8 version;
+    double resolution;
+    UInt32 signatureLength;
+    std::string signature;
+    UInt32 numEntries;
+    UInt32 i;
+
+    if (fp == NULL) {
+        // First run, the file is written at the end
+        return;
+    }
+
+    if (fread(magic, 1, strlen(PATHLOSS_CACHE_MAGIC), fp) !=
+            strlen(PATHLOSS_CACHE_MAGIC) ||
+        memcmp(magic, PATHLOSS_CACHE_MAGIC,
+               strlen(PATHLOSS_CACHE_MAGIC)) != 0 ||
+        !PATHLOSS_CACHE_READ(fp, version) ||
+        version != PATHLOSS_CACHE_VERSION ||
+        !PATHLOSS_CACHE_READ(fp, resolution) ||
+        !PATHLOSS_CACHE_READ(fp, signatureLength))
+    {
+        ERROR_ReportWarningArgs("%s is not a pathloss cache file, "
+                                "starting with an empty cache",
+                                cache->fileName.c_str());
+        fclose(fp);
+        return;
+    }
+
+    if (resolution != cache->resolution) {
+        ERROR_ReportWarningArgs("Pathloss cache file %s was made with "
+                                "PROPAGATION-PATHLOSS-CACHE-RESOLUTION %f, "
+                                "starting with an empty cache",
+                                cache->fileName.c_str(), resolution);
+        fclose(fp);
+        return;
+    }
+
+    // Only read as much of the signature as this scenario's could match
+    if (signatureLength == cache->signature.size()) {
+        signature.resize(signatureLength);
+        if (signatureLength > 0 &&
+            fread(&signature[0], 1, signatureLength, fp) != signatureLength)
+        {
+            signature.clear();
+        }
+    }
+
+    if (signatureLength != cache->signature.size() ||
+        signature != cache->signature)
+    {
+        ERROR_ReportWarningArgs("Pathloss cache file %s was made by a "
+                                "scenario with different propagation "
+                                "models or terrain, starting with an "
+                                "empty cache",
+                                cache->fileName.c_str());
+        fclose(fp);
+        return;
+    }
+
+    if (!PATHLOSS_CACHE_READ(fp, numEntries)) {
+        ERROR_ReportWarningArgs("Pathloss cache file %s is truncated",
+                                cache->fileName.c_str());
+        fclose(fp);
+        return;
+    }
+
+    for (i = 0; i < numEntries; i++) {
+        PathlossCacheKey key;
+        double pathloss_dB;
+
+        if (!PATHLOSS_CACHE_READ(fp, key.txNodeId) ||
+            !PATHLOSS_CACHE_READ(fp, key.rxNodeId) ||
+            !PATHLOSS_CACHE_READ(fp, key.channelIndex) ||
+            !PATHLOSS_CACHE_READ(fp, key.txAntennaHeight) ||
+            !PATHLOSS_CACHE_READ(fp, key.rxAntennaHeight) ||
+            !PATHLOSS_CACHE_READ(fp, key.wavelength) ||
+            !PATHLOSS_CACHE_READ(fp, key.txPosition) ||
+            !PATHLOSS_CACHE_READ(fp, key.rxPosition) ||
+            !PATHLOSS_CACHE_READ(fp, pathloss_dB))
+        {
+            ERROR_ReportWarningArgs("Pathloss cache file %s is truncated",
+                                    cache->fileName.c_str());
+            break;
+        }
+
+        double cached;
+        if (!cache->entries.find(key, cached)) {
+            cache->entries.insert(key, pathloss_dB);
+        }
+    }
+
+    if (DEBUG) {
+        printf("partition %d loaded %u pathloss values from %s\n",
+               cache->partitionData->partitionId,
+               (unsigned)cache->entries.getSize(),
+               cache->fileName.c_str());
+    }
+
+    fclose(fp);
+}
+
+void PathlossCacheInitialize(
+    PartitionData* partitionData,
+    const NodeInput* nodeInput)
+{
+    BOOL wasFound;
+    BOOL enabled = FALSE;
+    int maxEntries = PATHLOSS_CACHE_DEFAULT_SIZE;
+    double resolution = 0.0;
+    char buf[MAX_STRING_LENGTH];
+    PathlossCache* cache;
+
+    // The partition may hold a copy of another partition's pointer
+    if (partitionData->pathlossCache != NULL &&
+        partitionData->pathlossCache->partitionData == partitionData)
+    {
+        return;
+    }
+    partitionData->pathlossCache = NULL;
+
+    IO_ReadBool(
+        ANY_NODEID,
+        ANY_ADDRESS,
+        nodeInput,
+        "PROPAGATION-PATHLOSS-CACHE",
+        &wasFound,
+        &enabled);
+
+    if (!wasFound || !enabled) {
+        return;
+    }
+
+    IO_ReadInt(
+        ANY_NODEID,
+        ANY_ADDRESS,
+        nodeInput,
+        "PROPAGATION-PATHLOSS-CACHE-SIZE",
+        &wasFound,
+        &maxEntries);
+
+    if (wasFound && maxEntries <= 0) {
+        ERROR_ReportErrorArgs("PROPAGATION-PATHLOSS-CACHE-SIZE must be "
+                              "greater than 0, not %d", maxEntries);
+    }
+
+    IO_ReadDouble(
+        ANY_NODEID,
+        ANY_ADDRESS,
+        nodeInput,
+        "PROPAGATION-PATHLOSS-CACHE-RESOLUTION",
+        &wasFound,
+        &resolution);
+
+    if (wasFound && resolution < 0.0) {
+        ERROR_ReportErrorArgs("PROPAGATION-PATHLOSS-CACHE-RESOLUTION must "
+                              "not be negative, not %f", resolution);
+    }
+
+    cache = new PathlossCache(maxEntries);
+    cache->partitionData = partitionData;
+    cache->resolution = resolution;
+    cache->numHits = 0;
+    cache->numMisses = 0;
+
+    IO_ReadString(
+        ANY_NODEID,
+        ANY_ADDRESS,
+        nodeInput,
+        "PROPAGATION-PATHLOSS-CACHE-FILE",
+        &wasFound,
+        buf);
+
+    if (wasFound) {
+        if (partitionData->getNumPartitions() > 1) {
+            char partitionSuffix[MAX_STRING_LENGTH];
+            sprintf(partitionSuffix, ".%d", partitionData->partitionId);
+            strcat(buf, partitionSuffix);
+        }
+        cache->fileName = buf;
+        PathlossCacheMakeSignature(partitionData,
+                                   nodeInput,
+                                   &cache->signature);
+        PathlossCacheLoad(cache);
+    }
+
+    partitionData->pathlossCache = cache;
+}
+
+bool PathlossCacheApplies(PathlossModel pathlossModel)
+{
+    switch (pathlossModel) {
+        case ITM:
+        case TIREM:
+        case OKUMURA_HATA:
+        case COST231_HATA:
+        case COST231_WALFISH_IKEGAMI:
+        case URBAN_MODEL_AUTOSELECT:
+        case STREET_MICROCELL:
+        case STREET_M_TO_M:
+        case SUBURBAN_FOLIAGE:
+            return true;
+
+        default:
+            // Free space and two-ray are cheaper than a lookup; the
+            // others depend on time or on external data.
+            return false;
+    }
+}
+
+void PathlossCacheMakeKey(
+    const PathlossCache* cache,
+    NodeId txNodeId,
+    NodeId rxNodeId,
+    int channelIndex,
+    double wavelength,
+    float txAntennaHeight,
+    float rxAntennaHeight,
+    const PropPathProfile* pathProfile,
+    PathlossCacheKey* key)
+{
+    const Coordinates& from = pathProfile->fromPosition;
+    const Coordinates& to = pathProfile->toPosition;
+
+    key->txNodeId = txNodeId;
+    key->rxNodeId = rxNodeId;
+    key->channelIndex = channelIndex;
+    key->txAntennaHeight = txAntennaHeight;
+    key->rxAntennaHeight = rxAntennaHeight;
+    key->wavelength = wavelength;
+    key->txPosition[0] =
+        PathlossCacheQuantize(from.common.c1, cache->resolution);
+    key->txPosition[1] =
+        PathlossCacheQuantize(from.common.c2, cache->resolution);
+    key->txPosition[2] =
+        PathlossCacheQuantize(from.common.c3, cache->resolution);
+    key->rxPosition[0] =
+        PathlossCacheQuantize(to.common.c1, cache->resolution);
+    key->rxPosition[1] =
+        PathlossCacheQuantize(to.common.c2, cache->resolution);
+    key->rxPosition[2] =
+        PathlossCacheQuantize(to.common.c3, cache->resolution);
+}
+
+bool PathlossCacheFind(
+    PathlossCache* cache,
+    const PathlossCacheKey& key,
+    double* pathloss_dB)
+{
+    if (cache->entries.find(key, *pathloss_dB)) {
+        cache->numHits++;
+        return true;
+    }
+
+    cache->numMisses++;
+    return false;
+}
+
+void PathlossCacheInsert(
+    PathlossCache* cache,
+    const PathlossCacheKey& key,
+    double pathloss_dB)
+{
+    cache->entries.insert(key, pathloss_dB);
+}
+
+void PathlossCacheFinalize(PartitionData* partitionData)
+{
+    PathlossCache* cache = partitionData->pathlossCache;
+    Node* node = partitionData->firstNode;
+
+    if (cache == NULL || cache->partitionData != partitionData) {
+        return;
+    }
+
+    if (node != NULL) {
+        UInt64 numLookups = cache->numHits + cache->numMisses;
+
+        IO_PrintStat(
+            node,
+            "Physical",
+            "Propagation",
+            ANY_DEST,
+            -1,
+            "Pathloss cache hits = %" TYPES_64BITFMT "u",
+            cache->numHits);
+
+        IO_PrintStat(
+            node,
+            "Physical",
+            "Propagation",
+            ANY_DEST,
+            -1,
+            "Pathloss cache misses = %" TYPES_64BITFMT "u",
+            cache->numMisses);
+
+        IO_PrintStat(
+            node,
+            "Physical",
+            "Propagation",
+            ANY_DEST,
+            -1,
+            "Pathloss cache hit rate (percent) = %.2f",
+            numLookups == 0 ? 0.0 :
+                100.0 * (double)cache->numHits / (double)numLookups);
+    }
+
+    if (!cache->fileName.empty()) {
+        PathlossCacheSave(cache);
+    }
+
+    delete cache;
+    partitionData->pathlossCache = NULL;
+}
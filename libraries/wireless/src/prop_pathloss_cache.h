@@ -0,0 +1,180 @@
+// Copyright (c) 2001-2015, SCALABLE Network Technologies, Inc.  All Rights Reserved.
+//                          600 Corporate Pointe
+//                          Suite 1200
+//                          Culver City, CA 90230
+//                          info@scalable-networks.com
+//
+// This source code is licensed, not sold, and is subject to a written
+// license agreement.  Among other things, no portion of this source
+// code may be copied, transmitted, disclosed, displayed, distributed,
+// translated, used as the basis for a derivative work, or used, in
+// whole or in part, for any program or purpose other than its intended
+// use in compliance with the license agreement as part of the QualNet
+// software.  This source code and certain of the algorithms contained
+// within it are confidential trade secrets of Scalable Network
+// Technologies, Inc. and may not be used as the basis for any other
+// software, hardware, product or service.
+
+#ifndef PROP_PATHLOSS_CACHE_H
+#define PROP_PATHLOSS_CACHE_H
+
+/// \file This file defines the types needed to use the template Cache
+/// class to keep pathloss values of terrain and urban models, indexed
+/// by node pair and position.
+
+#include <string>
+#include <boost/functional/hash.hpp>
+
+#include "Cache.h"
+
+/// Number of pathloss values kept per partition by default
+#define PATHLOSS_CACHE_DEFAULT_SIZE     65536
+
+/// Cache file signature, followed by a version byte
+#define PATHLOSS_CACHE_MAGIC            "QPLCACH"
+#define PATHLOSS_CACHE_VERSION          2
+
+/// \brief Key value for the pathloss cache
+///
+/// Positions are quantized to the cache resolution.  A node that moves
+/// less than the resolution keeps its entries; a larger mobility update
+/// gives new keys, and the stale entries age out as least recently
+/// used.  With a resolution of 0 the positions are kept exactly.
+struct PathlossCacheKey
+{
+    NodeId  txNodeId;
+    NodeId  rxNodeId;
+    int     channelIndex;
+    float   txAntennaHeight;
+    float   rxAntennaHeight;
+    double  wavelength;
+    double  txPosition[3];
+    double  rxPosition[3];
+};
+
+/// \brief Equality operator for PathlossCacheKey
+///
+/// This definition allows the use of std::equal_to for testing equality.
+inline bool operator==(const PathlossCacheKey& lhs,
+                       const PathlossCacheKey& rhs)
+{
+    return lhs.txNodeId == rhs.txNodeId &&
+           lhs.rxNodeId == rhs.rxNodeId &&
+           lhs.channelIndex == rhs.channelIndex &&
+           lhs.txAntennaHeight == rhs.txAntennaHeight &&
+           lhs.rxAntennaHeight == rhs.rxAntennaHeight &&
+           lhs.wavelength == rhs.wavelength &&
+           lhs.txPosition[0] == rhs.txPosition[0] &&
+           lhs.txPosition[1] == rhs.txPosition[1] &&
+           lhs.txPosition[2] == rhs.txPosition[2] &&
+           lhs.rxPosition[0] == rhs.rxPosition[0] &&
+           lhs.rxPosition[1] == rhs.rxPosition[1] &&
+           lhs.rxPosition[2] == rhs.rxPosition[2];
+}
+
+/// \brief Hasher class for PathlossCacheKey
+///
+/// The node pair alone separates most keys; the positions are combined
+/// in as well so that a mobile pair does not pile up in one bucket.
+struct HashPathlossCacheKey
+{
+    size_t operator()(const PathlossCacheKey& v) const
+    {
+        size_t seed = 0;
+        boost::hash_combine(seed, v.txNodeId);
+        boost::hash_combine(seed, v.rxNodeId);
+        boost::hash_combine(seed, v.channelIndex);
+        boost::hash_combine(seed, v.txPosition[0]);
+        boost::hash_combine(seed, v.txPosition[1]);
+        boost::hash_combine(seed, v.rxPosition[0]);
+        boost::hash_combine(seed, v.rxPosition[1]);
+        return seed;
+    }
+};
+
+typedef
+Cache<PathlossCacheKey, double, HashPathlossCacheKey> PathlossCacheMap;
+
+/// Pathloss cache of a partition.  It is kept in the partition for
+/// thread safety.
+struct PathlossCache
+{
+    PartitionData*   partitionData; // partition owning the cache
+    double           resolution;    // position quantization, 0 if exact
+    std::string      fileName;      // cache file, empty if not saved
+    std::string      signature;     // models and terrain of the scenario
+    UInt64           numHits;
+    UInt64           numMisses;
+    PathlossCacheMap entries;
+
+    PathlossCache(size_t maxEntries) : entries(maxEntries) {}
+};
+
+/// Creates the partition's pathloss cache if PROPAGATION-PATHLOSS-CACHE
+/// is YES, and loads the entries of PROPAGATION-PATHLOSS-CACHE-FILE if
+/// the file exists.  Does nothing if the partition already has its own
+/// cache.
+///
+/// \param partitionData  Pointer to the partition
+/// \param nodeInput  Pointer to node input
+void PathlossCacheInitialize(
+    PartitionData* partitionData,
+    const NodeInput* nodeInput);
+
+/// Returns whether pathloss values of the model are cached.  Only
+/// models whose pathloss depends on nothing but the key are.
+///
+/// \param pathlossModel  pathloss model of the channel
+bool PathlossCacheApplies(PathlossModel pathlossModel);
+
+/// Builds the cache key for a pair
+///
+/// \param cache  the partition's cache
+/// \param txNodeId  transmitting node
+/// \param rxNodeId  receiving node
+/// \param channelIndex  channel
+/// \param wavelength  wavelength of the signal
+/// \param txAntennaHeight  transmitting antenna height
+/// \param rxAntennaHeight  receiving antenna height
+/// \param pathProfile  path, for the node positions
+/// \param key  receives the key
+void PathlossCacheMakeKey(
+    const PathlossCache* cache,
+    NodeId txNodeId,
+    NodeId rxNodeId,
+    int channelIndex,
+    double wavelength,
+    float txAntennaHeight,
+    float rxAntennaHeight,
+    const PropPathProfile* pathProfile,
+    PathlossCacheKey* key);
+
+/// Looks up a pathloss value and counts the hit or miss
+///
+/// \param cache  the partition's cache
+/// \param key  key built by PathlossCacheMakeKey
+/// \param pathloss_dB  set if the key is found
+///
+/// \return true if found
+bool PathlossCacheFind(
+    PathlossCache* cache,
+    const PathlossCacheKey& key,
+    double* pathloss_dB);
+
+/// Adds a pathloss value not yet in the cache
+///
+/// \param cache  the partition's cache
+/// \param key  key built by PathlossCacheMakeKey
+/// \param pathloss_dB  pathloss for the key
+void PathlossCacheInsert(
+    PathlossCache* cache,
+    const PathlossCacheKey& key,
+    double pathloss_dB);
+
+/// Prints the hit statistics, saves the cache file if one is
+/// configured and deletes the partition's cache.
+///
+/// \param partitionData  Pointer to the partition
+void PathlossCacheFinalize(PartitionData* partitionData);
+
+#endif /*PROP_PATHLOSS_CACHE_H*/
@@ -0,0 +1,198 @@
+// Copyright (c) 2001-2015, SCALABLE Network Technologies, Inc.  All Rights Reserved.
+//                          600 Corporate Pointe
+//                          Suite 1200
+//                          Culver City, CA 90230
+//                          info@scalable-networks.com
+//
+// This source code is licensed, not sold, and is subject to a written
+// license agreement.  Among other things, no portion of this source
+// code may be copied, transmitted, disclosed, displayed, distributed,
+// translated, used as the basis for a derivative work, or used, in
+// whole or in part, for any program or purpose other than its intended
+// use in compliance with the license agreement as part of the QualNet
+// software.  This source code and certain of the algorithms contained
+// within it are confidential trade secrets of Scalable Network
+// Technologies, Inc. and may not be used as the basis for any other
+// software, hardware, product or service.
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#include "api.h"
+#include "partition.h"
+#include "prop_spatial_index.h"
+
+// Returns the cell number of a coordinate
+static
+Int32 PropSpatialIndexCell(double coordinate, double cellSize)
+{
+    return (Int32) floor(coordinate / cellSize);
+}
+
+// PROP_ShadowingApplies for a channel's profile, which is known before
+// the nodes are
+static
+bool PropSpatialIndexShadowingApplies(const PropProfile* propProfile)
+{
+    if (propProfile->pathlossModel == FREE_SPACE ||
+        propProfile->pathlossModel == TWO_RAY)
+    {
+        return true;
+    }
+    if (propProfile->pathlossModel == PL_OPAR ||
+        propProfile->pathlossModel == PL_OPAR_PROP)
+    {
+        return propProfile->pathlossModelPrimary == FREE_SPACE ||
+               propProfile->pathlossModelPrimary == TWO_RAY;
+    }
+    return false;
+}
+
+void PropSpatialIndexInitialize(
+    PartitionData* partitionData,
+    const NodeInput* nodeInput)
+{
+    BOOL wasFound;
+    BOOL enabled = FALSE;
+    double minCellSize = 0.0;
+    PropSpatialIndex* index;
+    int i;
+
+    // The partition may hold a copy of another partition's pointer
+    if (partitionData->propSpatialIndex != NULL &&
+        partitionData->propSpatialIndex->partitionData == partitionData)
+    {
+        return;
+    }
+    partitionData->propSpatialIndex = NULL;
+
+    IO_ReadBool(
+        ANY_NODEID,
+        ANY_ADDRESS,
+        nodeInput,
+        "PROPAGATION-SPATIAL-INDEX",
+        &wasFound,
+        &enabled);
+
+    if (!wasFound || !enabled ||
+        partitionData->numChannels == 0 ||
+        partitionData->terrainData == NULL ||
+        partitionData->terrainData->getCoordinateSystem() != CARTESIAN)
+    {
+        return;
+    }
+
+#ifdef AGI_INTERFACE
+    // Positions and links come from STK
+    if (partitionData->isAgiInterfaceEnabled) {
+        return;
+    }
+#endif
+
+    IO_ReadDouble(
+        ANY_NODEID,
+        ANY_ADDRESS,
+        nodeInput,
+        "PROPAGATION-SPATIAL-INDEX-CELL-SIZE",
+        &wasFound,
+        &minCellSize);
+
+    if (wasFound && minCellSize <= 0.0) {
+        ERROR_ReportErrorArgs("PROPAGATION-SPATIAL-INDEX-CELL-SIZE must be "
+                              "greater than 0, not %f", minCellSize);
+    }
+
+    index = new PropSpatialIndex[partitionData->numChannels];
+
+    for (i = 0; i < partitionData->numChannels; i++) {
+        PropProfile* propProfile = partitionData->propChannel[i].profile;
+
+        index[i].partitionData = partitionData;
+        index[i].cellSize = 0.0;
+        index[i].numRejected = 0;
+
+        // The pathloss matrix models do not depend on the distance.
+        // Where shadowing applies it is added to the out of range
+        // pathloss, which then need not be dropped, so those channels
+        // are left to the default calculation.
+        if (propProfile->propMaxDistance > 0.1 &&
+            propProfile->pathlossModel != PL_MATRIX &&
+            propProfile->pathlossModel != FLAT_BINNING &&
+            !PropSpatialIndexShadowingApplies(propProfile))
+        {
+            index[i].cellSize = MAX(propProfile->propMaxDistance +
+                                        PROP_SPATIAL_INDEX_MARGIN,
+                                    minCellSize);
+        }
+    }
+
+    partitionData->propSpatialIndex = index;
+}
+
+bool PropSpatialIndexOutOfRange(
+    PartitionData* partitionData,
+    int channelIndex,
+    const Coordinates& txPosition,
+    const Coordinates& rxPosition)
+{
+    PropSpatialIndex* index = partitionData->propSpatialIndex;
+    double cellSize;
+    Int32 cellX;
+    Int32 cellY;
+
+    if (index == NULL || index[channelIndex].cellSize == 0.0) {
+        return false;
+    }
+
+    index = &(index[channelIndex]);
+    cellSize = index->cellSize;
+
+    cellX = PropSpatialIndexCell(txPosition.common.c1, cellSize) -
+            PropSpatialIndexCell(rxPosition.common.c1, cellSize);
+    cellY = PropSpatialIndexCell(txPosition.common.c2, cellSize) -
+            PropSpatialIndexCell(rxPosition.common.c2, cellSize);
+
+    // Two cells apart means more than a cell size apart
+    if (cellX > 1 || cellX < -1 || cellY > 1 || cellY < -1) {
+        index->numRejected++;
+        return true;
+    }
+
+    return false;
+}
+
+void PropSpatialIndexFinalize(PartitionData* partitionData)
+{
+    PropSpatialIndex* index = partitionData->propSpatialIndex;
+    Node* node = partitionData->firstNode;
+    UInt64 numRejected = 0;
+    bool indexed = false;
+    int i;
+
+    if (index == NULL || index->partitionData != partitionData) {
+        return;
+    }
+
+    for (i = 0; i < partitionData->numChannels; i++) {
+        if (index[i].cellSize > 0.0) {
+            indexed = true;
+            numRejected += index[i].numRejected;
+        }
+    }
+
+    if (node != NULL && indexed) {
+        IO_PrintStat(
+            node,
+            "Physical",
+            "Propagation",
+            ANY_DEST,
+            -1,
+            "Receivers skipped by spatial index = %" TYPES_64BITFMT "u",
+            numRejected);
+    }
+
+    delete [] index;
+    partitionData->propSpatialIndex = NULL;
+}
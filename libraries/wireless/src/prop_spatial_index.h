@@ -0,0 +1,87 @@
+// Copyright (c) 2001-2015, SCALABLE Network Technologies, Inc.  All Rights Reserved.
+//                          600 Corporate Pointe
+//                          Suite 1200
+//                          Culver City, CA 90230
+//                          info@scalable-networks.com
+//
+// This source code is licensed, not sold, and is subject to a written
+// license agreement.  Among other things, no portion of this source
+// code may be copied, transmitted, disclosed, displayed, distributed,
+// translated, used as the basis for a derivative work, or used, in
+// whole or in part, for any program or purpose other than its intended
+// use in compliance with the license agreement as part of the QualNet
+// software.  This source code and certain of the algorithms contained
+// within it are confidential trade secrets of Scalable Network
+// Technologies, Inc. and may not be used as the basis for any other
+// software, hardware, product or service.
+
+#ifndef PROP_SPATIAL_INDEX_H
+#define PROP_SPATIAL_INDEX_H
+
+/// \file This file defines the uniform grid cells of a propagation
+/// channel, used to drop receivers that are certainly out of
+/// propagation range from the cells of the two positions alone.
+
+/// Added to PROPAGATION-MAX-DISTANCE to get the smallest cell size, so
+/// that rounding in the cell computation never puts two nodes within
+/// range two cells apart.  In meters.
+#define PROP_SPATIAL_INDEX_MARGIN       1.0
+
+/// \brief Grid cells of one channel
+///
+/// A channel is divided into cells when it has a
+/// PROPAGATION-MAX-DISTANCE and the terrain is cartesian.  The cells
+/// are squares at least as large as the distance, so every receiver in
+/// range of a transmitter is in the transmitter's cell or in one of the
+/// eight around it.  The cell of a node is computed from its position
+/// when it is needed, so nothing has to be kept up to date as nodes
+/// move.
+///
+/// Receivers are not bucketed by cell: the loop over the receivers of
+/// a signal is in PROP_ProcessEvent, in the prebuilt library, and calls
+/// PROP_CalculateRxPowerAndPropagationDelay for each of them.  The
+/// index only makes that call cheap for a receiver out of range.
+/// Channels where shadowing applies are not indexed.
+struct PropSpatialIndex
+{
+    PartitionData*     partitionData; // partition owning the index
+    double             cellSize;      // 0 if the channel is not indexed
+    UInt64             numRejected;   // pairs skipped as out of range
+};
+
+/// Creates the partition's spatial index if PROPAGATION-SPATIAL-INDEX
+/// is YES.  The cell size of a channel is its PROPAGATION-MAX-DISTANCE
+/// plus PROP_SPATIAL_INDEX_MARGIN, or PROPAGATION-SPATIAL-INDEX-CELL-SIZE
+/// if that is larger.  Does nothing if the partition already has its
+/// own index.
+///
+/// \param partitionData  Pointer to the partition
+/// \param nodeInput  Pointer to node input
+void PropSpatialIndexInitialize(
+    PartitionData* partitionData,
+    const NodeInput* nodeInput);
+
+/// Returns whether a receiver is certainly beyond the
+/// PROPAGATION-MAX-DISTANCE of the channel, from the cells of the two
+/// positions alone, and counts it if so.  A pair for which this returns
+/// false may still be out of range.
+///
+/// \param partitionData  partition computing the pair
+/// \param channelIndex  channel
+/// \param txPosition  position of the transmitter
+/// \param rxPosition  position of the receiver
+///
+/// \return true if the pair is out of range
+bool PropSpatialIndexOutOfRange(
+    PartitionData* partitionData,
+    int channelIndex,
+    const Coordinates& txPosition,
+    const Coordinates& rxPosition);
+
+/// Prints the number of receivers skipped and deletes the partition's
+/// index.
+///
+/// \param partitionData  Pointer to the partition
+void PropSpatialIndexFinalize(PartitionData* partitionData);
+
+#endif /*PROP_SPATIAL_INDEX_H*/
@@ -30,6 +30,11 @@
 #include <math.h>
 #include <limits>
 
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define PROP_BATCH_SSE2
+#endif
+
 //#include "acoustics.h"
 
 #include "api.h"
@@ -42,6 +47,8 @@
 #include "antenna.h"
 #include "prop_itm.h"
 #include "prop_plmatrix.h"
+#include "prop_pathloss_cache.h"
+#include "prop_spatial_index.h"
 
 #ifdef ADDON_DB
 #include "dbapi.h"
@@ -241,41 +248,318 @@ double PROP_PathlossOpar(double distance,
 }
 
 
-void PROP_CalculatePathloss(
+// Frees the receiver arrays of a batch
+static
+void PropBatchFree(PropBatch* batch)
+{
+    if (batch->capacity == 0) {
+        return;
+    }
+
+    MEM_free(batch->rxNode);
+    MEM_free(batch->rxX);
+    MEM_free(batch->rxY);
+    MEM_free(batch->rxZ);
+    MEM_free(batch->rxAntennaHeight);
+    MEM_free(batch->hashKey);
+    MEM_free(batch->hashIndex);
+    MEM_free(batch->distance);
+    MEM_free(batch->pathloss_dB);
+    MEM_free(batch->fadingStretchingFactor);
+    MEM_free(batch->fading_dB);
+    batch->capacity = 0;
+}
+
+// Allocates room for numNodes receivers in a batch
+static
+void PropBatchReserve(PropBatch* batch, int numNodes)
+{
+    if (numNodes <= batch->capacity) {
+        return;
+    }
+
+    PropBatchFree(batch);
+
+    batch->capacity = numNodes;
+    batch->rxNode = (Node**) MEM_malloc(sizeof(Node*) * numNodes);
+    batch->rxX = (double*) MEM_malloc(sizeof(double) * numNodes);
+    batch->rxY = (double*) MEM_malloc(sizeof(double) * numNodes);
+    batch->rxZ = (double*) MEM_malloc(sizeof(double) * numNodes);
+    batch->rxAntennaHeight = (float*) MEM_malloc(sizeof(float) * numNodes);
+    batch->distance = (double*) MEM_malloc(sizeof(double) * numNodes);
+    batch->pathloss_dB = (double*) MEM_malloc(sizeof(double) * numNodes);
+    batch->fadingStretchingFactor =
+        (double*) MEM_malloc(sizeof(double) * numNodes);
+    batch->fading_dB = (float*) MEM_malloc(sizeof(float) * numNodes);
+
+    // At most half full, so probes stay short and always end
+    batch->hashSize = 1;
+    while (batch->hashSize < 2 * numNodes) {
+        batch->hashSize *= 2;
+    }
+    batch->hashKey = (NodeId*) MEM_malloc(sizeof(NodeId) * batch->hashSize);
+    batch->hashIndex = (int*) MEM_malloc(sizeof(int) * batch->hashSize);
+}
+
+static
+int PropBatchHash(const PropBatch* batch, NodeId nodeId)
+{
+    return (int)(((UInt32)nodeId * 2654435761U) >> 7) &
+           (batch->hashSize - 1);
+}
+
+// Returns the receiver index of nodeId, -1 if it is not in the batch
+static
+int PropBatchFind(const PropBatch* batch, NodeId nodeId)
+{
+    int h = PropBatchHash(batch, nodeId);
+
+    while (batch->hashIndex[h] >= 0) {
+        if (batch->hashKey[h] == nodeId) {
+            return batch->hashIndex[h];
+        }
+        h = (h + 1) & (batch->hashSize - 1);
+    }
+    return -1;
+}
+
+// Returns the batch for the channel, with the partition's receivers
+// gathered at the current time, or NULL if the channel is computed a
+// pair at a time.
+static
+PropBatch* PropBatchGet(PartitionData* partitionData, int channelIndex)
+{
+    PropChannel* propChannel = &(partitionData->propChannel[channelIndex]);
+    PropBatch* batch;
+    clocktype now = partitionData->getGlobalTime();
+    int i;
+    int n = 0;
+
+    if (partitionData->propBatch == NULL ||
+        propChannel->numNodes < PROP_BATCH_MIN_RECEIVERS)
+    {
+        return NULL;
+    }
+
+    batch = &(partitionData->propBatch[channelIndex]);
+
+    if (batch->rxTime == now) {
+        return batch;
+    }
+
+    PropBatchReserve(batch, propChannel->numNodes);
+    memset(batch->hashIndex, 0xff, sizeof(int) * batch->hashSize);
+
+    for (i = 0; i < propChannel->numNodes; i++) {
+        Node* rxNode = propChannel->nodeList[i];
+        Coordinates position;
+        int phyIndex;
+        int h;
+
+        // Receivers in other partitions are computed there
+        if (rxNode->partitionData != partitionData) {
+            continue;
+        }
+
+        for (phyIndex = 0; phyIndex < rxNode->numberPhys; phyIndex++) {
+            if (PHY_CanListenToChannel(rxNode, phyIndex, channelIndex)) {
+                break;
+            }
+        }
+        if (phyIndex == rxNode->numberPhys) {
+            continue;
+        }
+
+        MOBILITY_ReturnCoordinates(rxNode, &position);
+
+        batch->rxNode[n] = rxNode;
+        batch->rxX[n] = position.common.c1;
+        batch->rxY[n] = position.common.c2;
+        batch->rxZ[n] = position.common.c3;
+        batch->rxAntennaHeight[n] = ANTENNA_ReturnHeight(rxNode, phyIndex);
+
+        h = PropBatchHash(batch, rxNode->nodeId);
+        while (batch->hashIndex[h] >= 0) {
+            h = (h + 1) & (batch->hashSize - 1);
+        }
+        batch->hashKey[h] = rxNode->nodeId;
+        batch->hashIndex[h] = n;
+
+        n++;
+    }
+
+    batch->numReceivers = n;
+    batch->rxTime = now;
+    batch->pathlossValid = FALSE;
+    batch->fadingValid = FALSE;
+
+    return batch;
+}
+
+// Computes the distance and free space or two-ray pathloss of every
+// receiver in the batch.  Each value goes through the same operations
+// in the same order as COORD_CalcDistance and PROP_PathlossFreeSpace
+// / PROP_PathlossTwoRay; only the log10 is left scalar.
+static
+void PropBatchComputePathloss(PropBatch* batch, BOOL twoRay)
+{
+    const int n = batch->numReceivers;
+    double* value = batch->pathloss_dB;
+    int i = 0;
+
+    if (twoRay) {
+        // Antenna height product, in float as PROP_PathlossTwoRay does
+        const float txPlatformHeight =
+            (float)(batch->txZ + batch->txAntennaHeight);
+
+        for (i = 0; i < n; i++) {
+            value[i] = txPlatformHeight *
+                (float)(batch->rxZ[i] + batch->rxAntennaHeight[i]);
+        }
+        i = 0;
+    }
+
+#ifdef PROP_BATCH_SSE2
+    const __m128d txX = _mm_set1_pd(batch->txX);
+    const __m128d txY = _mm_set1_pd(batch->txY);
+    const __m128d txZ = _mm_set1_pd(batch->txZ);
+    const __m128d fourPi = _mm_set1_pd(4.0 * PI);
+    const __m128d wavelength = _mm_set1_pd(batch->wavelength);
+
+    for (; i + 2 <= n; i += 2) {
+        __m128d dx = _mm_sub_pd(_mm_loadu_pd(batch->rxX + i), txX);
+        __m128d dy = _mm_sub_pd(_mm_loadu_pd(batch->rxY + i), txY);
+        __m128d dz = _mm_sub_pd(_mm_loadu_pd(batch->rxZ + i), txZ);
+        __m128d distance =
+            _mm_sqrt_pd(_mm_add_pd(_mm_add_pd(_mm_mul_pd(dx, dx),
+                                              _mm_mul_pd(dy, dy)),
+                                   _mm_mul_pd(dz, dz)));
+        __m128d freeSpace =
+            _mm_div_pd(_mm_mul_pd(fourPi, distance), wavelength);
+
+        _mm_storeu_pd(batch->distance + i, distance);
+
+        if (twoRay) {
+            __m128d planeEarth =
+                _mm_div_pd(_mm_mul_pd(distance, distance),
+                           _mm_loadu_pd(value + i));
+            freeSpace = _mm_max_pd(planeEarth, freeSpace);
+        }
+        _mm_storeu_pd(value + i, freeSpace);
+    }
+#endif
+
+    for (; i < n; i++) {
+        double dx = batch->rxX[i] - batch->txX;
+        double dy = batch->rxY[i] - batch->txY;
+        double dz = batch->rxZ[i] - batch->txZ;
+        double distance = sqrt(dx * dx + dy * dy + dz * dz);
+        double freeSpace = 4.0 * PI * distance / batch->wavelength;
+
+        batch->distance[i] = distance;
+
+        if (twoRay) {
+            double planeEarth = distance * distance / value[i];
+
+            if (planeEarth > freeSpace) {
+                freeSpace = planeEarth;
+            }
+        }
+        value[i] = freeSpace;
+    }
+
+    for (i = 0; i < n; i++) {
+        value[i] = value[i] > 1.0 ? 20.0 * log10(value[i]) : 0.0;
+    }
+}
+
+// Looks up the free space or two-ray pathloss from the batch.  Returns
+// FALSE if the caller has to compute it.
+static
+BOOL PropBatchPathloss(
     Node* node,
-    NodeId txNodeId,
     NodeId rxNodeId,
     int channelIndex,
     double wavelength,
     float txAntennaHeight,
     float rxAntennaHeight,
-    PropPathProfile* pathProfile,
-    double* pathloss_dB,
-    bool /* forBinning */)
+    const PropPathProfile* pathProfile,
+    double* pathloss_dB)
 {
-    double txPlatformHeight;
-    double rxPlatformHeight;
-    TerrainData* terrainData = NODE_GetTerrainPtr(node);
-    PropProfile *propProfile = node->propChannel[channelIndex].profile;
+    PropProfile* propProfile = node->propChannel[channelIndex].profile;
+    const Coordinates& from = pathProfile->fromPosition;
+    const Coordinates& to = pathProfile->toPosition;
+    const BOOL twoRay = propProfile->pathlossModel == TWO_RAY;
+    PropBatch* batch;
+    int i;
 
-    if (DEBUG) {
-        printf("Calculating pathloss from node %d to node %d\n",
-               txNodeId, rxNodeId);
-    }
-    if (pathProfile->distance == 0.)
+    if ((propProfile->pathlossModel != FREE_SPACE && !twoRay) ||
+        NODE_GetTerrainPtr(node)->getCoordinateSystem() != CARTESIAN)
     {
-        *pathloss_dB = 0.;
-        return;
+        return FALSE;
     }
 
-    if (propProfile->propMaxDistance > 0.1 &&
-        pathProfile->distance > propProfile->propMaxDistance)
+    batch = PropBatchGet(node->partitionData, channelIndex);
+    if (batch == NULL) {
+        return FALSE;
+    }
+
+    if (batch->txX != from.common.c1 ||
+        batch->txY != from.common.c2 ||
+        batch->txZ != from.common.c3 ||
+        batch->txAntennaHeight != txAntennaHeight ||
+        batch->wavelength != wavelength)
     {
-        *pathloss_dB = NEGATIVE_PATHLOSS_dB;
+        // New transmitter: compute this pair alone, and the whole batch
+        // if it is asked for again
+        batch->txX = from.common.c1;
+        batch->txY = from.common.c2;
+        batch->txZ = from.common.c3;
+        batch->txAntennaHeight = txAntennaHeight;
+        batch->wavelength = wavelength;
+        batch->pathlossValid = FALSE;
+        return FALSE;
+    }
 
-        return;
+    if (!batch->pathlossValid) {
+        PropBatchComputePathloss(batch, twoRay);
+        batch->pathlossValid = TRUE;
     }
 
+    i = PropBatchFind(batch, rxNodeId);
+    if (i < 0 ||
+        batch->distance[i] != pathProfile->distance ||
+        batch->rxX[i] != to.common.c1 ||
+        batch->rxY[i] != to.common.c2 ||
+        batch->rxZ[i] != to.common.c3 ||
+        (twoRay && batch->rxAntennaHeight[i] != rxAntennaHeight))
+    {
+        return FALSE;
+    }
+
+    *pathloss_dB = batch->pathloss_dB[i];
+    return TRUE;
+}
+
+
+// Computes the pathloss with the channel's pathloss model.  The
+// distance limits have been checked by PROP_CalculatePathloss.
+static
+void PropCalculateModelPathloss(
+    Node* node,
+    NodeId txNodeId,
+    NodeId rxNodeId,
+    int channelIndex,
+    double wavelength,
+    float txAntennaHeight,
+    float rxAntennaHeight,
+    PropPathProfile* pathProfile,
+    double* pathloss_dB)
+{
+    double txPlatformHeight;
+    double rxPlatformHeight;
+    TerrainData* terrainData = NODE_GetTerrainPtr(node);
+    PropProfile *propProfile = node->propChannel[channelIndex].profile;
 
     switch (propProfile->pathlossModel) {
         case FREE_SPACE:
@@ -1107,6 +1391,74 @@ void PROP_CalculatePathloss(
 }
 
 
+void PROP_CalculatePathloss(
+    Node* node,
+    NodeId txNodeId,
+    NodeId rxNodeId,
+    int channelIndex,
+    double wavelength,
+    float txAntennaHeight,
+    float rxAntennaHeight,
+    PropPathProfile* pathProfile,
+    double* pathloss_dB,
+    bool forBinning)
+{
+    PropProfile *propProfile = node->propChannel[channelIndex].profile;
+    PathlossCache* cache = node->partitionData->pathlossCache;
+    PathlossCacheKey key;
+
+    if (DEBUG) {
+        printf("Calculating pathloss from node %d to node %d\n",
+               txNodeId, rxNodeId);
+    }
+    if (pathProfile->distance == 0.)
+    {
+        *pathloss_dB = 0.;
+        return;
+    }
+
+    if (propProfile->propMaxDistance > 0.1 &&
+        pathProfile->distance > propProfile->propMaxDistance)
+    {
+        *pathloss_dB = NEGATIVE_PATHLOSS_dB;
+
+        return;
+    }
+
+    if (!forBinning &&
+        PropBatchPathloss(node, rxNodeId, channelIndex, wavelength,
+                          txAntennaHeight, rxAntennaHeight,
+                          pathProfile, pathloss_dB))
+    {
+        return;
+    }
+
+    if (!forBinning && cache != NULL &&
+        PathlossCacheApplies(propProfile->pathlossModel))
+    {
+        PathlossCacheMakeKey(cache, txNodeId, rxNodeId, channelIndex,
+                             wavelength, txAntennaHeight, rxAntennaHeight,
+                             pathProfile, &key);
+
+        if (PathlossCacheFind(cache, key, pathloss_dB)) {
+            return;
+        }
+
+        PropCalculateModelPathloss(node, txNodeId, rxNodeId, channelIndex,
+                                   wavelength, txAntennaHeight,
+                                   rxAntennaHeight, pathProfile,
+                                   pathloss_dB);
+
+        PathlossCacheInsert(cache, key, *pathloss_dB);
+        return;
+    }
+
+    PropCalculateModelPathloss(node, txNodeId, rxNodeId, channelIndex,
+                               wavelength, txAntennaHeight, rxAntennaHeight,
+                               pathProfile, pathloss_dB);
+}
+
+
 
 //
 // RandomizeGaussianComponentStartingPoint() returns an integer in [0, arraySize)
@@ -1133,6 +1485,152 @@ int RandomizeGaussianComponentStartingPoint(
 
 
 
+// Returns the index into the gaussian components for the link from
+// txNodeId to rxNode at currentTime
+static
+int PropFadingIndex(
+    NodeId txNodeId,
+    Node* rxNode,
+    int channelIndex,
+    clocktype currentTime,
+    int numGaussianComponents)
+{
+    int arrayIndex;
+    double arrayIndexInDouble;
+
+    const int startingPoint =
+        RandomizeGaussianComponentStartingPoint(
+            txNodeId, rxNode->nodeId, channelIndex,
+            numGaussianComponents);
+
+    arrayIndexInDouble =
+        rxNode->propData[channelIndex].fadingStretchingFactor *
+        (double)currentTime;
+
+    arrayIndexInDouble -=
+        (double)numGaussianComponents *
+        floor(arrayIndexInDouble / (double)numGaussianComponents);
+
+    arrayIndex =
+        (RoundToInt(arrayIndexInDouble) + startingPoint) %
+        numGaussianComponents;
+
+    return arrayIndex;
+}
+
+// Computes the Ricean fading in dB of gaussian component arrayIndex
+static
+float PropComputeRiceanFading(
+    const PropProfile* propProfile,
+    const PropProfile* propProfile0,
+    int arrayIndex)
+{
+    double value1, value2;
+    const float kFactor = (float)propProfile->kFactor;
+
+    value1 = propProfile0->gaussianComponent1[arrayIndex] +
+        sqrt(2.0 * kFactor);
+    value2 = propProfile0->gaussianComponent2[arrayIndex];
+
+    return
+        (float)IN_DB((value1 * value1 + value2 * value2) / (2.0 * (kFactor + 1)));
+}
+
+// Returns the Ricean fading in dB of gaussian component arrayIndex,
+// from the profile's table unless the K factor has changed since it
+// was built
+static
+float PropRiceanFading(
+    const PropProfile* propProfile,
+    const PropProfile* propProfile0,
+    int arrayIndex)
+{
+    if (propProfile->riceanFading_dB != NULL &&
+        propProfile->riceanTableKFactor == propProfile->kFactor)
+    {
+        return propProfile->riceanFading_dB[arrayIndex];
+    }
+
+    return PropComputeRiceanFading(propProfile, propProfile0, arrayIndex);
+}
+
+// Builds the profile's table of Ricean fading, one entry per gaussian
+// component
+static
+void PropBuildRiceanFadingTable(
+    PropProfile* propProfile,
+    const PropProfile* propProfile0)
+{
+    const int numGaussianComponents = propProfile0->numGaussianComponents;
+    int i;
+
+    propProfile->riceanFading_dB =
+        (float*) MEM_malloc(sizeof(float) * numGaussianComponents);
+    propProfile->riceanTableKFactor = propProfile->kFactor;
+
+    for (i = 0; i < numGaussianComponents; i++) {
+        propProfile->riceanFading_dB[i] =
+            PropComputeRiceanFading(propProfile, propProfile0, i);
+    }
+}
+
+// Looks up the Ricean fading from the batch.  Returns FALSE if the
+// caller has to compute it.
+static
+BOOL PropBatchFading(
+    Message* signalMsg,
+    PropTxInfo* propTxInfo,
+    Node* node2,
+    int channelIndex,
+    clocktype currentTime,
+    float* fading_dB)
+{
+    PropBatch* batch = PropBatchGet(node2->partitionData, channelIndex);
+    int i;
+
+    if (batch == NULL) {
+        return FALSE;
+    }
+
+    if (batch->txNodeId != (NodeId)propTxInfo->txNodeId ||
+        batch->fadingTime != currentTime)
+    {
+        // New transmitter: compute this receiver alone, and the whole
+        // batch if it is asked for again
+        batch->txNodeId = propTxInfo->txNodeId;
+        batch->fadingTime = currentTime;
+        batch->fadingValid = FALSE;
+        return FALSE;
+    }
+
+    if (!batch->fadingValid) {
+        PROP_CalculateFadingBatch(signalMsg,
+                                  propTxInfo,
+                                  batch->rxNode,
+                                  batch->numReceivers,
+                                  channelIndex,
+                                  currentTime,
+                                  batch->fading_dB);
+        for (i = 0; i < batch->numReceivers; i++) {
+            batch->fadingStretchingFactor[i] =
+                batch->rxNode[i]->propData[channelIndex].fadingStretchingFactor;
+        }
+        batch->fadingValid = TRUE;
+    }
+
+    i = PropBatchFind(batch, node2->nodeId);
+    if (i < 0 ||
+        batch->fadingStretchingFactor[i] !=
+            node2->propData[channelIndex].fadingStretchingFactor)
+    {
+        return FALSE;
+    }
+
+    *fading_dB = batch->fading_dB[i];
+    return TRUE;
+}
+
+
 // assuming here that the receiving node (node 2) is always local, while transmitter might be remote.
 // also assuming that fading stretching factor is the same for both nodes
 void PROP_CalculateFading(
@@ -1163,15 +1661,6 @@ void PROP_CalculateFading(
 
     if (propProfile->fadingModel == RICEAN) {
         int arrayIndex;
-        double arrayIndexInDouble;
-        double value1, value2;
-
-        const float kFactor = (float)propProfile->kFactor;
-        const int numGaussianComponents = propProfile0->numGaussianComponents;
-        const int startingPoint =
-            RandomizeGaussianComponentStartingPoint(
-                propTxInfo->txNodeId, node2->nodeId, channelIndex,
-                numGaussianComponents);
 
         if (propProfile->motionEffectsEnabled){
 
@@ -1179,31 +1668,79 @@ void PROP_CalculateFading(
                                                     node2,
                                                     channelIndex);
         }
-
-        arrayIndexInDouble =
-            node2->propData[channelIndex].fadingStretchingFactor *
-            (double)currentTime;
-
-        arrayIndexInDouble -=
-            (double)numGaussianComponents *
-            floor(arrayIndexInDouble / (double)numGaussianComponents);
+        else if (PropBatchFading(signalMsg, propTxInfo, node2, channelIndex,
+                                 currentTime, fading_dB))
+        {
+            return;
+        }
 
         arrayIndex =
-            (RoundToInt(arrayIndexInDouble) + startingPoint) %
-            numGaussianComponents;
-
-        value1 = propProfile0->gaussianComponent1[arrayIndex] +
-            sqrt(2.0 * kFactor);
-        value2 = propProfile0->gaussianComponent2[arrayIndex];
+            PropFadingIndex(propTxInfo->txNodeId, node2, channelIndex,
+                            currentTime,
+                            propProfile0->numGaussianComponents);
 
-        *fading_dB =
-            (float)IN_DB((value1 * value1 + value2 * value2) / (2.0 * (kFactor + 1)));
+        *fading_dB = PropRiceanFading(propProfile, propProfile0, arrayIndex);
     }
     else {
         *fading_dB = 0.0;
     }
 }
 
+// Fading from one transmitter to several receivers
+void PROP_CalculateFadingBatch(
+    Message* signalMsg,
+    PropTxInfo* propTxInfo,
+    Node** rxNodes,
+    int numNodes,
+    int channelIndex,
+    clocktype currentTime,
+    float* fading_dB)
+{
+    PropChannel* propChannel;
+    PropProfile* propProfile;
+    PropProfile* propProfile0;
+    int i;
+
+    if (numNodes == 0) {
+        return;
+    }
+
+    propChannel = rxNodes[0]->partitionData->propChannel;
+    propProfile = propChannel[channelIndex].profile;
+    propProfile0 = propChannel[0].profile;
+
+#ifdef LTE_LIB
+    if (propProfile->fadingModel == RICEAN &&
+        MESSAGE_ReturnInfo(signalMsg, INFO_TYPE_LtePhyTxInfo) != NULL)
+    {
+        memset(fading_dB, 0, sizeof(float) * numNodes);
+        return;
+    }
+#endif // LTE_LIB
+
+    if (propProfile->fadingModel != RICEAN) {
+        memset(fading_dB, 0, sizeof(float) * numNodes);
+        return;
+    }
+
+    for (i = 0; i < numNodes; i++) {
+        int arrayIndex;
+
+        if (propProfile->motionEffectsEnabled) {
+            PROP_MotionObtainfadingStretchingFactor(propTxInfo,
+                                                    rxNodes[i],
+                                                    channelIndex);
+        }
+
+        arrayIndex =
+            PropFadingIndex(propTxInfo->txNodeId, rxNodes[i], channelIndex,
+                            currentTime,
+                            propProfile0->numGaussianComponents);
+
+        fading_dB[i] = PropRiceanFading(propProfile, propProfile0, arrayIndex);
+    }
+}
+
 // Returns true if shadowing applies to the pathloss calculation.
 bool PROP_ShadowingApplies(
     Node *node,
@@ -1246,6 +1783,111 @@ bool PROP_CalculateShadowing(
     return false;
 }
 
+// Returns the gain of an omnidirectional antenna, in dBi.  Returns
+// false for other antennas, whose gain is not bounded here.
+static
+bool PropOmnidirectionalGain(Node* node, int phyIndex, double* gain_dBi)
+{
+    PhyData* phyData = node->phyData[phyIndex];
+
+    if (phyData->antennaData == NULL ||
+        phyData->antennaData->antennaModelType != ANTENNA_OMNIDIRECTIONAL)
+    {
+        return false;
+    }
+
+    *gain_dBi = ((AntennaOmnidirectional*)
+                    phyData->antennaData->antennaVar)->antennaGain_dB;
+    return true;
+}
+
+// Returns whether a receiver can be skipped under PROPAGATION-CULLING:
+// even with free space pathloss less the two-ray gain, both antenna
+// gains and no system loss, the signal would arrive more than the
+// culling margin below the receiver's noise floor.  Shadowing and
+// fading gains, and any model with less pathloss than that, must fit
+// in the margin.
+//
+// A skipped receiver draws the same shadowing samples as the default
+// calculation would, so that its later signals are unchanged.
+static
+bool PropCullReceiver(
+    int channelIndex,
+    PropChannel* propChannel,
+    PropTxInfo* propTxInfo,
+    Node* txNode,
+    Node* rxNode,
+    const Coordinates& rxPosition)
+{
+    PropProfile* propProfile = propChannel->profile;
+    double distance;
+    double txGain_dBi;
+    double rxGain_dBi;
+    double bandwidth;
+    double rxPower_dBm;
+    double shadowing_dB;
+    int phyIndex;
+
+    if (!propProfile->cullingEnabled ||
+        propProfile->pathlossModel == PL_MATRIX ||
+        propProfile->pathlossModel == FLAT_BINNING ||
+        txNode->nodeId == rxNode->nodeId)
+    {
+        return false;
+    }
+
+    for (phyIndex = 0; phyIndex < rxNode->numberPhys; phyIndex++) {
+        if (PHY_CanListenToChannel(rxNode, phyIndex, channelIndex)) {
+            break;
+        }
+    }
+    if (phyIndex == rxNode->numberPhys) {
+        return false;
+    }
+
+    bandwidth = PHY_GetBandwidth(rxNode, phyIndex);
+    if (bandwidth <= 0.0 ||
+        rxNode->phyData[phyIndex]->noise_mW_hz <= 0.0 ||
+        !PropOmnidirectionalGain(txNode, propTxInfo->phyIndex,
+                                 &txGain_dBi) ||
+        !PropOmnidirectionalGain(rxNode, phyIndex, &rxGain_dBi))
+    {
+        return false;
+    }
+
+    COORD_CalcDistance(
+        NODE_GetTerrainPtr(rxNode)->getCoordinateSystem(),
+        &(propTxInfo->position),
+        &rxPosition,
+        &distance);
+
+    rxPower_dBm = propTxInfo->txPower_dBm + txGain_dBi + rxGain_dBi -
+                  (PROP_PathlossFreeSpace(distance, propProfile->wavelength)
+                   - PROP_TWO_RAY_MAX_GAIN_dB);
+
+    if (rxPower_dBm >=
+            IN_DB(rxNode->phyData[phyIndex]->noise_mW_hz * bandwidth) -
+            propProfile->cullingMargin_dB)
+    {
+        return false;
+    }
+
+    // One sample with the pathloss, and one more unless the pair is
+    // beyond PROPAGATION-MAX-DISTANCE and stays dropped
+    if (PROP_CalculateShadowing(rxNode, channelIndex, &shadowing_dB)) {
+        if (!(propProfile->propMaxDistance > 0.1 &&
+              distance > propProfile->propMaxDistance &&
+              NEGATIVE_PATHLOSS_dB + shadowing_dB < 0.0))
+        {
+            PROP_CalculateShadowing(rxNode, channelIndex, &shadowing_dB);
+        }
+    }
+
+    rxNode->partitionData->propSignalsCulled[channelIndex]
+        [rxNode->nodeIndex]++;
+    return true;
+}
+
 // This function will be called by QualNet wireless
 // propagation code to calculate rxPower and prop delay
 // for a specific signal from a specific tx node to
@@ -1298,6 +1940,50 @@ BOOL PROP_CalculateRxPowerAndPropagationDelay(
     else
 #endif
     {
+        PropSpatialIndex* spatialIndex =
+            rxNode->partitionData->propSpatialIndex;
+        bool indexed = spatialIndex != NULL &&
+                       spatialIndex[channelIndex].cellSize > 0.0;
+
+        // Without the spatial index or culling, which is the default,
+        // the pair goes straight to the default calculation.
+        if (indexed || propChannel->profile->cullingEnabled) {
+            Coordinates rxPosition;
+
+            MOBILITY_ReturnCoordinates(rxNode, &rxPosition);
+
+            if (indexed &&
+                PropSpatialIndexOutOfRange(rxNode->partitionData,
+                                           channelIndex,
+                                           propTxInfo->position,
+                                           rxPosition))
+            {
+                // Same outcome as a pathloss beyond
+                // PROPAGATION-MAX-DISTANCE
+                PHY_NotificationOfPacketDrop(
+                    rxNode,
+                    -1,
+                    channelIndex,
+                    msg,
+                    "Signal below Propagation Limit",
+                    0.0,
+                    0.0,
+                    0.0);
+
+                return FALSE;
+            }
+
+            if (PropCullReceiver(channelIndex,
+                                 propChannel,
+                                 propTxInfo,
+                                 txNode,
+                                 rxNode,
+                                 rxPosition))
+            {
+                return FALSE;
+            }
+        }
+
         return PROP_DefaultCalculateRxPowerAndPropagationDelay(
                    msg,
                    channelIndex,
@@ -1333,6 +2019,7 @@ void PROP_GlobalInit(PartitionData *partitionData, NodeInput *nodeInput) {
     Float64 propMaxDistance;
     double propCommunicationProximity;
     double propProfileUpdateRatio;
+    double cullingMargin_dB;
     int channelIndex = 0;
     int profileIndex = 0;
     int numChannels = 0;
@@ -1437,6 +2124,8 @@ void PROP_GlobalInit(PartitionData *partitionData, NodeInput *nodeInput) {
         propChannel[channelIndex].profile = new PropProfile;
         propProfile = propChannel[channelIndex].profile;
         propProfile->profileIndex = profileIndex;
+        propProfile->riceanFading_dB = NULL;
+        propProfile->riceanTableKFactor = 0.0;
         if (channelIndex == 0) {
             propProfile->numChannelsInMatrix = 0;
         }
@@ -1646,6 +2335,45 @@ void PROP_GlobalInit(PartitionData *partitionData, NodeInput *nodeInput) {
             propProfile->enableChannelOverlapCheck = FALSE;
         }
 
+        //
+        // Get the culling of receivers far below their noise floor.
+        //
+        wasEnabled = FALSE;
+
+        IO_ReadBoolInstance(
+            ANY_NODEID,
+            ANY_ADDRESS,
+            nodeInput,
+            "PROPAGATION-CULLING",
+            channelIndex,
+            TRUE,
+            &wasFound,
+            &wasEnabled);
+
+        propProfile->cullingEnabled = wasFound && wasEnabled;
+
+        IO_ReadDoubleInstance(
+            ANY_NODEID,
+            ANY_ADDRESS,
+            nodeInput,
+            "PROPAGATION-CULLING-MARGIN",
+            channelIndex,
+            TRUE,
+            &wasFound,
+            &cullingMargin_dB);
+
+        if (wasFound) {
+            if (cullingMargin_dB < 0.0) {
+                ERROR_ReportErrorArgs(
+                    "PROPAGATION-CULLING-MARGIN must not be negative, "
+                    "not %f", cullingMargin_dB);
+            }
+            propProfile->cullingMargin_dB = cullingMargin_dB;
+        }
+        else {
+            propProfile->cullingMargin_dB = PROP_DEFAULT_CULLING_MARGIN_dB;
+        }
+
         //
         // Set pathlossModel
         //
@@ -1960,6 +2688,7 @@ void PROP_GlobalInit(PartitionData *partitionData, NodeInput *nodeInput) {
         //
         // Set shadowingModel
         //
+        propProfile->shadowingZiggurat = FALSE;
         IO_ReadStringInstance(
             ANY_NODEID,
             ANY_ADDRESS,
@@ -2010,6 +2739,31 @@ void PROP_GlobalInit(PartitionData *partitionData, NodeInput *nodeInput) {
                     propProfile->shadowingMean_dB = PROP_DEFAULT_SHADOWING_MEAN_dB;
                 }
 
+                //
+                // Set the sampler of the LOGNORMAL model; LEGACY keeps
+                // the values of earlier versions
+                //
+                IO_ReadStringInstance(
+                    ANY_NODEID,
+                    ANY_ADDRESS,
+                    nodeInput,
+                    "PROPAGATION-SHADOWING-SAMPLER",
+                    channelIndex,
+                    TRUE,
+                    &wasFound,
+                    buf);
+
+                if (wasFound) {
+                    if (strcmp(buf, "ZIGGURAT") == 0) {
+                        propProfile->shadowingZiggurat = TRUE;
+                    }
+                    else if (strcmp(buf, "LEGACY") != 0) {
+                        ERROR_ReportErrorArgs(
+                            "Error: unknown PROPAGATION-SHADOWING-SAMPLER "
+                            "'%s'.\n", buf);
+                    }
+                }
+
             }
 
             if ((propProfile->pathlossModel != FREE_SPACE) &&
@@ -2219,6 +2973,16 @@ void PROP_GlobalInit(PartitionData *partitionData, NodeInput *nodeInput) {
         }
 
         assert(numItems == numGaussianComponents);
+
+        for (i = 0; i < channelIndex; i++) {
+            propProfile = propChannel[i].profile;
+
+            if (propProfile->fadingModel == RICEAN &&
+                propProfile->riceanFading_dB == NULL)
+            {
+                PropBuildRiceanFadingTable(propProfile, propProfile0);
+            }
+        }
     }
     else {
         propProfile0->baseDopplerFrequency = 0.0;
@@ -2232,6 +2996,42 @@ void PROP_GlobalInit(PartitionData *partitionData, NodeInput *nodeInput) {
     partitionData->numChannels = channelIndex;
     partitionData->numFixedChannels = numFixedChannels;
     partitionData->numProfiles = profileIndex;
+
+    PROP_BatchInit(partitionData, nodeInput);
+    PathlossCacheInitialize(partitionData, nodeInput);
+    PropSpatialIndexInitialize(partitionData, nodeInput);
+}
+
+// Allocates the per-channel propagation batches of the partition
+void PROP_BatchInit(PartitionData* partitionData, NodeInput* nodeInput)
+{
+    BOOL wasFound;
+    BOOL enabled = TRUE;
+    int i;
+
+    partitionData->propBatch = NULL;
+
+    IO_ReadBool(
+        ANY_NODEID,
+        ANY_ADDRESS,
+        nodeInput,
+        "PROPAGATION-BATCH",
+        &wasFound,
+        &enabled);
+
+    if ((wasFound && !enabled) || partitionData->numChannels == 0) {
+        return;
+    }
+
+    partitionData->propBatch = (PropBatch*)
+        MEM_malloc(sizeof(PropBatch) * partitionData->numChannels);
+    memset(partitionData->propBatch, 0,
+           sizeof(PropBatch) * partitionData->numChannels);
+
+    for (i = 0; i < partitionData->numChannels; i++) {
+        partitionData->propBatch[i].rxTime = -1;
+        partitionData->propBatch[i].fadingTime = -1;
+    }
 }
 
 /*
@@ -2253,6 +3053,61 @@ void PROP_PartitionInit(PartitionData *partitionData, NodeInput *nodeInput) {
     {
         PathlossMatrixPartitionInit(partitionData, nodeInput);
     }
+
+    // The batches, the pathloss cache and the spatial index are per
+    // partition as well
+    PROP_BatchInit(partitionData, nodeInput);
+    PathlossCacheInitialize(partitionData, nodeInput);
+    PropSpatialIndexInitialize(partitionData, nodeInput);
+}
+
+/*
+ * FUNCTION     PROP_PartitionFinalize
+ * PURPOSE      Finalize partition specific data structures.
+ *              This function is called from each partition, not from each node
+ *
+ * Parameters:
+ *     partitionData: Parition the action to be performed for
+ */
+void PROP_PartitionFinalize(PartitionData *partitionData) {
+    int i;
+
+    PathlossCacheFinalize(partitionData);
+    PropSpatialIndexFinalize(partitionData);
+
+    // The profiles are shared by all partitions and nodes, so their
+    // Ricean fading tables are freed once, by partition 0.
+    if (partitionData->partitionId == 0) {
+        for (i = 0; i < partitionData->numChannels; i++) {
+            PropProfile* propProfile =
+                partitionData->propChannel[i].profile;
+
+            if (propProfile != NULL &&
+                propProfile->riceanFading_dB != NULL)
+            {
+                MEM_free(propProfile->riceanFading_dB);
+                propProfile->riceanFading_dB = NULL;
+            }
+        }
+    }
+
+    if (partitionData->propBatch != NULL) {
+        for (i = 0; i < partitionData->numChannels; i++) {
+            PropBatchFree(&(partitionData->propBatch[i]));
+        }
+        MEM_free(partitionData->propBatch);
+        partitionData->propBatch = NULL;
+    }
+
+    if (partitionData->propSignalsCulled != NULL) {
+        for (i = 0; i < partitionData->numChannels; i++) {
+            if (partitionData->propSignalsCulled[i] != NULL) {
+                MEM_free(partitionData->propSignalsCulled[i]);
+            }
+        }
+        MEM_free(partitionData->propSignalsCulled);
+        partitionData->propSignalsCulled = NULL;
+    }
 }
 
 /*
@@ -2275,6 +3130,26 @@ void PROP_Init(Node *node, int channelIndex, NodeInput *nodeInput) {
     propData->rxSignalList = NULL;
     propData->propVar = NULL;
 
+    // The culling counters are kept by the partition, for all its nodes
+    if (propProfile->cullingEnabled) {
+        PartitionData* partitionData = node->partitionData;
+
+        if (partitionData->propSignalsCulled == NULL) {
+            partitionData->propSignalsCulled = (UInt64**)
+                MEM_malloc(sizeof(UInt64*) * partitionData->numChannels);
+            memset(partitionData->propSignalsCulled,
+                   0,
+                   sizeof(UInt64*) * partitionData->numChannels);
+        }
+        if (partitionData->propSignalsCulled[channelIndex] == NULL) {
+            partitionData->propSignalsCulled[channelIndex] = (UInt64*)
+                MEM_malloc(sizeof(UInt64) * partitionData->numNodes);
+            memset(partitionData->propSignalsCulled[channelIndex],
+                   0,
+                   sizeof(UInt64) * partitionData->numNodes);
+        }
+    }
+
     propData->shadowingDistribution.setSeed(
         node->globalSeed,
         node->nodeId,
@@ -2286,6 +3161,8 @@ void PROP_Init(Node *node, int channelIndex, NodeInput *nodeInput) {
     else { // propProfile->shadowingModel == LOGNORMAL
         propData->shadowingDistribution.setDistributionGaussian(
             propProfile->shadowingMean_dB);
+        propData->shadowingDistribution.setZiggurat(
+            propProfile->shadowingZiggurat == TRUE);
     }
 
     if (propChannel[channelIndex].profile->fadingModel == RICEAN) {
@@ -2352,6 +3229,22 @@ void PROP_Finalize(Node *node) {
          channelIndex < node->numberChannels;
          channelIndex++)
     {
+        PropData* propData = &(node->propData[channelIndex]);
+
+        if (node->propChannel[channelIndex].profile->cullingEnabled &&
+            propData->getNumPhysListenable() != 0)
+        {
+            IO_PrintStat(
+                node,
+                "Physical",
+                "Propagation",
+                ANY_DEST,
+                channelIndex,
+                "Signals culled below noise floor = %" TYPES_64BITFMT "u",
+                node->partitionData->propSignalsCulled[channelIndex]
+                    [node->nodeIndex]);
+        }
+
         if (node->propChannel[channelIndex].profile->numObstructions > 0)
         {
             MEM_free(node->propChannel[channelIndex].profile->obstructions);
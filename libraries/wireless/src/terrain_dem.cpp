@@ -398,29 +398,142 @@ void ReadTypeCRecord(FILE *fp, DemTypeCRecordData *c) {
 }
 
 
-   DemTerrainData::~DemTerrainData()
-   {
-       unsigned int i;
-       // free data
-       for (i = 0; i < m_numDemFiles; i++) {
-           DemTypeARecordData* a = m_records[i];
-           MEM_free(a->b->elevationData);
-           MEM_free(a->b);
-           MEM_free(a);
-   }
+DemTerrainData::~DemTerrainData()
+{
+    freeRecords();
+    delete m_cache;
+}
+
+void DemTerrainData::freeRecords() {
+    unsigned int i;
+    int j;
 
+    for (i = 0; i < m_numDemFiles; i++) {
+        DemTypeARecordData* a = m_records[i];
+
+        // mapped samples are released with the cache
+        if (m_cache == NULL) {
+            for (j = 0; j < a->numColumns; j++) {
+                MEM_free(a->b[j].elevationData);
+            }
+        }
+        MEM_free(a->b);
+        MEM_free(a);
+        m_records[i] = NULL;
+    }
+    m_numDemFiles = 0;
+}
+
+// Map the elevation cache and make records of its tiles, pointing into
+// the mapped samples.  Returns false if the cache is missing or was
+// written for other DEM files.
+bool DemTerrainData::loadCache(const std::string& cacheFilename,
+                               const std::string& sourceKey) {
+    TerrainElevationCache* cache = new TerrainElevationCache;
+    int i;
+    int j;
+
+    if (!cache->open(cacheFilename, sourceKey) ||
+        cache->numTiles() > MAX_NUM_DEM_FILES) {
+        delete cache;
+        return false;
+    }
+
+    freeRecords();
+    delete m_cache;
+    m_cache = cache;
+
+    for (i = 0; i < cache->numTiles(); i++) {
+        const TerrainElevationCache::Tile& tile = cache->getTile(i);
+        DemTypeARecordData* a =
+            (DemTypeARecordData*)MEM_malloc(sizeof(DemTypeARecordData));
+
+        memset(a, 0, sizeof(DemTypeARecordData));
+        a->southWestCorner = tile.southWestCorner;
+        a->northEastCorner = tile.northEastCorner;
+        for (j = 0; j < 3; j++) {
+            a->resolution[j] = (float)tile.resolution[j];
+        }
+        a->minElevation = (float)tile.minElevation;
+        a->maxElevation = (float)tile.maxElevation;
+        a->numRows = 1;
+        a->numColumns = tile.numLines;
+        a->b = (DemTypeBRecordData *)
+            MEM_malloc(a->numColumns * sizeof(DemTypeBRecordData));
+        memset(a->b, 0, a->numColumns * sizeof(DemTypeBRecordData));
+
+        for (j = 0; j < a->numColumns; j++) {
+            a->b[j].rowIndex = 1;
+            a->b[j].columnIndex = j + 1;
+            a->b[j].numRows = tile.lineLengths[j];
+            a->b[j].numColumns = 1;
+            a->b[j].elevationData = (short*)tile.lines[j];
+        }
+
+        m_records[i] = a;
+    }
+    m_numDemFiles = cache->numTiles();
+
+    printf("DEM elevation cache: \"%s\", %d files\n",
+           cacheFilename.c_str(), (int)m_numDemFiles);
+    return true;
+}
+
+// Write the parsed records to the elevation cache, then use the mapped
+// samples instead of the parsed ones
+void DemTerrainData::writeCache(const std::string& cacheFilename,
+                                const std::string& sourceKey) {
+    std::vector<TerrainElevationCache::Tile> tiles(m_numDemFiles);
+    std::vector<std::vector<Int32> > lineLengths(m_numDemFiles);
+    unsigned int i;
+    int j;
+
+    for (i = 0; i < m_numDemFiles; i++) {
+        const DemTypeARecordData* a = m_records[i];
+        TerrainElevationCache::Tile& tile = tiles[i];
+
+        tile.southWestCorner = a->southWestCorner;
+        tile.northEastCorner = a->northEastCorner;
+        for (j = 0; j < 3; j++) {
+            tile.resolution[j] = a->resolution[j];
+        }
+        tile.minElevation = a->minElevation;
+        tile.maxElevation = a->maxElevation;
+        tile.numLines = a->numColumns;
+        tile.lineStride = 1;
+        tile.lines.resize(a->numColumns);
+        lineLengths[i].resize(a->numColumns);
+
+        for (j = 0; j < a->numColumns; j++) {
+            tile.lineStride = MAX(tile.lineStride, a->b[j].numRows);
+            tile.lines[j] = a->b[j].elevationData;
+            lineLengths[i][j] = a->b[j].numRows;
+        }
+        tile.lineLengths = lineLengths[i].empty() ? NULL : &lineLengths[i][0];
+    }
+
+    if (!TerrainElevationCache::write(cacheFilename, sourceKey, tiles)) {
+        ERROR_ReportWarningArgs("Cannot write DEM-CACHE-FILENAME: %s",
+                                cacheFilename.c_str());
+        return;
+    }
+    loadCache(cacheFilename, sourceKey);
 }
 
 void DemTerrainData::initialize(NodeInput* nodeInput) {
     int i;
     char terrainFilename[MAX_STRING_LENGTH];
+    char cacheFilename[MAX_STRING_LENGTH];
+    std::vector<std::string> terrainFilenames;
+    std::vector<Coordinates> southWestCorners;
+    std::vector<Coordinates> northEastCorners;
+    std::string sourceKey;
     BOOL wasFound;
+    BOOL useCache;
     FILE *fp;
     int fileIndex = 0;
 
     while (TRUE) {
-        DemTypeARecordData* a;
-
         IO_ReadStringInstance(
             ANY_NODEID,
             ANY_ADDRESS,
@@ -437,53 +550,106 @@ void DemTerrainData::initialize(NodeInput* nodeInput) {
 
         assert(fileIndex < MAX_NUM_DEM_FILES);
 
-        fp = fopen(terrainFilename, "r");
+        terrainFilenames.push_back(terrainFilename);
+        fileIndex++;
+    }
 
-        if (fp == NULL) {
-            char errorMessage[MAX_STRING_LENGTH];
+    if (fileIndex == 0) {
+        ERROR_ReportError("Cannot find DEM-FILENAME in the configuration file");
+    }
 
-            sprintf(errorMessage, "Cannot open DEM-FILENAME: %s",
-                    terrainFilename);
-            ERROR_ReportError(errorMessage);
-        }
+    for (i = 0; i < MAX_NUM_DEM_FILES; i++) {
+        m_records[i] = NULL;
+    }
+
+    //
+    // The samples of the DEM files can be kept in a cache file, which
+    // is parsed once and then mapped into memory
+    //
+    IO_ReadString(
+        ANY_NODEID,
+        ANY_ADDRESS,
+        nodeInput,
+        "DEM-CACHE-FILENAME",
+        &useCache,
+        cacheFilename);
 
-        a = (DemTypeARecordData*)MEM_malloc(sizeof(DemTypeARecordData));
+    if (useCache) {
+        sourceKey = TerrainElevationCache::SourceKey("DEM", terrainFilenames);
+    }
 
-        m_records[fileIndex] = a;
+    if (!useCache || !loadCache(cacheFilename, sourceKey)) {
+        for (fileIndex = 0;
+             fileIndex < (int)terrainFilenames.size();
+             fileIndex++) {
+            DemTypeARecordData* a;
 
-        //
-        // Read Type A Record
-        //
-        ReadTypeARecord(fp, a);
+            fp = fopen(terrainFilenames[fileIndex].c_str(), "r");
 
-        //
-        // Read Type B Records
-        //
-        for (i = 0; i < a->numColumns; i++) {
-            ReadTypeBRecord(fp, i + 1, &(a->b[i]), a->resolution[2]);
-        }
+            if (fp == NULL) {
+                char errorMessage[MAX_STRING_LENGTH];
 
-        //
-        // Read Type C Record
-        //
-        if (a->accuracy == 1) {
-            ReadTypeCRecord(fp, &(a->c));
-        }
+                sprintf(errorMessage, "Cannot open DEM-FILENAME: %s",
+                        terrainFilenames[fileIndex].c_str());
+                ERROR_ReportError(errorMessage);
+            }
 
-        fclose(fp);
+            a = (DemTypeARecordData*)MEM_malloc(sizeof(DemTypeARecordData));
 
-        fileIndex++;
-    }
+            m_records[fileIndex] = a;
 
-    if (fileIndex == 0) {
-        ERROR_ReportError("Cannot find DEM-FILENAME in the configuration file");
+            //
+            // Read Type A Record
+            //
+            ReadTypeARecord(fp, a);
+
+            //
+            // Read Type B Records
+            //
+            for (i = 0; i < a->numColumns; i++) {
+                ReadTypeBRecord(fp, i + 1, &(a->b[i]), a->resolution[2]);
+            }
+
+            //
+            // Read Type C Record
+            //
+            if (a->accuracy == 1) {
+                ReadTypeCRecord(fp, &(a->c));
+            }
+
+            fclose(fp);
+
+            m_numDemFiles = fileIndex + 1;
+        }
+
+        if (useCache) {
+            writeCache(cacheFilename, sourceKey);
+        }
     }
 
-    for (i = fileIndex; i < MAX_NUM_DEM_FILES; i++) {
-        m_records[i] = NULL;
+    m_lines.resize(m_numDemFiles);
+    m_lineLengths.resize(m_numDemFiles);
+    for (fileIndex = 0; fileIndex < (int)m_numDemFiles; fileIndex++) {
+        const DemTypeARecordData* a = m_records[fileIndex];
+
+        m_lines[fileIndex].resize(a->numColumns);
+        m_lineLengths[fileIndex].resize(a->numColumns);
+        for (i = 0; i < a->numColumns; i++) {
+            m_lines[fileIndex][i] = a->b[i].elevationData;
+            m_lineLengths[fileIndex][i] = a->b[i].numRows;
+        }
     }
 
-    m_numDemFiles = fileIndex;
+    //
+    // Index the files by position for findMatchingFile()
+    //
+    if (m_terrainData->getCoordinateSystem() == LATLONALT) {
+        for (i = 0; i < (int)m_numDemFiles; i++) {
+            southWestCorners.push_back(m_records[i]->southWestCorner);
+            northEastCorners.push_back(m_records[i]->northEastCorner);
+        }
+        m_tileIndex.build(southWestCorners, northEastCorners);
+    }
 
     return;
 }
@@ -570,6 +736,27 @@ double DemTerrainData::getElevationAt(const Coordinates* point)
     return elevation;
 }
 
+bool DemTerrainData::getProfileTile(const Coordinates* point,
+                                    ElevationProfileTile* tile)
+{
+    UInt32 matchingFile = findMatchingFile(point);
+
+    if (matchingFile == DEM_NO_MATCH_FOUND) {
+        return false;
+    }
+
+    const DemTypeARecordData* const a = m_records[matchingFile];
+
+    tile->southWestCorner = a->southWestCorner;
+    tile->northEastCorner = a->northEastCorner;
+    tile->resolution[0] = a->resolution[0];
+    tile->resolution[1] = a->resolution[1];
+    tile->numLines = a->numColumns;
+    tile->lines = &m_lines[matchingFile][0];
+    tile->lineLengths = &m_lineLengths[matchingFile][0];
+    return true;
+}
+
 void DemTerrainData::getElevationBoundaries(int index, Coordinates* sw, Coordinates* ne)
 {
     ERROR_Assert(index >= 0 && index < (int)m_numDemFiles, "Invalid index");
@@ -616,6 +803,9 @@ UInt32 DemTerrainData::findMatchingFile(const Coordinates* point) {
 
     UInt32 lastMatch = m_mostRecentFile; // make a local copy
     UInt32 index = 0;
+    UInt32 numCandidates = m_numDemFiles;
+    const UInt32* candidates = NULL;
+    UInt32 i;
 
     // check for corrupted value
     if (lastMatch >= m_numDemFiles) {
@@ -629,7 +819,13 @@ UInt32 DemTerrainData::findMatchingFile(const Coordinates* point) {
         return lastMatch;
 }
 
-    for (; index < m_numDemFiles; index++) {
+    // Only the files indexed at the point can hold it
+    if (m_tileIndex.isUsable()) {
+        candidates = m_tileIndex.candidates(point, &numCandidates);
+    }
+
+    for (i = 0; i < numCandidates; i++) {
+        index = candidates != NULL ? candidates[i] : i;
         if ((index != lastMatch) &&
                 COORD_PointWithinRange(m_terrainData->getCoordinateSystem(),
                                        &(m_records[index]->southWestCorner),
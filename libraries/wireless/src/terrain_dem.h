@@ -19,6 +19,7 @@
 #define DEM_INTERFACE
 
 #include "terrain.h"
+#include "terrain_elevation_cache.h"
 
 #define QUADRANGLE_NAME_LENGTH 144
 #define MAX_NUM_DEM_FILES      100
@@ -72,15 +73,31 @@ private:
     UInt32 m_mostRecentFile;
     DemTypeARecordData* m_records[MAX_NUM_DEM_FILES];
 
+    // Elevation data mapped from DEM-CACHE-FILENAME, NULL when the
+    // records hold the data parsed from the DEM files
+    TerrainElevationCache* m_cache;
+    TerrainTileIndex       m_tileIndex;
+
+    // Start and length of each column of the files, for getProfileTile()
+    std::vector<std::vector<const short*> > m_lines;
+    std::vector<std::vector<int> >          m_lineLengths;
+
     // DEM specific functions
 
     // returns DEM_NO_MATCH_FOUND if there's no match
     UInt32 findMatchingFile(const Coordinates* c);
 
+    bool loadCache(const std::string& cacheFilename,
+                   const std::string& sourceKey);
+    void writeCache(const std::string& cacheFilename,
+                    const std::string& sourceKey);
+    void freeRecords();
+
 public:
     DemTerrainData(TerrainData* td) : ElevationTerrainData(td) {
         m_numDemFiles = 0;
         m_mostRecentFile = 0;
+        m_cache = NULL;
         m_modelName = "DEM";
     }
     virtual ~DemTerrainData();
@@ -89,6 +106,7 @@ public:
 
     bool hasData() { return true; }
     double getElevationAt(const Coordinates* c);
+    bool getProfileTile(const Coordinates* c, ElevationProfileTile* tile);
 
     virtual void getElevationBoundaries(int index, Coordinates* sw, Coordinates* ne);
 
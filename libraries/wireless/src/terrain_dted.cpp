@@ -307,31 +307,133 @@ void DtedReadElevationData(FILE *fp, DtedRecordData *a) {
         }
 
 DtedTerrainData::~DtedTerrainData() {
+    if (DEBUG) printf("DTED destructor called\n");
+    freeRecords();
+    delete m_cache;
+}
+
+void DtedTerrainData::freeRecords() {
     UInt32 i;
     int r;
 
-    if (DEBUG) printf("DTED destructor called\n");
     // free data
     for (i = 0; i < m_numFiles; i++) {
         DtedRecordData* d = m_records[i];
-        for (r = 0; r < d->numRows; r++) {
-            MEM_free(d->elevationData[r]);
+
+        // mapped samples are released with the cache
+        if (m_cache == NULL) {
+            for (r = 0; r < d->numRows; r++) {
+                MEM_free(d->elevationData[r]);
+            }
         }
         MEM_free(d->elevationData);
         MEM_free(d);
+        m_records[i] = NULL;
+    }
+    m_numFiles = 0;
+}
+
+// Map the elevation cache and make records of its tiles, pointing into
+// the mapped samples.  Returns false if the cache is missing or was
+// written for other DTED files.
+bool DtedTerrainData::loadCache(const std::string& cacheFilename,
+                                const std::string& sourceKey) {
+    TerrainElevationCache* cache = new TerrainElevationCache;
+    int i;
+    int r;
+
+    if (!cache->open(cacheFilename, sourceKey) ||
+        cache->numTiles() > MAX_NUM_DTED_FILES) {
+        delete cache;
+        return false;
+    }
+
+    freeRecords();
+    delete m_cache;
+    m_cache = cache;
+
+    for (i = 0; i < cache->numTiles(); i++) {
+        const TerrainElevationCache::Tile& tile = cache->getTile(i);
+        DtedRecordData* a =
+            (DtedRecordData*)MEM_malloc(sizeof(DtedRecordData));
+
+        memset(a, 0, sizeof(DtedRecordData));
+        a->southWestCorner = tile.southWestCorner;
+        a->northEastCorner = tile.northEastCorner;
+        memcpy(a->resolution, tile.resolution, sizeof(a->resolution));
+        a->numRows = tile.numLines;
+        a->numColumns = tile.lineStride;
+        a->elevationData = (short**)MEM_malloc(a->numRows * sizeof(short*));
+
+        for (r = 0; r < a->numRows; r++) {
+            a->elevationData[r] = (short*)tile.lines[r];
+        }
+
+        m_records[i] = a;
+    }
+    m_numFiles = cache->numTiles();
+
+    printf("DTED elevation cache: \"%s\", %d files\n",
+           cacheFilename.c_str(), (int)m_numFiles);
+    return true;
+}
+
+// Write the parsed records to the elevation cache, then use the mapped
+// samples instead of the parsed ones
+void DtedTerrainData::writeCache(const std::string& cacheFilename,
+                                 const std::string& sourceKey) {
+    std::vector<TerrainElevationCache::Tile> tiles(m_numFiles);
+    std::vector<std::vector<Int32> > lineLengths(m_numFiles);
+    UInt32 i;
+    int r;
+
+    for (i = 0; i < m_numFiles; i++) {
+        const DtedRecordData* a = m_records[i];
+        TerrainElevationCache::Tile& tile = tiles[i];
+        double highest = -99999.9;
+        double lowest = 99999.9;
+
+        getHighestAndLowestForFile(m_records[i], NULL, NULL,
+                                   &highest, &lowest);
+
+        tile.southWestCorner = a->southWestCorner;
+        tile.northEastCorner = a->northEastCorner;
+        memcpy(tile.resolution, a->resolution, sizeof(tile.resolution));
+        tile.minElevation = lowest;
+        tile.maxElevation = highest;
+        tile.numLines = a->numRows;
+        tile.lineStride = a->numColumns;
+        tile.lines.resize(a->numRows);
+        lineLengths[i].assign(a->numRows, a->numColumns);
+
+        for (r = 0; r < a->numRows; r++) {
+            tile.lines[r] = a->elevationData[r];
+        }
+        tile.lineLengths = lineLengths[i].empty() ? NULL : &lineLengths[i][0];
     }
+
+    if (!TerrainElevationCache::write(cacheFilename, sourceKey, tiles)) {
+        ERROR_ReportWarningArgs("Cannot write DTED-CACHE-FILENAME: %s",
+                                cacheFilename.c_str());
+        return;
+    }
+    loadCache(cacheFilename, sourceKey);
 }
 
 void DtedTerrainData::initialize(NodeInput* nodeInput) {
     int i;
     char terrainFilename[MAX_STRING_LENGTH];
+    char cacheFilename[MAX_STRING_LENGTH];
+    std::vector<std::string> terrainFilenames;
+    std::vector<Coordinates> southWestCorners;
+    std::vector<Coordinates> northEastCorners;
+    std::string sourceKey;
     BOOL wasFound;
+    BOOL useCache;
     FILE *fp;
     int fileIndex = 0;
 
     while (TRUE) {
-        DtedRecordData* a;
-
         IO_ReadStringInstance(
             ANY_NODEID,
             ANY_ADDRESS,
@@ -348,57 +450,88 @@ void DtedTerrainData::initialize(NodeInput* nodeInput) {
 
         assert(fileIndex < MAX_NUM_DTED_FILES);
 
-        fp = fopen(terrainFilename, "rb");
+        terrainFilenames.push_back(terrainFilename);
+        fileIndex++;
+    }
 
-        if (fp == NULL) {
-            char errorMessage[MAX_STRING_LENGTH];
+    if (fileIndex == 0) {
+        ERROR_ReportError("Cannot find DTED-FILENAME in the configuration file");
+    }
 
-            sprintf(errorMessage, "Cannot open DTED-FILENAME: %s",
-                    terrainFilename);
-            ERROR_ReportError(errorMessage);
-        }
+    // set all entries to NULL.
+    for (i = 0; i < MAX_NUM_DTED_FILES; i++) {
+        m_records[i] = NULL;
+    }
 
-        a = (DtedRecordData*)MEM_malloc(sizeof(DtedRecordData));
+    //
+    // The samples of the DTED files can be kept in a cache file, which
+    // is parsed once and then mapped into memory
+    //
+    IO_ReadString(
+        ANY_NODEID,
+        ANY_ADDRESS,
+        nodeInput,
+        "DTED-CACHE-FILENAME",
+        &useCache,
+        cacheFilename);
+
+    if (useCache) {
+        sourceKey = TerrainElevationCache::SourceKey("DTED", terrainFilenames);
+    }
 
-        m_records[fileIndex] = a;
+    if (!useCache || !loadCache(cacheFilename, sourceKey)) {
+        for (fileIndex = 0;
+             fileIndex < (int)terrainFilenames.size();
+             fileIndex++) {
+            DtedRecordData* a;
 
-        //
-        // Read UHL
-        //
-        DtedReadUserHeaderLabel(fp, a);
+            fp = fopen(terrainFilenames[fileIndex].c_str(), "rb");
 
-        //
-        // Read Data Set Identification (DSI) Record
-        //
-        DtedReadDataSetIdentificationRecord(fp, a);
+            if (fp == NULL) {
+                char errorMessage[MAX_STRING_LENGTH];
 
-        //
-        // Read Accuracy Description (ACC) Record
-        // ACC data are currently not used
-        //
-        DtedReadAccuracyDescriptionRecord(fp);
+                sprintf(errorMessage, "Cannot open DTED-FILENAME: %s",
+                        terrainFilenames[fileIndex].c_str());
+                ERROR_ReportError(errorMessage);
+            }
 
-        //
-        // Read elevation data
-        //
-        DtedReadElevationData(fp, a);
+            a = (DtedRecordData*)MEM_malloc(sizeof(DtedRecordData));
 
-        fclose(fp);
+            m_records[fileIndex] = a;
 
-        fileIndex++;
-    }
+            //
+            // Read UHL
+            //
+            DtedReadUserHeaderLabel(fp, a);
 
-    if (fileIndex == 0) {
-        ERROR_ReportError("Cannot find DTED-FILENAME in the configuration file");
-    }
+            //
+            // Read Data Set Identification (DSI) Record
+            //
+            DtedReadDataSetIdentificationRecord(fp, a);
 
-    // set all remaining entries to NULL.
-    for (i = fileIndex; i < MAX_NUM_DTED_FILES; i++) {
-        m_records[i] = NULL;
+            //
+            // Read Accuracy Description (ACC) Record
+            // ACC data are currently not used
+            //
+            DtedReadAccuracyDescriptionRecord(fp);
+
+            //
+            // Read elevation data
+            //
+            DtedReadElevationData(fp, a);
+
+            fclose(fp);
+
+            m_numFiles = fileIndex + 1;
+        }
+
+        if (useCache) {
+            writeCache(cacheFilename, sourceKey);
+        }
     }
 
     if (DEBUG) {
-        for (i = 0; i < fileIndex; i++) {
+        for (i = 0; i < (int)m_numFiles; i++) {
             printf("file %d, sw,ne = (%f,%f),(%f,%f)\n", i,
                    m_records[i]->southWestCorner.latlonalt.latitude,
                    m_records[i]->southWestCorner.latlonalt.longitude,
@@ -407,7 +540,22 @@ void DtedTerrainData::initialize(NodeInput* nodeInput) {
         }
     }
 
-    m_numFiles = fileIndex;
+    //
+    // Index the files by position for findMatchingFile()
+    //
+    if (m_terrainData->getCoordinateSystem() == LATLONALT) {
+        for (i = 0; i < (int)m_numFiles; i++) {
+            southWestCorners.push_back(m_records[i]->southWestCorner);
+            northEastCorners.push_back(m_records[i]->northEastCorner);
+        }
+        m_tileIndex.build(southWestCorners, northEastCorners);
+    }
+
+    m_lineLengths.resize(m_numFiles);
+    for (i = 0; i < (int)m_numFiles; i++) {
+        m_lineLengths[i].assign(m_records[i]->numRows,
+                                m_records[i]->numColumns);
+    }
 
     return;
 }
@@ -532,6 +680,28 @@ double DtedTerrainData::getElevationAt(const Coordinates* point) {
     return elevation;
 }
 
+bool DtedTerrainData::getProfileTile(const Coordinates* point,
+                                     ElevationProfileTile* tile) {
+    UInt32 bestFileIndex = findMatchingFile(point);
+
+    if (bestFileIndex == DTED_NO_MATCH_FOUND) {
+        return false;
+    }
+
+    m_mostRecentFile = bestFileIndex;
+
+    const DtedRecordData* a = m_records[bestFileIndex];
+
+    tile->southWestCorner = a->southWestCorner;
+    tile->northEastCorner = a->northEastCorner;
+    tile->resolution[0] = a->resolution[0];
+    tile->resolution[1] = a->resolution[1];
+    tile->numLines = a->numRows;
+    tile->lines = a->elevationData;
+    tile->lineLengths = &m_lineLengths[bestFileIndex][0];
+    return true;
+}
+
 void DtedTerrainData::getHighestAndLowestForFile(
     DtedRecordData*    record,
     const Coordinates* sw,
@@ -592,6 +762,8 @@ UInt32 DtedTerrainData::findMatchingFile(const Coordinates* point) {
     UInt32 lastMatch = m_mostRecentFile; // make a local copy
     UInt32 i, bestFileIndex;
     bool   foundMatch = false;
+    UInt32 numCandidates = m_numFiles;
+    const UInt32* candidates = NULL;
 
     if (DEBUG) {
         printf("last match, point = %d, (%f,%f)\n", lastMatch,
@@ -619,8 +791,14 @@ UInt32 DtedTerrainData::findMatchingFile(const Coordinates* point) {
         }
     }
 
-    for (i = 0; i < m_numFiles; i++)
+    // Only the files indexed at the point can hold it
+    if (m_tileIndex.isUsable()) {
+        candidates = m_tileIndex.candidates(point, &numCandidates);
+    }
+
+    for (UInt32 c = 0; c < numCandidates; c++)
     {
+        i = candidates != NULL ? candidates[c] : c;
         DtedRecordData* thisRecord = m_records[i];
         if (DEBUG) {
             printf("record sw, ne = (%f,%f), (%f,%f)\n",
@@ -19,6 +19,7 @@
 #define DTED_INTERFACE
 
 #include "terrain.h"
+#include "terrain_elevation_cache.h"
 
 #define MAX_NUM_DTED_FILES      100
 #define DTED_NO_MATCH_FOUND     (MAX_NUM_DTED_FILES + 1)
@@ -39,8 +40,21 @@ private:
     UInt32 m_mostRecentFile;
     DtedRecordData* m_records[MAX_NUM_DTED_FILES];
 
+    // Elevation data mapped from DTED-CACHE-FILENAME, NULL when the
+    // records hold the data parsed from the DTED files
+    TerrainElevationCache* m_cache;
+    TerrainTileIndex       m_tileIndex;
+
+    // Length of each row of the files, for getProfileTile()
+    std::vector<std::vector<int> > m_lineLengths;
+
     // returns DTED_NO_MATCH_FOUND if there's no match
     UInt32 findMatchingFile(const Coordinates* c);
+    bool   loadCache(const std::string& cacheFilename,
+                     const std::string& sourceKey);
+    void   writeCache(const std::string& cacheFilename,
+                      const std::string& sourceKey);
+    void   freeRecords();
     void   getHighestAndLowestForFile(DtedRecordData* record,
                                       const Coordinates* sw,
                                       const Coordinates* ne,
@@ -51,6 +65,7 @@ public:
     DtedTerrainData(TerrainData* td) : ElevationTerrainData(td) {
         m_numFiles = 0;
         m_mostRecentFile = 0;
+        m_cache = NULL;
         m_modelName = "DTED";
     }
     virtual ~DtedTerrainData();
@@ -58,6 +73,7 @@ public:
     bool hasData() { return true; }
     void initialize(NodeInput* nodeInput);
     double getElevationAt(const Coordinates* c);
+    bool getProfileTile(const Coordinates* c, ElevationProfileTile* tile);
 
     virtual void getElevationBoundaries(int index, Coordinates* sw, Coordinates* ne);
 
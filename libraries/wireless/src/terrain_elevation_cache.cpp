@@ -0,0 +1,553 @@
+// Copyright (c) 2001-2015, SCALABLE Network Technologies, Inc.  All Rights Reserved.
+//                          600 Corporate Pointe
+//                          Suite 1200
+//                          Culver City, CA 90230
+//                          info@scalable-networks.com
+//
+// This source code is licensed, not sold, and is subject to a written
+// license agreement.  Among other things, no portion of this source
+// code may be copied, transmitted, disclosed, displayed, distributed,
+// translated, used as the basis for a derivative work, or used, in
+// whole or in part, for any program or purpose other than its intended
+// use in compliance with the license agreement as part of the QualNet
+// software.  This source code and certain of the algorithms contained
+// within it are confidential trade secrets of Scalable Network
+// Technologies, Inc. and may not be used as the basis for any other
+// software, hardware, product or service.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+#include <sstream>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <process.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#endif
+
+#include "api.h"
+#include "terrain_elevation_cache.h"
+
+static const char TERRAIN_ELEVATION_CACHE_MAGIC[8] = "QNELEVC";
+static const UInt32 TERRAIN_ELEVATION_CACHE_BYTE_ORDER = 0x01020304;
+
+static
+UInt64 TerrainElevationCacheAlign(UInt64 offset, UInt64 alignment)
+{
+    return (offset + alignment - 1) / alignment * alignment;
+}
+
+// Bytes of the samples of a tile, up to its line lengths
+static
+UInt64 TerrainElevationCacheSamplesSize(Int32 numLines, Int32 lineStride)
+{
+    return TerrainElevationCacheAlign(
+               (UInt64)numLines * lineStride * sizeof(short),
+               sizeof(Int32));
+}
+
+TerrainTileIndex::TerrainTileIndex()
+{
+    m_usable = false;
+    m_south = 0.0;
+    m_north = 0.0;
+    m_west = 0.0;
+    m_east = 0.0;
+    m_latitudeCellsPerDegree = 0.0;
+    m_longitudeCellsPerDegree = 0.0;
+    m_numLatitudeCells = 0;
+    m_numLongitudeCells = 0;
+}
+
+// The cell of a coordinate is a non-decreasing function of it, so a
+// point within a tile is in a cell between those of the tile corners.
+int TerrainTileIndex::latitudeCell(double latitude) const
+{
+    int cell = (int)floor((latitude - m_south) * m_latitudeCellsPerDegree);
+    return MIN(MAX(cell, 0), m_numLatitudeCells - 1);
+}
+
+int TerrainTileIndex::longitudeCell(double longitude) const
+{
+    int cell = (int)floor((longitude - m_west) * m_longitudeCellsPerDegree);
+    return MIN(MAX(cell, 0), m_numLongitudeCells - 1);
+}
+
+void TerrainTileIndex::build(
+    const std::vector<Coordinates>& southWestCorners,
+    const std::vector<Coordinates>& northEastCorners)
+{
+    double cellLatitude = 0.0;
+    double cellLongitude = 0.0;
+    std::vector<UInt32> cellCount;
+    size_t i;
+
+    m_usable = false;
+    m_cellStart.clear();
+    m_tiles.clear();
+
+    if (southWestCorners.empty())
+    {
+        return;
+    }
+
+    m_south = southWestCorners[0].latlonalt.latitude;
+    m_west = southWestCorners[0].latlonalt.longitude;
+    m_north = northEastCorners[0].latlonalt.latitude;
+    m_east = northEastCorners[0].latlonalt.longitude;
+
+    for (i = 0; i < southWestCorners.size(); i++)
+    {
+        double south = southWestCorners[i].latlonalt.latitude;
+        double west = southWestCorners[i].latlonalt.longitude;
+        double north = northEastCorners[i].latlonalt.latitude;
+        double east = northEastCorners[i].latlonalt.longitude;
+
+        if (west > east || south > north)
+        {
+            // Crosses the dateline, scan the tiles
+            return;
+        }
+
+        m_south = MIN(m_south, south);
+        m_west = MIN(m_west, west);
+        m_north = MAX(m_north, north);
+        m_east = MAX(m_east, east);
+
+        if (north > south &&
+            (cellLatitude == 0.0 || north - south < cellLatitude))
+        {
+            cellLatitude = north - south;
+        }
+        if (east > west &&
+            (cellLongitude == 0.0 || east - west < cellLongitude))
+        {
+            cellLongitude = east - west;
+        }
+    }
+
+    m_numLatitudeCells = 1;
+    m_numLongitudeCells = 1;
+    m_latitudeCellsPerDegree = 0.0;
+    m_longitudeCellsPerDegree = 0.0;
+    if (cellLatitude > 0.0)
+    {
+        m_latitudeCellsPerDegree = 1.0 / cellLatitude;
+        m_numLatitudeCells =
+            (int)floor((m_north - m_south) * m_latitudeCellsPerDegree) + 1;
+    }
+    if (cellLongitude > 0.0)
+    {
+        m_longitudeCellsPerDegree = 1.0 / cellLongitude;
+        m_numLongitudeCells =
+            (int)floor((m_east - m_west) * m_longitudeCellsPerDegree) + 1;
+    }
+
+    // Small tiles spread far apart would take too many cells
+    while ((double)m_numLatitudeCells * m_numLongitudeCells
+           > TERRAIN_TILE_INDEX_MAX_CELLS)
+    {
+        m_latitudeCellsPerDegree /= 2.0;
+        m_longitudeCellsPerDegree /= 2.0;
+        m_numLatitudeCells =
+            (int)floor((m_north - m_south) * m_latitudeCellsPerDegree) + 1;
+        m_numLongitudeCells =
+            (int)floor((m_east - m_west) * m_longitudeCellsPerDegree) + 1;
+    }
+
+    // Count the tiles of each cell, then fill them in tile order so that
+    // each cell lists its tiles in ascending order
+    cellCount.resize(m_numLatitudeCells * m_numLongitudeCells, 0);
+    for (int pass = 0; pass < 2; pass++)
+    {
+        for (i = 0; i < southWestCorners.size(); i++)
+        {
+            int south = latitudeCell(southWestCorners[i].latlonalt.latitude);
+            int north = latitudeCell(northEastCorners[i].latlonalt.latitude);
+            int west = longitudeCell(southWestCorners[i].latlonalt.longitude);
+            int east = longitudeCell(northEastCorners[i].latlonalt.longitude);
+
+            for (int lat = south; lat <= north; lat++)
+            {
+                for (int lon = west; lon <= east; lon++)
+                {
+                    int cell = lat * m_numLongitudeCells + lon;
+                    if (pass == 0)
+                    {
+                        cellCount[cell]++;
+                    }
+                    else
+                    {
+                        m_tiles[m_cellStart[cell] + cellCount[cell]] =
+                            (UInt32)i;
+                        cellCount[cell]++;
+                    }
+                }
+            }
+        }
+
+        if (pass == 0)
+        {
+            m_cellStart.resize(cellCount.size() + 1);
+            m_cellStart[0] = 0;
+            for (i = 0; i < cellCount.size(); i++)
+            {
+                m_cellStart[i + 1] = m_cellStart[i] + cellCount[i];
+                cellCount[i] = 0;
+            }
+            m_tiles.resize(m_cellStart[cellCount.size()]);
+        }
+    }
+
+    m_usable = true;
+}
+
+const UInt32* TerrainTileIndex::candidates(
+    const Coordinates* point,
+    UInt32* numTiles) const
+{
+    double latitude = point->latlonalt.latitude;
+    double longitude = point->latlonalt.longitude;
+
+    *numTiles = 0;
+    if (!(latitude >= m_south && latitude <= m_north &&
+          longitude >= m_west && longitude <= m_east))
+    {
+        return NULL;
+    }
+
+    int cell = latitudeCell(latitude) * m_numLongitudeCells
+               + longitudeCell(longitude);
+    *numTiles = m_cellStart[cell + 1] - m_cellStart[cell];
+    return *numTiles > 0 ? &m_tiles[m_cellStart[cell]] : NULL;
+}
+
+TerrainElevationCache::TerrainElevationCache()
+{
+    m_data = NULL;
+    m_size = 0;
+}
+
+TerrainElevationCache::~TerrainElevationCache()
+{
+    close();
+}
+
+void TerrainElevationCache::close()
+{
+    if (m_data != NULL)
+    {
+#ifdef _WIN32
+        UnmapViewOfFile(m_data);
+#else
+        munmap((void*)m_data, (size_t)m_size);
+#endif
+    }
+    m_data = NULL;
+    m_size = 0;
+    m_tiles.clear();
+}
+
+std::string TerrainElevationCache::SourceKey(
+    const std::string& format,
+    const std::vector<std::string>& fileNames)
+{
+    std::stringstream key;
+
+    key << format;
+    for (size_t i = 0; i < fileNames.size(); i++)
+    {
+        struct stat fileStat;
+
+        key << "\n" << fileNames[i];
+        if (stat(fileNames[i].c_str(), &fileStat) == 0)
+        {
+            key << " " << (UInt64)fileStat.st_size
+                << " " << (Int64)fileStat.st_mtime;
+        }
+    }
+    return key.str();
+}
+
+bool TerrainElevationCache::open(
+    const std::string& fileName,
+    const std::string& sourceKey)
+{
+    const TerrainElevationCacheHeader* header;
+    const TerrainElevationCacheTile* records;
+    UInt64 offset;
+
+    close();
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(fileName.c_str(),
+                              GENERIC_READ,
+                              FILE_SHARE_READ,
+                              NULL,
+                              OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL,
+                              NULL);
+    LARGE_INTEGER fileSize;
+    HANDLE mapping;
+
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+    {
+        CloseHandle(file);
+        return false;
+    }
+    mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    CloseHandle(file);
+    if (mapping == NULL)
+    {
+        return false;
+    }
+    m_data = (const char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+    if (m_data == NULL)
+    {
+        return false;
+    }
+    m_size = (UInt64)fileSize.QuadPart;
+#else
+    struct stat fileStat;
+    int fd = ::open(fileName.c_str(), O_RDONLY);
+    void* data;
+
+    if (fd < 0)
+    {
+        return false;
+    }
+    if (fstat(fd, &fileStat) != 0 || fileStat.st_size == 0)
+    {
+        ::close(fd);
+        return false;
+    }
+    data = mmap(NULL, (size_t)fileStat.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (data == MAP_FAILED)
+    {
+        return false;
+    }
+    m_data = (const char*)data;
+    m_size = (UInt64)fileStat.st_size;
+#endif
+
+    // Check the header and the key, then that every tile is within the
+    // file
+    header = (const TerrainElevationCacheHeader*)m_data;
+    offset = sizeof(TerrainElevationCacheHeader);
+    if (m_size < offset ||
+        memcmp(header->magic, TERRAIN_ELEVATION_CACHE_MAGIC,
+               sizeof(header->magic)) != 0 ||
+        header->byteOrder != TERRAIN_ELEVATION_CACHE_BYTE_ORDER ||
+        header->version != TERRAIN_ELEVATION_CACHE_VERSION ||
+        header->keyLength != sourceKey.size() ||
+        m_size < offset + header->keyLength ||
+        memcmp(m_data + offset, sourceKey.data(), header->keyLength) != 0)
+    {
+        close();
+        return false;
+    }
+
+    offset = TerrainElevationCacheAlign(offset + header->keyLength, 8);
+    records = (const TerrainElevationCacheTile*)(m_data + offset);
+    if (m_size < offset
+                 + (UInt64)header->numTiles
+                 * sizeof(TerrainElevationCacheTile))
+    {
+        close();
+        return false;
+    }
+
+    m_tiles.resize(header->numTiles);
+    for (UInt32 i = 0; i < header->numTiles; i++)
+    {
+        const TerrainElevationCacheTile& record = records[i];
+        Tile& tile = m_tiles[i];
+        UInt64 samplesSize = TerrainElevationCacheSamplesSize(
+                                 record.numLines, record.lineStride);
+        UInt64 dataSize = samplesSize
+                          + (UInt64)record.numLines * sizeof(Int32);
+
+        if (record.numLines <= 0 ||
+            record.lineStride <= 0 ||
+            record.dataOffset % TERRAIN_ELEVATION_CACHE_ALIGNMENT != 0 ||
+            record.dataOffset > m_size ||
+            m_size - record.dataOffset < dataSize)
+        {
+            close();
+            return false;
+        }
+
+        memset(&tile.southWestCorner, 0, sizeof(tile.southWestCorner));
+        memset(&tile.northEastCorner, 0, sizeof(tile.northEastCorner));
+        tile.southWestCorner.latlonalt.latitude = record.southWestLatitude;
+        tile.southWestCorner.latlonalt.longitude = record.southWestLongitude;
+        tile.northEastCorner.latlonalt.latitude = record.northEastLatitude;
+        tile.northEastCorner.latlonalt.longitude = record.northEastLongitude;
+        memcpy(tile.resolution, record.resolution, sizeof(tile.resolution));
+        tile.minElevation = record.minElevation;
+        tile.maxElevation = record.maxElevation;
+        tile.numLines = record.numLines;
+        tile.lineStride = record.lineStride;
+        tile.lineLengths =
+            (const Int32*)(m_data + record.dataOffset + samplesSize);
+
+        const short* samples = (const short*)(m_data + record.dataOffset);
+        tile.lines.resize(record.numLines);
+        for (int line = 0; line < record.numLines; line++)
+        {
+            if (tile.lineLengths[line] < 0 ||
+                tile.lineLengths[line] > record.lineStride)
+            {
+                close();
+                return false;
+            }
+            tile.lines[line] = samples + (size_t)line * record.lineStride;
+        }
+    }
+
+    return true;
+}
+
+bool TerrainElevationCache::write(
+    const std::string& fileName,
+    const std::string& sourceKey,
+    const std::vector<Tile>& tiles)
+{
+    std::vector<TerrainElevationCacheTile> records(tiles.size());
+    TerrainElevationCacheHeader header;
+    std::stringstream tempName;
+    std::vector<short> line;
+    UInt64 offset;
+    FILE* fp;
+    bool ok = true;
+
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, TERRAIN_ELEVATION_CACHE_MAGIC, sizeof(header.magic));
+    header.byteOrder = TERRAIN_ELEVATION_CACHE_BYTE_ORDER;
+    header.version = TERRAIN_ELEVATION_CACHE_VERSION;
+    header.numTiles = (UInt32)tiles.size();
+    header.keyLength = (UInt32)sourceKey.size();
+
+    offset = TerrainElevationCacheAlign(
+                 sizeof(header) + sourceKey.size(), 8)
+             + tiles.size() * sizeof(TerrainElevationCacheTile);
+    for (size_t i = 0; i < tiles.size(); i++)
+    {
+        TerrainElevationCacheTile& record = records[i];
+
+        memset(&record, 0, sizeof(record));
+        record.southWestLatitude = tiles[i].southWestCorner.latlonalt.latitude;
+        record.southWestLongitude =
+            tiles[i].southWestCorner.latlonalt.longitude;
+        record.northEastLatitude = tiles[i].northEastCorner.latlonalt.latitude;
+        record.northEastLongitude =
+            tiles[i].northEastCorner.latlonalt.longitude;
+        memcpy(record.resolution, tiles[i].resolution,
+               sizeof(record.resolution));
+        record.minElevation = tiles[i].minElevation;
+        record.maxElevation = tiles[i].maxElevation;
+        record.numLines = tiles[i].numLines;
+        record.lineStride = tiles[i].lineStride;
+
+        offset = TerrainElevationCacheAlign(
+                     offset, TERRAIN_ELEVATION_CACHE_ALIGNMENT);
+        record.dataOffset = offset;
+        offset += TerrainElevationCacheSamplesSize(record.numLines,
+                                                   record.lineStride)
+                  + (UInt64)record.numLines * sizeof(Int32);
+    }
+
+    // Partitions and processes may write the cache at the same time,
+    // each under its own name
+#ifdef _WIN32
+    tempName << fileName << ".tmp" << _getpid();
+#else
+    tempName << fileName << ".tmp" << getpid();
+#endif
+    fp = fopen(tempName.str().c_str(), "wb");
+    if (fp == NULL)
+    {
+        return false;
+    }
+
+    ok = fwrite(&header, sizeof(header), 1, fp) == 1 &&
+         fwrite(sourceKey.data(), 1, sourceKey.size(), fp)
+             == sourceKey.size();
+    offset = sizeof(header) + sourceKey.size();
+    while (ok && offset % 8 != 0)
+    {
+        ok = fputc(0, fp) != EOF;
+        offset++;
+    }
+    if (ok && !records.empty())
+    {
+        ok = fwrite(&records[0], sizeof(records[0]), records.size(), fp)
+             == records.size();
+        offset += records.size() * sizeof(records[0]);
+    }
+
+    for (size_t i = 0; ok && i < tiles.size(); i++)
+    {
+        const Tile& tile = tiles[i];
+
+        while (ok && offset < records[i].dataOffset)
+        {
+            ok = fputc(0, fp) != EOF;
+            offset++;
+        }
+
+        // Lines shorter than the stride are padded with zeros
+        line.resize(tile.lineStride);
+        for (int j = 0; ok && j < tile.numLines; j++)
+        {
+            std::fill(line.begin(), line.end(), (short)0);
+            memcpy(&line[0], tile.lines[j],
+                   tile.lineLengths[j] * sizeof(short));
+            ok = fwrite(&line[0], sizeof(short), line.size(), fp)
+                 == line.size();
+            offset += line.size() * sizeof(short);
+        }
+
+        while (ok && offset % sizeof(Int32) != 0)
+        {
+            ok = fputc(0, fp) != EOF;
+            offset++;
+        }
+        if (ok && tile.numLines > 0)
+        {
+            ok = fwrite(tile.lineLengths, sizeof(Int32), tile.numLines, fp)
+                 == (size_t)tile.numLines;
+            offset += tile.numLines * sizeof(Int32);
+        }
+    }
+
+    if (fclose(fp) != 0)
+    {
+        ok = false;
+    }
+    if (ok)
+    {
+        // rename() does not replace an existing file on Windows
+        remove(fileName.c_str());
+        ok = rename(tempName.str().c_str(), fileName.c_str()) == 0;
+    }
+    if (!ok)
+    {
+        remove(tempName.str().c_str());
+    }
+    return ok;
+}
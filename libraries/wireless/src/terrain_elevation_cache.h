@@ -0,0 +1,182 @@
+// Copyright (c) 2001-2015, SCALABLE Network Technologies, Inc.  All Rights Reserved.
+//                          600 Corporate Pointe
+//                          Suite 1200
+//                          Culver City, CA 90230
+//                          info@scalable-networks.com
+//
+// This source code is licensed, not sold, and is subject to a written
+// license agreement.  Among other things, no portion of this source
+// code may be copied, transmitted, disclosed, displayed, distributed,
+// translated, used as the basis for a derivative work, or used, in
+// whole or in part, for any program or purpose other than its intended
+// use in compliance with the license agreement as part of the QualNet
+// software.  This source code and certain of the algorithms contained
+// within it are confidential trade secrets of Scalable Network
+// Technologies, Inc. and may not be used as the basis for any other
+// software, hardware, product or service.
+
+#ifndef TERRAIN_ELEVATION_CACHE_H
+#define TERRAIN_ELEVATION_CACHE_H
+
+#include <string>
+#include <vector>
+
+#include "terrain.h"
+
+// The elevation cache file holds the samples of the tiles (the DEM or
+// DTED files) of a terrain, so that they are parsed once and then mapped
+// into memory, where the pages are shared by every partition and process
+// using the file.  It is written in the byte order of the host:
+//
+//   TerrainElevationCacheHeader
+//   the source key, which names the source files with their sizes and
+//   modification times, padded to 8 bytes
+//   a TerrainElevationCacheTile for each tile
+//   for each tile, starting on a TERRAIN_ELEVATION_CACHE_ALIGNMENT
+//   boundary, the samples, lineStride Int16 per line, then padded to 4
+//   bytes an Int32 sample count for each line
+//
+// A line runs from south to north along a longitude, and the lines of a
+// tile go from west to east.
+
+#define TERRAIN_ELEVATION_CACHE_VERSION    1
+#define TERRAIN_ELEVATION_CACHE_ALIGNMENT  4096
+
+// Most cells of a TerrainTileIndex
+#define TERRAIN_TILE_INDEX_MAX_CELLS       (1 << 20)
+
+struct TerrainElevationCacheHeader
+{
+    char   magic[8];
+    UInt32 byteOrder;
+    UInt32 version;
+    UInt32 numTiles;
+    UInt32 keyLength;
+};
+
+struct TerrainElevationCacheTile
+{
+    double southWestLatitude;
+    double southWestLongitude;
+    double northEastLatitude;
+    double northEastLongitude;
+    double resolution[3];
+    double minElevation;
+    double maxElevation;
+    Int32  numLines;
+    Int32  lineStride;
+    UInt64 dataOffset;
+};
+
+/// \brief Grid over the bounding box of the elevation tiles giving, for
+/// each cell, the tiles that can hold a point of the cell, so that the
+/// tile of a point is found without scanning every tile.
+///
+/// The cells are as small as the smallest tile.  A tile crossing the
+/// dateline leaves the index unusable, and the tiles are then scanned.
+class TerrainTileIndex {
+public:
+    TerrainTileIndex();
+
+    void build(const std::vector<Coordinates>& southWestCorners,
+               const std::vector<Coordinates>& northEastCorners);
+
+    bool isUsable() const { return m_usable; }
+
+    /// Get the tiles, in ascending order, whose bounding box can hold
+    /// the point.
+    ///
+    /// \param point  Point in latitude and longitude
+    /// \param numTiles  Number of tiles returned
+    ///
+    /// \return The tiles, NULL if there are none
+    const UInt32* candidates(const Coordinates* point,
+                             UInt32* numTiles) const;
+
+private:
+    int latitudeCell(double latitude) const;
+    int longitudeCell(double longitude) const;
+
+    bool   m_usable;
+    double m_south;
+    double m_north;
+    double m_west;
+    double m_east;
+    double m_latitudeCellsPerDegree;
+    double m_longitudeCellsPerDegree;
+    int    m_numLatitudeCells;
+    int    m_numLongitudeCells;
+
+    // Tiles of cell c are m_tiles[m_cellStart[c]] up to
+    // m_tiles[m_cellStart[c + 1]]
+    std::vector<UInt32> m_cellStart;
+    std::vector<UInt32> m_tiles;
+};
+
+/// \brief Elevation tiles of a terrain in a cache file mapped read-only
+/// into memory.
+class TerrainElevationCache {
+public:
+    /// One tile, as its elevation data is written to or read from the
+    /// cache.
+    struct Tile {
+        Coordinates        southWestCorner;
+        Coordinates        northEastCorner;
+        double             resolution[3];
+        double             minElevation;
+        double             maxElevation;
+        int                numLines;
+        int                lineStride;
+        const Int32*       lineLengths;
+
+        // Start of each line.  In a mapped cache line i starts at
+        // samples + i * lineStride.
+        std::vector<const short*> lines;
+    };
+
+    TerrainElevationCache();
+    ~TerrainElevationCache();
+
+    /// Get the key of the source files of a terrain, from their names,
+    /// sizes and modification times.
+    ///
+    /// \param format  Terrain format, DEM or DTED
+    /// \param fileNames  Source files
+    ///
+    /// \return Key written to the cache
+    static std::string SourceKey(const std::string& format,
+                                 const std::vector<std::string>& fileNames);
+
+    /// Map the cache file.
+    ///
+    /// \param fileName  Cache file
+    /// \param sourceKey  Key of the source files
+    ///
+    /// \return false if there is no cache or it is not for the sources
+    bool open(const std::string& fileName, const std::string& sourceKey);
+
+    /// Write the tiles to the cache file.  The file is written under a
+    /// temporary name and then renamed, so that processes reading it
+    /// never see part of it.
+    ///
+    /// \param fileName  Cache file
+    /// \param sourceKey  Key of the source files
+    /// \param tiles  Tiles of the terrain
+    ///
+    /// \return false if the file cannot be written
+    static bool write(const std::string& fileName,
+                      const std::string& sourceKey,
+                      const std::vector<Tile>& tiles);
+
+    int numTiles() const { return (int)m_tiles.size(); }
+    const Tile& getTile(int index) const { return m_tiles[index]; }
+
+private:
+    void close();
+
+    const char*       m_data;
+    UInt64            m_size;
+    std::vector<Tile> m_tiles;
+};
+
+#endif /* TERRAIN_ELEVATION_CACHE_H */
@@ -272,10 +272,10 @@ protected:
         PhyData802_11* phy802_11 = m_parentData;
         double ber = 0;
 
-        ber = PHY_BER(phy802_11->thisPhy,
-                      this->rxDataRateType,
-                      sinr,
-                      getRxModel());
+        ber = PHY_GridBER(phy802_11->thisPhy,
+                          this->rxDataRateType,
+                          sinr,
+                          getRxModel());
         return ber;
     }
 
@@ -4,6 +4,9 @@
 #include "antenna.h"
 #include "message.h"
 #include "node.h"
+#include "partition.h"
+
+#include <algorithm>
 
 
 period::period(const Message* msg) 
@@ -97,6 +100,17 @@ std::ostream& PropOverlappingSignal::fmt(std::ostream& os) const
   return os;
 }
 
+// Orders signals by start time for the binary searches
+static bool startsBefore(clocktype t, const PropOverlappingSignal& sg)
+{
+  return t < sg.times().lower();
+}
+
+static bool startsAfter(const PropOverlappingSignal& sg, clocktype t)
+{
+  return sg.times().lower() < t;
+}
+
 void PropInterference::insert(Node* node, Message* msg) 
 {
   spectralBand* sb = MESSAGE_GetSpectralBand(msg);
@@ -106,16 +120,44 @@ void PropInterference::insert(Node* node, Message* msg)
 
   assert(node == m_node);
 
-  PropOverlappingSignal* sg = new PropOverlappingSignal(node, msg, sb);
+  PropOverlappingSignal sg(node, msg, sb);
 
-  if (m_signals == NULL) m_signals = new std::set<PropOverlappingSignal*>;
-  
+  if (m_signals == NULL) 
+  {
+    m_signals = new SignalStore;
+    m_signals->maxDuration = 0;
+  }
 
 #if DEBUG
-  cout << "node:" << node->nodeId << " " << "insert:" << *sg << endl;
+  cout << "node:" << node->nodeId << " " << "insert:" << sg << endl;
 #endif
 
-  m_signals->insert(sg);
+  // Signals arrive in start order, so this is nearly always the end
+  SignalList& signals = m_signals->signals;
+  clocktype start = sg.m_times.lower();
+
+  if (signals.empty() || signals.back().m_times.lower() <= start)
+  {
+    signals.push_back(sg);
+  }
+  else
+  {
+    signals.insert(std::upper_bound(signals.begin(), signals.end(),
+                                    start, startsBefore),
+                   sg);
+  }
+
+  m_signals->durations[sg.m_times.duration()]++;
+  if (sg.m_times.duration() > m_signals->maxDuration)
+  {
+    m_signals->maxDuration = sg.m_times.duration();
+  }
+}
+
+double PropInterference::overlapFraction(const spectralBand* band,
+                                         const spectralBand* signalBand)
+{
+  return m_node->partitionData->theSpectrum.overlapFraction(band, signalBand);
 }
 
 PropInterference::~PropInterference() 
@@ -363,30 +405,35 @@ double PropInterference::totalBandPower_mW(const spectralBand* band, clocktype s
 {
   if (m_signals == NULL) return 0.0;
 
-  
+  SignalList& signals = m_signals->signals;
+
+  // A signal active at start began after start - maxDuration
+  SignalListIterator it = std::upper_bound(signals.begin(), signals.end(),
+                                           start - m_signals->maxDuration,
+                                           startsBefore);
+  SignalListIterator last = std::upper_bound(it, signals.end(),
+                                             start, startsBefore);
   double powerTotal = 0;
-  std::set<PropOverlappingSignal*>::iterator it = m_signals->begin();
 
-  while (it != m_signals->end()) 
+  while (it != last) 
   {
-    PropOverlappingSignal* val = *it++;
+    PropOverlappingSignal& val = *it++;
 
-    if (val->m_times.in(start)) 
+    if (val.m_times.in(start)) 
     {
 #if DEBUG
-      std::cout << "band1: " << band << " band2: " << val->m_band << std::endl;
+      std::cout << "band1: " << band << " band2: " << val.m_band << std::endl;
 #endif
 
-        double bandFraction 
-          = band->convolve(val->m_band) / val->m_band->getBandwidth();
+      double bandFraction = overlapFraction(band, val.m_band);
 
-        double power_mW =  val->m_powerAtPhy[phyIndex];
+      double power_mW =  val.m_powerAtPhy[phyIndex];
 
 #if DEBUG
-        std::cout << "bandFraction: " << bandFraction << " power(mW): " << power_mW << std::endl;
+      std::cout << "bandFraction: " << bandFraction << " power(mW): " << power_mW << std::endl;
 #endif
 
-        powerTotal += bandFraction * power_mW;
+      powerTotal += bandFraction * power_mW;
     }
   }
 
@@ -403,23 +450,27 @@ double PropInterference::totalBandPower_mW(const spectralBand* band, clocktype s
   if (band == NULL) return 0.0;
   if (duration == 0) return 0.0;
 
-  double energyTotal = 0.0;
-  double timeTotal(0.0);
-
   period interval(start, duration + start);
 
-  std::set<PropOverlappingSignal*>::iterator it = m_signals->begin();
-  while (it != m_signals->end()) 
-  {
-    PropOverlappingSignal& val = *(*it); 
-    it++;
+  SignalList& signals = m_signals->signals;
 
-    double bandOverlap = band->convolve(val.m_band);
-    double bandFraction = bandOverlap / val.m_band->getBandwidth();
+  // Signals outside these bounds overlap the interval for no time
+  SignalListIterator it = std::upper_bound(signals.begin(), signals.end(),
+                                           start - m_signals->maxDuration,
+                                           startsBefore);
+  SignalListIterator last = std::lower_bound(it, signals.end(),
+                                             start + duration, startsAfter);
+  double energyTotal = 0.0;
+
+  while (it != last) 
+  {
+    PropOverlappingSignal& val = *it++;
 
     double timeOverlap = (double)interval.overlap(val.m_times);
     // double timeFraction = timeOverlap / (double)duration;
 
+    double bandFraction = overlapFraction(band, val.m_band);
+
     double power_mW =  val.m_powerAtPhy[phyIndex];
 
 #if DEBUG
@@ -429,7 +480,7 @@ double PropInterference::totalBandPower_mW(const spectralBand* band, clocktype s
     assert(timeOverlap <= duration);
 
     // This actually gives energy, not power
-    energyTotal += timeOverlap * bandFraction * val.m_powerAtPhy[phyIndex];
+    energyTotal += timeOverlap * bandFraction * power_mW;
   }
 
   double powerTotal = energyTotal / (double)duration;
@@ -515,7 +566,7 @@ double PropInterference::signalPower_mW(const Message* msg, const spectralBand*
 
     double bandFraction = (band == NULL || msgBand == NULL) 
       ? 1.0 
-      : band->convolve(msgBand)/msgBand->getBandwidth();
+      : overlapFraction(band, msgBand);
 
 
 /*
@@ -564,7 +615,7 @@ double PropInterference::signalPower_mW(const PropRxInfo* prx, const spectralBan
 
     double bandOverlap = (band == NULL) 
       ? 1.0 
-      : band->convolve(msgBand)/msgBand->getBandwidth();
+      : overlapFraction(band, msgBand);
 
 
 /*
@@ -601,7 +652,7 @@ double PropInterference::signalPower_mW(const PropRxInfo* rxInfo, const spectral
 
   double bandFraction = (band == NULL || msgBand == NULL)
     ? 1.0 
-    : band->convolve(msgBand)/msgBand->getBandwidth();
+    : overlapFraction(band, msgBand);
 
   clocktype startTime = rxInfo->rxStartTime;
   clocktype endTime = startTime + rxInfo->duration;
@@ -642,35 +693,56 @@ void PropInterference::prune(clocktype now)
   // lower is begining of signal
   // upper is end time
 
+  // The signals are in start order, so the first one not yet ended is
+  // the oldest.
+  SignalList& signals = m_signals->signals;
+  std::map<clocktype, int>& durations = m_signals->durations;
   clocktype oldest = now;
-  std::set<PropOverlappingSignal*>::iterator it = m_signals->begin();
-  while (it != m_signals->end()) 
-  {
-    PropOverlappingSignal* val= *it++;
+  SignalListIterator it = signals.begin();
 
-    if (val->m_times.upper() > now && val->m_times.lower() < oldest)
+  while (it != signals.end() && it->m_times.lower() < now) 
+  {
+    if (it->m_times.upper() > now)
     {
-      oldest = val->m_times.lower();
+      oldest = it->m_times.lower();
+      break;
     }
+    it++;
   }
 
-  it = m_signals->begin();
-  while (it != m_signals->end()) 
-  {
-    PropOverlappingSignal* val = *it++;
+  // Only signals starting by oldest can have ended by then.  Keep the
+  // others of them in order at the front.
+  SignalListIterator last = std::upper_bound(signals.begin(), signals.end(),
+                                             oldest, startsBefore);
+  SignalListIterator kept = signals.begin();
 
-    if (val->m_times.upper() > oldest) 
+  for (it = signals.begin(); it != last; it++) 
+  {
+    if (it->m_times.upper() > oldest) 
     {
-      continue;  // this signal overlaps at least one current signal
+      // this signal overlaps at least one current signal
+      if (kept != it) *kept = *it;
+      kept++;
+      continue;
     }
 
 #if DEBUG
-    cout << "prune:" << *val << endl;
+    cout << "prune:" << *it << endl;
 #endif
 
-    m_signals->erase(val);
-    delete(val);
+    std::map<clocktype, int>::iterator count =
+      durations.find(it->m_times.duration());
+    if (--count->second == 0)
+    {
+      durations.erase(count);
+    }
   }
+
+  signals.erase(kept, last);
+
+  // The pruned signals may have included the longest one; the lookups
+  // widen their search by maxDuration, so keep it to what is left.
+  m_signals->maxDuration = durations.empty() ? 0 : durations.rbegin()->first;
 }
 
 std::ostream& PropInterference::fmt(std::ostream& os) const 
@@ -681,13 +753,12 @@ std::ostream& PropInterference::fmt(std::ostream& os) const
     return os;
   }
 
-  SignalSetIterator it = m_signals->begin();
-  if (it == m_signals->end()) os << "empty";
+  SignalListConstIterator it = m_signals->signals.begin();
+  if (it == m_signals->signals.end()) os << "empty";
 
-  while (it != m_signals->end()) 
+  while (it != m_signals->signals.end()) 
   {
-    PropOverlappingSignal* val = *it++;
-    os << *val << endl;
+    os << *it++ << endl;
   }
 
   return os;
@@ -6076,6 +6076,7 @@ void MAC_ProcessDisableInterface(Node* node,
             forwardTable->row[i].interfaceIsEnabled = FALSE;
         }
     }
+    forwardTable->version++;
     // send event to GUI for showing deactivated interface
     GUI_SendInterfaceActivateDeactivateStatus(node->nodeId,
                                               GUI_DEACTIVATE_INTERFACE,
@@ -6226,6 +6227,7 @@ void MAC_ProcessEnableInterface(Node*    node,
             forwardTable->row[i].interfaceIsEnabled = TRUE;
         }
     }
+    forwardTable->version++;
 
 #ifdef ENTERPRISE_LIB
     if (MAC_IsASwitch(node))
@@ -22,9 +22,16 @@
 
 #include <math.h>
 
+#if defined(_WIN32) || defined(__linux__)
+#include <malloc.h>
+#elif defined(__MACH__)
+#include <malloc/malloc.h>
+#endif
+
 #include "api.h"
 #include "memory.h"
 #include "parallel.h"
+#include "qualnet_mutex.h"
 
 #define MEMSET_FULL_POOL (0)
 
@@ -56,6 +63,140 @@ UInt32 totalFreedMemory = 0;
 UInt32 totalPeakUsage = 0;
 UInt32 totalForPeakUsage = 0;
 
+// Per-thread state for the memory pools.  The key is created during
+// static initialization, before any partition or worker thread runs.
+struct MemoryPoolThreadState
+{
+    int         partitionId;
+    MemoryPool* cache;
+};
+
+static void MemoryPoolThreadStateFree(void* data)
+{
+    MemoryPoolThreadState* state = (MemoryPoolThreadState*) data;
+
+    if (state == NULL)
+    {
+        return;
+    }
+    if (state->cache != NULL)
+    {
+        MEM_PoolDestroy(state->cache);
+    }
+    free(state);
+}
+
+class MemoryPoolThreadKey
+{
+public:
+    MemoryPoolThreadKey()
+    {
+#ifdef _WIN32
+        m_index = TlsAlloc();
+        m_valid = (m_index != TLS_OUT_OF_INDEXES);
+#else
+        m_valid = (pthread_key_create(&m_key,
+                                      MemoryPoolThreadStateFree) == 0);
+#endif
+    }
+
+    MemoryPoolThreadState* get()
+    {
+        if (!m_valid)
+        {
+            ERROR_ReportError("Failed to create memory pool thread key");
+        }
+#ifdef _WIN32
+        MemoryPoolThreadState* state =
+            (MemoryPoolThreadState*) TlsGetValue(m_index);
+#else
+        MemoryPoolThreadState* state =
+            (MemoryPoolThreadState*) pthread_getspecific(m_key);
+#endif
+        if (state == NULL)
+        {
+            // Plain malloc, this must not recurse into the pools
+            state = (MemoryPoolThreadState*)
+                malloc(sizeof(MemoryPoolThreadState));
+            state->partitionId = -1;
+            state->cache = NULL;
+#ifdef _WIN32
+            TlsSetValue(m_index, state);
+#else
+            pthread_setspecific(m_key, state);
+#endif
+        }
+        return state;
+    }
+
+private:
+    bool          m_valid;
+#ifdef _WIN32
+    unsigned long m_index;
+#else
+    pthread_key_t m_key;
+#endif
+};
+
+static MemoryPoolThreadKey memoryPoolThreadKey;
+
+// Registry of partition pools, used for reporting only
+static MemoryPool*      memoryPoolList = NULL;
+static QNPartitionMutex memoryPoolListMutex;
+
+// Set by MEM_PoolEnableStats, see MEMORY-POOL-STATISTICS
+static bool memoryPoolPrintStats = false;
+
+// Returns the size class serving a request, or
+// MEM_POOL_NUM_SIZE_CLASSES if it is too large for the pool.
+static inline int MemoryPoolSizeClass(size_t size)
+{
+    int sizeClass = 0;
+    size_t cellSize = MEM_POOL_MIN_CELL_SIZE;
+
+    while (cellSize < size && sizeClass < MEM_POOL_NUM_SIZE_CLASSES)
+    {
+        cellSize <<= 1;
+        sizeClass++;
+    }
+    return sizeClass;
+}
+
+// Returns the size class a block can be recycled into: the largest
+// class whose cells fit in the block.  The block's real size is asked
+// of the allocator, since blocks handed to MEM_PoolFree may have been
+// allocated by MEM_malloc rather than by a pool.  Returns
+// MEM_POOL_NUM_SIZE_CLASSES for blocks that should just be freed,
+// including every block where the allocator can't tell its size.
+static inline int MemoryPoolBlockClass(void* ptr)
+{
+    size_t blockSize = 0;
+
+#if defined(_WIN32)
+    blockSize = _msize(ptr);
+#elif defined(__linux__)
+    blockSize = malloc_usable_size(ptr);
+#elif defined(__MACH__)
+    blockSize = malloc_size(ptr);
+#endif
+
+    if (blockSize < MEM_POOL_MIN_CELL_SIZE
+        || blockSize >= 2 * (size_t) MEM_POOL_MAX_CELL_SIZE)
+    {
+        return MEM_POOL_NUM_SIZE_CLASSES;
+    }
+
+    int sizeClass = 0;
+    size_t cellSize = MEM_POOL_MIN_CELL_SIZE;
+
+    while ((cellSize << 1) <= blockSize)
+    {
+        cellSize <<= 1;
+        sizeClass++;
+    }
+    return sizeClass;
+}
+
 static void* MEM_SystemCheckedMalloc(size_t size, const char * filename, int lineno) {
     void *ptr = NULL;
 
@@ -189,6 +330,8 @@ void MEM_CreateThreadData() {
 
 void MEM_InitializeThreadData(MemoryUsageData *usageData)
 {
+    memoryPoolThreadKey.get()->partitionId = usageData->partitionId;
+
 #ifdef MEMORY_SYSTEM
 
 #ifdef PARALLEL
@@ -233,6 +376,178 @@ void MEM_PrintThreadData()
 #endif //PARALLEL
 
 #endif //MEMORY_SYSTEM
+
+    if (!memoryPoolPrintStats)
+    {
+        return;
+    }
+
+    MemoryPoolThreadState* state = memoryPoolThreadKey.get();
+    {
+        // Without thread data (sequential runs) report every partition
+        QNPartitionLock lock(&memoryPoolListMutex);
+        for (MemoryPool* pool = memoryPoolList;
+             pool != NULL;
+             pool = pool->nextPool)
+        {
+            if (state->partitionId < 0
+                || pool->partitionId == state->partitionId)
+            {
+                MEM_PoolPrintStats(pool);
+            }
+        }
+    }
+    if (state->cache != NULL)
+    {
+        MEM_PoolPrintStats(state->cache);
+    }
+}
+
+void MEM_PoolEnableStats(bool enable)
+{
+    memoryPoolPrintStats = enable;
+}
+
+MemoryPool* MEM_PoolCreate(const char* name,
+                           int partitionId,
+                           UInt32 cacheBytesPerClass)
+{
+    MemoryPool* pool = (MemoryPool*) MEM_malloc(sizeof(MemoryPool));
+    memset(pool, 0, sizeof(MemoryPool));
+
+    strncpy(pool->name, name, sizeof(pool->name) - 1);
+    pool->partitionId = partitionId;
+    for (int i = 0; i < MEM_POOL_NUM_SIZE_CLASSES; i++)
+    {
+        pool->maxFree[i] =
+            cacheBytesPerClass / (MEM_POOL_MIN_CELL_SIZE << i);
+    }
+
+    if (partitionId >= 0)
+    {
+        QNPartitionLock lock(&memoryPoolListMutex);
+        pool->nextPool = memoryPoolList;
+        memoryPoolList = pool;
+    }
+    return pool;
+}
+
+void MEM_PoolDestroy(MemoryPool* pool)
+{
+    // The pool is no longer on the list MEM_PrintThreadData reports
+    if (memoryPoolPrintStats)
+    {
+        MEM_PoolPrintStats(pool);
+    }
+
+    if (pool->partitionId >= 0)
+    {
+        QNPartitionLock lock(&memoryPoolListMutex);
+        MemoryPool** prev = &memoryPoolList;
+        while (*prev != NULL && *prev != pool)
+        {
+            prev = &((*prev)->nextPool);
+        }
+        if (*prev == pool)
+        {
+            *prev = pool->nextPool;
+        }
+    }
+
+    for (int i = 0; i < MEM_POOL_NUM_SIZE_CLASSES; i++)
+    {
+        while (pool->freeList[i] != NULL)
+        {
+            MemoryPoolCell* cell = pool->freeList[i];
+            pool->freeList[i] = cell->next;
+            MEM_free(cell);
+        }
+        pool->numFree[i] = 0;
+    }
+    MEM_free(pool);
+}
+
+void* MEM_PoolAlloc(MemoryPool* pool, size_t size)
+{
+    int sizeClass = MemoryPoolSizeClass(size);
+
+    if (sizeClass == MEM_POOL_NUM_SIZE_CLASSES)
+    {
+        pool->numOversize++;
+        return MEM_malloc(size);
+    }
+
+    MemoryPoolCell* cell = pool->freeList[sizeClass];
+    if (cell == NULL)
+    {
+        pool->stats[sizeClass].misses++;
+        return MEM_malloc(MEM_POOL_MIN_CELL_SIZE << sizeClass);
+    }
+
+    pool->freeList[sizeClass] = cell->next;
+    pool->numFree[sizeClass]--;
+    pool->stats[sizeClass].hits++;
+    return cell;
+}
+
+void MEM_PoolFree(MemoryPool* pool, void* ptr)
+{
+    int sizeClass = MemoryPoolBlockClass(ptr);
+
+    if (sizeClass == MEM_POOL_NUM_SIZE_CLASSES)
+    {
+        MEM_free(ptr);
+        return;
+    }
+
+    if (pool->numFree[sizeClass] >= pool->maxFree[sizeClass])
+    {
+        pool->stats[sizeClass].released++;
+        MEM_free(ptr);
+        return;
+    }
+
+    MemoryPoolCell* cell = (MemoryPoolCell*) ptr;
+    cell->next = pool->freeList[sizeClass];
+    pool->freeList[sizeClass] = cell;
+    pool->numFree[sizeClass]++;
+    pool->stats[sizeClass].recycled++;
+}
+
+MemoryPool* MEM_PoolGetThreadCache()
+{
+    MemoryPoolThreadState* state = memoryPoolThreadKey.get();
+
+    if (state->cache == NULL)
+    {
+        state->cache = MEM_PoolCreate("thread cache",
+                                      -1,
+                                      MEM_POOL_THREAD_CACHE_BYTES);
+    }
+    return state->cache;
+}
+
+void MEM_PoolPrintStats(const MemoryPool* pool)
+{
+    printf("Memory Pool %s (partition %d): oversize allocations %"
+           TYPES_64BITFMT "u\n",
+           pool->name, pool->partitionId, pool->numOversize);
+
+    for (int i = 0; i < MEM_POOL_NUM_SIZE_CLASSES; i++)
+    {
+        const MemoryPoolClassStats* stats = &pool->stats[i];
+        if (stats->hits + stats->misses == 0)
+        {
+            continue;
+        }
+        printf("    cell %6d: hits (%" TYPES_64BITFMT "u), misses (%"
+               TYPES_64BITFMT "u), recycled (%" TYPES_64BITFMT
+               "u), released (%" TYPES_64BITFMT "u), cached (%u)\n",
+               MEM_POOL_MIN_CELL_SIZE << i,
+               stats->hits, stats->misses,
+               stats->recycled, stats->released,
+               pool->numFree[i]);
+    }
 }
 
 void MEM_ReportPartitionUsage(int    partitionId,
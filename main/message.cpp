@@ -81,6 +81,52 @@ std::set<Message*> gMessageSet;
 int gMessageSetPrintCount = 0;
 #endif /* TRACK_UNFREED_MESSAGES */
 
+// Returns the pool to use for payload or info memory.  Worker threads
+// can't use the partition pools (they aren't locked) so they use their
+// own thread-local pool instead, as do calls without a partition or
+// after the partition pools have been destroyed.
+static inline MemoryPool* MessageMemoryPool(
+    PartitionData* partition,
+    MemoryPool* partitionPool,
+    bool isMT)
+{
+    if (isMT || partition == NULL || partitionPool == NULL)
+    {
+        return MEM_PoolGetThreadCache();
+    }
+    return partitionPool;
+}
+
+// Returns true if dstMsg may share srcMsg's payload instead of copying
+// it.  The reference count isn't atomic, so sharing is limited to
+// sequential runs, and messages owned by worker threads never share.
+static inline bool MessageCanSharePayload(
+    PartitionData* partition,
+    const Message* dstMsg,
+    const Message* srcMsg)
+{
+    return partition != NULL
+           && !partition->isRunningInParallel()
+           && !dstMsg->mtWasMT
+           && !srcMsg->mtWasMT;
+}
+
+// Drops msg's reference to its shared payload.  Returns true if msg
+// held the last reference, in which case it now owns the buffer.
+static bool MessageReleaseSharedPayload(Message* msg)
+{
+    MessageSharedPayload* shared = msg->m_sharedPayload;
+
+    msg->m_sharedPayload = NULL;
+    shared->refCount--;
+    if (shared->refCount > 0)
+    {
+        return false;
+    }
+    MEM_free(shared);
+    return true;
+}
+
 // Message graph outputs a dependency graph that is useful for debugging.
 // purposes.  works for -np 1.  Outputs a file in the form:
 //
@@ -96,7 +142,8 @@ int gMessageSetPrintCount = 0;
 static Message gGraphMessage;
 #endif
 
-Message::Message() : m_radioId(-1), d_stamped(false)
+Message::Message()
+    : m_radioId(-1), d_stamped(false), m_sharedPayload(NULL)
 {
 #ifdef TRACK_UNFREED_MESSAGES
     assert(gMessageSet.find(this) == gMessageSet.end());
@@ -104,7 +151,8 @@ Message::Message() : m_radioId(-1), d_stamped(false)
 #endif
 }
 
-Message::Message(const Message& m) : m_radioId(-1), d_stamped(false)
+Message::Message(const Message& m)
+    : m_radioId(-1), mtWasMT(false), d_stamped(false), m_sharedPayload(NULL)
 {
 #ifdef TRACK_UNFREED_MESSAGES
     assert(gMessageSet.find(this) == gMessageSet.end());
@@ -122,7 +170,8 @@ Message::Message(
     int  /* layerType */,
     int  /* protocol */,
     int  /* eventType */,
-    bool /* isMT */) : m_radioId(-1), d_stamped(false)
+    bool /* isMT */)
+    : m_radioId(-1), d_stamped(false), m_sharedPayload(NULL)
 {
 #ifdef TRACK_UNFREED_MESSAGES
     assert(gMessageSet.find(this) == gMessageSet.end());
@@ -145,7 +194,14 @@ void MESSAGE_FreeContents(PartitionData *partition, Message *msg)
 
     if (msg->payloadSize > 0)
     {
-        MESSAGE_PayloadFree(partition, msg->payload, msg->payloadSize, wasMT);
+        if (msg->m_sharedPayload == NULL
+            || MessageReleaseSharedPayload(msg))
+        {
+            MESSAGE_PayloadFree(partition,
+                                msg->payload,
+                                msg->payloadSize,
+                                wasMT);
+        }
         msg->payload = 0;
         msg->payloadSize = 0;
     }
@@ -248,12 +304,18 @@ void Message::initialize(PartitionData* partition)
     m_flags               = 0;
     m_band                = NULL;
     m_mimoData            = NULL;
+    m_sharedPayload       = NULL;
 
     MESSAGE_SetLayer(this, DEFAULT_LAYER, TRACE_ANY_PROTOCOL);
     MESSAGE_SetEvent(this, MSG_DEFAULT);
 }
 
 void Message::operator = (const Message &msg)
+{
+    copyFrom(msg, false);
+}
+
+void Message::copyFrom(const Message& msg, bool sharePayload)
 {
     // copied the contents of MESSAGE_Duplicate to create this.
 
@@ -313,9 +375,26 @@ void Message::operator = (const Message &msg)
     memcpy(headerProtocols, msg.headerProtocols, sizeof(int) * MAX_HEADERS);
     memcpy(headerSizes, msg.headerSizes, sizeof(int) * MAX_HEADERS);
 
+    m_sharedPayload = NULL;
     if (payloadSize == 0) {
         payload = NULL;
     }
+    else if (sharePayload
+             && MessageCanSharePayload(m_partitionData, this, &msg))
+    {
+        // Share the payload; the first holder to modify it takes a copy.
+        // See Message::unsharePayload.
+        Message& srcMsg = const_cast<Message&>(msg);
+        if (srcMsg.m_sharedPayload == NULL)
+        {
+            srcMsg.m_sharedPayload = (MessageSharedPayload*)
+                MEM_malloc(sizeof(MessageSharedPayload));
+            srcMsg.m_sharedPayload->refCount = 1;
+        }
+        srcMsg.m_sharedPayload->refCount++;
+        m_sharedPayload = srcMsg.m_sharedPayload;
+        payload = msg.payload;
+    }
     else
     {
         payload = MESSAGE_PayloadAlloc(m_partitionData, msg.payloadSize, false);
@@ -388,6 +467,26 @@ void Message::operator = (const Message &msg)
     }
 }
 
+void Message::unsharePayload()
+{
+    char* sharedPayload = payload;
+
+    if (MessageReleaseSharedPayload(this))
+    {
+        // The other holders are gone, the buffer is ours.
+        return;
+    }
+
+    payload = MESSAGE_PayloadAlloc(m_partitionData, payloadSize, mtWasMT);
+    assert(payload != NULL);
+    memcpy(payload, sharedPayload, payloadSize);
+
+    if (packet != NULL)
+    {
+        packet = payload + (packet - sharedPayload);
+    }
+}
+
 void Message::setSent(bool val)
 {
     if (val)
@@ -723,39 +822,22 @@ char* MESSAGE_InfoFieldAlloc(PartitionData *partition, int infoSize, bool isMT)
     char * newInfo;
 
 #ifdef MESSAGE_NO_RECYCLE
-    const bool recycle = false;
+    newInfo = (char *) MEM_malloc(infoSize);
+    memset(newInfo, 0, infoSize);
 #else
-    const bool recycle = true;
+    // Info fields of up to SMALL_INFO_SPACE_SIZE bytes are grown in
+    // place by MESSAGE_AddInfo, so never hand out less than that.
+    int cellSize = MAX(infoSize, SMALL_INFO_SPACE_SIZE);
+
+    newInfo = (char *) MEM_PoolAlloc(
+                  MessageMemoryPool(partition,
+                                    partition ? partition->msgInfoPool : NULL,
+                                    isMT),
+                  cellSize);
+    memset(newInfo, 0, cellSize);
 #endif
 
-    bool useRecycled = (recycle && !isMT && partition != NULL);
-
-    if (infoSize > SMALL_INFO_SPACE_SIZE || !useRecycled)
-    {
-        newInfo = (char *) MEM_malloc(infoSize);
-        memset(newInfo, 0, infoSize);
-        return newInfo;
-    }
-    else
-    {
-        if ((partition->msgInfoFreeList == NULL) || ((isMT)) )
-        {
-            MessageInfoListCell* NewCell = (MessageInfoListCell*)
-                MEM_malloc(sizeof(MessageInfoListCell));
-            memset((char*)&(NewCell->infoMemory[0]), 0, SMALL_INFO_SPACE_SIZE);
-            return (char*) &(NewCell->infoMemory[0]);
-        }
-        else
-        {
-            newInfo = (char*)
-                &(partition->msgInfoFreeList->infoMemory[0]);
-            partition->msgInfoFreeList =
-                partition->msgInfoFreeList->next;
-            (partition->msgInfoFreeListNum) --;
-            memset(newInfo, 0, SMALL_INFO_SPACE_SIZE);
-            return newInfo;
-        }
-    }
+    return newInfo;
 }
 
 // Free space for one "info" field
@@ -780,34 +862,20 @@ void MESSAGE_InfoFieldFree(
     MessageInfoHeader* hdrPtr,
     bool wasMT)
 {
-#ifdef MESSAGE_NO_RECYCLE
-    if (hdrPtr->infoType != INFO_TYPE_DEFAULT||
-        hdrPtr->infoSize > SMALL_INFO_SPACE_SIZE)
+    // Default info fields that fit live in the message's smallInfoSpace
+    if (hdrPtr->infoType == INFO_TYPE_DEFAULT &&
+        hdrPtr->infoSize <= SMALL_INFO_SPACE_SIZE)
     {
-        MEM_free(hdrPtr->info);
+        return;
     }
+
+#ifdef MESSAGE_NO_RECYCLE
+    MEM_free(hdrPtr->info);
 #else
-    if ((partition != NULL &&
-        hdrPtr->infoType != INFO_TYPE_DEFAULT &&
-        hdrPtr->infoSize <= SMALL_INFO_SPACE_SIZE &&
-        (wasMT == false) &&
-        partition->msgInfoFreeListNum < MSG_INFO_LIST_MAX))
-    {
-        MessageInfoListCell* cellPtr =
-            (MessageInfoListCell*)hdrPtr->info;
-        cellPtr->next = partition->msgInfoFreeList;
-        partition->msgInfoFreeList = cellPtr;
-        (partition->msgInfoFreeListNum)++;
-    }
-    else if (hdrPtr->infoType != INFO_TYPE_DEFAULT ||
-             hdrPtr->infoSize > SMALL_INFO_SPACE_SIZE)
-    {
-        MEM_free(hdrPtr->info);
-    }
-    else
-    {
-        assert(hdrPtr->infoType == INFO_TYPE_DEFAULT && hdrPtr->infoSize <= SMALL_INFO_SPACE_SIZE);
-    }
+    MEM_PoolFree(MessageMemoryPool(partition,
+                                   partition ? partition->msgInfoPool : NULL,
+                                   wasMT),
+                 hdrPtr->info);
 #endif
 }
 
@@ -900,9 +968,9 @@ char* MESSAGE_AddInfo(PartitionData *partition,
             }
             else
             {
-                // TODO: Check that this is mem_freed
-                infoHdr.info = (char*) MEM_malloc(infoSize);
-                memset(infoHdr.info, 0, infoSize);
+                infoHdr.info = MESSAGE_InfoFieldAlloc(partition,
+                                                      infoSize,
+                                                      msg->mtWasMT);
             }
 
             infoHdr.infoSize = infoSize;
@@ -916,7 +984,9 @@ char* MESSAGE_AddInfo(PartitionData *partition,
                 // Free old memory if it was not using small info space
                 if (hdrPtrInfo->infoSize > SMALL_INFO_SPACE_SIZE)
                 {
-                    MEM_free(hdrPtrInfo->info);
+                    MESSAGE_InfoFieldFree(partition,
+                                          hdrPtrInfo,
+                                          msg->mtWasMT);
                 }
 
                 hdrPtrInfo->info = (char*) msg->smallInfoSpace;
@@ -929,13 +999,19 @@ char* MESSAGE_AddInfo(PartitionData *partition,
                     && hdrPtrInfo->infoSize > SMALL_INFO_SPACE_SIZE)
                 {
                     // Old one was not small info, free then allocate
-                    MEM_free(hdrPtrInfo->info);
-                    hdrPtrInfo->info = (char*) MEM_malloc(infoSize);
+                    MESSAGE_InfoFieldFree(partition,
+                                          hdrPtrInfo,
+                                          msg->mtWasMT);
+                    hdrPtrInfo->info = MESSAGE_InfoFieldAlloc(partition,
+                                                              infoSize,
+                                                              msg->mtWasMT);
                 }
                 else if ((unsigned int)infoSize > hdrPtrInfo->infoSize)
                 {
                     // Old one was small info, allocate new memory
-                    hdrPtrInfo->info = (char*) MEM_malloc(infoSize);
+                    hdrPtrInfo->info = MESSAGE_InfoFieldAlloc(partition,
+                                                              infoSize,
+                                                              msg->mtWasMT);
                 }
 
                 memset(hdrPtrInfo->info, 0, infoSize);
@@ -1507,6 +1583,11 @@ void MESSAGE_AddHeader(Node* /* node */,
                        int hdrSize,
                        TraceProtocolType traceProtocol)
 {
+    if (msg->m_sharedPayload != NULL)
+    {
+        msg->unsharePayload();
+    }
+
     msg->packet -= hdrSize;
     msg->packetSize += hdrSize;
 
@@ -1548,6 +1629,11 @@ void MESSAGE_RemoveHeader(Node* /* node */,
     ERROR_Assert(msg->headerProtocols[msg->numberOfHeaders-1] == traceProtocol,
                  "TRACE: Removing trace header that doesn't match!\n");
 
+    if (msg->m_sharedPayload != NULL)
+    {
+        msg->unsharePayload();
+    }
+
     msg->packet += hdrSize;
     msg->packetSize -= hdrSize;
 
@@ -1581,6 +1667,12 @@ char* MESSAGE_ReturnHeader(const Message* msg,
     int sizeOfHeadersToSkip = 0;
     assert(header <= msg->numberOfHeaders);
 
+    // Callers may write through the returned header
+    if (msg->m_sharedPayload != NULL)
+    {
+        const_cast<Message*>(msg)->unsharePayload();
+    }
+
     for (h = 0; h < header; h++) {
         sizeOfHeadersToSkip += msg->headerSizes[h];
     }
@@ -1601,6 +1693,11 @@ void MESSAGE_ExpandPacket(Node* /* node */,
                           Message *msg,
                           int size)
 {
+    if (msg->m_sharedPayload != NULL)
+    {
+        msg->unsharePayload();
+    }
+
     msg->packet -= size;
     msg->packetSize += size;
 
@@ -1626,6 +1723,11 @@ void MESSAGE_ShrinkPacket(Node* /* node */,
                           Message *msg,
                           int size)
 {
+    if (msg->m_sharedPayload != NULL)
+    {
+        msg->unsharePayload();
+    }
+
     msg->packet += size;
     msg->packetSize -= size;
 
@@ -1776,6 +1878,43 @@ Message* MESSAGE_Duplicate(
     return newMsg;
 }
 
+/* FUNCTION     MESSAGE_DuplicateShared
+ * PURPOSE      Create a new message which is a duplicate of the message
+ *              supplied as the parameter to the function, sharing its
+ *              payload buffer, and return the new message.
+ *
+ * Parameters:
+ *    node:       node which is caling message copy
+ *    msg:        message for which duplicate has to be made
+ */
+Message* MESSAGE_DuplicateShared(Node *node, const Message *msg)
+{
+    return MESSAGE_DuplicateShared(node->partitionData, msg);
+}
+
+/* FUNCTION     MESSAGE_DuplicateShared
+ * PURPOSE      Create a new message which is a duplicate of the message
+ *              supplied as the parameter to the function, sharing its
+ *              payload buffer, and return the new message.
+ *
+ * Parameters:
+ *    partition:  partition which is caling message copy
+ *    msg:        message for which duplicate has to be made
+ */
+Message* MESSAGE_DuplicateShared(PartitionData *partition, const Message *msg)
+{
+    Message* newMsg = MESSAGE_Alloc(partition,
+                                    msg->layerType,
+                                    msg->protocolType,
+                                    msg->eventType,
+                                    false);
+
+    assert(newMsg != NULL);
+    newMsg->copyFrom(*msg, true);
+
+    return newMsg;
+}
+
 
 /*
  * FUNCTION     MESSAGE_PayloadAlloc
@@ -1804,35 +1943,18 @@ char* MESSAGE_PayloadAlloc(PartitionData *partition,
                            int payloadSize,
                            bool isMT)
 {
-    if ((payloadSize/* + MSG_MAX_HDR_SIZE*/) > MAX_CACHED_PAYLOAD_SIZE)
-    {
-        return (char *) MEM_malloc(payloadSize/* + MSG_MAX_HDR_SIZE*/);
-    }
-    else
-    {
 #ifdef MESSAGE_NO_RECYCLE
-        char *ptr = (char *) MEM_malloc(payloadSize/* + MSG_MAX_HDR_SIZE*/);
-        memset(ptr, 0, payloadSize);
-        return ptr;
+    char *ptr = (char *) MEM_malloc(payloadSize);
+    memset(ptr, 0, payloadSize);
+    return ptr;
 #else
-        if ((partition->msgPayloadFreeList == NULL) || (isMT))
-        {
-            MessagePayloadListCell* NewCell = (MessagePayloadListCell*)
-                MEM_malloc(sizeof(MessagePayloadListCell));
-            return (char *) &(NewCell->payloadMemory[0]);
-        }
-        else
-        {
-            char *payload = (char *)
-                &(partition->msgPayloadFreeList->payloadMemory[0]);
-            partition->msgPayloadFreeList =
-                partition->msgPayloadFreeList->next;
-            (partition->msgPayloadFreeListNum)--;
-
-            return payload;
-        }
+    return (char *) MEM_PoolAlloc(
+                        MessageMemoryPool(partition,
+                                          partition ? partition->msgPayloadPool
+                                                    : NULL,
+                                          isMT),
+                        payloadSize);
 #endif
-    }
 }
 
 /*
@@ -1869,21 +1991,10 @@ void MESSAGE_PayloadFree(PartitionData *partition,
 #ifdef MESSAGE_NO_RECYCLE
     MEM_free(payload);
 #else
-    if ((partition != NULL) &&
-        (payloadSize <= MAX_CACHED_PAYLOAD_SIZE) &&
-        (wasMT == false) &&
-        (partition->msgPayloadFreeListNum < MSG_PAYLOAD_LIST_MAX))
-    {
-        MessagePayloadListCell* cellPtr =
-            (MessagePayloadListCell*)payload;
-        cellPtr->next = partition->msgPayloadFreeList;
-        partition->msgPayloadFreeList = cellPtr;
-        (partition->msgPayloadFreeListNum)++;
-    }
-    else
-    {
-        MEM_free(payload);
-    }
+    MEM_PoolFree(MessageMemoryPool(partition,
+                                   partition ? partition->msgPayloadPool : NULL,
+                                   wasMT),
+                 payload);
 #endif
 }
 
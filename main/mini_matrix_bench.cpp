@@ -0,0 +1,244 @@
+// Copyright (c) 2001-2015, SCALABLE Network Technologies, Inc.  All Rights Reserved.
+//                          600 Corporate Pointe
+//                          Suite 1200
+//                          Culver City, CA 90230
+//                          info@scalable-networks.com
+//
+// This source code is licensed, not sold, and is subject to a written
+// license agreement.  Among other things, no portion of this source
+// code may be copied, transmitted, disclosed, displayed, distributed,
+// translated, used as the basis for a derivative work, or used, in
+// whole or in part, for any program or purpose other than its intended
+// use in compliance with the license agreement as part of the QualNet
+// software.  This source code and certain of the algorithms contained
+// within it are confidential trade secrets of Scalable Network
+// Technologies, Inc. and may not be used as the basis for any other
+// software, hardware, product or service.
+
+/*
+ * Times the complex MiniMatrix inverse and determinant kernels against
+ * the cofactor expansions they replaced, for each matrix size, and
+ * reports the largest error of A * inverse(A) - I of each.
+ *
+ * Usage: mini_matrix_bench [-size <n>]... [-seconds <s>]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sstream>
+#include <vector>
+
+#include "api.h"
+#include "random.h"
+#include "util_mini_matrix.h"
+#include "WallClock.h"
+
+#define MINI_MATRIX_BENCH_MATRICES  64
+#define MINI_MATRIX_BENCH_MAX_SIZE  8
+
+// Sum of results, which keeps the kernels from being optimized away
+static std::complex<double> miniMatrixBenchSink;
+
+typedef CplxMiniMatrix (CplxMiniMatrix::*MiniMatrixBenchInverse)() const;
+typedef std::complex<double>
+    (CplxMiniMatrix::*MiniMatrixBenchDeterminant)() const;
+
+// Random channel-like matrices with entries of unit variance
+static
+void MiniMatrixBenchCreateMatrices(
+    std::size_t size,
+    std::vector<CplxMiniMatrix>& matrices)
+{
+    RandomSeed seed;
+    RANDOM_SetSeed(seed, 1, (UInt32) size);
+
+    matrices.clear();
+    for (int m = 0; m < MINI_MATRIX_BENCH_MATRICES; m++)
+    {
+        CplxMiniMatrix matrix(size, size);
+        for (std::size_t i = 0; i < size; i++)
+        {
+            for (std::size_t j = 0; j < size; j++)
+            {
+                matrix(i, j) = std::complex<double>(
+                                   RANDOM_erand(seed) - 0.5,
+                                   RANDOM_erand(seed) - 0.5) * 2.449;
+            }
+        }
+        matrices.push_back(matrix);
+    }
+}
+
+// Largest magnitude of the elements of A * inverse(A) - I
+static
+double MiniMatrixBenchError(
+    const CplxMiniMatrix& matrix,
+    const CplxMiniMatrix& inverse)
+{
+    CplxMiniMatrix product = matrix * inverse;
+    double error = 0.0;
+
+    for (std::size_t i = 0; i < product.Rows(); i++)
+    {
+        for (std::size_t j = 0; j < product.Cols(); j++)
+        {
+            std::complex<double> expected(i == j ? 1.0 : 0.0, 0.0);
+            error = MAX(error, std::abs(product(i, j) - expected));
+        }
+    }
+    return error;
+}
+
+// Runs the kernel over the matrices until the time is used, and returns
+// the nanoseconds per matrix
+static
+double MiniMatrixBenchTimeInverse(
+    const std::vector<CplxMiniMatrix>& matrices,
+    MiniMatrixBenchInverse inverse,
+    double seconds,
+    double* error)
+{
+    clocktype start = WallClock::getTrueRealTime();
+    clocktype elapsed;
+    Int64 count = 0;
+
+    *error = 0.0;
+    for (std::size_t m = 0; m < matrices.size(); m++)
+    {
+        *error = MAX(*error, MiniMatrixBenchError(matrices[m],
+                                                  (matrices[m].*inverse)()));
+    }
+
+    do
+    {
+        for (std::size_t m = 0; m < matrices.size(); m++)
+        {
+            miniMatrixBenchSink += (matrices[m].*inverse)()(0, 0);
+        }
+        count += matrices.size();
+        elapsed = WallClock::getTrueRealTime() - start;
+    } while (elapsed < seconds * SECOND);
+
+    return (double) elapsed / (double) NANO_SECOND / (double) count;
+}
+
+static
+double MiniMatrixBenchTimeDeterminant(
+    const std::vector<CplxMiniMatrix>& matrices,
+    MiniMatrixBenchDeterminant determinant,
+    double seconds)
+{
+    clocktype start = WallClock::getTrueRealTime();
+    clocktype elapsed;
+    Int64 count = 0;
+
+    do
+    {
+        for (std::size_t m = 0; m < matrices.size(); m++)
+        {
+            miniMatrixBenchSink += (matrices[m].*determinant)();
+        }
+        count += matrices.size();
+        elapsed = WallClock::getTrueRealTime() - start;
+    } while (elapsed < seconds * SECOND);
+
+    return (double) elapsed / (double) NANO_SECOND / (double) count;
+}
+
+static
+void MiniMatrixBenchUsage(const char* program)
+{
+    fprintf(stderr,
+            "Usage: %s [-size <n>]... [-seconds <s>]\n"
+            "  -size     matrix size, 2 to %d (default all)\n"
+            "  -seconds  time spent on each kernel and size (default 0.2)\n",
+            program, MINI_MATRIX_BENCH_MAX_SIZE);
+    exit(1);
+}
+
+int main(int argc, char **argv)
+{
+    std::vector<std::size_t> sizes;
+    double seconds = 0.2;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-size") == 0 && i + 1 < argc)
+        {
+            int size = atoi(argv[++i]);
+            if (size < 2 || size > MINI_MATRIX_BENCH_MAX_SIZE)
+            {
+                MiniMatrixBenchUsage(argv[0]);
+            }
+            sizes.push_back((std::size_t) size);
+        }
+        else if (strcmp(argv[i], "-seconds") == 0 && i + 1 < argc)
+        {
+            seconds = atof(argv[++i]);
+            if (seconds <= 0.0)
+            {
+                MiniMatrixBenchUsage(argv[0]);
+            }
+        }
+        else
+        {
+            MiniMatrixBenchUsage(argv[0]);
+        }
+    }
+    if (sizes.empty())
+    {
+        for (std::size_t size = 2; size <= MINI_MATRIX_BENCH_MAX_SIZE; size++)
+        {
+            sizes.push_back(size);
+        }
+    }
+
+    printf("%-5s %14s %14s %8s %12s %12s %14s %14s\n",
+           "size",
+           "cofactor inv", "inverse", "speedup",
+           "cofactor err", "error",
+           "cofactor det", "determinant");
+
+    for (std::size_t s = 0; s < sizes.size(); s++)
+    {
+        std::vector<CplxMiniMatrix> matrices;
+        double cofactorError;
+        double error;
+
+        MiniMatrixBenchCreateMatrices(sizes[s], matrices);
+
+        double cofactorInverseNs = MiniMatrixBenchTimeInverse(
+                                       matrices,
+                                       &CplxMiniMatrix::CofactorInverse,
+                                       seconds,
+                                       &cofactorError);
+        double inverseNs = MiniMatrixBenchTimeInverse(
+                               matrices,
+                               &CplxMiniMatrix::Inverse,
+                               seconds,
+                               &error);
+        double cofactorDeterminantNs = MiniMatrixBenchTimeDeterminant(
+                                           matrices,
+                                           &CplxMiniMatrix::CofactorDeterminant,
+                                           seconds);
+        double determinantNs = MiniMatrixBenchTimeDeterminant(
+                                   matrices,
+                                   &CplxMiniMatrix::Determinant,
+                                   seconds);
+
+        printf("%dx%-3d %11.1f ns %11.1f ns %7.1fx %12.2e %12.2e "
+               "%11.1f ns %11.1f ns\n",
+               (int) sizes[s], (int) sizes[s],
+               cofactorInverseNs, inverseNs,
+               cofactorInverseNs / inverseNs,
+               cofactorError, error,
+               cofactorDeterminantNs, determinantNs);
+    }
+
+    if (miniMatrixBenchSink.real() == 0.125)
+    {
+        printf("\n");
+    }
+    return 0;
+}
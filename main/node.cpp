@@ -665,6 +665,8 @@ void Node::initMIMO() {
   RANDOM_SetSeed(mimoSeed, globalSeed, nodeId, APP_MIMO, 0);
   mimo_Rand.setSeed(mimoSeed);
   mimo_Rand.setDistributionGaussian(sqrt(0.5));
+  // getMIMO_Hw draws the whole channel at once
+  mimo_Rand.setBuffered(true);
   mimoHw_nextRebuild = 0;
   mimoHw_interval = mimoUpdateInterval;
 
@@ -56,6 +56,9 @@
 #include "partition.h"
 #include "external_util.h"
 #include "scheduler.h"
+#include "sched_ladder.h"
+#include "sched_pairing_heap.h"
+#include "sched_trace.h"
 #include "WallClock.h"
 #include "stats_global.h"
 #include "context.h"
@@ -765,6 +768,9 @@ PartitionData::PartitionData(int thePartitionId, int numPartitions, int numOPHos
     numChannels = 0;
     numFixedChannels = 0;
     propChannel = NULL;
+    propBatch = NULL;
+    propSpatialIndex = NULL;
+    propSignalsCulled = NULL;
 
 #ifdef ADDON_NGCNMS
     gridInfo = NULL;
@@ -788,6 +794,12 @@ PartitionData::PartitionData(int thePartitionId, int numPartitions, int numOPHos
     msgPayloadFreeList = NULL;
     msgInfoFreeListNum = 0;
     msgInfoFreeList = NULL;
+    msgPayloadPool = MEM_PoolCreate("message payloads",
+                                    thePartitionId,
+                                    MEM_POOL_PARTITION_CACHE_BYTES);
+    msgInfoPool = MEM_PoolCreate("message info fields",
+                                 thePartitionId,
+                                 MEM_POOL_PARTITION_CACHE_BYTES);
     splayNodeFreeListNum = 0;
     splayNodeFreeList = NULL;
     eventSequence = 0;
@@ -814,6 +826,9 @@ PartitionData::PartitionData(int thePartitionId, int numPartitions, int numOPHos
     externalForwardCommunicator = 0;
     externalSimulationDurationCommunicator = 0;
     schedulerInfo = NULL;
+    schedulerTrace = NULL;
+    ladderQueue = NULL;
+    pairingHeap = NULL;
     numAntennaPatterns = 0;
     numAntennaModels = 0;
     antennaPatterns = NULL;
@@ -883,6 +898,7 @@ PartitionData::PartitionData(int thePartitionId, int numPartitions, int numOPHos
     dbController = NULL;
 
     urbanCache = NULL;
+    pathlossCache = NULL;
 }
 
 bool PartitionData::addOpHost()
@@ -1133,6 +1149,9 @@ void PARTITION_InitializePartition(
     memset(partitionData->nodeData, 0, sizeof(Node*) * numNodes);
 
     partitionData->propChannel = NULL;
+    partitionData->propBatch = NULL;
+    partitionData->propSpatialIndex = NULL;
+    partitionData->propSignalsCulled = NULL;
 #ifdef ADDON_NGCNMS
     partitionData->gridInfo = NULL;
     partitionData->gridAutoBuild = NULL;
@@ -1447,8 +1466,53 @@ void PARTITION_InitializePartition(
     }
 #endif
 
-    // Initalize scheduler for this partition
-    SCHED_Initialize(partitionData, nodeInput);
+    // Initalize scheduler for this partition.  SCHED_Initialize only
+    // reads SCHEDULER-QUEUE-TYPE and does not know the ladder queue or
+    // pairing heap, so for those it is given no parameters, which sets
+    // up its default queue, and the queue is then replaced.
+    IO_ReadString(
+        partitionData->partitionId,
+        ANY_ADDRESS,
+        nodeInput,
+        "SCHEDULER-QUEUE-TYPE",
+        &wasFound,
+        buf);
+
+    if (wasFound
+        && (strcmp(buf, "LADDER") == 0 || strcmp(buf, "PAIRING-HEAP") == 0))
+    {
+        NodeInput noInput;
+        memset(&noInput, 0, sizeof(noInput));
+        SCHED_Initialize(partitionData, &noInput);
+
+        if (strcmp(buf, "LADDER") == 0) {
+            SCHED_LADDER_Setup(partitionData);
+        }
+        else {
+            SCHED_PAIRINGHEAP_Setup(partitionData);
+        }
+    }
+    else {
+        SCHED_Initialize(partitionData, nodeInput);
+    }
+
+    // Record the scheduler calls for replay by sched_bench
+    IO_ReadString(
+        partitionData->partitionId,
+        ANY_ADDRESS,
+        nodeInput,
+        "SCHEDULER-TRACE-FILE",
+        &wasFound,
+        buf);
+
+    if (wasFound) {
+        if (partitionData->getNumPartitions() > 1) {
+            char partitionSuffix[MAX_STRING_LENGTH];
+            sprintf(partitionSuffix, ".%d", partitionData->partitionId);
+            strcat(buf, partitionSuffix);
+        }
+        SCHED_TRACE_Start(partitionData, buf);
+    }
 
     return;
 }
@@ -1855,6 +1919,22 @@ void PARTITION_InitializeNodes(PartitionData* partitionData) {
         printf("Creating local nodes on %d\n", partitionData->partitionId);
     }
 
+    // Counters of the message memory pools, printed at the end of the
+    // run.  Default is "NO".
+    BOOL poolStatsFound;
+    BOOL poolStats;
+    IO_ReadBool(
+        partitionData->partitionId,
+        ANY_ADDRESS,
+        nodeInput,
+        "MEMORY-POOL-STATISTICS",
+        &poolStatsFound,
+        &poolStats);
+    if (poolStatsFound)
+    {
+        MEM_PoolEnableStats(poolStats == TRUE);
+    }
+
 #ifdef SOPSVOPS_INTERFACE
     if (SopsVopsInterfaceEnabled())
     {
@@ -2522,6 +2602,8 @@ void PARTITION_Finalize(PartitionData* partitionData)
 #endif // LTE_LIB
     }
 
+    PROP_PartitionFinalize(partitionData);
+
     // Finalize scheduler for this partition
     SCHED_Finalize(partitionData);
 
@@ -2547,6 +2629,13 @@ void PARTITION_Finalize(PartitionData* partitionData)
     UTIL_PartitionFinalize(partitionData);
     // if last one should call UTIL_GlobalEpoch()
 #endif /* SATELLITE_LIB */
+
+    // Messages freed from here on return their memory to the thread
+    // cache instead
+    MEM_PoolDestroy(partitionData->msgPayloadPool);
+    partitionData->msgPayloadPool = NULL;
+    MEM_PoolDestroy(partitionData->msgInfoPool);
+    partitionData->msgInfoPool = NULL;
 }
 
 /*
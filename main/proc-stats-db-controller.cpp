@@ -324,7 +324,8 @@ void Proc::DB::StatsDBController::PublishFinishedTablesInterestsToDb()
         {
             query += "RowId bigint auto_increment primary key";
         }
-        else if (partition->statsDb->engineType == UTIL::Database::dbSqlite)
+        else if (partition->statsDb->engineType == UTIL::Database::dbSqlite ||
+                 partition->statsDb->engineType == UTIL::Database::dbLog)
         {
             query += "RowId INTEGER PRIMARY KEY AUTOINCREMENT";
         }
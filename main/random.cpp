@@ -24,10 +24,13 @@
 #include "clock.h"
 #include "fileio.h"
 #include "qualnet_error.h"
+#include "qualnet_mutex.h"
 
+#include <algorithm>
 #include <map>
 #include <iostream>
 #include <string>
+#include <vector>
 
 using namespace std;
 
@@ -10038,10 +10041,84 @@ const unsigned short randomSeeds[10000][3] = {
 
 std::map<string, ArbitraryDistribution*> userDistributions;
 
+// Builds the cumulative probabilities of a normalized distribution
+static void RANDOM_BuildCumulative(ArbitraryDistribution* dist)
+{
+    int n = dist->numDistPoints;
+    double sum = 0.0;
+    int i;
+
+    dist->cumulative = (double*) MEM_malloc(sizeof(double) * n);
+    for (i = 0; i < n; i++)
+    {
+        sum += dist->values[i].probability;
+        dist->cumulative[i] = sum;
+    }
+    if (n > 0)
+    {
+        dist->cumulative[n - 1] = 1.0;
+    }
+}
+
+// Builds the alias table of a normalized distribution (Vose's method)
+static void RANDOM_BuildAliasTable(ArbitraryDistribution* dist)
+{
+    int n = dist->numDistPoints;
+    std::vector<int> small;
+    std::vector<int> large;
+    int i;
+
+    dist->aliasProbability = (double*) MEM_malloc(sizeof(double) * n);
+    dist->alias = (Int32*) MEM_malloc(sizeof(Int32) * n);
+
+    for (i = 0; i < n; i++)
+    {
+        dist->aliasProbability[i] = dist->values[i].probability * n;
+        dist->alias[i] = i;
+
+        if (dist->aliasProbability[i] < 1.0)
+        {
+            small.push_back(i);
+        }
+        else
+        {
+            large.push_back(i);
+        }
+    }
+
+    // Each point below the average is topped up by one above it
+    while (!small.empty() && !large.empty())
+    {
+        int less = small.back();
+        int more = large.back();
+
+        small.pop_back();
+        dist->alias[less] = more;
+        dist->aliasProbability[more] -= 1.0 - dist->aliasProbability[less];
+
+        if (dist->aliasProbability[more] < 1.0)
+        {
+            large.pop_back();
+            small.push_back(more);
+        }
+    }
+
+    // Those left are at the average up to rounding
+    for (i = 0; i < (int) large.size(); i++)
+    {
+        dist->aliasProbability[large[i]] = 1.0;
+    }
+    for (i = 0; i < (int) small.size(); i++)
+    {
+        dist->aliasProbability[small[i]] = 1.0;
+    }
+}
+
 static ArbitraryDistribution* RANDOM_ReadDistributionData(
     int             count,
     const NodeInput distInput,
-    const char*     distName)
+    const char*     distName,
+    ArbitrarySampling sampling)
 {
     char distStr[MAX_STRING_LENGTH];
     int distNumPoints = 10;
@@ -10062,6 +10139,10 @@ static ArbitraryDistribution* RANDOM_ReadDistributionData(
             dist->distributionName = (char*) MEM_malloc(strlen(distName) + 1);
             strcpy(dist->distributionName, distName);
             dist->numDistPoints = distNumPoints;
+            dist->sampling = sampling;
+            dist->aliasProbability = NULL;
+            dist->alias = NULL;
+            dist->cumulative = NULL;
             dist->values = (ValueProbabilityPair*)
                            MEM_malloc(sizeof(ValueProbabilityPair) * distNumPoints);
 
@@ -10091,6 +10172,24 @@ static ArbitraryDistribution* RANDOM_ReadDistributionData(
     for (i = 0; i < dist->numDistPoints; i++) {
         dist->values[i].probability /= sum;
     }
+
+    if (sampling == ARBITRARY_CONTINUOUS)
+    {
+        for (i = 1; i < dist->numDistPoints; i++)
+        {
+            if (dist->values[i].value < dist->values[i - 1].value)
+            {
+                ERROR_ReportErrorArgs(
+                    "The values of the CONTINUOUS distribution %s must be "
+                    "in increasing order", distName);
+            }
+        }
+        RANDOM_BuildCumulative(dist);
+    }
+    else if (sampling == ARBITRARY_ALIAS)
+    {
+        RANDOM_BuildAliasTable(dist);
+    }
     return dist;
 }
 
@@ -10100,6 +10199,7 @@ void RANDOM_LoadUserDistributions(
     NodeInput appInput;
     char appStr[MAX_STRING_LENGTH];
     char distName[MAX_STRING_LENGTH];
+    char distMode[MAX_STRING_LENGTH];
     string newName;
     int i;
     int k;
@@ -10177,11 +10277,28 @@ void RANDOM_LoadUserDistributions(
 
         for (i = 0; i < appInput.numLines; i++)
         {
-            sscanf(appInput.inputStrings[i], "%s %s", appStr, distName);
+            distMode[0] = '\0';
+            sscanf(appInput.inputStrings[i], "%s %s %s",
+                   appStr, distName, distMode);
 
             if (strcmp(appStr, "ARBITRARY-DISTRIBUTION") == 0)
             {
-                arb = RANDOM_ReadDistributionData(i+1, appInput, distName);
+                // ARBITRARY-DISTRIBUTION <name> [ALIAS | CONTINUOUS]
+                ArbitrarySampling sampling = ARBITRARY_SCAN;
+
+                if (strcmp(distMode, "ALIAS") == 0)
+                {
+                    sampling = ARBITRARY_ALIAS;
+                }
+                else if (strcmp(distMode, "CONTINUOUS") == 0)
+                {
+                    sampling = ARBITRARY_CONTINUOUS;
+                }
+                arb = RANDOM_ReadDistributionData(
+                          i+1,
+                          appInput,
+                          distName,
+                          sampling);
 
                 newName = distName;
                 userDistributions[newName] = arb;
@@ -10407,7 +10524,7 @@ T RandomDistribution<T>::uniform(RandomSeed seed){
         range += 1.0; // add an extra one to allow for truncation
     }
 
-    random = range * RANDOM_erand(seed);
+    random = range * erand(seed);
 
     val = value1 + (T) (random);
 
@@ -10420,7 +10537,10 @@ T RandomDistribution<T>::uniform(RandomSeed seed){
 
 template <class T>
 T RandomDistribution<T>::exponential(RandomSeed seed) {
-    return (T)(-log(RANDOM_erand(seed)) * (double)value1);
+    if (type == ZIG_EXP) {
+        return (T)(zigguratExponential(seed) * (double)value1);
+    }
+    return (T)(-log(erand(seed)) * (double)value1);
 }
 
 //pdf is of the form: f(x) = K V**K/x**(K+1)
@@ -10445,7 +10565,7 @@ T RandomDistribution<T>::pareto(RandomSeed seed) {
     cdf_b = xmin/b;
     cdf_b = 1. - pow(cdf_b, alpha);
 
-    double U = RANDOM_erand(seed);
+    double U = erand(seed);
 
     U = (cdf_b - cdf_a)*U + cdf_a;
 
@@ -10470,7 +10590,7 @@ T RandomDistribution<T>::paretoGeneral(RandomSeed seed) {
     double b = (double) value1;
     double a = alpha;
 
-    double U = RANDOM_erand(seed);
+    double U = erand(seed);
 
     U = pow(1. - U, 1./a);
     U = b/U - b;
@@ -10483,7 +10603,7 @@ T RandomDistribution<T>::paretoUntruncated(RandomSeed seed) {
 
     double xmin = (double) value1;
 
-    double U = RANDOM_erand(seed);
+    double U = erand(seed);
 
     U = pow(1. - U, 1./alpha);
 
@@ -10496,16 +10616,20 @@ T RandomDistribution<T>::gaussianInt(RandomSeed seed) {
     double val1 = 0.0;
     double val2;
     double r = 0.0;
-    while (r == 0.0 || r > 1.0) {
-        val1 = -1.0 + 2.0 * RANDOM_erand(seed);
-        val2 = -1.0 + 2.0 * RANDOM_erand(seed);
-        r = val1 * val1 + val2 * val2;
-    }
-
     double rv_double;
     int rv_int;
 
-    rv_double = (alpha * val1 * sqrt(-2.0 * log(r) / r)) ;
+    if (type == ZIG_INT_GAU) {
+        rv_double = alpha * zigguratNormal(seed);
+    }
+    else {
+        while (r == 0.0 || r > 1.0) {
+            val1 = -1.0 + 2.0 * erand(seed);
+            val2 = -1.0 + 2.0 * erand(seed);
+            r = val1 * val1 + val2 * val2;
+        }
+        rv_double = (alpha * val1 * sqrt(-2.0 * log(r) / r)) ;
+    }
     rv_int = (int) rv_double;
 
     double diff = rv_double - (double) rv_int;
@@ -10528,9 +10652,12 @@ T RandomDistribution<T>::gaussian(RandomSeed seed) {
     double val1 = 0.0;
     double val2;
     double r = 0.0;
+    if (type == ZIG_GAU) {
+        return (T)(alpha * zigguratNormal(seed));
+    }
     while (r == 0.0 || r > 1.0) {
-        val1 = -1.0 + 2.0 * RANDOM_erand(seed);
-        val2 = -1.0 + 2.0 * RANDOM_erand(seed);
+        val1 = -1.0 + 2.0 * erand(seed);
+        val2 = -1.0 + 2.0 * erand(seed);
         r = val1 * val1 + val2 * val2;
     }
     return (T)(alpha * val1 * sqrt(-2.0 * log(r) / r));
@@ -10725,6 +10852,7 @@ T RandomDistribution<T>::getRandomNumber()
         return uniform(randomSeed);
         break;
     case EXP:
+    case ZIG_EXP:
         return exponential(randomSeed);
         break;
     case TPD4:
@@ -10740,9 +10868,11 @@ T RandomDistribution<T>::getRandomNumber()
         return paretoGeneral(randomSeed);
         break;
     case GAU:
+    case ZIG_GAU:
         return gaussian(randomSeed);
         break;
     case INT_GAU:
+    case ZIG_INT_GAU:
         return gaussianInt(randomSeed);
         break;
     case USER:
@@ -10772,6 +10902,7 @@ T RandomDistribution<T>::getRandomNumber(RandomSeed newSeed)
         return uniform(newSeed);
         break;
     case EXP:
+    case ZIG_EXP:
         return exponential(newSeed);
         break;
     case TPD4:
@@ -10787,9 +10918,11 @@ T RandomDistribution<T>::getRandomNumber(RandomSeed newSeed)
         return paretoGeneral(newSeed);
         break;
     case GAU:
+    case ZIG_GAU:
         return gaussian(newSeed);
         break;
     case INT_GAU:
+    case ZIG_INT_GAU:
         return gaussianInt(newSeed);
         break;
     case USER:
@@ -10812,7 +10945,7 @@ double RandomDistribution<T>::processUserDistribution(RandomSeed seed)
 
     ERROR_Assert(arb != NULL, "User defined Arbitrary Distribution not found\n");
 
-    randNum = RANDOM_erand(seed);
+    randNum = erand(seed);
 
     return getNextNumber(arb, randNum);
 }
@@ -10821,17 +10954,54 @@ template <class T>
 double RandomDistribution<T>::getNextNumber(ArbitraryDistribution* data,
         double randNum)
 {
-    double upper = 0.0;
+    int n = data->numDistPoints;
+    double column;
+    int i;
 
-    int i = 0;
-    while (upper <= randNum) {
-        upper = MIN(1.0, upper + data->values[i].probability);
-        if (upper > randNum) {
-            return data->values[i].value;
+    if (data->sampling == ARBITRARY_SCAN) {
+        double upper = 0.0;
+
+        i = 0;
+        while (upper <= randNum) {
+            upper = MIN(1.0, upper + data->values[i].probability);
+            if (upper > randNum) {
+                return data->values[i].value;
+            }
+            i++;
+        }
+        return 0.0; // not sure how this can happen
+    }
+
+    if (n == 0) {
+        return 0.0;
+    }
+
+    if (data->sampling == ARBITRARY_CONTINUOUS) {
+        // Inverse of the cumulative distribution, linear between the
+        // values; the first value has its own probability
+        i = (int) (std::upper_bound(data->cumulative,
+                                    data->cumulative + n,
+                                    randNum) - data->cumulative);
+        if (i == 0) {
+            return data->values[0].value;
+        }
+        if (i >= n) {
+            return data->values[n - 1].value;
         }
-        i++;
+        return data->values[i - 1].value +
+               (randNum - data->cumulative[i - 1]) /
+               (data->cumulative[i] - data->cumulative[i - 1]) *
+               (data->values[i].value - data->values[i - 1].value);
+    }
+
+    // The integer part picks a column of the alias table and the
+    // fraction whether it gives its own point or the alias
+    column = randNum * n;
+    i = MIN((int) column, n - 1);
+    if (column - i < data->aliasProbability[i]) {
+        return data->values[i].value;
     }
-    return 0.0; // not sure how this can happen
+    return data->values[data->alias[i]].value;
 }
 
 Int32 RANDOM_nrand(RandomSeed seed) {
@@ -10947,6 +11117,451 @@ double RANDOM_erand(RandomSeed seed) {
 }
 
 
+// Jump-ahead constants of the generator: stepping the state x by j + 1
+// values gives (RANDOM_JumpMultiplier[j] * x + RANDOM_JumpIncrement[j])
+// modulo 2^48
+#define RANDOM_LANES 8
+#define RANDOM_BULK_SIZE 256
+
+static const UInt64 RANDOM_JumpMultiplier[RANDOM_LANES] = {
+    TYPES_ToUInt64(0x0005deece66d), TYPES_ToUInt64(0xbb20b4600a69),
+    TYPES_ToUInt64(0xd498bd0ac4b5), TYPES_ToUInt64(0x32eb772c5f11),
+    TYPES_ToUInt64(0x6e00fcf9c03d), TYPES_ToUInt64(0x45d73749a7f9),
+    TYPES_ToUInt64(0x37bc7ed23b05), TYPES_ToUInt64(0x75489f259f21)
+};
+
+static const UInt64 RANDOM_JumpIncrement[RANDOM_LANES] = {
+    TYPES_ToUInt64(0x00000000000b), TYPES_ToUInt64(0x0040942de6ba),
+    TYPES_ToUInt64(0x0aa8544e593d), TYPES_ToUInt64(0x2d3873c4cd04),
+    TYPES_ToUInt64(0x5d5692ace2bf), TYPES_ToUInt64(0x17617168255e),
+    TYPES_ToUInt64(0x17a0d1925d11), TYPES_ToUInt64(0x7cba449ae648)
+};
+
+static inline UInt64 RANDOM_SeedToState(const RandomSeed seed)
+{
+    return ((UInt64) seed[2] << 32) | ((UInt64) seed[1] << 16) |
+           (UInt64) seed[0];
+}
+
+static inline void RANDOM_StateToSeed(UInt64 state, RandomSeed seed)
+{
+    seed[0] = (unsigned short) (state & 0xffff);
+    seed[1] = (unsigned short) ((state >> 16) & 0xffff);
+    seed[2] = (unsigned short) ((state >> 32) & 0xffff);
+}
+
+// Same as RANDOM_erand for the state it leaves in the seed
+static inline double RANDOM_StateToUniform(UInt64 state)
+{
+    return (Int64)(state >> 16)/(double)0xffffffff;
+}
+
+// Fills the count states following the seed's and leaves the seed at
+// the last one
+static void RANDOM_NextStates(RandomSeed seed, UInt64* states, int count)
+{
+    const UInt64 mask = TYPES_ToUInt64(0xffffffffffff);
+    UInt64 state = RANDOM_SeedToState(seed);
+    int i = 0;
+    int j;
+
+    for (; i + RANDOM_LANES <= count; i += RANDOM_LANES) {
+        for (j = 0; j < RANDOM_LANES; j++) {
+            states[i + j] = (RANDOM_JumpMultiplier[j] * state +
+                             RANDOM_JumpIncrement[j]) & mask;
+        }
+        state = states[i + RANDOM_LANES - 1];
+    }
+    for (; i < count; i++) {
+        state = (RANDOM_JumpMultiplier[0] * state +
+                 RANDOM_JumpIncrement[0]) & mask;
+        states[i] = state;
+    }
+
+    RANDOM_StateToSeed(state, seed);
+}
+
+void RANDOM_erandArray(RandomSeed seed, double* values, int count)
+{
+    UInt64 states[RANDOM_BULK_SIZE];
+    int i;
+    int j;
+
+    for (i = 0; i < count; i += RANDOM_BULK_SIZE) {
+        int n = MIN(count - i, RANDOM_BULK_SIZE);
+
+        RANDOM_NextStates(seed, states, n);
+        for (j = 0; j < n; j++) {
+            values[i + j] = RANDOM_StateToUniform(states[j]);
+        }
+    }
+}
+
+void RANDOM_nrandArray(RandomSeed seed, Int32* values, int count)
+{
+    UInt64 states[RANDOM_BULK_SIZE];
+    int i;
+    int j;
+
+    for (i = 0; i < count; i += RANDOM_BULK_SIZE) {
+        int n = MIN(count - i, RANDOM_BULK_SIZE);
+
+        RANDOM_NextStates(seed, states, n);
+        for (j = 0; j < n; j++) {
+            values[i + j] = (Int32)(states[j] >> 17);
+        }
+    }
+}
+
+void RANDOM_ExponentialArray(RandomSeed seed,
+                             double mean,
+                             double* values,
+                             int count)
+{
+    int i;
+
+    RANDOM_erandArray(seed, values, count);
+    for (i = 0; i < count; i++) {
+        values[i] = -log(values[i]) * mean;
+    }
+}
+
+void RANDOM_GaussianArray(RandomSeed seed,
+                          double sigma,
+                          double* values,
+                          int count)
+{
+    UInt64 states[RANDOM_BULK_SIZE];
+    RandomSeed ahead;
+    UInt64 last = RANDOM_SeedToState(seed);
+    int used = 0;
+    int filled = 0;
+    int i = 0;
+
+    // States are drawn ahead with a copy of the seed; the seed is set to
+    // the last state used at the end
+    memcpy(ahead, seed, sizeof(RandomSeed));
+
+    while (i < count) {
+        double val1;
+        double val2;
+        double r;
+
+        if (used + 2 > filled) {
+            int left = filled - used;
+
+            if (left > 0) {
+                states[0] = states[used];
+            }
+            RANDOM_NextStates(ahead, states + left, RANDOM_BULK_SIZE - left);
+            used = 0;
+            filled = RANDOM_BULK_SIZE;
+        }
+
+        // The polar method of RandomDistribution<T>::gaussian
+        val1 = -1.0 + 2.0 * RANDOM_StateToUniform(states[used]);
+        val2 = -1.0 + 2.0 * RANDOM_StateToUniform(states[used + 1]);
+        last = states[used + 1];
+        used += 2;
+
+        r = val1 * val1 + val2 * val2;
+        if (r == 0.0 || r > 1.0) {
+            continue;
+        }
+        values[i++] = sigma * val1 * sqrt(-2.0 * log(r) / r);
+    }
+
+    RANDOM_StateToSeed(last, seed);
+}
+
+// Seed states drawn ahead for a buffered RandomDistribution.  They are
+// kept aside, in slots of randomBuffers, so that the distributions keep
+// their size.  The states follow base, and are used only while the
+// member seed is still at base: a distribution given a new seed draws a
+// new buffer from it.  A copy gets a slot of its own.
+struct RandomBuffer
+{
+    UInt64 base;
+    Int32  next;
+    Int32  count;
+    UInt64 states[RANDOM_BUFFER_SIZE];
+};
+
+// Slot 0 is for the distributions that are not buffered.  The buffers
+// are never freed, their slots are reused.
+#define RANDOM_MAX_BUFFERS 65536
+
+static RandomBuffer* randomBuffers[RANDOM_MAX_BUFFERS];
+static std::vector<UInt16> randomFreeBuffers;
+static UInt32 randomNumBuffers = 1;
+static QNThreadMutex randomBuffersMutex;
+
+// Takes the next state of the member seed from the buffer, leaving the
+// seed at it as RANDOM_erand would
+template <class T>
+UInt64 RandomDistribution<T>::nextBufferedState()
+{
+    RandomBuffer* buffer = randomBuffers[bufferSlot];
+    UInt64 state;
+
+    if (buffer->next == buffer->count ||
+        buffer->base != RANDOM_SeedToState(randomSeed))
+    {
+        RANDOM_NextStates(randomSeed, buffer->states, RANDOM_BUFFER_SIZE);
+        buffer->next = 0;
+        buffer->count = RANDOM_BUFFER_SIZE;
+    }
+
+    state = buffer->states[buffer->next++];
+    buffer->base = state;
+    RANDOM_StateToSeed(state, randomSeed);
+    return state;
+}
+
+template <class T>
+double RandomDistribution<T>::erand(RandomSeed seed)
+{
+    // Other seeds passed to getRandomNumber are not buffered
+    if (bufferSlot == 0 || seed != randomSeed) {
+        return RANDOM_erand(seed);
+    }
+    return RANDOM_StateToUniform(nextBufferedState());
+}
+
+// The 32 bits RANDOM_jrand would return
+template <class T>
+UInt32 RandomDistribution<T>::bits(RandomSeed seed)
+{
+    if (bufferSlot == 0 || seed != randomSeed) {
+        return (UInt32) RANDOM_jrand(seed);
+    }
+    return (UInt32) (nextBufferedState() >> 16);
+}
+
+// Layers of the Ziggurat method of Marsaglia and Tsang, "The Ziggurat
+// Method for Generating Random Variables", 2000: 128 for the normal
+// distribution and 256 for the exponential one.  A draw of 32 bits
+// picks the layer with its top bits, which are the best bits of the
+// generator, and the position in the layer with its low 24 bits.
+#define RANDOM_ZIGGURAT_SCALE     16777216.0    // 2^24
+#define RANDOM_ZIGGURAT_NORMAL_R  3.442619855899
+#define RANDOM_ZIGGURAT_NORMAL_V  9.91256303526217e-3
+#define RANDOM_ZIGGURAT_EXP_R     7.697117470131487
+#define RANDOM_ZIGGURAT_EXP_V     3.949659822581572e-3
+
+struct RandomZiggurat
+{
+    UInt32 kn[128];     // position below which a point is accepted
+    double wn[128];     // width of a position
+    double fn[128];     // density at the edge of the layer
+    UInt32 ke[256];
+    double we[256];
+    double fe[256];
+
+    RandomZiggurat()
+    {
+        double dn = RANDOM_ZIGGURAT_NORMAL_R;
+        double tn = dn;
+        double de = RANDOM_ZIGGURAT_EXP_R;
+        double te = de;
+        double q;
+        int i;
+
+        q = RANDOM_ZIGGURAT_NORMAL_V / exp(-0.5 * dn * dn);
+        kn[0] = (UInt32) ((dn / q) * RANDOM_ZIGGURAT_SCALE);
+        kn[1] = 0;
+        wn[0] = q / RANDOM_ZIGGURAT_SCALE;
+        wn[127] = dn / RANDOM_ZIGGURAT_SCALE;
+        fn[0] = 1.0;
+        fn[127] = exp(-0.5 * dn * dn);
+        for (i = 126; i >= 1; i--) {
+            dn = sqrt(-2.0 * log(RANDOM_ZIGGURAT_NORMAL_V / dn +
+                                 exp(-0.5 * dn * dn)));
+            kn[i + 1] = (UInt32) ((dn / tn) * RANDOM_ZIGGURAT_SCALE);
+            tn = dn;
+            fn[i] = exp(-0.5 * dn * dn);
+            wn[i] = dn / RANDOM_ZIGGURAT_SCALE;
+        }
+
+        q = RANDOM_ZIGGURAT_EXP_V / exp(-de);
+        ke[0] = (UInt32) ((de / q) * RANDOM_ZIGGURAT_SCALE);
+        ke[1] = 0;
+        we[0] = q / RANDOM_ZIGGURAT_SCALE;
+        we[255] = de / RANDOM_ZIGGURAT_SCALE;
+        fe[0] = 1.0;
+        fe[255] = exp(-de);
+        for (i = 254; i >= 1; i--) {
+            de = -log(RANDOM_ZIGGURAT_EXP_V / de + exp(-de));
+            ke[i + 1] = (UInt32) ((de / te) * RANDOM_ZIGGURAT_SCALE);
+            te = de;
+            fe[i] = exp(-de);
+            we[i] = de / RANDOM_ZIGGURAT_SCALE;
+        }
+    }
+};
+
+static const RandomZiggurat RANDOM_Ziggurat;
+
+// Returns a value of the standard normal distribution
+template <class T>
+double RandomDistribution<T>::zigguratNormal(RandomSeed seed)
+{
+    const RandomZiggurat& z = RANDOM_Ziggurat;
+
+    while (true) {
+        UInt32 u = bits(seed);
+        int layer = (int) (u >> 25);
+        UInt32 position = u & 0xffffff;
+        double sign = (u & 0x1000000) ? -1.0 : 1.0;
+        double x;
+        double y;
+
+        if (position < z.kn[layer]) {
+            return sign * position * z.wn[layer];
+        }
+
+        // The base layer holds the tail beyond its last rectangle
+        if (layer == 0) {
+            do {
+                x = -log(erand(seed)) / RANDOM_ZIGGURAT_NORMAL_R;
+                y = -log(erand(seed));
+            } while (y + y < x * x);
+            return sign * (RANDOM_ZIGGURAT_NORMAL_R + x);
+        }
+
+        x = position * z.wn[layer];
+        if (z.fn[layer] + erand(seed) * (z.fn[layer - 1] - z.fn[layer]) <
+            exp(-0.5 * x * x))
+        {
+            return sign * x;
+        }
+    }
+}
+
+// Returns a value of the exponential distribution of mean 1
+template <class T>
+double RandomDistribution<T>::zigguratExponential(RandomSeed seed)
+{
+    const RandomZiggurat& z = RANDOM_Ziggurat;
+
+    while (true) {
+        UInt32 u = bits(seed);
+        int layer = (int) (u >> 24);
+        UInt32 position = u & 0xffffff;
+        double x;
+
+        if (position < z.ke[layer]) {
+            return position * z.we[layer];
+        }
+
+        if (layer == 0) {
+            return RANDOM_ZIGGURAT_EXP_R - log(erand(seed));
+        }
+
+        x = position * z.we[layer];
+        if (z.fe[layer] + erand(seed) * (z.fe[layer - 1] - z.fe[layer]) <
+            exp(-x))
+        {
+            return x;
+        }
+    }
+}
+
+template <class T>
+void RandomDistribution<T>::setBuffered(bool enable)
+{
+    if (enable == (bufferSlot != 0)) {
+        return;
+    }
+
+    QNThreadLock lock(&randomBuffersMutex);
+
+    // The member seed is always at the last state used, so the buffer
+    // can go at any time
+    if (!enable) {
+        randomFreeBuffers.push_back(bufferSlot);
+        bufferSlot = 0;
+        return;
+    }
+
+    if (!randomFreeBuffers.empty()) {
+        bufferSlot = randomFreeBuffers.back();
+        randomFreeBuffers.pop_back();
+    }
+    else if (randomNumBuffers < RANDOM_MAX_BUFFERS) {
+        bufferSlot = (UInt16) randomNumBuffers++;
+        randomBuffers[bufferSlot] =
+            (RandomBuffer*) MEM_malloc(sizeof(RandomBuffer));
+    }
+    else {
+        // Out of buffers, the values are the same unbuffered
+        return;
+    }
+    randomBuffers[bufferSlot]->next = 0;
+    randomBuffers[bufferSlot]->count = 0;
+}
+
+template <class T>
+RandomDistribution<T>::RandomDistribution(const RandomDistribution& other)
+    : userDefinedDistributionName(other.userDefinedDistributionName),
+      value1(other.value1),
+      value2(other.value2),
+      value3(other.value3),
+      alpha(other.alpha),
+      bufferSlot(0),
+      type(other.type)
+{
+    memcpy(randomSeed, other.randomSeed, sizeof(RandomSeed));
+    if (other.bufferSlot != 0) {
+        setBuffered(true);
+    }
+}
+
+template <class T>
+RandomDistribution<T>&
+RandomDistribution<T>::operator=(const RandomDistribution& other)
+{
+    if (this != &other) {
+        userDefinedDistributionName = other.userDefinedDistributionName;
+        value1 = other.value1;
+        value2 = other.value2;
+        value3 = other.value3;
+        alpha = other.alpha;
+        type = other.type;
+        memcpy(randomSeed, other.randomSeed, sizeof(RandomSeed));
+        setBuffered(other.bufferSlot != 0);
+    }
+    return *this;
+}
+
+template <class T>
+RandomDistribution<T>::~RandomDistribution()
+{
+    setBuffered(false);
+}
+
+template <class T>
+void RandomDistribution<T>::setZiggurat(bool enable)
+{
+    switch (type) {
+    case EXP:
+    case ZIG_EXP:
+        type = enable ? ZIG_EXP : EXP;
+        break;
+    case GAU:
+    case ZIG_GAU:
+        type = enable ? ZIG_GAU : GAU;
+        break;
+    case INT_GAU:
+    case ZIG_INT_GAU:
+        type = enable ? ZIG_INT_GAU : INT_GAU;
+        break;
+    default:
+        // Only these distributions have a Ziggurat method
+        break;
+    }
+}
+
 template class RandomDistribution<Int32>;
 template class RandomDistribution<UInt32>;
 template class RandomDistribution<Float64>;
@@ -0,0 +1,290 @@
+// Copyright (c) 2001-2015, SCALABLE Network Technologies, Inc.  All Rights Reserved.
+//                          600 Corporate Pointe
+//                          Suite 1200
+//                          Culver City, CA 90230
+//                          info@scalable-networks.com
+//
+// This source code is licensed, not sold, and is subject to a written
+// license agreement.  Among other things, no portion of this source
+// code may be copied, transmitted, disclosed, displayed, distributed,
+// translated, used as the basis for a derivative work, or used, in
+// whole or in part, for any program or purpose other than its intended
+// use in compliance with the license agreement as part of the QualNet
+// software.  This source code and certain of the algorithms contained
+// within it are confidential trade secrets of Scalable Network
+// Technologies, Inc. and may not be used as the basis for any other
+// software, hardware, product or service.
+
+/*
+ * Checks that the bulk random functions and the buffered
+ * RandomDistribution return the values, and leave the seeds, of the
+ * one-at-a-time functions they stand for.  Exits with the number of
+ * failed checks.
+ *
+ * Usage: random_check
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+#include "api.h"
+#include "random.h"
+
+// Array lengths checked, around the block and buffer sizes
+static const int randomCheckCounts[] = {0, 1, 3, 4, 15, 16, 17, 33, 1000};
+
+#define RANDOM_CHECK_NUM_COUNTS \
+    (int) (sizeof(randomCheckCounts) / sizeof(randomCheckCounts[0]))
+#define RANDOM_CHECK_DRAWS  2000
+
+static int randomCheckFailures = 0;
+
+static
+void RandomCheck(bool ok, const char* what, int count)
+{
+    if (!ok)
+    {
+        printf("FAIL %s, count %d\n", what, count);
+        randomCheckFailures++;
+    }
+}
+
+static
+bool RandomCheckSameSeed(RandomSeed a, RandomSeed b)
+{
+    return memcmp(a, b, sizeof(RandomSeed)) == 0;
+}
+
+static
+void RandomCheckArrays()
+{
+    for (int c = 0; c < RANDOM_CHECK_NUM_COUNTS; c++)
+    {
+        int count = randomCheckCounts[c];
+        std::vector<double> values(count + 1);
+        std::vector<Int32> integers(count + 1);
+        RandomSeed bulk;
+        RandomSeed single;
+        bool same;
+
+        RANDOM_SetSeed(bulk, 1, 2, 3, c);
+        memcpy(single, bulk, sizeof(RandomSeed));
+        RANDOM_erandArray(bulk, &values[0], count);
+        same = true;
+        for (int i = 0; i < count; i++)
+        {
+            same = same && values[i] == RANDOM_erand(single);
+        }
+        RandomCheck(same, "RANDOM_erandArray values", count);
+        RandomCheck(RandomCheckSameSeed(bulk, single),
+                    "RANDOM_erandArray seed", count);
+
+        RANDOM_nrandArray(bulk, &integers[0], count);
+        same = true;
+        for (int i = 0; i < count; i++)
+        {
+            same = same && integers[i] == RANDOM_nrand(single);
+        }
+        RandomCheck(same, "RANDOM_nrandArray values", count);
+        RandomCheck(RandomCheckSameSeed(bulk, single),
+                    "RANDOM_nrandArray seed", count);
+    }
+}
+
+// The bulk distributions against the RandomDistribution of the same
+// parameters drawing from the same seed
+static
+void RandomCheckDistributionArrays()
+{
+    for (int c = 0; c < RANDOM_CHECK_NUM_COUNTS; c++)
+    {
+        int count = randomCheckCounts[c];
+        std::vector<double> values(count + 1);
+        RandomDistribution<double> distribution;
+        RandomSeed bulk;
+        RandomSeed single;
+        bool same;
+
+        distribution.init();
+
+        RANDOM_SetSeed(bulk, 4, 5, 6, c);
+        memcpy(single, bulk, sizeof(RandomSeed));
+        distribution.setDistributionExponential(2.5);
+        RANDOM_ExponentialArray(bulk, 2.5, &values[0], count);
+        same = true;
+        for (int i = 0; i < count; i++)
+        {
+            same = same && values[i] == distribution.getRandomNumber(single);
+        }
+        RandomCheck(same, "RANDOM_ExponentialArray values", count);
+        RandomCheck(RandomCheckSameSeed(bulk, single),
+                    "RANDOM_ExponentialArray seed", count);
+
+        RANDOM_SetSeed(bulk, 7, 8, 9, c);
+        memcpy(single, bulk, sizeof(RandomSeed));
+        distribution.setDistributionGaussian(1.5);
+        RANDOM_GaussianArray(bulk, 1.5, &values[0], count);
+        same = true;
+        for (int i = 0; i < count; i++)
+        {
+            same = same && values[i] == distribution.getRandomNumber(single);
+        }
+        RandomCheck(same, "RANDOM_GaussianArray values", count);
+    }
+}
+
+typedef void (*RandomCheckSetup)(RandomDistribution<double>& distribution);
+
+static
+void RandomCheckSetupUniform(RandomDistribution<double>& distribution)
+{
+    distribution.setDistributionUniform(-1.0, 3.0);
+}
+
+static
+void RandomCheckSetupExponential(RandomDistribution<double>& distribution)
+{
+    distribution.setDistributionExponential(0.5);
+}
+
+static
+void RandomCheckSetupGaussian(RandomDistribution<double>& distribution)
+{
+    distribution.setDistributionGaussian(2.0);
+}
+
+static
+void RandomCheckSetupZigguratGaussian(
+    RandomDistribution<double>& distribution)
+{
+    distribution.setDistributionGaussian(2.0);
+    distribution.setZiggurat(true);
+}
+
+// A buffered distribution against an unbuffered one of the same seed,
+// through the calls that move the member seed or copy the distribution
+static
+void RandomCheckBuffered(const char* what, RandomCheckSetup setup)
+{
+    RandomDistribution<double> plain;
+    RandomDistribution<double> buffered;
+    RandomSeed other;
+    RandomSeed otherBuffered;
+    bool same = true;
+
+    plain.init();
+    buffered.init();
+    setup(plain);
+    setup(buffered);
+    plain.setSeed(11, 12, 13, 14);
+    buffered.setSeed(11, 12, 13, 14);
+    buffered.setBuffered(true);
+    RANDOM_SetSeed(other, 15, 16, 17, 18);
+    memcpy(otherBuffered, other, sizeof(RandomSeed));
+
+    for (int i = 0; i < RANDOM_CHECK_DRAWS; i++)
+    {
+        same = same && plain.getRandomNumber() == buffered.getRandomNumber();
+
+        if (i % 7 == 0)
+        {
+            // Another seed leaves the buffer of the member seed alone
+            same = same &&
+                   plain.getRandomNumber(other) ==
+                   buffered.getRandomNumber(otherBuffered);
+        }
+        if (i == 500)
+        {
+            // A copy draws from its own buffer
+            RandomDistribution<double> plainCopy(plain);
+            RandomDistribution<double> bufferedCopy(buffered);
+
+            same = same && bufferedCopy.isBuffered();
+            for (int k = 0; k < 37; k++)
+            {
+                same = same &&
+                       plainCopy.getRandomNumber() ==
+                       bufferedCopy.getRandomNumber();
+            }
+        }
+        if (i == 900)
+        {
+            RandomDistribution<double> plainCopy;
+            RandomDistribution<double> bufferedCopy;
+
+            plainCopy = plain;
+            bufferedCopy = buffered;
+            for (int k = 0; k < 21; k++)
+            {
+                same = same &&
+                       plainCopy.getRandomNumber() ==
+                       bufferedCopy.getRandomNumber();
+            }
+            buffered = bufferedCopy;
+            plain = plainCopy;
+        }
+        if (i == 1200)
+        {
+            buffered.setBuffered(false);
+        }
+        if (i == 1203)
+        {
+            buffered.setBuffered(true);
+        }
+        if (i == 1500)
+        {
+            plain.setSeed(19, 20, 21, 22);
+            buffered.setSeed(19, 20, 21, 22);
+        }
+    }
+    RandomCheck(same, what, RANDOM_CHECK_DRAWS);
+}
+
+// More buffered distributions are made and destroyed than there are
+// slots, which runs out of slots unless the destructor releases them
+static
+void RandomCheckSlotsReleased()
+{
+    bool same = true;
+
+    for (int i = 0; i < 70000; i++)
+    {
+        RandomDistribution<Int32> plain;
+        RandomDistribution<Int32> buffered;
+
+        plain.init();
+        buffered.init();
+        plain.setDistributionUniform(0, 1000);
+        buffered.setDistributionUniform(0, 1000);
+        plain.setSeed(23, i);
+        buffered.setSeed(23, i);
+        buffered.setBuffered(true);
+        same = same && buffered.isBuffered();
+        same = same && plain.getRandomNumber() == buffered.getRandomNumber();
+    }
+    RandomCheck(same, "buffered distributions made and destroyed", 70000);
+}
+
+int main(int argc, char **argv)
+{
+    if (argc != 1)
+    {
+        fprintf(stderr, "Usage: %s\n", argv[0]);
+        return 1;
+    }
+
+    RandomCheckArrays();
+    RandomCheckDistributionArrays();
+    RandomCheckBuffered("buffered uniform", RandomCheckSetupUniform);
+    RandomCheckBuffered("buffered exponential", RandomCheckSetupExponential);
+    RandomCheckBuffered("buffered gaussian", RandomCheckSetupGaussian);
+    RandomCheckBuffered("buffered ziggurat gaussian",
+                        RandomCheckSetupZigguratGaussian);
+    RandomCheckSlotsReleased();
+
+    printf("%s: %d failed\n",
+           randomCheckFailures == 0 ? "PASS" : "FAIL",
+           randomCheckFailures);
+    return randomCheckFailures;
+}
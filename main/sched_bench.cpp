@@ -0,0 +1,624 @@
+// Copyright (c) 2001-2015, SCALABLE Network Technologies, Inc.  All Rights Reserved.
+//                          600 Corporate Pointe
+//                          Suite 1200
+//                          Culver City, CA 90230
+//                          info@scalable-networks.com
+//
+// This source code is licensed, not sold, and is subject to a written
+// license agreement.  Among other things, no portion of this source
+// code may be copied, transmitted, disclosed, displayed, distributed,
+// translated, used as the basis for a derivative work, or used, in
+// whole or in part, for any program or purpose other than its intended
+// use in compliance with the license agreement as part of the QualNet
+// software.  This source code and certain of the algorithms contained
+// within it are confidential trade secrets of Scalable Network
+// Technologies, Inc. and may not be used as the basis for any other
+// software, hardware, product or service.
+
+/*
+ * Replays a scheduler trace (see SCHEDULER-TRACE-FILE) against every
+ * scheduler queue type and reports the cost of each.
+ *
+ * Usage: sched_bench <trace-file> [-queue <type>]... [-repeat <n>]
+ *
+ * On POSIX systems each queue type is replayed in its own process so
+ * that its peak memory can be measured; on Linux the cache misses of
+ * the replay are read from perf_event when the kernel allows it.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <new>
+#include <vector>
+
+#ifndef _WIN32
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+#endif
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#endif
+
+#include "api.h"
+#include "partition.h"
+#include "WallClock.h"
+#include "sched_calendar.h"
+#include "sched_ladder.h"
+#include "sched_pairing_heap.h"
+#include "sched_splaytree.h"
+#include "sched_std_library.h"
+#include "sched_trace.h"
+
+// Fills in a SchedulerInfo for one of the queue types in the kernel,
+// the same way SCHED_Initialize does.
+#define SCHED_BENCH_KERNEL_SETUP(setupFunction, queueType, PREFIX)         \
+static void setupFunction(PartitionData* partitionData)                    \
+{                                                                          \
+    SchedulerInfo* info = (SchedulerInfo*) MEM_malloc(sizeof(SchedulerInfo)); \
+    memset(info, 0, sizeof(SchedulerInfo));                                \
+    info->schedQueueType      = queueType;                                 \
+    info->InsertMessage       = PREFIX##_InsertMessage;                    \
+    info->ExtractFirstMessage = PREFIX##_ExtractFirstMessage;              \
+    info->PeekFirstMessage    = PREFIX##_PeekFirstMessage;                 \
+    info->DeleteMessage       = PREFIX##_DeleteMessage;                    \
+    info->InsertNode          = PREFIX##_InsertNode;                       \
+    info->PeekNextNode        = PREFIX##_PeekNextNode;                     \
+    info->DeleteNode          = PREFIX##_DeleteNode;                       \
+    info->CurrentNode         = PREFIX##_CurrentNode;                      \
+    info->HasNodes            = PREFIX##_HasNodes;                         \
+    info->NextEvent           = PREFIX##_NextEvent;                        \
+    info->NextEventTime       = PREFIX##_NextEventTime;                    \
+    info->Initalize           = PREFIX##_Initialize;                       \
+    info->Finalize            = PREFIX##_Finalize;                         \
+    partitionData->schedulerInfo = info;                                   \
+    info->Initalize(partitionData);                                        \
+}
+
+SCHED_BENCH_KERNEL_SETUP(SchedBenchSetupSplayTree,
+                         SPLAYTREE_QUEUE,
+                         SCHED_SPLAYTREE)
+SCHED_BENCH_KERNEL_SETUP(SchedBenchSetupCalendar,
+                         CALENDAR_QUEUE2,
+                         SCHED_CALENDAR)
+SCHED_BENCH_KERNEL_SETUP(SchedBenchSetupStdlib,
+                         STDLIB_HEAP,
+                         SCHED_STDLIB)
+
+// The ladder queue and pairing heap replace a kernel queue, as they do
+// in PARTITION_InitializePartition.
+static void SchedBenchSetupLadder(PartitionData* partitionData)
+{
+    SchedBenchSetupStdlib(partitionData);
+    SCHED_LADDER_Setup(partitionData);
+}
+
+static void SchedBenchSetupPairingHeap(PartitionData* partitionData)
+{
+    SchedBenchSetupStdlib(partitionData);
+    SCHED_PAIRINGHEAP_Setup(partitionData);
+}
+
+struct SchedBenchQueue
+{
+    const char* name;   // SCHEDULER-QUEUE-TYPE value
+    void (*setup)(PartitionData* partitionData);
+};
+
+static const SchedBenchQueue schedBenchQueues[] =
+{
+    { "SPLAYTREE",    SchedBenchSetupSplayTree },
+    { "CALENDAR",     SchedBenchSetupCalendar },
+    { "STDLIB",       SchedBenchSetupStdlib },
+    { "LADDER",       SchedBenchSetupLadder },
+    { "PAIRING-HEAP", SchedBenchSetupPairingHeap }
+};
+
+static const int schedBenchNumQueues =
+    sizeof(schedBenchQueues) / sizeof(schedBenchQueues[0]);
+
+struct SchedBenchResult
+{
+    double nsPerOp;         // best of the repeats
+    Int64  numEvents;       // messages returned by the queue
+    Int64  cacheMisses;     // -1 if not available
+    Int64  peakMemoryKB;    // -1 if not available
+};
+
+
+//-------------------------------------------------------------------
+// Cache miss counter
+//-------------------------------------------------------------------
+
+static
+int SchedBenchOpenCacheCounter()
+{
+#ifdef __linux__
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.size = sizeof(attr);
+    attr.config = PERF_COUNT_HW_CACHE_MISSES;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+
+    return (int) syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+#else
+    return -1;
+#endif
+}
+
+static
+void SchedBenchStartCacheCounter(int counter)
+{
+#ifdef __linux__
+    if (counter >= 0)
+    {
+        ioctl(counter, PERF_EVENT_IOC_RESET, 0);
+        ioctl(counter, PERF_EVENT_IOC_ENABLE, 0);
+    }
+#endif
+}
+
+static
+Int64 SchedBenchStopCacheCounter(int counter)
+{
+#ifdef __linux__
+    if (counter >= 0)
+    {
+        Int64 count;
+        ioctl(counter, PERF_EVENT_IOC_DISABLE, 0);
+        if (read(counter, &count, sizeof(count)) == sizeof(count))
+        {
+            return count;
+        }
+    }
+#endif
+    return -1;
+}
+
+
+//-------------------------------------------------------------------
+// Replay
+//-------------------------------------------------------------------
+
+// Creates the nodes referenced by the trace, as NODE_CreateNode does
+static
+void SchedBenchCreateNodes(
+    PartitionData* partitionData,
+    const std::vector<SchedTraceRecord>& records,
+    std::vector<Node*>& nodes)
+{
+    int numNodes = 0;
+    for (size_t i = 0; i < records.size(); i++)
+    {
+        if (records[i].nodeIndex >= numNodes)
+        {
+            numNodes = records[i].nodeIndex + 1;
+        }
+    }
+    if (numNodes == 0)
+    {
+        numNodes = 1;
+    }
+
+    partitionData->numNodes = numNodes;
+    for (int i = 0; i < numNodes; i++)
+    {
+        void* mem = MEM_malloc(sizeof(Node));
+        memset(mem, 0, sizeof(Node));
+
+        Node* node = new (mem) Node();
+        node->partitionData = partitionData;
+        node->nodeIndex = i;
+        node->nodeId = i + 1;
+        node->numNodes = numNodes;
+        node->timeValue = CLOCKTYPE_MAX;
+        nodes.push_back(node);
+    }
+}
+
+// Returns the node a record refers to, NULL if it took none
+static inline
+Node* SchedBenchNode(
+    const std::vector<Node*>& nodes,
+    const SchedTraceRecord& record)
+{
+    return record.nodeIndex < 0 ? NULL : nodes[record.nodeIndex];
+}
+
+static
+Message* SchedBenchGetMessage(
+    PartitionData* partitionData,
+    std::vector<Message*>& freeMessages,
+    const SchedTraceRecord& record,
+    unsigned int naturalOrder)
+{
+    Message* msg;
+    if (freeMessages.empty())
+    {
+        msg = new Message();
+    }
+    else
+    {
+        msg = freeMessages.back();
+        freeMessages.pop_back();
+    }
+
+    msg->next = NULL;
+    msg->m_partitionData = partitionData;
+    msg->eventTime = record.simTime + record.delay;
+    msg->naturalOrder = naturalOrder;
+    msg->layerType = record.layerType;
+    msg->protocolType = 0;
+    msg->instanceId = (short) record.instanceId;
+    msg->eventType = (short) record.eventType;
+    msg->originatingNodeId = record.originatingNodeId;
+    msg->cancelled = false;
+    msg->isScheduledOnMainHeap = false;
+    return msg;
+}
+
+// Replays the trace once against a freshly set up queue.  Returns the
+// elapsed time.
+static
+clocktype SchedBenchReplay(
+    PartitionData* partitionData,
+    const SchedBenchQueue& queue,
+    const std::vector<SchedTraceRecord>& records,
+    const std::vector<Node*>& nodes,
+    std::vector<Message*>& freeMessages,
+    int cacheCounter,
+    SchedBenchResult& result)
+{
+    partitionData->setTime(0);
+    queue.setup(partitionData);
+    SchedulerInfo* info = partitionData->schedulerInfo;
+    for (size_t i = 0; i < nodes.size(); i++)
+    {
+        nodes[i]->timeValue = CLOCKTYPE_MAX;
+        info->InsertNode(partitionData, nodes[i]);
+    }
+
+    Int64 numEvents = 0;
+    unsigned int naturalOrder = 0;
+
+    SchedBenchStartCacheCounter(cacheCounter);
+    clocktype start = WallClock::getTrueRealTime();
+
+    for (size_t i = 0; i < records.size(); i++)
+    {
+        const SchedTraceRecord& record = records[i];
+        Message* msg = NULL;
+
+        partitionData->setTime(record.simTime);
+        switch (record.op)
+        {
+            case SCHED_TRACE_INSERT_MESSAGE:
+            {
+                msg = SchedBenchGetMessage(partitionData,
+                                           freeMessages,
+                                           record,
+                                           naturalOrder++);
+                info->InsertMessage(SchedBenchNode(nodes, record),
+                                    msg,
+                                    record.delay);
+                msg = NULL;
+                break;
+            }
+            case SCHED_TRACE_EXTRACT_FIRST_MESSAGE:
+            {
+                msg = info->ExtractFirstMessage(partitionData,
+                                                SchedBenchNode(nodes, record));
+                break;
+            }
+            case SCHED_TRACE_PEEK_FIRST_MESSAGE:
+            {
+                info->PeekFirstMessage(SchedBenchNode(nodes, record));
+                break;
+            }
+            case SCHED_TRACE_CURRENT_NODE:
+            {
+                info->CurrentNode(partitionData);
+                break;
+            }
+            case SCHED_TRACE_HAS_NODES:
+            {
+                info->HasNodes(partitionData);
+                break;
+            }
+            case SCHED_TRACE_NEXT_EVENT:
+            {
+                msg = info->NextEvent(partitionData,
+                                      SchedBenchNode(nodes, record));
+                break;
+            }
+            case SCHED_TRACE_NEXT_EVENT_TIME:
+            {
+                info->NextEventTime(partitionData);
+                break;
+            }
+        }
+
+        if (msg != NULL)
+        {
+            numEvents++;
+            freeMessages.push_back(msg);
+        }
+    }
+
+    clocktype elapsed = WallClock::getTrueRealTime() - start;
+    Int64 cacheMisses = SchedBenchStopCacheCounter(cacheCounter);
+
+    // Return whatever the trace left in the queue
+    while (info->HasNodes(partitionData))
+    {
+        Node* node = info->CurrentNode(partitionData);
+        Message* msg = info->ExtractFirstMessage(partitionData, node);
+        if (msg == NULL)
+        {
+            break;
+        }
+        freeMessages.push_back(msg);
+    }
+    info->Finalize(partitionData);
+    MEM_free(info);
+    partitionData->schedulerInfo = NULL;
+
+    result.numEvents = numEvents;
+    if (result.cacheMisses < 0 || cacheMisses < result.cacheMisses)
+    {
+        result.cacheMisses = cacheMisses;
+    }
+    return elapsed;
+}
+
+static
+void SchedBenchRun(
+    PartitionData* partitionData,
+    const SchedBenchQueue& queue,
+    const std::vector<SchedTraceRecord>& records,
+    const std::vector<Node*>& nodes,
+    int repeat,
+    SchedBenchResult& result)
+{
+    std::vector<Message*> freeMessages;
+    int cacheCounter = SchedBenchOpenCacheCounter();
+
+    result.nsPerOp = 0.0;
+    result.numEvents = 0;
+    result.cacheMisses = -1;
+    result.peakMemoryKB = -1;
+
+    for (int i = 0; i < repeat; i++)
+    {
+        clocktype elapsed = SchedBenchReplay(partitionData,
+                                             queue,
+                                             records,
+                                             nodes,
+                                             freeMessages,
+                                             cacheCounter,
+                                             result);
+        double nsPerOp =
+            (double) elapsed / (double) NANO_SECOND / (double) records.size();
+        if (i == 0 || nsPerOp < result.nsPerOp)
+        {
+            result.nsPerOp = nsPerOp;
+        }
+    }
+
+#ifdef __linux__
+    if (cacheCounter >= 0)
+    {
+        close(cacheCounter);
+    }
+#endif
+}
+
+#ifndef _WIN32
+// Runs the queue in a child process and measures the child's peak
+// resident memory above what it inherited.
+static
+BOOL SchedBenchRunInChild(
+    PartitionData* partitionData,
+    const SchedBenchQueue& queue,
+    const std::vector<SchedTraceRecord>& records,
+    const std::vector<Node*>& nodes,
+    int repeat,
+    SchedBenchResult& result)
+{
+    int fds[2];
+    if (pipe(fds) != 0)
+    {
+        return FALSE;
+    }
+
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    long baselineKB = usage.ru_maxrss;
+
+    pid_t pid = fork();
+    if (pid < 0)
+    {
+        close(fds[0]);
+        close(fds[1]);
+        return FALSE;
+    }
+    if (pid == 0)
+    {
+        close(fds[0]);
+        SchedBenchRun(partitionData, queue, records, nodes, repeat, result);
+        ssize_t written = write(fds[1], &result, sizeof(result));
+        _exit(written == sizeof(result) ? 0 : 1);
+    }
+
+    close(fds[1]);
+    ssize_t numRead = read(fds[0], &result, sizeof(result));
+    close(fds[0]);
+
+    int status;
+    if (wait4(pid, &status, 0, &usage) != pid
+        || numRead != sizeof(result)
+        || !WIFEXITED(status)
+        || WEXITSTATUS(status) != 0)
+    {
+        return FALSE;
+    }
+
+    // ru_maxrss is in kilobytes on Linux and bytes on Mac OS X
+#ifdef __APPLE__
+    result.peakMemoryKB = (usage.ru_maxrss - baselineKB) / 1024;
+#else
+    result.peakMemoryKB = usage.ru_maxrss - baselineKB;
+#endif
+    if (result.peakMemoryKB < 0)
+    {
+        result.peakMemoryKB = 0;
+    }
+    return TRUE;
+}
+#endif
+
+static
+void SchedBenchUsage(const char* program)
+{
+    fprintf(stderr,
+            "Usage: %s <trace-file> [-queue <type>]... [-repeat <n>]\n"
+            "Queue types:",
+            program);
+    for (int i = 0; i < schedBenchNumQueues; i++)
+    {
+        fprintf(stderr, " %s", schedBenchQueues[i].name);
+    }
+    fprintf(stderr, "\n");
+    exit(1);
+}
+
+int main(int argc, char **argv)
+{
+    const char* traceFile = NULL;
+    std::vector<const SchedBenchQueue*> queues;
+    int repeat = 3;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-queue") == 0 && i + 1 < argc)
+        {
+            i++;
+            int q;
+            for (q = 0; q < schedBenchNumQueues; q++)
+            {
+                if (strcmp(argv[i], schedBenchQueues[q].name) == 0)
+                {
+                    queues.push_back(&schedBenchQueues[q]);
+                    break;
+                }
+            }
+            if (q == schedBenchNumQueues)
+            {
+                SchedBenchUsage(argv[0]);
+            }
+        }
+        else if (strcmp(argv[i], "-repeat") == 0 && i + 1 < argc)
+        {
+            repeat = atoi(argv[++i]);
+            if (repeat < 1)
+            {
+                SchedBenchUsage(argv[0]);
+            }
+        }
+        else if (traceFile == NULL && argv[i][0] != '-')
+        {
+            traceFile = argv[i];
+        }
+        else
+        {
+            SchedBenchUsage(argv[0]);
+        }
+    }
+    if (traceFile == NULL)
+    {
+        SchedBenchUsage(argv[0]);
+    }
+    if (queues.empty())
+    {
+        for (int q = 0; q < schedBenchNumQueues; q++)
+        {
+            queues.push_back(&schedBenchQueues[q]);
+        }
+    }
+
+    std::vector<SchedTraceRecord> records;
+    if (!SCHED_TRACE_Load(traceFile, records))
+    {
+        fprintf(stderr, "Cannot read scheduler trace %s\n", traceFile);
+        return 1;
+    }
+    if (records.empty())
+    {
+        fprintf(stderr, "Scheduler trace %s is empty\n", traceFile);
+        return 1;
+    }
+
+    PartitionData* partitionData = PARTITION_CreateEmptyPartition(0, 1);
+    std::vector<Node*> nodes;
+    SchedBenchCreateNodes(partitionData, records, nodes);
+
+    printf("%s: %u operations, %d nodes, best of %d\n\n",
+           traceFile, (unsigned) records.size(), (int) nodes.size(), repeat);
+    printf("%-14s %10s %12s %14s %12s\n",
+           "queue", "ns/op", "events", "cache misses", "peak KB");
+
+    for (size_t q = 0; q < queues.size(); q++)
+    {
+        SchedBenchResult result;
+#ifndef _WIN32
+        if (!SchedBenchRunInChild(partitionData,
+                                  *queues[q],
+                                  records,
+                                  nodes,
+                                  repeat,
+                                  result))
+        {
+            printf("%-14s failed\n", queues[q]->name);
+            continue;
+        }
+#else
+        SchedBenchRun(partitionData, *queues[q], records, nodes, repeat, result);
+#endif
+
+        char cacheMisses[MAX_STRING_LENGTH];
+        char peakMemory[MAX_STRING_LENGTH];
+        if (result.cacheMisses >= 0)
+        {
+            sprintf(cacheMisses, "%" TYPES_64BITFMT "d", result.cacheMisses);
+        }
+        else
+        {
+            strcpy(cacheMisses, "n/a");
+        }
+        if (result.peakMemoryKB >= 0)
+        {
+            sprintf(peakMemory, "%" TYPES_64BITFMT "d", result.peakMemoryKB);
+        }
+        else
+        {
+            strcpy(peakMemory, "n/a");
+        }
+
+        printf("%-14s %10.1f %12" TYPES_64BITFMT "d %14s %12s\n",
+               queues[q]->name,
+               result.nsPerOp,
+               result.numEvents,
+               cacheMisses,
+               peakMemory);
+    }
+
+    return 0;
+}
@@ -0,0 +1,531 @@
+// Copyright (c) 2001-2015, SCALABLE Network Technologies, Inc.  All Rights Reserved.
+//                          600 Corporate Pointe
+//                          Suite 1200
+//                          Culver City, CA 90230
+//                          info@scalable-networks.com
+//
+// This source code is licensed, not sold, and is subject to a written
+// license agreement.  Among other things, no portion of this source
+// code may be copied, transmitted, disclosed, displayed, distributed,
+// translated, used as the basis for a derivative work, or used, in
+// whole or in part, for any program or purpose other than its intended
+// use in compliance with the license agreement as part of the QualNet
+// software.  This source code and certain of the algorithms contained
+// within it are confidential trade secrets of Scalable Network
+// Technologies, Inc. and may not be used as the basis for any other
+// software, hardware, product or service.
+
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+
+#include "api.h"
+#include "partition.h"
+#include "sched_ladder.h"
+
+
+//-------------------------------------------------------------------
+// LadderQueue
+//
+// Every pending event is in exactly one of three places:
+//
+//   top     unsorted, all events later than m_lowerMax
+//   rungs   bucketed by time; an event goes to the coarsest rung whose
+//           current bucket starts at or before it
+//   bottom  sorted, earlier than every event in the rungs
+//
+// Only the bottom is ever sorted, and it is refilled one bucket at a
+// time, so sorting costs O(LADDER_THRESHOLD log LADDER_THRESHOLD) per
+// bucket regardless of the queue size.
+//-------------------------------------------------------------------
+
+LadderQueue::LadderQueue()
+    : m_lowerMax(-1),
+      m_topMin(0),
+      m_topMax(0),
+      m_numRungs(0),
+      m_size(0)
+{
+    // Buckets are referenced while new rungs are created, so the rung
+    // array must never be reallocated.
+    m_rungs.reserve(LADDER_MAX_RUNGS);
+}
+
+void LadderQueue::insert(const SchedulerStlEvent& event)
+{
+    m_size++;
+    if (m_size == 1)
+    {
+        // Queue was empty, start over with everything in the top
+        m_numRungs = 0;
+        m_lowerMax = -1;
+    }
+    route(event);
+}
+
+const SchedulerStlEvent& LadderQueue::top()
+{
+    if (m_bottom.empty())
+    {
+        fillBottom();
+    }
+    return m_bottom.back();
+}
+
+void LadderQueue::pop()
+{
+    if (m_bottom.empty())
+    {
+        fillBottom();
+    }
+    m_bottom.pop_back();
+    m_size--;
+}
+
+void LadderQueue::route(const SchedulerStlEvent& event)
+{
+    clocktype t = event.m_timeValue;
+
+    if (t > m_lowerMax)
+    {
+        if (m_top.empty())
+        {
+            m_topMin = t;
+            m_topMax = t;
+        }
+        else if (t < m_topMin)
+        {
+            m_topMin = t;
+        }
+        else if (t > m_topMax)
+        {
+            m_topMax = t;
+        }
+        m_top.push_back(event);
+        return;
+    }
+
+    for (size_t i = 0; i < m_numRungs; i++)
+    {
+        Rung& rung = m_rungs[i];
+        if (rung.isActive() && t >= rung.currentStart())
+        {
+            rung.buckets[(size_t)((t - rung.start) / rung.width)]
+                .push_back(event);
+            rung.numEvents++;
+            return;
+        }
+    }
+
+    insertBottom(event);
+}
+
+void LadderQueue::insertBottom(const SchedulerStlEvent& event)
+{
+    // A bottom that keeps growing makes each insert a linear move, so
+    // spread it over a new rung while there are rungs to spare.
+    if (m_bottom.size() >= LADDER_THRESHOLD
+        && m_numRungs < LADDER_MAX_RUNGS
+        && m_bottom.back().m_timeValue < m_bottom.front().m_timeValue)
+    {
+        clocktype last = m_lowerMax;
+        for (size_t i = m_numRungs; i > 0; i--)
+        {
+            if (m_rungs[i - 1].isActive())
+            {
+                last = m_rungs[i - 1].currentStart() - 1;
+                break;
+            }
+        }
+        spawnRung(m_bottom, m_bottom.back().m_timeValue, last);
+        route(event);
+        return;
+    }
+
+    m_bottom.insert(
+        std::lower_bound(m_bottom.begin(), m_bottom.end(), event),
+        event);
+}
+
+void LadderQueue::spawnRung(
+    EventList& events,
+    clocktype start,
+    clocktype last)
+{
+    if (m_numRungs == m_rungs.size())
+    {
+        m_rungs.push_back(Rung());
+    }
+    Rung& rung = m_rungs[m_numRungs];
+    m_numRungs++;
+
+    // One bucket per event, but never more buckets than time units.
+    // The last bucket may be partial; it ends at last.
+    clocktype span = last - start;
+    size_t numBuckets = std::min(events.size(), (size_t)LADDER_MAX_BUCKETS);
+    if (span < (clocktype)numBuckets)
+    {
+        numBuckets = (size_t)span + 1;
+    }
+    rung.width = span / (clocktype)numBuckets + 1;
+    rung.numBuckets = (size_t)(span / rung.width) + 1;
+    rung.start = start;
+    rung.last = last;
+    rung.current = 0;
+    rung.numEvents = events.size();
+    if (rung.buckets.size() < rung.numBuckets)
+    {
+        rung.buckets.resize(rung.numBuckets);
+    }
+
+    for (size_t i = 0; i < events.size(); i++)
+    {
+        rung.buckets[(size_t)((events[i].m_timeValue - start) / rung.width)]
+            .push_back(events[i]);
+    }
+    events.clear();
+}
+
+void LadderQueue::fillBottom()
+{
+    ERROR_Assert(m_size > 0, "LadderQueue: queue is empty");
+
+    while (m_bottom.empty())
+    {
+        // An empty rung at the bottom of the ladder can go: anything
+        // later inserted in its range belongs in the bottom list.
+        while (m_numRungs > 0 && m_rungs[m_numRungs - 1].numEvents == 0)
+        {
+            m_numRungs--;
+        }
+
+        if (m_numRungs == 0)
+        {
+            // Everything left is in the top
+            m_lowerMax = m_topMax;
+            if (m_top.size() <= LADDER_THRESHOLD || m_topMin == m_topMax)
+            {
+                m_bottom.swap(m_top);
+                std::sort(m_bottom.begin(), m_bottom.end());
+            }
+            else
+            {
+                spawnRung(m_top, m_topMin, m_topMax);
+            }
+            continue;
+        }
+
+        Rung& rung = m_rungs[m_numRungs - 1];
+        while (rung.buckets[rung.current].empty())
+        {
+            rung.current++;
+        }
+        size_t index = rung.current;
+        EventList& bucket = rung.buckets[index];
+        clocktype bucketLast;
+        if (index == rung.numBuckets - 1)
+        {
+            bucketLast = rung.last;
+        }
+        else
+        {
+            bucketLast = rung.start + (clocktype)(index + 1) * rung.width - 1;
+        }
+        rung.current++;
+        rung.numEvents -= bucket.size();
+
+        if (bucket.size() > LADDER_THRESHOLD
+            && m_numRungs < LADDER_MAX_RUNGS)
+        {
+            clocktype minTime = bucket[0].m_timeValue;
+            clocktype maxTime = minTime;
+            for (size_t i = 1; i < bucket.size(); i++)
+            {
+                minTime = std::min(minTime, bucket[i].m_timeValue);
+                maxTime = std::max(maxTime, bucket[i].m_timeValue);
+            }
+            if (minTime < maxTime)
+            {
+                spawnRung(bucket, minTime, bucketLast);
+                continue;
+            }
+        }
+
+        m_bottom.swap(bucket);
+        std::sort(m_bottom.begin(), m_bottom.end());
+    }
+}
+
+void LadderQueue::remove(
+    const Node* node,
+    const Message* msg,
+    std::vector<Message*>& removed)
+{
+    size_t numRemoved = removeFrom(m_top, node, msg, removed);
+
+    // Buckets before current are empty
+    for (size_t i = 0; i < m_numRungs; i++)
+    {
+        Rung& rung = m_rungs[i];
+        for (size_t j = rung.current; j < rung.numBuckets; j++)
+        {
+            size_t n = removeFrom(rung.buckets[j], node, msg, removed);
+            rung.numEvents -= n;
+            numRemoved += n;
+        }
+    }
+
+    numRemoved += removeFrom(m_bottom, node, msg, removed);
+    m_size -= numRemoved;
+}
+
+// Removes the matching events from a list, keeping the order of the
+// rest.  Returns the number of events removed.
+size_t LadderQueue::removeFrom(
+    EventList& events,
+    const Node* node,
+    const Message* msg,
+    std::vector<Message*>& removed)
+{
+    size_t kept = 0;
+    for (size_t i = 0; i < events.size(); i++)
+    {
+        if (events[i].m_node == node
+            && (msg == NULL || events[i].m_msg == msg))
+        {
+            removed.push_back(events[i].m_msg);
+        }
+        else
+        {
+            if (kept != i)
+            {
+                events[kept] = events[i];
+            }
+            kept++;
+        }
+    }
+
+    size_t numRemoved = events.size() - kept;
+    events.erase(events.begin() + kept, events.end());
+    return numRemoved;
+}
+
+
+//-------------------------------------------------------------------
+// Scheduler interface
+//-------------------------------------------------------------------
+
+void SCHED_LADDER_InsertMessage(
+    Node *node,
+    Message *msg,
+    clocktype delay)
+{
+    if (delay < 0)
+    {
+        ERROR_ReportError("SCHED_LADDER_InsertMessage: "
+                          "Delay is less then 0.");
+    }
+
+    clocktype eventTime = node->getNodeTime() + delay;
+    node->partitionData->ladderQueue->insert(
+        SchedulerStlEvent(msg, node, eventTime));
+
+    if (eventTime < node->timeValue)
+    {
+        node->timeValue = eventTime;
+    }
+}
+
+
+Message* SCHED_LADDER_ExtractFirstMessage(
+    PartitionData *partitionData,
+    Node *)
+{
+    LadderQueue* queue = partitionData->ladderQueue;
+    if (queue->empty())
+    {
+        return NULL;
+    }
+
+    Message* msg = queue->top().m_msg;
+    queue->pop();
+    return msg;
+}
+
+
+Message* SCHED_LADDER_PeekFirstMessage(
+    Node *node)
+{
+    LadderQueue* queue = node->partitionData->ladderQueue;
+    if (queue->empty())
+    {
+        return NULL;
+    }
+    return queue->top().m_msg;
+}
+
+
+void SCHED_LADDER_DeleteMessage(
+    Node *node,
+    Message *msg)
+{
+    ERROR_Assert(node != NULL, "SCHED_LADDER_DeleteMessage: Node is NULL.");
+    ERROR_Assert(msg != NULL,
+                 "SCHED_LADDER_DeleteMessage: Message is NULL.");
+
+    std::vector<Message*> removed;
+    node->partitionData->ladderQueue->remove(node, msg, removed);
+}
+
+
+void SCHED_LADDER_InsertNode(
+    PartitionData *partitionData,
+    Node *node)
+{
+    // All events are kept in the one partition queue
+    ERROR_Assert(partitionData != NULL,
+                 "SCHED_LADDER_InsertNode: Partition Data is NULL.");
+    ERROR_Assert(node != NULL, "SCHED_LADDER_InsertNode: Node is NULL.");
+}
+
+
+Node* SCHED_LADDER_PeekNextNode(
+    PartitionData *partitionData)
+{
+    ERROR_Assert(partitionData != NULL,
+                 "SCHED_LADDER_PeekNextNode: Partition Data is NULL.");
+
+    LadderQueue* queue = partitionData->ladderQueue;
+    if (queue->empty())
+    {
+        return NULL;
+    }
+    return queue->top().m_node;
+}
+
+
+void SCHED_LADDER_DeleteNode(
+    PartitionData *partitionData,
+    Node *node)
+{
+    ERROR_Assert(partitionData != NULL,
+                 "SCHED_LADDER_DeleteNode: Partition Data is NULL.");
+    ERROR_Assert(node != NULL, "SCHED_LADDER_DeleteNode: node is NULL.");
+
+    std::vector<Message*> removed;
+    partitionData->ladderQueue->remove(node, NULL, removed);
+    for (size_t i = 0; i < removed.size(); i++)
+    {
+        MESSAGE_Free(node, removed[i]);
+    }
+}
+
+
+Node* SCHED_LADDER_CurrentNode(
+    const PartitionData *partitionData)
+{
+    ERROR_Assert(partitionData != NULL,
+                 "SCHED_LADDER_CurrentNode: Partition Data is NULL.");
+    ERROR_Assert(partitionData->schedulerInfo != NULL,
+                 "SCHED_LADDER_CurrentNode: Scheduler Info is NULL.");
+
+    LadderQueue* queue = partitionData->ladderQueue;
+    if (queue->empty())
+    {
+        return NULL;
+    }
+    return queue->top().m_node;
+}
+
+
+BOOL SCHED_LADDER_HasNodes(
+    const PartitionData *partitionData)
+{
+    return !partitionData->ladderQueue->empty();
+}
+
+
+Message* SCHED_LADDER_NextEvent(
+    PartitionData *partitionData,
+    Node* node)
+{
+    LadderQueue* queue = partitionData->ladderQueue;
+    if (queue->empty())
+    {
+        return NULL;
+    }
+
+    const SchedulerStlEvent& event = queue->top();
+    if (event.m_timeValue != node->getNodeTime())
+    {
+        return NULL;
+    }
+
+    Message* msg = event.m_msg;
+    queue->pop();
+    return msg;
+}
+
+
+clocktype SCHED_LADDER_NextEventTime(
+    const PartitionData *partitionData)
+{
+    LadderQueue* queue = partitionData->ladderQueue;
+    if (queue->empty())
+    {
+        return CLOCKTYPE_MAX;
+    }
+
+    clocktype toVal = queue->top().m_timeValue;
+    assert(toVal >= partitionData->getGlobalTime());
+    return toVal;
+}
+
+
+void SCHED_LADDER_Initialize(
+    PartitionData *partitionData)
+{
+    assert(partitionData);
+
+    partitionData->ladderQueue = new LadderQueue;
+}
+
+
+void SCHED_LADDER_Finalize(
+    PartitionData *partitionData)
+{
+    delete partitionData->ladderQueue;
+    partitionData->ladderQueue = NULL;
+}
+
+
+void SCHED_LADDER_Setup(
+    PartitionData *partitionData)
+{
+    SchedulerInfo* info = partitionData->schedulerInfo;
+    ERROR_Assert(info != NULL,
+                 "SCHED_LADDER_Setup: scheduler is not initialized.");
+    ERROR_Assert(!info->HasNodes(partitionData),
+                 "SCHED_LADDER_Setup: scheduler queue is not empty.");
+
+    // The SchedulerInfo belongs to SCHED_Initialize; only its queue and
+    // function table are replaced.
+    info->Finalize(partitionData);
+
+    info->schedQueueType      = LADDER_QUEUE;
+    info->InsertMessage       = SCHED_LADDER_InsertMessage;
+    info->ExtractFirstMessage = SCHED_LADDER_ExtractFirstMessage;
+    info->PeekFirstMessage    = SCHED_LADDER_PeekFirstMessage;
+    info->DeleteMessage       = SCHED_LADDER_DeleteMessage;
+    info->InsertNode          = SCHED_LADDER_InsertNode;
+    info->PeekNextNode        = SCHED_LADDER_PeekNextNode;
+    info->DeleteNode          = SCHED_LADDER_DeleteNode;
+    info->CurrentNode         = SCHED_LADDER_CurrentNode;
+    info->HasNodes            = SCHED_LADDER_HasNodes;
+    info->NextEvent           = SCHED_LADDER_NextEvent;
+    info->NextEventTime       = SCHED_LADDER_NextEventTime;
+    info->Initalize           = SCHED_LADDER_Initialize;
+    info->Finalize            = SCHED_LADDER_Finalize;
+
+    info->Initalize(partitionData);
+}
@@ -0,0 +1,393 @@
+// Copyright (c) 2001-2015, SCALABLE Network Technologies, Inc.  All Rights Reserved.
+//                          600 Corporate Pointe
+//                          Suite 1200
+//                          Culver City, CA 90230
+//                          info@scalable-networks.com
+//
+// This source code is licensed, not sold, and is subject to a written
+// license agreement.  Among other things, no portion of this source
+// code may be copied, transmitted, disclosed, displayed, distributed,
+// translated, used as the basis for a derivative work, or used, in
+// whole or in part, for any program or purpose other than its intended
+// use in compliance with the license agreement as part of the QualNet
+// software.  This source code and certain of the algorithms contained
+// within it are confidential trade secrets of Scalable Network
+// Technologies, Inc. and may not be used as the basis for any other
+// software, hardware, product or service.
+
+#include <stdio.h>
+#include <string.h>
+#include <new>
+
+#include "api.h"
+#include "partition.h"
+#include "sched_pairing_heap.h"
+
+
+//-------------------------------------------------------------------
+// PairingHeap
+//-------------------------------------------------------------------
+
+PairingHeap::PairingHeap()
+    : m_root(NULL),
+      m_size(0),
+      m_freeList(NULL)
+{
+}
+
+PairingHeap::~PairingHeap()
+{
+    for (size_t i = 0; i < m_blocks.size(); i++)
+    {
+        MEM_free(m_blocks[i]);
+    }
+}
+
+PairingHeap::HeapNode* PairingHeap::allocNode(const SchedulerStlEvent& event)
+{
+    if (m_freeList == NULL)
+    {
+        HeapNode* block = (HeapNode*)
+            MEM_malloc(sizeof(HeapNode) * PAIRING_HEAP_BLOCK_SIZE);
+        m_blocks.push_back(block);
+        for (int i = 0; i < PAIRING_HEAP_BLOCK_SIZE; i++)
+        {
+            block[i].sibling = m_freeList;
+            m_freeList = &block[i];
+        }
+    }
+
+    HeapNode* heapNode = m_freeList;
+    m_freeList = heapNode->sibling;
+
+    new (&heapNode->event) SchedulerStlEvent(event);
+    heapNode->child = NULL;
+    heapNode->sibling = NULL;
+    return heapNode;
+}
+
+void PairingHeap::freeNode(HeapNode* heapNode)
+{
+    heapNode->sibling = m_freeList;
+    m_freeList = heapNode;
+}
+
+// Makes the later of two heaps the first child of the earlier one
+PairingHeap::HeapNode* PairingHeap::meld(HeapNode* a, HeapNode* b)
+{
+    if (a->event < b->event)
+    {
+        HeapNode* tmp = a;
+        a = b;
+        b = tmp;
+    }
+    b->sibling = a->child;
+    a->child = b;
+    a->sibling = NULL;
+    return a;
+}
+
+void PairingHeap::insert(const SchedulerStlEvent& event)
+{
+    HeapNode* heapNode = allocNode(event);
+    m_root = (m_root == NULL) ? heapNode : meld(m_root, heapNode);
+    m_size++;
+}
+
+void PairingHeap::pop()
+{
+    HeapNode* oldRoot = m_root;
+    HeapNode* child = oldRoot->child;
+
+    // First pass: meld the children in pairs, left to right
+    m_pairs.clear();
+    while (child != NULL)
+    {
+        HeapNode* first = child;
+        HeapNode* second = child->sibling;
+        if (second == NULL)
+        {
+            first->sibling = NULL;
+            m_pairs.push_back(first);
+            break;
+        }
+        child = second->sibling;
+        m_pairs.push_back(meld(first, second));
+    }
+
+    // Second pass: meld the pairs right to left
+    m_root = NULL;
+    for (size_t i = m_pairs.size(); i > 0; i--)
+    {
+        m_root = (m_root == NULL)
+                 ? m_pairs[i - 1]
+                 : meld(m_pairs[i - 1], m_root);
+    }
+
+    freeNode(oldRoot);
+    m_size--;
+}
+
+void PairingHeap::remove(
+    const Node* node,
+    const Message* msg,
+    std::vector<Message*>& removed)
+{
+    // Take the heap apart and meld the nodes that stay back together.
+    // m_pairs holds the nodes still to be visited.
+    m_pairs.clear();
+    if (m_root != NULL)
+    {
+        m_pairs.push_back(m_root);
+    }
+
+    HeapNode* newRoot = NULL;
+    while (!m_pairs.empty())
+    {
+        HeapNode* heapNode = m_pairs.back();
+        m_pairs.pop_back();
+        if (heapNode->child != NULL)
+        {
+            m_pairs.push_back(heapNode->child);
+        }
+        if (heapNode->sibling != NULL)
+        {
+            m_pairs.push_back(heapNode->sibling);
+        }
+
+        if (heapNode->event.m_node == node
+            && (msg == NULL || heapNode->event.m_msg == msg))
+        {
+            removed.push_back(heapNode->event.m_msg);
+            freeNode(heapNode);
+            m_size--;
+        }
+        else
+        {
+            heapNode->child = NULL;
+            heapNode->sibling = NULL;
+            newRoot = (newRoot == NULL) ? heapNode : meld(newRoot, heapNode);
+        }
+    }
+    m_root = newRoot;
+}
+
+
+//-------------------------------------------------------------------
+// Scheduler interface
+//-------------------------------------------------------------------
+
+void SCHED_PAIRINGHEAP_InsertMessage(
+    Node *node,
+    Message *msg,
+    clocktype delay)
+{
+    if (delay < 0)
+    {
+        ERROR_ReportError("SCHED_PAIRINGHEAP_InsertMessage: "
+                          "Delay is less then 0.");
+    }
+
+    clocktype eventTime = node->getNodeTime() + delay;
+    node->partitionData->pairingHeap->insert(
+        SchedulerStlEvent(msg, node, eventTime));
+
+    if (eventTime < node->timeValue)
+    {
+        node->timeValue = eventTime;
+    }
+}
+
+
+Message* SCHED_PAIRINGHEAP_ExtractFirstMessage(
+    PartitionData *partitionData,
+    Node *)
+{
+    PairingHeap* heap = partitionData->pairingHeap;
+    if (heap->empty())
+    {
+        return NULL;
+    }
+
+    Message* msg = heap->top().m_msg;
+    heap->pop();
+    return msg;
+}
+
+
+Message* SCHED_PAIRINGHEAP_PeekFirstMessage(
+    Node *node)
+{
+    PairingHeap* heap = node->partitionData->pairingHeap;
+    if (heap->empty())
+    {
+        return NULL;
+    }
+    return heap->top().m_msg;
+}
+
+
+void SCHED_PAIRINGHEAP_DeleteMessage(
+    Node *node,
+    Message *msg)
+{
+    ERROR_Assert(node != NULL, "SCHED_PAIRINGHEAP_DeleteMessage: Node is NULL.");
+    ERROR_Assert(msg != NULL,
+                 "SCHED_PAIRINGHEAP_DeleteMessage: Message is NULL.");
+
+    std::vector<Message*> removed;
+    node->partitionData->pairingHeap->remove(node, msg, removed);
+}
+
+
+void SCHED_PAIRINGHEAP_InsertNode(
+    PartitionData *partitionData,
+    Node *node)
+{
+    // All events are kept in the one partition queue
+    ERROR_Assert(partitionData != NULL,
+                 "SCHED_PAIRINGHEAP_InsertNode: Partition Data is NULL.");
+    ERROR_Assert(node != NULL, "SCHED_PAIRINGHEAP_InsertNode: Node is NULL.");
+}
+
+
+Node* SCHED_PAIRINGHEAP_PeekNextNode(
+    PartitionData *partitionData)
+{
+    ERROR_Assert(partitionData != NULL,
+                 "SCHED_PAIRINGHEAP_PeekNextNode: Partition Data is NULL.");
+
+    PairingHeap* heap = partitionData->pairingHeap;
+    if (heap->empty())
+    {
+        return NULL;
+    }
+    return heap->top().m_node;
+}
+
+
+void SCHED_PAIRINGHEAP_DeleteNode(
+    PartitionData *partitionData,
+    Node *node)
+{
+    ERROR_Assert(partitionData != NULL,
+                 "SCHED_PAIRINGHEAP_DeleteNode: Partition Data is NULL.");
+    ERROR_Assert(node != NULL, "SCHED_PAIRINGHEAP_DeleteNode: node is NULL.");
+
+    std::vector<Message*> removed;
+    partitionData->pairingHeap->remove(node, NULL, removed);
+    for (size_t i = 0; i < removed.size(); i++)
+    {
+        MESSAGE_Free(node, removed[i]);
+    }
+}
+
+
+Node* SCHED_PAIRINGHEAP_CurrentNode(
+    const PartitionData *partitionData)
+{
+    ERROR_Assert(partitionData != NULL,
+                 "SCHED_PAIRINGHEAP_CurrentNode: Partition Data is NULL.");
+    ERROR_Assert(partitionData->schedulerInfo != NULL,
+                 "SCHED_PAIRINGHEAP_CurrentNode: Scheduler Info is NULL.");
+
+    PairingHeap* heap = partitionData->pairingHeap;
+    if (heap->empty())
+    {
+        return NULL;
+    }
+    return heap->top().m_node;
+}
+
+
+BOOL SCHED_PAIRINGHEAP_HasNodes(
+    const PartitionData *partitionData)
+{
+    return !partitionData->pairingHeap->empty();
+}
+
+
+Message* SCHED_PAIRINGHEAP_NextEvent(
+    PartitionData *partitionData,
+    Node* node)
+{
+    PairingHeap* heap = partitionData->pairingHeap;
+    if (heap->empty())
+    {
+        return NULL;
+    }
+
+    const SchedulerStlEvent& event = heap->top();
+    if (event.m_timeValue != node->getNodeTime())
+    {
+        return NULL;
+    }
+
+    Message* msg = event.m_msg;
+    heap->pop();
+    return msg;
+}
+
+
+clocktype SCHED_PAIRINGHEAP_NextEventTime(
+    const PartitionData *partitionData)
+{
+    PairingHeap* heap = partitionData->pairingHeap;
+    if (heap->empty())
+    {
+        return CLOCKTYPE_MAX;
+    }
+
+    clocktype toVal = heap->top().m_timeValue;
+    assert(toVal >= partitionData->getGlobalTime());
+    return toVal;
+}
+
+
+void SCHED_PAIRINGHEAP_Initialize(
+    PartitionData *partitionData)
+{
+    assert(partitionData);
+
+    partitionData->pairingHeap = new PairingHeap;
+}
+
+
+void SCHED_PAIRINGHEAP_Finalize(
+    PartitionData *partitionData)
+{
+    delete partitionData->pairingHeap;
+    partitionData->pairingHeap = NULL;
+}
+
+
+void SCHED_PAIRINGHEAP_Setup(
+    PartitionData *partitionData)
+{
+    SchedulerInfo* info = partitionData->schedulerInfo;
+    ERROR_Assert(info != NULL,
+                 "SCHED_PAIRINGHEAP_Setup: scheduler is not initialized.");
+    ERROR_Assert(!info->HasNodes(partitionData),
+                 "SCHED_PAIRINGHEAP_Setup: scheduler queue is not empty.");
+
+    // The SchedulerInfo belongs to SCHED_Initialize; only its queue and
+    // function table are replaced.
+    info->Finalize(partitionData);
+
+    info->schedQueueType      = PAIRING_HEAP;
+    info->InsertMessage       = SCHED_PAIRINGHEAP_InsertMessage;
+    info->ExtractFirstMessage = SCHED_PAIRINGHEAP_ExtractFirstMessage;
+    info->PeekFirstMessage    = SCHED_PAIRINGHEAP_PeekFirstMessage;
+    info->DeleteMessage       = SCHED_PAIRINGHEAP_DeleteMessage;
+    info->InsertNode          = SCHED_PAIRINGHEAP_InsertNode;
+    info->PeekNextNode        = SCHED_PAIRINGHEAP_PeekNextNode;
+    info->DeleteNode          = SCHED_PAIRINGHEAP_DeleteNode;
+    info->CurrentNode         = SCHED_PAIRINGHEAP_CurrentNode;
+    info->HasNodes            = SCHED_PAIRINGHEAP_HasNodes;
+    info->NextEvent           = SCHED_PAIRINGHEAP_NextEvent;
+    info->NextEventTime       = SCHED_PAIRINGHEAP_NextEventTime;
+    info->Initalize           = SCHED_PAIRINGHEAP_Initialize;
+    info->Finalize            = SCHED_PAIRINGHEAP_Finalize;
+
+    info->Initalize(partitionData);
+}
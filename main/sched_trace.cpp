@@ -0,0 +1,483 @@
+// Copyright (c) 2001-2015, SCALABLE Network Technologies, Inc.  All Rights Reserved.
+//                          600 Corporate Pointe
+//                          Suite 1200
+//                          Culver City, CA 90230
+//                          info@scalable-networks.com
+//
+// This source code is licensed, not sold, and is subject to a written
+// license agreement.  Among other things, no portion of this source
+// code may be copied, transmitted, disclosed, displayed, distributed,
+// translated, used as the basis for a derivative work, or used, in
+// whole or in part, for any program or purpose other than its intended
+// use in compliance with the license agreement as part of the QualNet
+// software.  This source code and certain of the algorithms contained
+// within it are confidential trade secrets of Scalable Network
+// Technologies, Inc. and may not be used as the basis for any other
+// software, hardware, product or service.
+
+#include <stdio.h>
+#include <string.h>
+
+#include "api.h"
+#include "partition.h"
+#include "sched_trace.h"
+
+#define SCHED_TRACE_BUFFER_SIZE     (64 * 1024)
+
+// Largest encoded record: op, time, node and five insert fields
+#define SCHED_TRACE_MAX_RECORD_SIZE (1 + 8 * 10)
+
+// The recording state.  The scheduler function table is replaced by
+// the Trace* functions below; the original table is kept here and
+// every call is forwarded to it after being recorded.
+struct SchedulerTrace
+{
+    SchedulerInfo original;   // only the function pointers are used
+    FILE*         fp;
+    clocktype     lastTime;
+    size_t        used;
+    unsigned char buffer[SCHED_TRACE_BUFFER_SIZE];
+};
+
+static
+SchedulerTrace* SchedTraceOf(const PartitionData* partitionData)
+{
+    return partitionData->schedulerTrace;
+}
+
+// Copies the function table only.  The kernel allocates SchedulerInfo
+// at its own size, so the structure is never copied as a whole.
+static
+void SchedTraceCopyFunctions(SchedulerInfo* dst, const SchedulerInfo* src)
+{
+    dst->InsertMessage       = src->InsertMessage;
+    dst->ExtractFirstMessage = src->ExtractFirstMessage;
+    dst->PeekFirstMessage    = src->PeekFirstMessage;
+    dst->DeleteMessage       = src->DeleteMessage;
+    dst->InsertNode          = src->InsertNode;
+    dst->PeekNextNode        = src->PeekNextNode;
+    dst->DeleteNode          = src->DeleteNode;
+    dst->CurrentNode         = src->CurrentNode;
+    dst->HasNodes            = src->HasNodes;
+    dst->NextEvent           = src->NextEvent;
+    dst->NextEventTime       = src->NextEventTime;
+    dst->Initalize           = src->Initalize;
+    dst->Finalize            = src->Finalize;
+}
+
+static
+void SchedTraceFlush(SchedulerTrace* trace)
+{
+    if (trace->used > 0)
+    {
+        fwrite(trace->buffer, 1, trace->used, trace->fp);
+        trace->used = 0;
+    }
+}
+
+static
+void SchedTracePutVarint(SchedulerTrace* trace, UInt64 value)
+{
+    while (value >= 0x80)
+    {
+        trace->buffer[trace->used++] = (unsigned char) (value | 0x80);
+        value >>= 7;
+    }
+    trace->buffer[trace->used++] = (unsigned char) value;
+}
+
+static
+void SchedTracePutSigned(SchedulerTrace* trace, Int64 value)
+{
+    // zigzag: small negative values stay short
+    SchedTracePutVarint(trace,
+                        ((UInt64) value << 1) ^ (UInt64) (value >> 63));
+}
+
+// Writes the node a call takes, as its index plus one so that calls
+// made without a node (events that belong to no node) are 0
+static
+void SchedTracePutNode(SchedulerTrace* trace, const Node* node)
+{
+    SchedTracePutVarint(trace, node == NULL ? 0 : (UInt64) node->nodeIndex + 1);
+}
+
+// Starts a record: the operation and the change in simulation time
+static
+void SchedTraceBegin(
+    SchedulerTrace* trace,
+    SchedTraceOp op,
+    clocktype simTime)
+{
+    if (trace->used + SCHED_TRACE_MAX_RECORD_SIZE > SCHED_TRACE_BUFFER_SIZE)
+    {
+        SchedTraceFlush(trace);
+    }
+    trace->buffer[trace->used++] = (unsigned char) op;
+    SchedTracePutSigned(trace, simTime - trace->lastTime);
+    trace->lastTime = simTime;
+}
+
+
+//-------------------------------------------------------------------
+// Recording wrappers
+//-------------------------------------------------------------------
+
+static
+void TraceInsertMessage(
+    Node *node,
+    Message *msg,
+    clocktype delay)
+{
+    SchedulerTrace* trace = SchedTraceOf(node->partitionData);
+
+    SchedTraceBegin(trace, SCHED_TRACE_INSERT_MESSAGE, node->getNodeTime());
+    SchedTracePutNode(trace, node);
+    SchedTracePutSigned(trace, delay);
+    SchedTracePutSigned(trace, msg->layerType);
+    SchedTracePutSigned(trace, msg->eventType);
+    SchedTracePutSigned(trace, msg->instanceId);
+    SchedTracePutVarint(trace, msg->originatingNodeId);
+
+    trace->original.InsertMessage(node, msg, delay);
+}
+
+static
+Message* TraceExtractFirstMessage(
+    PartitionData *partitionData,
+    Node *node)
+{
+    SchedulerTrace* trace = SchedTraceOf(partitionData);
+
+    SchedTraceBegin(trace,
+                    SCHED_TRACE_EXTRACT_FIRST_MESSAGE,
+                    partitionData->getGlobalTime());
+    SchedTracePutNode(trace, node);
+
+    return trace->original.ExtractFirstMessage(partitionData, node);
+}
+
+static
+Message* TracePeekFirstMessage(
+    Node *node)
+{
+    SchedulerTrace* trace = SchedTraceOf(node->partitionData);
+
+    SchedTraceBegin(trace,
+                    SCHED_TRACE_PEEK_FIRST_MESSAGE,
+                    node->getNodeTime());
+    SchedTracePutNode(trace, node);
+
+    return trace->original.PeekFirstMessage(node);
+}
+
+static
+void TraceDeleteMessage(
+    Node *node,
+    Message *msg)
+{
+    SchedTraceOf(node->partitionData)->original.DeleteMessage(node, msg);
+}
+
+static
+void TraceInsertNode(
+    PartitionData *partitionData,
+    Node *node)
+{
+    SchedTraceOf(partitionData)->original.InsertNode(partitionData, node);
+}
+
+static
+Node* TracePeekNextNode(
+    PartitionData *partitionData)
+{
+    return SchedTraceOf(partitionData)->original.PeekNextNode(partitionData);
+}
+
+static
+void TraceDeleteNode(
+    PartitionData *partitionData,
+    Node *node)
+{
+    SchedTraceOf(partitionData)->original.DeleteNode(partitionData, node);
+}
+
+static
+Node* TraceCurrentNode(
+    const PartitionData *partitionData)
+{
+    SchedulerTrace* trace = SchedTraceOf(partitionData);
+
+    SchedTraceBegin(trace,
+                    SCHED_TRACE_CURRENT_NODE,
+                    partitionData->getGlobalTime());
+
+    return trace->original.CurrentNode(partitionData);
+}
+
+static
+BOOL TraceHasNodes(
+    const PartitionData *partitionData)
+{
+    SchedulerTrace* trace = SchedTraceOf(partitionData);
+
+    SchedTraceBegin(trace,
+                    SCHED_TRACE_HAS_NODES,
+                    partitionData->getGlobalTime());
+
+    return trace->original.HasNodes(partitionData);
+}
+
+static
+Message* TraceNextEvent(
+    PartitionData *partitionData,
+    Node* node)
+{
+    SchedulerTrace* trace = SchedTraceOf(partitionData);
+
+    SchedTraceBegin(trace,
+                    SCHED_TRACE_NEXT_EVENT,
+                    partitionData->getGlobalTime());
+    SchedTracePutNode(trace, node);
+
+    return trace->original.NextEvent(partitionData, node);
+}
+
+static
+clocktype TraceNextEventTime(
+    const PartitionData *partitionData)
+{
+    SchedulerTrace* trace = SchedTraceOf(partitionData);
+
+    SchedTraceBegin(trace,
+                    SCHED_TRACE_NEXT_EVENT_TIME,
+                    partitionData->getGlobalTime());
+
+    return trace->original.NextEventTime(partitionData);
+}
+
+static
+void TraceFinalize(
+    PartitionData *partitionData)
+{
+    SchedulerInfo* info = partitionData->schedulerInfo;
+    SchedulerTrace* trace = partitionData->schedulerTrace;
+
+    SchedTraceFlush(trace);
+    fclose(trace->fp);
+
+    // Put the original functions back before finalizing the queue
+    SchedTraceCopyFunctions(info, &trace->original);
+
+    MEM_free(trace);
+    partitionData->schedulerTrace = NULL;
+
+    info->Finalize(partitionData);
+}
+
+
+//-------------------------------------------------------------------
+// Public functions
+//-------------------------------------------------------------------
+
+void SCHED_TRACE_Start(
+    PartitionData *partitionData,
+    const char *fileName)
+{
+    SchedulerInfo* info = partitionData->schedulerInfo;
+    ERROR_Assert(info != NULL,
+                 "SCHED_TRACE_Start: scheduler is not initialized.");
+    ERROR_Assert(partitionData->schedulerTrace == NULL,
+                 "SCHED_TRACE_Start: scheduler is already traced.");
+
+    FILE* fp = fopen(fileName, "wb");
+    if (fp == NULL)
+    {
+        char errorStr[MAX_STRING_LENGTH];
+        sprintf(errorStr,
+                "Cannot open scheduler trace file %s", fileName);
+        ERROR_ReportError(errorStr);
+        return;
+    }
+    fwrite(SCHED_TRACE_MAGIC, 1, strlen(SCHED_TRACE_MAGIC), fp);
+    fputc(SCHED_TRACE_VERSION, fp);
+
+    SchedulerTrace* trace =
+        (SchedulerTrace*) MEM_malloc(sizeof(SchedulerTrace));
+    SchedTraceCopyFunctions(&trace->original, info);
+    trace->fp = fp;
+    trace->lastTime = 0;
+    trace->used = 0;
+
+    partitionData->schedulerTrace = trace;
+    info->InsertMessage       = TraceInsertMessage;
+    info->ExtractFirstMessage = TraceExtractFirstMessage;
+    info->PeekFirstMessage    = TracePeekFirstMessage;
+    info->DeleteMessage       = TraceDeleteMessage;
+    info->InsertNode          = TraceInsertNode;
+    info->PeekNextNode        = TracePeekNextNode;
+    info->DeleteNode          = TraceDeleteNode;
+    info->CurrentNode         = TraceCurrentNode;
+    info->HasNodes            = TraceHasNodes;
+    info->NextEvent           = TraceNextEvent;
+    info->NextEventTime       = TraceNextEventTime;
+    info->Finalize            = TraceFinalize;
+}
+
+
+static
+BOOL SchedTraceGetVarint(
+    const unsigned char*& pos,
+    const unsigned char* end,
+    UInt64& value)
+{
+    value = 0;
+    for (int shift = 0; shift < 64; shift += 7)
+    {
+        if (pos == end)
+        {
+            return FALSE;
+        }
+        unsigned char byte = *pos++;
+        value |= (UInt64) (byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0)
+        {
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+static
+BOOL SchedTraceGetSigned(
+    const unsigned char*& pos,
+    const unsigned char* end,
+    Int64& value)
+{
+    UInt64 raw;
+    if (!SchedTraceGetVarint(pos, end, raw))
+    {
+        return FALSE;
+    }
+    value = (Int64) (raw >> 1) ^ -(Int64) (raw & 1);
+    return TRUE;
+}
+
+
+BOOL SCHED_TRACE_Load(
+    const char *fileName,
+    std::vector<SchedTraceRecord>& records)
+{
+    FILE* fp = fopen(fileName, "rb");
+    if (fp == NULL)
+    {
+        return FALSE;
+    }
+
+    std::vector<unsigned char> data;
+    unsigned char chunk[SCHED_TRACE_BUFFER_SIZE];
+    size_t numRead;
+    while ((numRead = fread(chunk, 1, sizeof(chunk), fp)) > 0)
+    {
+        data.insert(data.end(), chunk, chunk + numRead);
+    }
+    fclose(fp);
+
+    size_t magicLength = strlen(SCHED_TRACE_MAGIC);
+    if (data.size() < magicLength + 1
+        || memcmp(&data[0], SCHED_TRACE_MAGIC, magicLength) != 0
+        || data[magicLength] != SCHED_TRACE_VERSION)
+    {
+        return FALSE;
+    }
+
+    const unsigned char* pos = &data[0] + magicLength + 1;
+    const unsigned char* end = &data[0] + data.size();
+    clocktype simTime = 0;
+
+    records.clear();
+    while (pos < end)
+    {
+        SchedTraceRecord record;
+        memset(&record, 0, sizeof(record));
+        record.op = *pos++;
+
+        Int64 delta;
+        if (!SchedTraceGetSigned(pos, end, delta))
+        {
+            return FALSE;
+        }
+        simTime += delta;
+        record.simTime = simTime;
+
+        UInt64 value;
+        Int64 signedValue;
+        switch (record.op)
+        {
+            case SCHED_TRACE_INSERT_MESSAGE:
+            {
+                if (!SchedTraceGetVarint(pos, end, value))
+                {
+                    return FALSE;
+                }
+                record.nodeIndex = (Int32) value - 1;
+
+                if (!SchedTraceGetSigned(pos, end, signedValue))
+                {
+                    return FALSE;
+                }
+                record.delay = signedValue;
+
+                if (!SchedTraceGetSigned(pos, end, signedValue))
+                {
+                    return FALSE;
+                }
+                record.layerType = (UInt8) signedValue;
+
+                if (!SchedTraceGetSigned(pos, end, signedValue))
+                {
+                    return FALSE;
+                }
+                record.eventType = (Int32) signedValue;
+
+                if (!SchedTraceGetSigned(pos, end, signedValue))
+                {
+                    return FALSE;
+                }
+                record.instanceId = (UInt16) signedValue;
+
+                if (!SchedTraceGetVarint(pos, end, value))
+                {
+                    return FALSE;
+                }
+                record.originatingNodeId = (UInt32) value;
+                break;
+            }
+            case SCHED_TRACE_EXTRACT_FIRST_MESSAGE:
+            case SCHED_TRACE_PEEK_FIRST_MESSAGE:
+            case SCHED_TRACE_NEXT_EVENT:
+            {
+                if (!SchedTraceGetVarint(pos, end, value))
+                {
+                    return FALSE;
+                }
+                record.nodeIndex = (Int32) value - 1;
+                break;
+            }
+            case SCHED_TRACE_CURRENT_NODE:
+            case SCHED_TRACE_HAS_NODES:
+            case SCHED_TRACE_NEXT_EVENT_TIME:
+            {
+                break;
+            }
+            default:
+            {
+                return FALSE;
+            }
+        }
+
+        records.push_back(record);
+    }
+
+    return TRUE;
+}
@@ -190,6 +190,28 @@ std::ostream& spectralBand_Square::fmt(std::ostream& os) const {
     return os;
 }
 
+void spectrum::addBand(spectralBand* b) 
+{
+    size_t id = m_bands.size();
+
+    b->m_bandId = (int)id;
+    m_bands.push_back(b);
+
+    // Bands are never removed, so each pair is computed once
+    for (size_t i = 0; i < id; i++)
+    {
+      m_overlap[i].push_back(
+        m_bands[i]->convolve(b) / b->getBandwidth());
+    }
+
+    m_overlap.resize(id + 1);
+    m_overlap[id].resize(id + 1);
+    for (size_t j = 0; j <= id; j++)
+    {
+      m_overlap[id][j] = b->convolve(m_bands[j]) / m_bands[j]->getBandwidth();
+    }
+}
+
 std::ostream& spectrum::fmt(std::ostream& os) const {
     for (size_t i = 0; i < m_elements.size(); ++i) {
       os << " RadioID:" << i << " ";
@@ -23,8 +23,10 @@
 
 #include <string>
 #include <iostream>
+#include <algorithm>
 
 #include "terrain.h"
+#include "terrain_profile_cache.h"
 
 #ifdef WIRELESS_LIB
 #include "terrain_cartesian.h"
@@ -50,6 +52,11 @@
 #define DEBUG 1
 #define NODEBUG 0
 
+#define ARC_SECONDS 3600.0
+
+// Most samples of a profile interpolated together
+#define ELEVATION_PROFILE_BLOCK 256
+
 #define VALUE_NOT_USED -1
 
 
@@ -370,6 +377,75 @@ double UrbanIndoorPathProperties::getAvgThinWallThickness() {
 }
 
 
+// Interpolates the elevations of points of a tile from the triangles of
+// the grid cells holding them, as DemTerrainData::getElevationAt and
+// DtedTerrainData::getElevationAt do.  The cells and the positions in
+// them are found in a first pass, which the compiler can vectorize, and
+// the grid is then read without branches.
+static
+void TerrainInterpolateProfile(
+    const ElevationProfileTile* tile,
+    const double* latitudes,
+    const double* longitudes,
+    int numPoints,
+    double* elevations)
+{
+    int northWestLatitude[ELEVATION_PROFILE_BLOCK];
+    int northWestLongitude[ELEVATION_PROFILE_BLOCK];
+    double dLatitude[ELEVATION_PROFILE_BLOCK];
+    double dLongitude[ELEVATION_PROFILE_BLOCK];
+    const double south = tile->southWestCorner.latlonalt.latitude;
+    const double west = tile->southWestCorner.latlonalt.longitude;
+    const double latitudeResolution = tile->resolution[1];
+    const double longitudeResolution = tile->resolution[0];
+    int i;
+
+    assert(numPoints <= ELEVATION_PROFILE_BLOCK);
+
+    for (i = 0; i < numPoints; i++) {
+        const double normalizedLongitude =
+            ARC_SECONDS * (longitudes[i] - west) / longitudeResolution;
+        const double normalizedLatitude =
+            ARC_SECONDS * (latitudes[i] - south) / latitudeResolution;
+
+        northWestLatitude[i] = (int)ceil(normalizedLatitude);
+        northWestLongitude[i] = (int)floor(normalizedLongitude);
+        dLatitude[i] = northWestLatitude[i] - normalizedLatitude;
+        dLongitude[i] = normalizedLongitude - northWestLongitude[i];
+    }
+
+    for (i = 0; i < numPoints; i++) {
+        const int lon = northWestLongitude[i];
+        const int lat = northWestLatitude[i];
+        const bool hasEast = lon < tile->numLines - 1;
+
+        assert(dLatitude[i] >= 0.0 && dLatitude[i] < 1.0);
+        assert(dLongitude[i] >= 0.0 && dLongitude[i] < 1.0);
+        assert(lon >= 0 && lon < tile->numLines);
+        assert(lat >= 0 && lat < tile->lineLengths[lon]);
+
+        // The last line has no line east of it, and the first sample
+        // of a line none south of it.  Points there lie on the edge, so
+        // the missing samples are weighted by 0.
+        const short* line = tile->lines[lon];
+        const short* eastLine = tile->lines[hasEast ? lon + 1 : lon];
+        const int northWest = line[lat];
+        const int northEast = eastLine[lat];
+        const int southWest = line[lat > 0 ? lat - 1 : 0];
+        const int southEast = (hasEast && lat > 0) ? eastLine[lat - 1] : 0;
+        const bool southWestTriangle = dLatitude[i] > dLongitude[i];
+
+        const int eastSlope = southWestTriangle ?
+                              southEast - southWest : northEast - northWest;
+        const int southSlope = southWestTriangle ?
+                               southWest - northWest : southEast - northEast;
+
+        elevations[i] = northWest +
+                        eastSlope * dLongitude[i] +
+                        southSlope * dLatitude[i];
+    }
+}
+
 int ElevationTerrainData::getElevationArray(
     const Coordinates* c1,
     const Coordinates* c2,
@@ -381,6 +457,10 @@ int ElevationTerrainData::getElevationArray(
     int numSamples;
     double d1, d2;
     Coordinates position;
+    double latitudes[ELEVATION_PROFILE_BLOCK];
+    double longitudes[ELEVATION_PROFILE_BLOCK];
+    ElevationProfileTile tile;
+    int first;
     int i;
 
     // actual # of samples is numSamples + 1 as we include samples at
@@ -419,18 +499,48 @@ int ElevationTerrainData::getElevationArray(
         printf("numSamples: %d\n", numSamples);
     }
 
-    for (i = 0; i <= numSamples; i++) {
-        elevationArray[i] = getElevationAt(&position);
+    //
+    // The samples are taken tile by tile: the tile of the first sample
+    // is looked up, the path is followed to the edge of the tile, and
+    // the samples on the way are interpolated together
+    //
+    i = 0;
+    while (i <= numSamples) {
+        if (!getProfileTile(&position, &tile)) {
+            elevationArray[i] = getElevationAt(&position);
+
+            position.common.c1 += d1;
+            position.common.c2 += d2;
+            i++;
+            continue;
+        }
 
-        if (NODEBUG) {
-            printf("%d (%lf, %lf, %lf)\n",
-                   i,
-                   position.common.c1,
-                   position.common.c2,
-                   elevationArray[i]);
+        first = i;
+        do {
+            latitudes[i - first] = position.common.c1;
+            longitudes[i - first] = position.common.c2;
+
+            position.common.c1 += d1;
+            position.common.c2 += d2;
+            i++;
+        } while (i <= numSamples &&
+                 i - first < ELEVATION_PROFILE_BLOCK &&
+                 COORD_PointWithinRange(m_terrainData->getCoordinateSystem(),
+                                        &tile.southWestCorner,
+                                        &tile.northEastCorner,
+                                        &position));
+
+        TerrainInterpolateProfile(&tile,
+                                  latitudes,
+                                  longitudes,
+                                  i - first,
+                                  &elevationArray[first]);
+    }
+
+    if (NODEBUG) {
+        for (i = 0; i <= numSamples; i++) {
+            printf("%d (%lf)\n", i, elevationArray[i]);
         }
-        position.common.c1 += d1;
-        position.common.c2 += d2;
     }
 
     return numSamples;
@@ -692,6 +802,8 @@ void TerrainData::initialize(NodeInput* nodeInput,
         initializeRegions(nodeInput);
         }
 
+    initializeProfileCache(nodeInput);
+
     if (NODEBUG) {
         print();
         }
@@ -715,7 +827,156 @@ void TerrainData::finalize() {
         delete m_regions;
         m_regions = NULL;
 }
+    if (m_profileCache != NULL) {
+        printf("Terrain profile cache: %" TYPES_64BITFMT "u hits, "
+               "%" TYPES_64BITFMT "u misses\n",
+               m_profileCache->numHits, m_profileCache->numMisses);
+        delete m_profileCache;
+        m_profileCache = NULL;
+    }
+
+}
+
+void TerrainData::initializeProfileCache(NodeInput* nodeInput) {
+    BOOL wasFound;
+    BOOL enabled = FALSE;
+    int maxEntries = TERRAIN_PROFILE_CACHE_DEFAULT_SIZE;
+    double resolution = 0.0;
+
+    IO_ReadBool(
+        ANY_NODEID,
+        ANY_ADDRESS,
+        nodeInput,
+        "TERRAIN-PROFILE-CACHE",
+        &wasFound,
+        &enabled);
+
+    if (!wasFound || !enabled) {
+        return;
+    }
+
+    IO_ReadInt(
+        ANY_NODEID,
+        ANY_ADDRESS,
+        nodeInput,
+        "TERRAIN-PROFILE-CACHE-SIZE",
+        &wasFound,
+        &maxEntries);
 
+    if (wasFound && maxEntries <= 0) {
+        ERROR_ReportErrorArgs("TERRAIN-PROFILE-CACHE-SIZE must be "
+                              "greater than 0, not %d", maxEntries);
+    }
+
+    IO_ReadDouble(
+        ANY_NODEID,
+        ANY_ADDRESS,
+        nodeInput,
+        "TERRAIN-PROFILE-CACHE-RESOLUTION",
+        &wasFound,
+        &resolution);
+
+    if (wasFound && resolution < 0.0) {
+        ERROR_ReportErrorArgs("TERRAIN-PROFILE-CACHE-RESOLUTION must "
+                              "not be negative, not %f", resolution);
+    }
+
+    m_profileCache = new TerrainProfileCache(maxEntries);
+    m_profileCache->resolution = resolution;
+    m_profileCache->numHits = 0;
+    m_profileCache->numMisses = 0;
+}
+
+// Quantizes a coordinate to the profile cache resolution
+static
+double TerrainProfileQuantize(double coordinate, double resolution)
+{
+    if (resolution > 0.0) {
+        return floor(coordinate / resolution);
+    }
+    return coordinate;
+}
+
+int TerrainData::getElevationArray(const Coordinates* c1,
+                                   const Coordinates* c2,
+                                   double             distance,
+                                   double             samplingDistance,
+                                   double             elevationArray[]) {
+    const Coordinates* start;
+    const Coordinates* end;
+    bool reversed;
+    bool found;
+    TerrainProfileKey key;
+    TerrainProfilePointer profile;
+    int numSamples;
+
+    if (m_profileCache == NULL) {
+        return m_elevationData->getElevationArray(c1, c2, distance,
+                                                  samplingDistance,
+                                                  elevationArray);
+    }
+
+    // Both directions of a path share the profile sampled from the
+    // endpoint with the larger latitude, then longitude.  Sampling starts
+    // from c1 when the latitudes are equal, so the profile is reversed
+    // there when c1 is the other endpoint.
+    if (c1->common.c1 > c2->common.c1 ||
+        (c1->common.c1 == c2->common.c1 &&
+         c1->common.c2 >= c2->common.c2)) {
+        start = c1;
+        end = c2;
+    }
+    else {
+        start = c2;
+        end = c1;
+    }
+    reversed = start != c1 && c1->common.c1 == c2->common.c1;
+
+    key.start[0] = TerrainProfileQuantize(start->common.c1,
+                                          m_profileCache->resolution);
+    key.start[1] = TerrainProfileQuantize(start->common.c2,
+                                          m_profileCache->resolution);
+    key.end[0] = TerrainProfileQuantize(end->common.c1,
+                                        m_profileCache->resolution);
+    key.end[1] = TerrainProfileQuantize(end->common.c2,
+                                        m_profileCache->resolution);
+    key.samplingDistance = samplingDistance;
+    key.numSamples = MIN((int)ceil(distance / samplingDistance),
+                         MAX_NUM_ELEVATION_SAMPLES - 1);
+
+    {
+        QNThreadLock lock(&m_profileCache->mutex);
+
+        found = m_profileCache->entries.find(key, profile);
+        if (found) {
+            m_profileCache->numHits++;
+        }
+        else {
+            m_profileCache->numMisses++;
+        }
+    }
+
+    if (found) {
+        numSamples = (int)profile->size() - 1;
+        memcpy(elevationArray, &(*profile)[0],
+               profile->size() * sizeof(double));
+    }
+    else {
+        numSamples = m_elevationData->getElevationArray(start, end, distance,
+                                                        samplingDistance,
+                                                        elevationArray);
+        profile = TerrainProfilePointer(
+            new std::vector<double>(elevationArray,
+                                    elevationArray + numSamples + 1));
+
+        QNThreadLock lock(&m_profileCache->mutex);
+        m_profileCache->entries.insert(key, profile);
+    }
+
+    if (reversed) {
+        std::reverse(elevationArray, elevationArray + numSamples + 1);
+    }
+    return numSamples;
 }
 
 void TerrainData::boundCoordinatesToTerrain(Coordinates* point,
@@ -0,0 +1,170 @@
+// Copyright (c) 2001-2015, SCALABLE Network Technologies, Inc.  All Rights Reserved.
+//                          600 Corporate Pointe
+//                          Suite 1200
+//                          Culver City, CA 90230
+//                          info@scalable-networks.com
+//
+// This source code is licensed, not sold, and is subject to a written
+// license agreement.  Among other things, no portion of this source
+// code may be copied, transmitted, disclosed, displayed, distributed,
+// translated, used as the basis for a derivative work, or used, in
+// whole or in part, for any program or purpose other than its intended
+// use in compliance with the license agreement as part of the QualNet
+// software.  This source code and certain of the algorithms contained
+// within it are confidential trade secrets of Scalable Network
+// Technologies, Inc. and may not be used as the basis for any other
+// software, hardware, product or service.
+
+/*
+ * Checks that the terrain profile cache returns, in both directions of
+ * a path, the elevation profile getElevationArray returns without the
+ * cache, on a miss and on a hit.  Exits with the number of failed
+ * checks.
+ *
+ * Usage: terrain_profile_check
+ */
+
+#include <stdio.h>
+#include <math.h>
+
+#include "api.h"
+#include "fileio.h"
+#include "terrain.h"
+
+#define TERRAIN_PROFILE_CHECK_CONFIG    "terrain_profile_check.config"
+#define TERRAIN_PROFILE_CHECK_SAMPLING  7.0
+
+// A cached profile of a path along a latitude may be sampled from the
+// other endpoint and reversed, which can change the rounding
+#define TERRAIN_PROFILE_CHECK_TOLERANCE 1e-6
+
+static int terrainProfileCheckFailures = 0;
+
+// Elevation of a tilted surface, different along every path from its
+// reverse unless the path is level
+class TerrainProfileCheckSlope : public ElevationTerrainData
+{
+public:
+    TerrainProfileCheckSlope(TerrainData* td) : ElevationTerrainData(td) {
+        m_modelName = "SLOPE";
+    }
+
+    bool hasData() { return true; }
+
+    double getElevationAt(const Coordinates* c) {
+        return 3.0 * c->common.c1 + 7.0 * c->common.c2 +
+               0.01 * c->common.c1 * c->common.c2;
+    }
+};
+
+static
+void TerrainProfileCheckInitialize(TerrainData* terrainData, bool cached)
+{
+    NodeInput nodeInput;
+    FILE* fp;
+
+    fp = fopen(TERRAIN_PROFILE_CHECK_CONFIG, "w");
+    if (fp == NULL)
+    {
+        ERROR_ReportError("Cannot write " TERRAIN_PROFILE_CHECK_CONFIG);
+    }
+    fprintf(fp, "COORDINATE-SYSTEM CARTESIAN\n");
+    fprintf(fp, "TERRAIN-DIMENSIONS (1000, 1000)\n");
+    fprintf(fp, "TERRAIN-PROFILE-CACHE %s\n", cached ? "YES" : "NO");
+    fclose(fp);
+
+    IO_InitializeNodeInput(&nodeInput, true);
+    IO_ReadNodeInput(&nodeInput, TERRAIN_PROFILE_CHECK_CONFIG);
+    remove(TERRAIN_PROFILE_CHECK_CONFIG);
+
+    terrainData->initialize(&nodeInput, true);
+    terrainData->setElevationData(new TerrainProfileCheckSlope(terrainData));
+}
+
+// Gets the profile from c1 to c2 from both terrains, twice from the
+// cached one so that the second is a hit, and compares them
+static
+void TerrainProfileCheckPath(TerrainData* plain,
+                             TerrainData* cached,
+                             const Coordinates* c1,
+                             const Coordinates* c2)
+{
+    double expected[MAX_NUM_ELEVATION_SAMPLES];
+    double actual[MAX_NUM_ELEVATION_SAMPLES];
+    double distance;
+    int numExpected;
+    int numActual;
+    bool same;
+
+    distance = sqrt(pow(c2->common.c1 - c1->common.c1, 2) +
+                    pow(c2->common.c2 - c1->common.c2, 2));
+    numExpected = plain->getElevationArray(c1, c2, distance,
+                                           TERRAIN_PROFILE_CHECK_SAMPLING,
+                                           expected);
+
+    for (int pass = 0; pass < 2; pass++)
+    {
+        numActual = cached->getElevationArray(c1, c2, distance,
+                                              TERRAIN_PROFILE_CHECK_SAMPLING,
+                                              actual);
+        same = numActual == numExpected;
+        for (int i = 0; same && i <= numExpected; i++)
+        {
+            same = fabs(actual[i] - expected[i]) <
+                   TERRAIN_PROFILE_CHECK_TOLERANCE;
+        }
+        if (!same)
+        {
+            printf("FAIL (%g, %g) to (%g, %g), %s\n",
+                   c1->common.c1, c1->common.c2,
+                   c2->common.c1, c2->common.c2,
+                   pass == 0 ? "miss" : "hit");
+            terrainProfileCheckFailures++;
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    // Path endpoints; each pair is checked in both directions
+    static const double endpoints[][4] = {
+        {100.0, 200.0, 700.0, 900.0},   // rising
+        {800.0, 150.0, 250.0, 600.0},   // falling
+        {400.0, 100.0, 400.0, 850.0},   // equal latitudes
+        {300.0, 500.0, 900.0, 500.0}};  // equal longitudes
+    TerrainData plain;
+    TerrainData cached;
+
+    if (argc != 1)
+    {
+        fprintf(stderr, "Usage: %s\n", argv[0]);
+        return 1;
+    }
+
+    TerrainProfileCheckInitialize(&plain, false);
+    TerrainProfileCheckInitialize(&cached, true);
+
+    for (size_t p = 0; p < sizeof(endpoints) / sizeof(endpoints[0]); p++)
+    {
+        Coordinates a;
+        Coordinates b;
+
+        memset(&a, 0, sizeof(a));
+        memset(&b, 0, sizeof(b));
+        a.common.c1 = endpoints[p][0];
+        a.common.c2 = endpoints[p][1];
+        b.common.c1 = endpoints[p][2];
+        b.common.c2 = endpoints[p][3];
+
+        TerrainProfileCheckPath(&plain, &cached, &a, &b);
+        TerrainProfileCheckPath(&plain, &cached, &b, &a);
+    }
+
+    plain.finalize();
+    cached.finalize();
+
+    printf("%s: %d failed\n",
+           terrainProfileCheckFailures == 0 ? "PASS" : "FAIL",
+           terrainProfileCheckFailures);
+    return terrainProfileCheckFailures;
+}